@@ -0,0 +1,307 @@
+#include "AsyncLogger.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+// Copy a string into a record's text field, truncating if it does not fit
+static void copy_text(LogRecord& record, std::string_view text) {
+    std::size_t n = std::min(text.size(), sizeof(record.text) - 1);
+    std::memcpy(record.text, text.data(), n);
+    record.text[n] = '\0';
+}
+
+// The shared logger
+AsyncLogger& AsyncLogger::instance() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+// Start the writer thread
+AsyncLogger::AsyncLogger() : writer_(&AsyncLogger::run, this) {}
+
+// Write whatever is still queued and close the file
+AsyncLogger::~AsyncLogger() {
+    stop();
+    if (fd_ > 2) {
+        ::close(fd_);
+    }
+}
+
+// Send the log to a file that is rotated once it passes max_bytes
+void AsyncLogger::set_file(const std::string& path, std::uint64_t max_bytes, int max_files) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    if (fd_ > 2) {
+        ::close(fd_);
+    }
+    file_path_ = path;
+    max_bytes_ = max_bytes;
+    max_files_ = std::max(1, max_files);
+    open_file();
+}
+
+// Open file_path_ for appending, falling back to stdout if that fails
+void AsyncLogger::open_file() {
+    fd_ = ::open(file_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::cerr << "Cannot open log file " << file_path_ << ", logging to stdout\n";
+        fd_ = 1;
+        file_path_.clear();
+        return;
+    }
+    off_t size = ::lseek(fd_, 0, SEEK_END);
+    file_bytes_ = size > 0 ? static_cast<std::uint64_t>(size) : 0;
+}
+
+// path.(N-1) is discarded, every other file moves up one and a fresh path is opened
+void AsyncLogger::rotate() {
+    ::close(fd_);
+    for (int i = max_files_ - 1; i > 0; --i) {
+        std::string from = i == 1 ? file_path_ : file_path_ + "." + std::to_string(i - 1);
+        std::string to = file_path_ + "." + std::to_string(i);
+        std::rename(from.c_str(), to.c_str());
+    }
+    if (max_files_ == 1) {
+        ::unlink(file_path_.c_str());
+    }
+    open_file();
+}
+
+// This thread's ring; the list lock is only taken the first time a thread logs
+SpscRing<LogRecord>* AsyncLogger::local_ring() {
+    thread_local RingHandle handle;
+    if (!handle.ring) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        if (!running_.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        rings_.push_back(std::make_unique<ThreadRing>(kRingCapacity));
+        handle.ring = rings_.back().get();
+    }
+    return &handle.ring->ring;
+}
+
+// Thread exit: the writer frees the ring after draining what is left in it
+AsyncLogger::RingHandle::~RingHandle() {
+    if (ring) {
+        ring->retired.store(true, std::memory_order_release);
+    }
+}
+
+// Fill the next record of this thread's ring in place; never waits for the writer
+template <typename Fill>
+void AsyncLogger::push(Fill&& fill) {
+    SpscRing<LogRecord>* ring = local_ring();
+    if (!ring || !ring->try_emplace(fill)) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Copy the fields the line needs; formatting happens on the writer thread
+void AsyncLogger::log(const MarketEvent& event) {
+    push([&event](LogRecord& record) {
+        record.timestamp_ns = event.receive_ns;
+        record.exchange_ts = event.exchange_ts;
+        record.latency_ns = event.exchange_latency_ns;
+        std::memcpy(record.text, event.symbol, kSymbolSize);
+        switch (event.type) {
+        case EventType::PriceIndex:
+            record.kind = LogKind::PriceIndex;
+            record.values[0] = event.index.price;
+            break;
+        case EventType::Book:
+            record.kind = LogKind::Book;
+            record.flag = event.book.snapshot;
+            record.count = static_cast<std::uint16_t>(event.book.count);
+            record.sequence = event.book.change_id;
+            break;
+        case EventType::Trade:
+            record.kind = LogKind::Trade;
+            record.flag = event.trade.buy;
+            record.values[0] = event.trade.amount;
+            record.values[1] = event.trade.price;
+            break;
+        case EventType::Ticker:
+            record.kind = LogKind::Ticker;
+            record.values[0] = event.ticker.best_bid_amount;
+            record.values[1] = event.ticker.best_bid_price;
+            record.values[2] = event.ticker.best_ask_amount;
+            record.values[3] = event.ticker.best_ask_price;
+            record.values[4] = event.ticker.mark_price;
+            break;
+        default:
+            record.kind = LogKind::Text;
+            copy_text(record, "[unknown] " + std::string(event.symbol_view()));
+            break;
+        }
+    });
+}
+
+// Queue one line of text
+void AsyncLogger::log(std::string_view text) {
+    auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    push([&text, now_ns](LogRecord& record) {
+        record.timestamp_ns = now_ns;
+        record.kind = LogKind::Text;
+        copy_text(record, text);
+    });
+}
+
+// Wait for two complete writer passes after every ring has been seen empty, so records queued before
+// the call are on their way to the sink
+void AsyncLogger::flush() {
+    if (!writer_.joinable()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    std::uint64_t target = passes_ + 2;
+    flushed_.wait(lock, [this, target]() { return passes_ >= target || !running_.load(); });
+}
+
+// Drain and join the writer; rings of live threads stay allocated because their threads still hold them
+void AsyncLogger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        running_.store(false);
+    }
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    flushed_.notify_all();
+}
+
+// Written and dropped counters
+LogStats AsyncLogger::stats() const {
+    return LogStats{written_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed)};
+}
+
+// Move every queued record of every ring into batch, then free the rings of exited threads. Only the
+// writer removes rings, so indices below ring_count stay valid while producers append new ones.
+std::size_t AsyncLogger::drain(std::vector<LogRecord>& batch) {
+    std::size_t ring_count;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        ring_count = rings_.size();
+    }
+    std::size_t drained = 0;
+    bool any_retired = false;
+    for (std::size_t i = 0; i < ring_count; ++i) {
+        ThreadRing* owner;
+        {
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            owner = rings_[i].get();
+        }
+        bool retired = owner->retired.load(std::memory_order_acquire);  // Before draining: nothing is pushed after it
+        any_retired |= retired;
+        while (LogRecord* record = owner->ring.front()) {
+            batch.push_back(*record);
+            owner->ring.pop();
+            ++drained;
+        }
+    }
+    if (any_retired) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        auto drained_end = rings_.begin() + static_cast<std::ptrdiff_t>(ring_count);
+        rings_.erase(std::remove_if(rings_.begin(), drained_end,
+                                    [](const std::unique_ptr<ThreadRing>& owner) {
+                                        return owner->retired.load(std::memory_order_acquire) && owner->ring.front() == nullptr;
+                                    }),
+                     drained_end);
+    }
+    return drained;
+}
+
+// Writer thread: drain, order by timestamp, format into one buffer and write it in one call
+void AsyncLogger::run() {
+    std::vector<LogRecord> batch;
+    std::string text;
+    while (true) {
+        bool stopping = !running_.load();
+        batch.clear();
+        drain(batch);
+        if (!batch.empty()) {
+            std::stable_sort(batch.begin(), batch.end(),
+                [](const LogRecord& a, const LogRecord& b) { return a.timestamp_ns < b.timestamp_ns; });
+            text.clear();
+            for (const LogRecord& record : batch) {
+                format(record, text);
+            }
+            write(text);
+            written_.fetch_add(batch.size(), std::memory_order_relaxed);
+        }
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            ++passes_;
+        }
+        flushed_.notify_all();
+        if (stopping) {
+            return;  // The pass after the stop request found everything queued before it
+        }
+        if (batch.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));  // Nothing to batch yet
+        }
+    }
+}
+
+// Write a formatted batch, retrying short writes, and rotate the file once it is full
+void AsyncLogger::write(const std::string& chunk) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    const char* data = chunk.data();
+    std::size_t left = chunk.size();
+    while (left > 0) {
+        ssize_t n = ::write(fd_, data, left);
+        if (n <= 0) {
+            break;  // Nothing sensible to report the failure to
+        }
+        data += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    if (!file_path_.empty()) {
+        file_bytes_ += chunk.size();
+        if (file_bytes_ >= max_bytes_) {
+            rotate();
+        }
+    }
+}
+
+// One line per record, in the same layout as operator<<(std::ostream&, const MarketEvent&)
+void AsyncLogger::format(const LogRecord& record, std::string& out) {
+    char line[512];
+    int n = 0;
+    switch (record.kind) {
+    case LogKind::PriceIndex:
+        n = std::snprintf(line, sizeof(line), "[index] %s price=%g", record.text, record.values[0]);
+        break;
+    case LogKind::Book:
+        n = std::snprintf(line, sizeof(line), "[book] %s %s change_id=%lld levels=%u", record.text,
+                          record.flag ? "snapshot" : "delta", static_cast<long long>(record.sequence),
+                          static_cast<unsigned>(record.count));
+        break;
+    case LogKind::Trade:
+        n = std::snprintf(line, sizeof(line), "[trade] %s %s %g @ %g", record.text, record.flag ? "buy" : "sell",
+                          record.values[0], record.values[1]);
+        break;
+    case LogKind::Ticker:
+        n = std::snprintf(line, sizeof(line), "[ticker] %s bid=%g @ %g ask=%g @ %g mark=%g", record.text,
+                          record.values[0], record.values[1], record.values[2], record.values[3], record.values[4]);
+        break;
+    case LogKind::Text:
+        out.append(record.text);
+        out.push_back('\n');
+        return;
+    }
+    out.append(line, static_cast<std::size_t>(std::clamp(n, 0, static_cast<int>(sizeof(line)) - 1)));
+    n = std::snprintf(line, sizeof(line), " ts=%lld", static_cast<long long>(record.exchange_ts));
+    out.append(line, static_cast<std::size_t>(n));
+    if (record.latency_ns != 0) {
+        n = std::snprintf(line, sizeof(line), " latency_us=%lld", static_cast<long long>(record.latency_ns / 1000));
+        out.append(line, static_cast<std::size_t>(n));
+    }
+    out.push_back('\n');
+}
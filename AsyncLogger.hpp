@@ -0,0 +1,96 @@
+#ifndef ASYNC_LOGGER_HPP
+#define ASYNC_LOGGER_HPP
+
+#include <atomic>  // Stop flag and counters
+#include <condition_variable>  // flush() waits for the writer
+#include <cstdint>  // Record fields
+#include <memory>  // Per-thread rings
+#include <mutex>  // Ring list and sink
+#include <string>  // Output path and format buffer
+#include <string_view>  // Text records
+#include <thread>  // Writer thread
+#include <vector>  // Ring list and batches
+#include "MarketEvents.hpp"  // Events logged by the feed consumer
+#include "SpscRing.hpp"  // Per-thread record buffers
+
+enum class LogKind : std::uint8_t { Text, PriceIndex, Book, Trade, Ticker };  // Layout of a LogRecord
+
+constexpr std::size_t kLogTextSize = 192;  // Longest text line kept, terminator included; longer lines are cut
+
+// Compact record pushed by hot threads; formatted to text only on the writer thread
+struct LogRecord {
+    std::int64_t timestamp_ns;  // Receive time for events, enqueue time for text
+    LogKind kind;  // Which fields below are meaningful
+    bool flag;  // Book: snapshot; Trade: buy
+    std::uint16_t count;  // Book: levels in the fragment
+    char text[kLogTextSize];  // Symbol, or the (truncated) message for Text
+    std::int64_t exchange_ts;  // Exchange timestamp in milliseconds
+    std::int64_t sequence;  // Book: change_id
+    std::int64_t latency_ns;  // MarketEvent::exchange_latency_ns
+    double values[5];  // Index: price; Trade: amount, price; Ticker: bid amount/price, ask amount/price, mark
+};
+
+struct LogStats {
+    std::uint64_t written;  // Records formatted and written
+    std::uint64_t dropped;  // Records lost because a thread's buffer was full
+};
+
+// Logging that never blocks the thread producing the records: each thread pushes fixed-size records
+// into its own SPSC ring and one writer thread drains every ring, orders the batch by timestamp,
+// formats it and hands it to stdout or a size-rotated file with a single write.
+class AsyncLogger {
+public:
+    static AsyncLogger& instance();  // The shared logger; its writer starts on first use
+    ~AsyncLogger();  // Drains and stops the writer
+
+    void set_file(const std::string& path, std::uint64_t max_bytes = 256ull << 20, int max_files = 5);  // Write to path instead of stdout, keeping path.1 .. path.<max_files - 1>
+    void log(const MarketEvent& event);  // Record a decoded event; drops (and counts) if this thread's buffer is full
+    void log(std::string_view text);  // Record one line of text, truncated to the record size
+    void flush();  // Wait until everything logged before the call has been written
+    void stop();  // Drain the rings and stop the writer; later records are dropped
+    LogStats stats() const;  // Written and dropped counters
+
+private:
+    AsyncLogger();
+
+    static constexpr std::size_t kRingCapacity = 16384;  // Records buffered per producing thread
+
+    // One producing thread's buffer; retired when the thread exits and freed by the writer once drained
+    struct ThreadRing {
+        explicit ThreadRing(std::size_t capacity) : ring(capacity) {}
+        SpscRing<LogRecord> ring;  // Records from the owning thread
+        std::atomic<bool> retired{false};  // The owning thread has exited and will push no more
+    };
+    struct RingHandle {
+        ThreadRing* ring = nullptr;  // This thread's ring, null until it first logs
+        ~RingHandle();  // Retire the ring at thread exit
+    };
+
+    SpscRing<LogRecord>* local_ring();  // This thread's ring, created on first use; nullptr once stopped
+    template <typename Fill>
+    void push(Fill&& fill);  // Fill a record in this thread's ring
+    void run();  // Writer thread body
+    std::size_t drain(std::vector<LogRecord>& batch);  // Move every queued record into batch
+    void write(const std::string& chunk);  // Hand formatted text to the sink, rotating the file if due
+    void open_file();  // (Re)open file_path_ for appending (sink_mutex_ held)
+    void rotate();  // Shift path.N -> path.N+1 and start a new file (sink_mutex_ held)
+    static void format(const LogRecord& record, std::string& out);  // Append one line
+
+    std::mutex rings_mutex_;  // Guards rings_ growth
+    std::vector<std::unique_ptr<ThreadRing>> rings_;  // One per live producing thread (and exited ones not yet drained)
+    std::mutex sink_mutex_;  // Guards the file state below
+    int fd_ = 1;  // stdout until set_file()
+    std::string file_path_;  // Empty for stdout
+    std::uint64_t file_bytes_ = 0;  // Size of the current file
+    std::uint64_t max_bytes_ = 0;  // Rotation threshold
+    int max_files_ = 0;  // Files kept including the current one
+    std::mutex flush_mutex_;  // Pairs with flushed_
+    std::condition_variable flushed_;  // Signalled after every writer pass
+    std::uint64_t passes_ = 0;  // Writer passes completed (flush_mutex_ held)
+    std::atomic<bool> running_{true};  // Cleared by stop()
+    std::atomic<std::uint64_t> written_{0};  // LogStats::written
+    std::atomic<std::uint64_t> dropped_{0};  // LogStats::dropped
+    std::thread writer_;  // Formats and writes batches
+};
+
+#endif
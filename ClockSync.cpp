@@ -0,0 +1,115 @@
+#include "ClockSync.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// The shared estimator
+ClockSync& ClockSync::instance() {
+    static ClockSync clock_sync;
+    return clock_sync;
+}
+
+// Record one round trip; only the round's minimum-round-trip sample survives finish_round()
+void ClockSync::add_sample(std::int64_t send_ns, std::int64_t exchange_in_ns, std::int64_t exchange_out_ns,
+                           std::int64_t receive_ns) {
+    Sample sample;
+    sample.round_trip_ns = std::max<std::int64_t>(0, (receive_ns - send_ns) - (exchange_out_ns - exchange_in_ns));
+    sample.offset_ns = ((exchange_in_ns - send_ns) + (exchange_out_ns - receive_ns)) / 2;
+    sample.local_ns = send_ns + (receive_ns - send_ns) / 2;
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!round_has_sample_ || sample.round_trip_ns < round_best_.round_trip_ns) {
+        round_best_ = sample;
+        round_has_sample_ = true;
+    }
+}
+
+// Close the round and refit: rounds whose best round trip is more than three times the quietest one
+// are ignored (queueing made them asymmetric), then a least-squares line through the rest gives the
+// drift once they span a minute; before that the quietest round's offset is used as is.
+void ClockSync::finish_round() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!round_has_sample_) {
+        return;
+    }
+    rounds_.push_back(round_best_);
+    round_has_sample_ = false;
+    if (rounds_.size() > kMaxRounds) {
+        rounds_.pop_front();
+    }
+
+    auto quietest = std::min_element(rounds_.begin(), rounds_.end(),
+        [](const Sample& a, const Sample& b) { return a.round_trip_ns < b.round_trip_ns; });
+    std::int64_t limit = std::max<std::int64_t>(quietest->round_trip_ns * 3, 1000);
+    std::vector<Sample> kept;
+    for (const Sample& round : rounds_) {
+        if (round.round_trip_ns <= limit) {
+            kept.push_back(round);
+        }
+    }
+    std::int64_t uncertainty_ns = quietest->round_trip_ns / 2;
+    if (kept.size() < 3 || kept.back().local_ns - kept.front().local_ns < kMinFitSpanNs) {
+        publish(quietest->offset_ns, 0, uncertainty_ns, quietest->local_ns);
+        return;
+    }
+
+    // Fit offset = a + b * (local - reference) with the newest kept round as reference
+    std::int64_t reference_ns = kept.back().local_ns;
+    double mean_x = 0.0, mean_y = 0.0;
+    for (const Sample& round : kept) {
+        mean_x += static_cast<double>(round.local_ns - reference_ns);
+        mean_y += static_cast<double>(round.offset_ns);
+    }
+    mean_x /= static_cast<double>(kept.size());
+    mean_y /= static_cast<double>(kept.size());
+    double sxx = 0.0, sxy = 0.0;
+    for (const Sample& round : kept) {
+        double dx = static_cast<double>(round.local_ns - reference_ns) - mean_x;
+        sxx += dx * dx;
+        sxy += dx * (static_cast<double>(round.offset_ns) - mean_y);
+    }
+    double slope = sxx > 0.0 ? sxy / sxx : 0.0;
+    auto drift_ppb = std::clamp(static_cast<std::int64_t>(slope * 1e9), -kMaxDriftPpb, kMaxDriftPpb);
+    double offset_at_reference = mean_y - static_cast<double>(drift_ppb) / 1e9 * mean_x;
+    publish(static_cast<std::int64_t>(offset_at_reference), drift_ppb, uncertainty_ns, reference_ns);
+}
+
+// Write the estimate so readers never see a mix of two fits
+void ClockSync::publish(std::int64_t offset_ns, std::int64_t drift_ppb, std::int64_t uncertainty_ns,
+                        std::int64_t reference_ns) {
+    std::uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    offset_ns_.store(offset_ns, std::memory_order_relaxed);
+    drift_ppb_.store(drift_ppb, std::memory_order_relaxed);
+    uncertainty_ns_.store(uncertainty_ns, std::memory_order_relaxed);
+    reference_ns_.store(reference_ns, std::memory_order_relaxed);
+    synced_.store(true, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+// Consistent copy of the published estimate
+ClockEstimate ClockSync::estimate() const {
+    ClockEstimate copy;
+    std::uint32_t before, after;
+    do {
+        before = sequence_.load(std::memory_order_acquire);
+        copy.offset_ns = offset_ns_.load(std::memory_order_relaxed);
+        copy.drift_ppb = drift_ppb_.load(std::memory_order_relaxed);
+        copy.uncertainty_ns = uncertainty_ns_.load(std::memory_order_relaxed);
+        copy.reference_ns = reference_ns_.load(std::memory_order_relaxed);
+        copy.synced = synced_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence_.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return copy;
+}
+
+// Exchange minus local clock at a local time, extrapolated along the fitted drift
+std::int64_t ClockSync::offset_at(std::int64_t local_ns) const {
+    ClockEstimate current = estimate();
+    if (!current.synced) {
+        return 0;
+    }
+    auto elapsed = static_cast<double>(local_ns - current.reference_ns);
+    return current.offset_ns + static_cast<std::int64_t>(elapsed * static_cast<double>(current.drift_ppb) / 1e9);
+}
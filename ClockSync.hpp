@@ -0,0 +1,70 @@
+#ifndef CLOCK_SYNC_HPP
+#define CLOCK_SYNC_HPP
+
+#include <atomic>  // Published estimate
+#include <chrono>  // Wall clock
+#include <cstdint>  // Nanosecond timestamps
+#include <deque>  // Retained round samples
+#include <mutex>  // Sample bookkeeping
+
+struct ClockEstimate {
+    std::int64_t offset_ns;  // Exchange clock minus local clock at reference_ns
+    std::int64_t drift_ppb;  // Offset change per second of local time, in ns/s
+    std::int64_t uncertainty_ns;  // Half the round trip of the best recent sample
+    std::int64_t reference_ns;  // Local time offset_ns was measured at
+    bool synced;  // At least one round has completed
+};
+
+// Estimates the offset between the local wall clock and Deribit's from public/get_time round trips,
+// NTP style: each sample gives offset = ((t1 - t0) + (t2 - t3)) / 2 with round trip (t3 - t0) - (t2 - t1),
+// each round of samples keeps only its minimum-round-trip one, and a line fitted through the recent
+// rounds gives offset and drift. Readers on any thread get the estimate through a sequence lock.
+class ClockSync {
+public:
+    static ClockSync& instance();  // The shared estimator
+    static std::int64_t now_ns() {  // Local wall clock in nanoseconds, the clock receive_ns uses
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void add_sample(std::int64_t send_ns, std::int64_t exchange_in_ns, std::int64_t exchange_out_ns,
+                    std::int64_t receive_ns);  // One round trip: local send, exchange receive/send, local receive
+    void finish_round();  // Keep the round's best sample and refit the estimate
+    ClockEstimate estimate() const;  // Consistent copy of the published estimate
+
+    std::int64_t offset_at(std::int64_t local_ns) const;  // Exchange minus local clock at a local time; 0 until synced
+    std::int64_t to_local_ns(std::int64_t exchange_ns) const { return exchange_ns - offset_at(exchange_ns); }  // Exchange time on the local clock
+    std::int64_t one_way_ns(std::int64_t exchange_ns, std::int64_t receive_ns) const {  // Exchange stamp -> local receipt
+        return receive_ns - (exchange_ns - offset_at(receive_ns));
+    }
+
+private:
+    ClockSync() = default;
+
+    struct Sample {
+        std::int64_t local_ns;  // Midpoint of the round trip on the local clock
+        std::int64_t offset_ns;  // Exchange minus local
+        std::int64_t round_trip_ns;  // Network part of the round trip
+    };
+
+    void publish(std::int64_t offset_ns, std::int64_t drift_ppb, std::int64_t uncertainty_ns,
+                 std::int64_t reference_ns);  // Write the estimate under the sequence lock (mutex_ held)
+
+    static constexpr std::size_t kMaxRounds = 16;  // Rounds kept for the drift fit
+    static constexpr std::int64_t kMaxDriftPpb = 500000;  // 500 ppm; anything steeper is noise
+    static constexpr std::int64_t kMinFitSpanNs = 60'000'000'000;  // Fit drift only over a minute or more
+
+    std::mutex mutex_;  // Guards the sample bookkeeping below
+    Sample round_best_{};  // Minimum-round-trip sample of the current round
+    bool round_has_sample_ = false;  // round_best_ is valid
+    std::deque<Sample> rounds_;  // Best sample of each recent round, oldest first
+
+    std::atomic<std::uint32_t> sequence_{0};  // Odd while the estimate is being written
+    std::atomic<std::int64_t> offset_ns_{0};  // ClockEstimate::offset_ns
+    std::atomic<std::int64_t> drift_ppb_{0};  // ClockEstimate::drift_ppb
+    std::atomic<std::int64_t> uncertainty_ns_{0};  // ClockEstimate::uncertainty_ns
+    std::atomic<std::int64_t> reference_ns_{0};  // ClockEstimate::reference_ns
+    std::atomic<bool> synced_{false};  // ClockEstimate::synced
+};
+
+#endif
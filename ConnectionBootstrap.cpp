@@ -0,0 +1,239 @@
+#include "ConnectionBootstrap.hpp"
+
+#include <boost/asio/ssl/host_name_verification.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// ex_data slot carrying the session cache key from connect() to on_new_session()
+static int key_index() {
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+// The shared bootstrap
+ConnectionBootstrap& ConnectionBootstrap::instance() {
+    static ConnectionBootstrap bootstrap;
+    return bootstrap;
+}
+
+// Release every cached session
+ConnectionBootstrap::~ConnectionBootstrap() {
+    for (auto& [key, session] : sessions_) {
+        SSL_SESSION_free(session);
+    }
+}
+
+// Resolve host:port, reusing an answer younger than kResolveTtl. The lookup itself runs without the
+// lock, so a slow DNS server never stalls connections to other hosts or session bookkeeping; threads
+// that miss the cache together each resolve and the last answer is kept.
+tcp::resolver::results_type ConnectionBootstrap::resolve(const std::string& host, const std::string& port) {
+    std::string key = host + ":" + port;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = endpoints_.find(key);
+        if (it != endpoints_.end() && std::chrono::steady_clock::now() - it->second.resolved < kResolveTtl) {
+            return it->second.endpoints;
+        }
+    }
+    net::io_context ioc;
+    tcp::resolver resolver(ioc);
+    auto endpoints = resolver.resolve(host, port);
+    std::lock_guard<std::mutex> lock(mutex_);
+    endpoints_[key] = CachedEndpoints{endpoints, std::chrono::steady_clock::now()};
+    return endpoints;
+}
+
+// Sessions are only interchangeable between connections to the same host and port made with the same
+// verification; a session from an unverified peer is never offered to a verified connection
+std::string ConnectionBootstrap::session_key(const std::string& host, const std::string& port, bool verify_peer) {
+    return host + ":" + port + (verify_peer ? "" : " unverified");
+}
+
+// Have OpenSSL hand new client sessions of this context to on_new_session instead of its internal cache
+void ConnectionBootstrap::prepare_context(SSL_CTX* ctx) {
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, &ConnectionBootstrap::on_new_session);
+}
+
+// Open a WebSocket over TLS: cached DNS, TCP_NODELAY, SNI, optional peer and host-name verification,
+// and, for verified connections, the cached session of the host and port offered for resumption (the
+// server falls back to a full handshake if it no longer accepts it). Unverified connections neither
+// resume nor store sessions.
+void ConnectionBootstrap::connect(SecureWebSocket& ws, const std::string& host, const std::string& port,
+                                  const std::string& target, bool verify_peer) {
+    auto endpoints = resolve(host, port);
+    net::connect(beast::get_lowest_layer(ws), endpoints.begin(), endpoints.end());
+    beast::get_lowest_layer(ws).set_option(tcp::no_delay(true));
+
+    SSL* ssl = ws.next_layer().native_handle();
+    prepare_context(SSL_get_SSL_CTX(ssl));
+    std::string session = session_key(host, port, verify_peer);
+    if (verify_peer) {
+        const std::string* key;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            key = &*keys_.insert(session).first;
+        }
+        SSL_set_ex_data(ssl, key_index(), const_cast<std::string*>(key));
+    }
+    boost::system::error_code address_error;
+    net::ip::make_address(host, address_error);
+    if (address_error) {
+        SSL_set_tlsext_host_name(ssl, host.c_str());  // SNI, only meaningful for names
+    }
+    if (verify_peer) {
+        ws.next_layer().set_verify_mode(ssl::verify_peer);
+        ws.next_layer().set_verify_callback(ssl::host_name_verification(host));
+    } else {
+        ws.next_layer().set_verify_mode(ssl::verify_none);
+    }
+    if (SSL_SESSION* cached = verify_peer ? session_for(session) : nullptr) {
+        SSL_set_session(ssl, cached);
+        SSL_SESSION_free(cached);
+    }
+
+    ws.next_layer().handshake(ssl::stream_base::client);
+    (SSL_session_reused(ssl) ? resumed_handshakes_ : full_handshakes_).fetch_add(1, std::memory_order_relaxed);
+    ws.handshake(host, target);
+}
+
+// Resolve and connect once on a scratch socket so DNS and a TLS session are cached before the real
+// connection needs them; the WebSocket upgrade also reads the TLS 1.3 tickets sent after the handshake
+void ConnectionBootstrap::prewarm(const std::string& host, const std::string& port, const std::string& target) {
+    try {
+        net::io_context ioc;
+        ssl::context ctx(ssl::context::tlsv12_client);
+        ctx.set_default_verify_paths();
+        SecureWebSocket ws(ioc, ctx);
+        connect(ws, host, port, target, true);
+        ws.close(websocket::close_code::normal);
+    } catch (const std::exception& e) {
+        std::cerr << "Pre-warming " << host << " failed: " << e.what() << "\n";
+    }
+}
+
+// OpenSSL callback: a resumable session (or TLS 1.3 ticket) arrived for a connection made by connect()
+int ConnectionBootstrap::on_new_session(SSL* ssl, SSL_SESSION* session) {
+    const auto* key = static_cast<const std::string*>(SSL_get_ex_data(ssl, key_index()));
+    if (!key || !SSL_SESSION_is_resumable(session)) {
+        return 0;  // Not ours to keep (or unverified); OpenSSL frees it
+    }
+    instance().store_session(*key, session);
+    return 1;  // We keep the reference
+}
+
+// Replace the key's session with a newer one and persist the cache
+void ConnectionBootstrap::store_session(const std::string& key, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = sessions_.emplace(key, session);
+    if (!inserted) {
+        SSL_SESSION_free(it->second);
+        it->second = session;
+    }
+    if (!session_file_.empty()) {
+        save_sessions();
+    }
+}
+
+// Extra reference to the key's session if it has not expired
+SSL_SESSION* ConnectionBootstrap::session_for(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(key);
+    if (it == sessions_.end()) {
+        return nullptr;
+    }
+    if (SSL_SESSION_get_time(it->second) + SSL_SESSION_get_timeout(it->second) <= std::time(nullptr)) {
+        SSL_SESSION_free(it->second);
+        sessions_.erase(it);
+        return nullptr;
+    }
+    SSL_SESSION_up_ref(it->second);
+    return it->second;
+}
+
+// Load sessions saved by a previous run and write every new one back. The file holds session secrets,
+// so it is created readable by the owner only. A file that does not parse completely (truncated,
+// oversized lengths, an undecodable session) is discarded as a whole and rewritten from scratch.
+void ConnectionBootstrap::set_session_file(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    session_file_ = path;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    std::vector<std::pair<std::string, SSL_SESSION*>> loaded;
+    bool corrupt = false;
+    std::uint32_t key_length, der_length;
+    while (in.read(reinterpret_cast<char*>(&key_length), sizeof(key_length))) {
+        std::string key(std::min(key_length, kMaxKeyLength), '\0');
+        std::vector<unsigned char> der;
+        corrupt = key_length > kMaxKeyLength || !in.read(key.data(), key_length) ||
+                  !in.read(reinterpret_cast<char*>(&der_length), sizeof(der_length)) || der_length > kMaxSessionLength;
+        if (!corrupt) {
+            der.resize(der_length);
+            corrupt = !in.read(reinterpret_cast<char*>(der.data()), der_length);
+        }
+        SSL_SESSION* session = nullptr;
+        if (!corrupt) {
+            const unsigned char* cursor = der.data();
+            session = d2i_SSL_SESSION(nullptr, &cursor, static_cast<long>(der.size()));
+            corrupt = !session;
+        }
+        if (corrupt) {
+            break;
+        }
+        loaded.emplace_back(std::move(key), session);
+    }
+    corrupt = corrupt || (!in.eof() || in.gcount() != 0);  // A partial length at the end
+    if (corrupt) {
+        for (auto& [key, session] : loaded) {
+            SSL_SESSION_free(session);
+        }
+        in.close();
+        std::remove(path.c_str());
+        std::cerr << "Discarded unreadable TLS session file " << path << "\n";
+        return;
+    }
+    for (auto& [key, session] : loaded) {
+        auto [it, inserted] = sessions_.emplace(std::move(key), session);
+        if (!inserted) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+        }
+    }
+}
+
+// Rewrite the session file atomically (lock held)
+void ConnectionBootstrap::save_sessions() {
+    std::string temporary = session_file_ + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        std::filesystem::permissions(temporary, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write,
+                                     std::filesystem::perm_options::replace);
+        for (const auto& [key, session] : sessions_) {
+            int length = i2d_SSL_SESSION(session, nullptr);
+            if (length <= 0) {
+                continue;
+            }
+            std::vector<unsigned char> der(static_cast<std::size_t>(length));
+            unsigned char* cursor = der.data();
+            i2d_SSL_SESSION(session, &cursor);
+            auto key_length = static_cast<std::uint32_t>(key.size());
+            auto der_length = static_cast<std::uint32_t>(der.size());
+            out.write(reinterpret_cast<const char*>(&key_length), sizeof(key_length));
+            out.write(key.data(), key_length);
+            out.write(reinterpret_cast<const char*>(&der_length), sizeof(der_length));
+            out.write(reinterpret_cast<const char*>(der.data()), der_length);
+        }
+    }
+    std::rename(temporary.c_str(), session_file_.c_str());
+}
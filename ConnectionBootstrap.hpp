@@ -0,0 +1,74 @@
+#ifndef CONNECTION_BOOTSTRAP_HPP
+#define CONNECTION_BOOTSTRAP_HPP
+
+#include <boost/asio.hpp>  // Resolver and io_context
+#include <boost/asio/ssl.hpp>  // TLS contexts and streams
+#include <boost/beast/core.hpp>  // Lowest-layer access
+#include <boost/beast/ssl.hpp>  // beast::ssl_stream
+#include <boost/beast/websocket.hpp>  // WebSocket upgrade
+#include <openssl/ssl.h>  // SSL_SESSION handling
+#include <atomic>  // Handshake counters
+#include <chrono>  // Resolution cache lifetime
+#include <cstdint>  // Counters
+#include <map>  // Per-host caches
+#include <mutex>  // Shared by every connecting thread
+#include <set>  // Stable session-key storage for OpenSSL ex_data
+#include <string>  // Host names and paths
+
+namespace beast = boost::beast;  // Alias for Boost.Beast
+namespace websocket = beast::websocket;  // Alias for WebSocket in Beast
+namespace net = boost::asio;  // Alias for Boost.Asio
+namespace ssl = boost::asio::ssl;  // Alias for Boost.Asio SSL functionality
+using tcp = net::ip::tcp;  // Alias for TCP socket type
+
+using SecureWebSocket = websocket::stream<beast::ssl_stream<tcp::socket>>;  // What DeribitClient and the feed shards speak
+
+// Process-wide connection set-up shared by the trading client and the market-data shards: DNS answers
+// are cached, TLS sessions (tickets) of verified connections are kept per host and port and optionally
+// persisted to a file so later connections, including those of the next process, resume instead of
+// doing a full handshake, and a host can be pre-warmed in the background while another connection is being set up.
+class ConnectionBootstrap {
+public:
+    static ConnectionBootstrap& instance();  // The shared bootstrap
+    ConnectionBootstrap(const ConnectionBootstrap&) = delete;
+    ConnectionBootstrap& operator=(const ConnectionBootstrap&) = delete;
+
+    tcp::resolver::results_type resolve(const std::string& host, const std::string& port);  // Cached for kResolveTtl
+    void connect(SecureWebSocket& ws, const std::string& host, const std::string& port,
+                 const std::string& target, bool verify_peer);  // TCP, TLS (resumed when possible) and WebSocket upgrade
+    void prewarm(const std::string& host, const std::string& port, const std::string& target);  // Resolve and complete one throwaway handshake
+    void set_session_file(const std::string& path);  // Load cached TLS sessions and keep the file updated
+
+    std::uint64_t full_handshakes() const { return full_handshakes_.load(std::memory_order_relaxed); }  // TLS handshakes without resumption
+    std::uint64_t resumed_handshakes() const { return resumed_handshakes_.load(std::memory_order_relaxed); }  // TLS handshakes that reused a session
+
+private:
+    ConnectionBootstrap() = default;
+    ~ConnectionBootstrap();  // Frees cached sessions
+
+    static constexpr std::chrono::minutes kResolveTtl{5};  // How long a DNS answer is reused
+    static constexpr std::uint32_t kMaxKeyLength = 255;  // Longest session key accepted from the session file
+    static constexpr std::uint32_t kMaxSessionLength = 16 * 1024;  // Longest encoded session accepted from it
+
+    struct CachedEndpoints {
+        tcp::resolver::results_type endpoints;  // Resolver answer
+        std::chrono::steady_clock::time_point resolved;  // When it was obtained
+    };
+
+    static std::string session_key(const std::string& host, const std::string& port, bool verify_peer);  // Cache key of a session
+    void prepare_context(SSL_CTX* ctx);  // Route new client sessions of this context to the cache
+    static int on_new_session(SSL* ssl, SSL_SESSION* session);  // OpenSSL callback, called when a ticket arrives
+    void store_session(const std::string& key, SSL_SESSION* session);  // Takes ownership of one reference
+    SSL_SESSION* session_for(const std::string& key);  // Extra reference to the cached session, or nullptr
+    void save_sessions();  // Write the session file (lock held)
+
+    std::mutex mutex_;  // Guards the caches and the file; never held across DNS lookups
+    std::map<std::string, CachedEndpoints> endpoints_;  // "host:port" -> endpoints
+    std::map<std::string, SSL_SESSION*> sessions_;  // session_key() -> newest resumable session
+    std::set<std::string> keys_;  // Keys handed to OpenSSL as ex_data; nodes never move
+    std::string session_file_;  // Empty when sessions are not persisted
+    std::atomic<std::uint64_t> full_handshakes_{0};  // See full_handshakes()
+    std::atomic<std::uint64_t> resumed_handshakes_{0};  // See resumed_handshakes()
+};
+
+#endif
@@ -1,29 +1,66 @@
 
 #include "DeribitClient.hpp"
 
-// Constructor: Initializes WebSocket and SSL context
+#include <algorithm>
+#include <cassert>
+
+// Constructor: Initializes WebSocket and SSL context on a strand of the shared runtime
 DeribitClient::DeribitClient(const std::string& host, const std::string& port, const std::string& client_id, const std::string& client_secret)
-        : resolver_(ioc_), ws_(ioc_, ctx_), host_(host), port_(port), client_id_(client_id), client_secret_(client_secret) {
+        : strand_(Runtime::instance().make_strand()), ws_(strand_, ctx_), host_(host), port_(port),
+          client_id_(client_id), client_secret_(client_secret) {
         ctx_.set_default_verify_paths();
         ctx_.set_verify_mode(net::ssl::verify_peer);
+        std::shared_ptr<std::promise<void>> drained = std::make_shared<std::promise<void>>();
+        drained_ = drained->get_future();
+        lifetime_ = std::shared_ptr<void>(nullptr, [drained](void*) { drained->set_value(); });
     }
 
-// Destructor: Closes WebSocket connection
+// Destructor: Closes the WebSocket on the connection's strand and waits until no handler can touch this
+// object any more. Every asynchronous operation holds a copy of lifetime_, so dropping ours and waiting
+// for the last copy to go covers the read loop, queued writes and the timers alike. A peer that does not
+// answer the close within kCloseTimeout has its socket shut, which aborts whatever is still pending. Must
+// not run on strand_ or any other runtime thread: the wait needs those threads to run the handlers.
 DeribitClient:: ~DeribitClient() {
-        try {
-            ws_.close(websocket::close_code::normal);
-        } catch (const std::exception& e) {
-            std::cerr << "WebSocket close error: " << e.what() << "\n";
-        }
+        assert(!strand_.running_in_this_thread());
+        net::post(strand_, [this, alive = lifetime_]() {
+            refresh_timer_.cancel();
+            heartbeat_timer_.cancel();
+            clock_timer_.cancel();
+            if (!open_.exchange(false)) {
+                beast::error_code ignored;
+                beast::get_lowest_layer(ws_).close(ignored);  // Aborts writes still waiting on a dead connection
+                return;
+            }
+            close_timer_.expires_after(kCloseTimeout);
+            close_timer_.async_wait([this, alive](beast::error_code ec) {
+                if (!ec) {
+                    std::cerr << "WebSocket close timed out\n";
+                    beast::get_lowest_layer(ws_).close(ec);
+                }
+            });
+            ws_.async_close(websocket::close_code::normal, [this, alive](beast::error_code ec) {
+                close_timer_.cancel();
+                if (ec) {
+                    std::cerr << "WebSocket close error: " << ec.message() << "\n";
+                }
+            });
+        });
+        lifetime_.reset();
+        drained_.wait();
+        fail_pending("Connection closed");
     }
 
 // Connect to Deribit WebSocket API
 void DeribitClient:: connect() {
-        auto const results = resolver_.resolve(host_, port_);
-        net::connect(beast::get_lowest_layer(ws_), results.begin(), results.end());
-        ws_.next_layer().handshake(net::ssl::stream_base::client);
         ws_.binary(false);
-        ws_.handshake(host_, "/ws/api/v2");
+        ConnectionBootstrap::instance().connect(ws_, host_, port_, "/ws/api/v2", verify_peer_);  // Cached DNS, resumed TLS when possible
+        start_io();
+    }
+
+// Start reading responses asynchronously on the connection's strand
+void DeribitClient:: start_io() {
+        open_ = true;
+        net::post(strand_, [this, alive = lifetime_]() { do_read(); });
     }
 
 // Authenticate with API using client credentials
@@ -38,48 +75,495 @@ void DeribitClient:: authenticate() {
                 {"client_secret", client_secret_}
             }}
         };
-        send_request(auth_payload);
+        json::value response = send_request(auth_payload);
+        const auto* result = response.as_object().if_contains("result");
+        if (!result || !result->is_object()) {
+            throw std::runtime_error("Authentication failed: " + json::serialize(response));
+        }
+        net::post(strand_, [this, alive = lifetime_, result = result->as_object()]() { on_auth_result(result); });
     }
 
-// Send request via WebSocket and return response
-json::value DeribitClient:: send_request(const json::value& payload) {
-        ws_.write(net::buffer(json::serialize(payload)));
-        beast::flat_buffer buffer;
-        ws_.read(buffer);
-        std::string response = beast::buffers_to_string(buffer.data());
-        return json::parse(response);
+// Remember the refresh token and use it shortly before the access token expires (strand)
+void DeribitClient:: on_auth_result(const json::object& result) {
+        const auto* token = result.if_contains("refresh_token");
+        const auto* expires_in = result.if_contains("expires_in");
+        if (!token || !token->is_string() || !expires_in || !expires_in->is_int64()) {
+            return;
+        }
+        refresh_token_.assign(token->as_string().data(), token->as_string().size());
+        auto lifetime = std::chrono::seconds(expires_in->as_int64());
+        refresh_timer_.expires_after(lifetime * 4 / 5);  // Leave a fifth of the lifetime for the round trip
+        refresh_timer_.async_wait([this, alive = lifetime_](beast::error_code ec) {
+            if (!ec && open_) {
+                refresh_session();
+            }
+        });
     }
 
-// Place a buy order
-json::value DeribitClient:: place_order(const std::string& instrument, const std::string& type, int quantity, double price) {
-        json::value order_payload = {
+// Renew the session with grant_type=refresh_token; fall back to the client credentials if it is refused
+void DeribitClient:: refresh_session() {
+        json::value refresh_payload = {
             {"jsonrpc", "2.0"},
-            {"id", ++current_id_},
-            {"method", "private/buy"},
+            {"method", "public/auth"},
             {"params", {
-                {"instrument_name", instrument},
-                {"amount", quantity},
-                {"type", type},
-                {"price", price}
+                {"grant_type", "refresh_token"},
+                {"refresh_token", refresh_token_}
             }}
         };
-        return send_request(order_payload);
+        async_request(std::move(refresh_payload), [this](json::value response) {
+            const auto* result = response.as_object().if_contains("result");
+            if (result && result->is_object()) {
+                on_auth_result(result->as_object());
+                return;
+            }
+            std::cerr << "Token refresh failed, re-authenticating: " << json::serialize(response) << "\n";
+            json::value auth_payload = {
+                {"jsonrpc", "2.0"},
+                {"method", "public/auth"},
+                {"params", {
+                    {"grant_type", "client_credentials"},
+                    {"client_id", client_id_},
+                    {"client_secret", client_secret_}
+                }}
+            };
+            async_request(std::move(auth_payload), [this](json::value retry) {
+                const auto* retry_result = retry.as_object().if_contains("result");
+                if (retry_result && retry_result->is_object()) {
+                    on_auth_result(retry_result->as_object());
+                } else {
+                    std::cerr << "Re-authentication failed: " << json::serialize(retry) << "\n";
+                }
+            });
+        });
     }
 
-// Place a sell order
-json::value DeribitClient:: sell_order(const std::string& instrument, const std::string& type, int quantity, double price) {
-        json::value order_payload = {
+// Send request via WebSocket and block until the response with the same id arrives
+json::value DeribitClient:: send_request(const json::value& payload) {
+        return async_request(payload).get();
+    }
+
+// Send request without waiting and return a future for its response
+std::future<json::value> DeribitClient:: async_request(json::value payload) {
+        std::future<json::value> response;
+        async_request(std::move(payload), promise_handler(response));
+        return response;
+    }
+
+// Build a handler that fulfils a promise and hand back the matching future
+ResponseHandler DeribitClient:: promise_handler(std::future<json::value>& future) {
+        auto promise = std::make_shared<std::promise<json::value>>();
+        future = promise->get_future();
+        return [promise](json::value result) { promise->set_value(std::move(result)); };
+    }
+
+// Send request without waiting; handler is invoked on the connection's strand with the matching response
+void DeribitClient:: async_request(json::value payload, ResponseHandler handler) {
+        std::uint64_t start = TscClock::now();
+        int id = assign_id(payload);
+        std::string frame = json::serialize(payload);
+        encode_latency_.record_ticks(start);
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            pending_.emplace(id, PendingRequest{std::move(handler), TscClock::now(), ClockSync::now_ns()});  // Register before writing so the reply cannot overtake us
+        }
+        dispatch_frame(id, std::move(frame));
+    }
+
+// Encode an order-entry frame from the cached templates into a pooled buffer and send it without waiting
+template <typename Encode>
+void DeribitClient:: send_encoded(Encode&& encode, ResponseHandler handler) {
+        int id = ++current_id_;
+        std::string frame;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            if (!frame_pool_.empty()) {
+                frame = std::move(frame_pool_.back());
+                frame_pool_.pop_back();
+            }
+            std::uint64_t start = TscClock::now();
+            try {
+                encode(frame, id);
+            } catch (const std::exception& e) {
+                // Nothing was sent: fail the handler so a risk reservation made for this order is released
+                net::post(strand_, [handler = std::move(handler), reason = std::string(e.what()), id]() {
+                    handler(make_error(id, "Rejected locally: " + reason, -32602));
+                });
+                return;
+            }
+            std::uint64_t encoded = TscClock::now();
+            encode_latency_.record(TscClock::to_ns(encoded - start));
+            pending_.emplace(id, PendingRequest{std::move(handler), encoded, ClockSync::now_ns()});
+        }
+        dispatch_frame(id, std::move(frame));
+    }
+
+// Hand a serialized frame to the connection's strand; the request must already be registered in pending_
+void DeribitClient:: dispatch_frame(int id, std::string frame) {
+        if (!open_) {
+            // Only this request is failed: others may still be answered by a connection that is closing
+            ResponseHandler handler;
+            {
+                std::lock_guard<std::mutex> lock(pending_mutex_);
+                auto it = pending_.find(id);
+                if (it == pending_.end()) {
+                    return;  // Already failed by the connection's own shutdown
+                }
+                handler = std::move(it->second.handler);
+                pending_.erase(it);
+            }
+            handler(make_error(id, "WebSocket is not connected"));
+            return;
+        }
+        net::post(strand_, [this, alive = lifetime_, frame = std::move(frame)]() mutable {
+            write_queue_.push_back(std::move(frame));
+            if (write_queue_.size() == 1) {
+                do_write();
+            }
+        });
+    }
+
+// Keep a written frame's capacity for the next encoded order
+void DeribitClient:: recycle_frame(std::string frame) {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (frame_pool_.size() < 256) {
+            frame_pool_.push_back(std::move(frame));
+        }
+    }
+
+// Install the receiver for subscription and heartbeat frames
+void DeribitClient:: set_notification_handler(NotificationHandler handler) {
+        notification_handler_ = std::move(handler);
+    }
+
+// Ask Deribit for heartbeats and start checking that frames keep arriving
+void DeribitClient:: set_heartbeat(int interval_seconds) {
+        interval_seconds = std::max(10, interval_seconds);
+        json::value heartbeat_payload = {
             {"jsonrpc", "2.0"},
-            {"id", ++current_id_},
-            {"method", "private/sell"},
-            {"params", {
-                {"instrument_name", instrument},
-                {"amount", quantity},
-                {"type", type},
-                {"price", price}
-            }}
+            {"method", "public/set_heartbeat"},
+            {"params", { {"interval", interval_seconds} }}
+        };
+        async_request(std::move(heartbeat_payload), [](json::value response) {
+            if (response.as_object().contains("error")) {
+                std::cerr << "set_heartbeat failed: " << json::serialize(response) << "\n";
+            }
+        });
+        net::post(strand_, [this, alive = lifetime_, interval_seconds]() {
+            bool running = heartbeat_interval_.count() > 0;
+            heartbeat_interval_ = std::chrono::seconds(interval_seconds);
+            last_frame_ = std::chrono::steady_clock::now();
+            if (!running) {
+                check_heartbeat();
+            }
+        });
+    }
+
+// Once a second: a connection that has been silent for 1.5 heartbeat intervals is dead, so close it and
+// fail its pending requests instead of letting callers wait on it
+void DeribitClient:: check_heartbeat() {
+        heartbeat_timer_.expires_after(std::chrono::seconds(1));
+        heartbeat_timer_.async_wait([this, alive = lifetime_](beast::error_code ec) {
+            if (ec || !open_) {
+                return;
+            }
+            auto silent = std::chrono::steady_clock::now() - last_frame_;
+            if (silent > heartbeat_interval_ * 3 / 2) {
+                std::cerr << "No frames for " << std::chrono::duration_cast<std::chrono::milliseconds>(silent).count()
+                          << " ms, closing the connection\n";
+                open_ = false;
+                fail_pending("Heartbeat timeout");
+                beast::error_code ignored;
+                beast::get_lowest_layer(ws_).close(ignored);  // Aborts the pending read
+                return;
+            }
+            check_heartbeat();
+        });
+    }
+
+// Measure the exchange clock now and then every interval
+void DeribitClient:: start_clock_sync(std::chrono::seconds interval) {
+        net::post(strand_, [this, alive = lifetime_, interval]() {
+            bool running = clock_interval_.count() > 0;
+            clock_interval_ = interval;
+            if (!running) {
+                sample_clock(kClockSamplesPerRound);
+            }
+        });
+    }
+
+// One public/get_time round trip; the burst's samples go out back to back so none queues behind another,
+// and the round is closed (keeping its minimum-round-trip sample) after the last one
+void DeribitClient:: sample_clock(int remaining) {
+        json::value time_payload = {
+            {"jsonrpc", "2.0"},
+            {"method", "public/get_time"},
+            {"params", json::object()}
+        };
+        std::int64_t send_ns = ClockSync::now_ns();
+        async_request(std::move(time_payload), [this, remaining, send_ns](json::value response) {
+            const auto& obj = response.as_object();
+            const auto* us_in = obj.if_contains("usIn");
+            const auto* us_out = obj.if_contains("usOut");
+            const auto* result = obj.if_contains("result");
+            if (us_in && us_out && us_in->is_number() && us_out->is_number()) {
+                ClockSync::instance().add_sample(send_ns, us_in->to_number<std::int64_t>() * 1000,
+                                                 us_out->to_number<std::int64_t>() * 1000, frame_ns_);
+            } else if (result && result->is_number()) {
+                std::int64_t exchange_ns = result->to_number<std::int64_t>() * 1000000;  // Millisecond fallback
+                ClockSync::instance().add_sample(send_ns, exchange_ns, exchange_ns, frame_ns_);
+            }
+            if (!open_) {
+                return;
+            }
+            if (remaining > 1) {
+                sample_clock(remaining - 1);
+                return;
+            }
+            ClockSync::instance().finish_round();
+            clock_timer_.expires_after(clock_interval_);
+            clock_timer_.async_wait([this, alive = lifetime_](beast::error_code ec) {
+                if (!ec && open_) {
+                    sample_clock(kClockSamplesPerRound);
+                }
+            });
+        });
+    }
+
+// Toggle TLS certificate verification (the local mock server uses a self-signed certificate)
+void DeribitClient:: set_verify_peer(bool verify) {
+        verify_peer_ = verify;  // Applied to the stream by connect()
+    }
+
+// Number of requests still waiting for a response
+std::size_t DeribitClient:: pending_requests() {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        return pending_.size();
+    }
+
+// Ensure the payload carries an id and return it
+int DeribitClient:: assign_id(json::value& payload) {
+        auto& obj = payload.as_object();
+        if (!obj.contains("id")) {
+            obj["id"] = ++current_id_;
+        }
+        return static_cast<int>(obj["id"].to_number<std::int64_t>());
+    }
+
+// Write the head of the outgoing queue; Beast allows a single outstanding write
+void DeribitClient:: do_write() {
+        write_started_ticks_ = TscClock::now();
+        ws_.async_write(net::buffer(write_queue_.front()),
+            [this, alive = lifetime_](beast::error_code ec, std::size_t bytes) { on_write(ec, bytes); });
+    }
+
+// Pop the written frame and continue with the next one
+void DeribitClient:: on_write(beast::error_code ec, std::size_t) {
+        if (ec) {
+            std::cerr << "WebSocket write error: " << ec.message() << "\n";
+            open_ = false;
+            write_queue_.clear();
+            fail_pending(ec.message());
+            return;
+        }
+        write_latency_.record_ticks(write_started_ticks_);
+        recycle_frame(std::move(write_queue_.front()));
+        write_queue_.pop_front();
+        if (!write_queue_.empty()) {
+            do_write();
+        }
+    }
+
+// Arm the next asynchronous read
+void DeribitClient:: do_read() {
+        ws_.async_read(read_buffer_,
+            [this, alive = lifetime_](beast::error_code ec, std::size_t bytes) { on_read(ec, bytes); });
+    }
+
+// Route a received frame to its pending request by id, or to the notification handler
+void DeribitClient:: on_read(beast::error_code ec, std::size_t) {
+        if (ec) {
+            open_ = false;
+            if (ec != websocket::error::closed && ec != net::error::operation_aborted) {
+                std::cerr << "WebSocket read error: " << ec.message() << "\n";
+            }
+            fail_pending(ec.message());
+            return;
+        }
+
+        std::uint64_t received = TscClock::now();
+        frame_ns_ = ClockSync::now_ns();
+        last_frame_ = std::chrono::steady_clock::now();
+        json::value message;
+        try {
+            message = json::parse(json::string_view(static_cast<const char*>(read_buffer_.cdata().data()), read_buffer_.size()));
+        } catch (const std::exception& e) {
+            std::cerr << "Malformed frame: " << e.what() << "\n";
+        }
+        read_buffer_.consume(read_buffer_.size());
+        parse_latency_.record_ticks(received);
+
+        if (auto* obj = message.if_object()) {
+            const auto* id = obj->if_contains("id");
+            if (id && id->is_number() && (obj->contains("result") || obj->contains("error"))) {
+                ResponseHandler handler;
+                std::int64_t sent_ns = 0;
+                {
+                    std::lock_guard<std::mutex> lock(pending_mutex_);
+                    auto it = pending_.find(static_cast<int>(id->to_number<std::int64_t>()));
+                    if (it != pending_.end()) {
+                        handler = std::move(it->second.handler);
+                        sent_ns = it->second.sent_ns;
+                        wire_latency_.record(TscClock::to_ns(received - it->second.queued_ticks));
+                        pending_.erase(it);
+                    }
+                }
+                if (handler) {
+                    annotate_timing(*obj, sent_ns);
+                    handler(std::move(message));
+                }
+            } else {
+                const auto* method = obj->if_contains("method");
+                const auto* params = obj->if_contains("params");
+                if (method && method->is_string() && method->as_string() == "heartbeat" && params && params->is_object()) {
+                    const auto* type = params->as_object().if_contains("type");
+                    if (type && type->is_string() && type->as_string() == "test_request") {
+                        async_request(json::value{{"jsonrpc", "2.0"}, {"method", "public/test"}, {"params", json::object()}},
+                                      [](json::value) {});  // Unanswered test requests make Deribit close the connection
+                    }
+                }
+                const auto* channel = params && params->is_object() ? params->as_object().if_contains("channel") : nullptr;
+                if (channel && channel->is_string() && std::string_view(channel->as_string().data(), channel->as_string().size()).substr(0, 12) == "user.orders.") {
+                    const auto* data = params->as_object().if_contains("data");
+                    if (data) {
+                        RiskEngine::instance().on_orders(*data);  // Fills and final states, whoever placed the order
+                    }
+                }
+                if (notification_handler_) {
+                    notification_handler_(message);
+                }
+            }
+        }
+        do_read();
+    }
+
+// Split a response's round trip with its usIn/usOut stamps: request -> exchange, inside the exchange and
+// exchange -> client, the outer two on the local clock via ClockSync. Added to the response as
+// "client_timing" (microseconds) so callers can tell a slow network from a slow exchange or a slow client.
+void DeribitClient:: annotate_timing(json::object& response, std::int64_t sent_ns) {
+        const auto* us_in = response.if_contains("usIn");
+        const auto* us_out = response.if_contains("usOut");
+        if (!us_in || !us_out || !us_in->is_number() || !us_out->is_number()) {
+            return;
+        }
+        std::int64_t exchange_in_ns = us_in->to_number<std::int64_t>() * 1000;
+        std::int64_t exchange_out_ns = us_out->to_number<std::int64_t>() * 1000;
+        ClockSync& clock = ClockSync::instance();
+        std::int64_t to_exchange_ns = clock.to_local_ns(exchange_in_ns) - sent_ns;
+        std::int64_t in_exchange_ns = exchange_out_ns - exchange_in_ns;
+        std::int64_t from_exchange_ns = clock.one_way_ns(exchange_out_ns, frame_ns_);
+        to_exchange_latency_.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, to_exchange_ns)));
+        in_exchange_latency_.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, in_exchange_ns)));
+        from_exchange_latency_.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, from_exchange_ns)));
+        response["client_timing"] = {
+            {"to_exchange_us", to_exchange_ns / 1000},
+            {"in_exchange_us", in_exchange_ns / 1000},
+            {"from_exchange_us", from_exchange_ns / 1000},
+            {"clock_synced", clock.estimate().synced}
+        };
+    }
+
+// Complete every outstanding request with a transport error
+void DeribitClient:: fail_pending(const std::string& reason) {
+        std::unordered_map<int, PendingRequest> failed;
+        {
+            std::lock_guard<std::mutex> lock(pending_mutex_);
+            failed.swap(pending_);
+        }
+        for (auto& [id, request] : failed) {
+            request.handler(make_error(id, reason));
+        }
+    }
+
+// Build a JSON-RPC error response so callers handle transport failures like exchange errors
+json::value DeribitClient:: make_error(int id, const std::string& message, int code) {
+        return {
+            {"jsonrpc", "2.0"},
+            {"id", id},
+            {"error", { {"code", code}, {"message", message} }}
         };
-        return send_request(order_payload);
+    }
+
+// Validate against the instrument registry, then the risk engine. A rejected order never leaves the
+// process and its handler gets an error on the connection's strand, like an exchange rejection; an accepted one
+// gets a handler that reports the result to the risk engine first.
+bool DeribitClient:: reject_locally(OrderSide side, const std::string& instrument, const std::string& type, int quantity, double price, ResponseHandler& handler) {
+        InstrumentId id = InstrumentRegistry::instance().intern(instrument);
+        OrderCheck check = InstrumentRegistry::instance().check_order(id, type, quantity, price);
+        RiskCheck risk = check == OrderCheck::Ok ? RiskEngine::instance().check_order(id, side, type, quantity, price) : RiskCheck::Ok;
+        if (check == OrderCheck::Ok && risk == RiskCheck::Ok) {
+            handler = [handler = std::move(handler), id, side, quantity](json::value response) {
+                const auto* result = response.is_object() ? response.as_object().if_contains("result") : nullptr;
+                const auto* order = result && result->is_object() ? result->as_object().if_contains("order") : nullptr;
+                if (order && order->is_object()) {
+                    RiskEngine::instance().on_order(order->as_object());
+                } else {
+                    RiskEngine::instance().release(id, side, quantity);
+                }
+                handler(std::move(response));
+            };
+            return false;
+        }
+        std::string reason = std::string("Rejected locally: ") + (check != OrderCheck::Ok ? describe(check) : describe(risk));
+        int code = check != OrderCheck::Ok ? -32602 : -32000;
+        int request_id = ++current_id_;  // Never sent, but unique so callers correlating by id cannot confuse it
+        net::post(strand_, [handler = std::move(handler), reason = std::move(reason), code, request_id]() {
+            handler(make_error(request_id, reason, code));
+        });
+        return true;
+    }
+
+// Place a buy order
+json::value DeribitClient:: place_order(const std::string& instrument, const std::string& type, int quantity, double price) {
+        return async_place_order(instrument, type, quantity, price).get();
+    }
+
+// Place a buy order without waiting for the response
+std::future<json::value> DeribitClient:: async_place_order(const std::string& instrument, const std::string& type, int quantity, double price) {
+        std::future<json::value> response;
+        async_place_order(instrument, type, quantity, price, promise_handler(response));
+        return response;
+    }
+
+// Place a buy order; handler receives the response on the connection's strand
+void DeribitClient:: async_place_order(const std::string& instrument, const std::string& type, int quantity, double price, ResponseHandler handler) {
+        if (reject_locally(OrderSide::Buy, instrument, type, quantity, price, handler)) {
+            return;
+        }
+        send_encoded([&](std::string& frame, int id) {
+            encoder_.encode_order(frame, OrderSide::Buy, instrument, type, id, quantity, price);
+        }, std::move(handler));
+    }
+
+// Place a sell order
+json::value DeribitClient:: sell_order(const std::string& instrument, const std::string& type, int quantity, double price) {
+        return async_sell_order(instrument, type, quantity, price).get();
+    }
+
+// Place a sell order without waiting for the response
+std::future<json::value> DeribitClient:: async_sell_order(const std::string& instrument, const std::string& type, int quantity, double price) {
+        std::future<json::value> response;
+        async_sell_order(instrument, type, quantity, price, promise_handler(response));
+        return response;
+    }
+
+// Place a sell order; handler receives the response on the connection's strand
+void DeribitClient:: async_sell_order(const std::string& instrument, const std::string& type, int quantity, double price, ResponseHandler handler) {
+        if (reject_locally(OrderSide::Sell, instrument, type, quantity, price, handler)) {
+            return;
+        }
+        send_encoded([&](std::string& frame, int id) {
+            encoder_.encode_order(frame, OrderSide::Sell, instrument, type, id, quantity, price);
+        }, std::move(handler));
     }
 
 // Get last market price for an instrument
@@ -95,24 +579,63 @@ json::value DeribitClient:: get_market_price_by_instruments(const std::string& i
 
 // Cancel an order
 json::value DeribitClient:: cancel_order(const std::string& order_id) {
-        json::value cancel_payload = {
-            {"jsonrpc", "2.0"},
-            {"id", ++current_id_},
-            {"method", "private/cancel"},
-            {"params", { {"order_id", order_id} }}
-        };
-        return send_request(cancel_payload);
+        return async_cancel_order(order_id).get();
+    }
+
+// Cancel an order without waiting for the response
+std::future<json::value> DeribitClient:: async_cancel_order(const std::string& order_id) {
+        std::future<json::value> response;
+        async_cancel_order(order_id, promise_handler(response));
+        return response;
+    }
+
+// Cancel an order; handler receives the response on the connection's strand
+void DeribitClient:: async_cancel_order(const std::string& order_id, ResponseHandler handler) {
+        RiskEngine::instance().count_cancel();
+        send_encoded([&](std::string& frame, int id) {
+            encoder_.encode_cancel(frame, id, order_id);
+        }, std::move(handler));
     }
 
 // Modify an existing order
 json::value DeribitClient:: modify_order(const std::string& order_id, double amount, double new_price) {
-        json::value modify_payload = {
-            {"jsonrpc", "2.0"},
-            {"id", ++current_id_},
-            {"method", "private/edit"},
-            {"params", { {"order_id", order_id}, {"amount", amount}, {"price", new_price} }}
+        return async_modify_order(order_id, amount, new_price).get();
+    }
+
+// Modify an existing order without waiting for the response
+std::future<json::value> DeribitClient:: async_modify_order(const std::string& order_id, double amount, double new_price) {
+        std::future<json::value> response;
+        async_modify_order(order_id, amount, new_price, promise_handler(response));
+        return response;
+    }
+
+// Modify an order; handler receives the response on the connection's strand. The edit passes the same
+// risk checks as a new order, against the instrument, side and amount the risk engine tracks for it.
+void DeribitClient:: async_modify_order(const std::string& order_id, double amount, double new_price, ResponseHandler handler) {
+        InstrumentId instrument = kNoInstrument;
+        OrderSide side = OrderSide::Buy;
+        double previous_amount = 0;
+        RiskEngine::instance().find_order(order_id, instrument, side, previous_amount);  // Unknown orders: limits only
+        RiskCheck risk = RiskEngine::instance().check_edit(instrument, side, previous_amount, amount, new_price);
+        if (risk != RiskCheck::Ok) {
+            int request_id = ++current_id_;
+            net::post(strand_, [handler = std::move(handler), request_id, risk]() {
+                handler(make_error(request_id, std::string("Rejected locally: ") + describe(risk)));
+            });
+            return;
+        }
+        handler = [handler = std::move(handler), instrument, side, previous_amount, amount](json::value response) {
+            const auto* result = response.is_object() ? response.as_object().if_contains("result") : nullptr;
+            const auto* order = result && result->is_object() ? result->as_object().if_contains("order") : nullptr;
+            if (order && order->is_object()) {
+                RiskEngine::instance().on_order(order->as_object());
+            }
+            RiskEngine::instance().finish_edit(instrument, side, previous_amount, amount, result != nullptr);
+            handler(std::move(response));
         };
-        return send_request(modify_payload);
+        send_encoded([&](std::string& frame, int id) {
+            encoder_.encode_edit(frame, id, order_id, amount, new_price);
+        }, std::move(handler));
     }
 
 // Get the order book for an instrument
@@ -136,3 +659,48 @@ json::value DeribitClient:: view_positions(const std::string& currency, const st
         };
         return send_request(positions_payload);
     }
+
+// Subscribe to notification channels; updates arrive through the notification handler
+std::future<json::value> DeribitClient:: async_subscribe(const std::vector<std::string>& channels) {
+        json::array channel_list;
+        for (const auto& channel : channels) {
+            channel_list.push_back(json::value(channel));
+        }
+        json::value subscribe_payload = {
+            {"jsonrpc", "2.0"},
+            {"id", ++current_id_},
+            {"method", "public/subscribe"},
+            {"params", { {"channels", channel_list} }}
+        };
+        return async_request(std::move(subscribe_payload));
+    }
+
+// Unsubscribe from notification channels
+std::future<json::value> DeribitClient:: async_unsubscribe(const std::vector<std::string>& channels) {
+        json::array channel_list;
+        for (const auto& channel : channels) {
+            channel_list.push_back(json::value(channel));
+        }
+        json::value unsubscribe_payload = {
+            {"jsonrpc", "2.0"},
+            {"id", ++current_id_},
+            {"method", "public/unsubscribe"},
+            {"params", { {"channels", channel_list} }}
+        };
+        return async_request(std::move(unsubscribe_payload));
+    }
+
+// Subscribe to private channels (user.orders.*, user.trades.*, user.portfolio.*) of the authenticated account
+std::future<json::value> DeribitClient:: async_private_subscribe(const std::vector<std::string>& channels) {
+        json::array channel_list;
+        for (const auto& channel : channels) {
+            channel_list.push_back(json::value(channel));
+        }
+        json::value subscribe_payload = {
+            {"jsonrpc", "2.0"},
+            {"id", ++current_id_},
+            {"method", "private/subscribe"},
+            {"params", { {"channels", channel_list} }}
+        };
+        return async_request(std::move(subscribe_payload));
+    }
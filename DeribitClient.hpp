@@ -11,6 +11,21 @@
 #include <iostream>
 #include <string>
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "OrderEncoder.hpp"  // Pre-rendered order-entry frames
+#include "LatencyStats.hpp"  // Per-stage latency histograms
+#include "ConnectionBootstrap.hpp"  // Cached DNS and TLS session resumption
+#include "ClockSync.hpp"  // Exchange clock offset for one-way latencies
+#include "InstrumentRegistry.hpp"  // Local order validation against instrument reference data
+#include "RiskEngine.hpp"  // Pre-trade risk gate and fill tracking
+#include "Runtime.hpp"  // Shared I/O thread pool
 
 namespace beast = boost::beast;  // Alias for Boost.Beast
 namespace websocket = beast::websocket;  // Alias for WebSocket in Beast
@@ -18,12 +33,15 @@ namespace net = boost::asio;  // Alias for Boost.Asio
 namespace json = boost::json;  // Alias for Boost.JSON
 using tcp = net::ip::tcp;  // Alias for TCP socket type
 
+using ResponseHandler = std::function<void(json::value)>;  // Callback receiving the response matched to a request id
+using NotificationHandler = std::function<void(const json::value&)>;  // Callback receiving frames without a request id
+
 class DeribitClient {
 public:
     DeribitClient(const std::string& host, const std::string& port, const std::string& client_id, const std::string& client_secret);  // Constructor to initialize with connection details
-    ~DeribitClient();  // Destructor
+    ~DeribitClient();  // Close and wait for pending handlers; never call from the connection's strand or a runtime thread
     void connect();  // Establish WebSocket connection to Deribit
-    void authenticate();  // Authenticate client with Deribit
+    void authenticate();  // Authenticate client with Deribit; the session is then kept alive with refresh_token
     json::value place_order(const std::string& instrument, const std::string& type, int quantity, double price);  // Place a new order
     json::value sell_order(const std::string& instrument, const std::string& type, int quantity, double price);  // Place a sell order
     json::value get_market_price_by_instruments(const std::string& instrument_name);  // Get market price for a given instrument
@@ -32,14 +50,92 @@ public:
     json::value get_orderbook(const std::string& instrument);  // Retrieve orderbook data for an instrument
     json::value view_positions(const std::string& currency, const std::string& kind);  // View current positions in a specific currency
 
+    std::future<json::value> async_place_order(const std::string& instrument, const std::string& type, int quantity, double price);  // Pipelined buy order
+    std::future<json::value> async_sell_order(const std::string& instrument, const std::string& type, int quantity, double price);  // Pipelined sell order
+    std::future<json::value> async_cancel_order(const std::string& order_id);  // Pipelined cancel
+    std::future<json::value> async_modify_order(const std::string& order_id, double amount, double new_price);  // Pipelined edit
+    void async_place_order(const std::string& instrument, const std::string& type, int quantity, double price, ResponseHandler handler);  // Buy; handler runs on the connection's strand
+    void async_sell_order(const std::string& instrument, const std::string& type, int quantity, double price, ResponseHandler handler);  // Sell; handler runs on the connection's strand
+    void async_cancel_order(const std::string& order_id, ResponseHandler handler);  // Cancel; handler runs on the connection's strand
+    void async_modify_order(const std::string& order_id, double amount, double new_price, ResponseHandler handler);  // Edit; handler runs on the connection's strand
+
+    std::future<json::value> async_subscribe(const std::vector<std::string>& channels);  // public/subscribe without waiting
+    std::future<json::value> async_unsubscribe(const std::vector<std::string>& channels);  // public/unsubscribe without waiting
+    std::future<json::value> async_private_subscribe(const std::vector<std::string>& channels);  // private/subscribe (user.* channels); needs authenticate()
+
+    std::future<json::value> async_request(json::value payload);  // Send a request without waiting; the future holds its response
+    void async_request(json::value payload, ResponseHandler handler);  // Send a request without waiting; handler runs on the connection's strand
+    void set_notification_handler(NotificationHandler handler);  // Install before connect(); receives subscription and heartbeat frames
+    void set_verify_peer(bool verify);  // Disable only for self-signed test servers; call before connect()
+    void set_heartbeat(int interval_seconds);  // public/set_heartbeat (10 s minimum); the connection is failed after 1.5 silent intervals
+    void start_clock_sync(std::chrono::seconds interval = std::chrono::seconds(30));  // Sample public/get_time into ClockSync now and every interval
+    std::size_t pending_requests();  // Number of requests still waiting for a response
+
 private:
-    json::value send_request(const json::value& payload);  // Send a JSON request and return the response
-    net::io_context ioc_;  // I/O context for asynchronous operations
+    static constexpr int kClockSamplesPerRound = 5;  // public/get_time round trips per clock-sync burst
+    static constexpr std::chrono::seconds kCloseTimeout{2};  // Wait for the close handshake before shutting the socket
+
+    json::value send_request(const json::value& payload);  // Send a JSON request and block until its response arrives
+    int assign_id(json::value& payload);  // Ensure the payload carries an id and return it
+    void start_io();  // Start the read loop on the strand once the handshake is done
+    void do_read();  // Arm the next asynchronous read
+    void on_read(beast::error_code ec, std::size_t bytes);  // Route a received frame to its pending request or the notification handler
+    template <typename Encode>
+    void send_encoded(Encode&& encode, ResponseHandler handler);  // Encode an order frame under the pending lock and send it
+    static ResponseHandler promise_handler(std::future<json::value>& future);  // Handler fulfilling future, for the future-returning calls
+    void dispatch_frame(int id, std::string frame);  // Queue request id's serialized frame on the strand, or fail it when closed
+    void recycle_frame(std::string frame);  // Return a written frame's buffer to the pool
+    void do_write();  // Write the head of the outgoing queue
+    void on_write(beast::error_code ec, std::size_t bytes);  // Pop the written frame and continue with the next one
+    void fail_pending(const std::string& reason);  // Complete every outstanding request with a transport error
+    static json::value make_error(int id, const std::string& message, int code = -32000);  // Build a JSON-RPC error response
+    bool reject_locally(OrderSide side, const std::string& instrument, const std::string& type, int quantity, double price, ResponseHandler& handler);  // Instrument and risk checks; fails the handler or wraps it for fill tracking
+    void on_auth_result(const json::object& result);  // Keep the refresh token and schedule its use (strand)
+    void refresh_session();  // Exchange the refresh token for a new access token (strand)
+    void check_heartbeat();  // Fail the connection if nothing arrived for 1.5 heartbeat intervals (strand)
+    void sample_clock(int remaining);  // One public/get_time round trip of a burst (strand)
+    void annotate_timing(json::object& response, std::int64_t sent_ns);  // Add "client_timing" and record its histograms
+
+    Strand strand_;  // Serializes this connection's handlers on the shared runtime
     net::ssl::context ctx_{net::ssl::context::tlsv12_client};  // SSL context for secure communication
-    tcp::resolver resolver_;  // Resolver for looking up host addresses
     websocket::stream<beast::ssl_stream<tcp::socket>> ws_;  // WebSocket stream wrapped with SSL
     std::string host_, port_, client_id_, client_secret_;  // Connection details
     std::atomic<int> current_id_{0};  // Atomic counter for tracking request IDs
+    bool verify_peer_ = true;  // Certificate and host-name verification on connect()
+    std::string refresh_token_;  // From the latest public/auth result (strand only)
+    net::steady_timer refresh_timer_{strand_};  // Fires before the access token expires
+    net::steady_timer heartbeat_timer_{strand_};  // Periodic liveness check once heartbeats are on
+    net::steady_timer clock_timer_{strand_};  // Next clock-sync burst
+    net::steady_timer close_timer_{strand_};  // Deadline of the close handshake in the destructor
+    std::chrono::seconds heartbeat_interval_{0};  // Agreed heartbeat interval, 0 when off (strand only)
+    std::chrono::seconds clock_interval_{0};  // Pause between clock-sync bursts (strand only)
+    std::chrono::steady_clock::time_point last_frame_;  // Arrival of the newest frame (strand only)
+    std::int64_t frame_ns_ = 0;  // Wall-clock arrival of the frame being handled (strand only)
+
+    std::shared_ptr<void> lifetime_;  // Copied into every pending handler; the last copy releases drained_
+    std::future<void> drained_;  // Ready once no handler refers to this client
+    std::atomic<bool> open_{false};  // True while the read loop is alive
+    beast::flat_buffer read_buffer_;  // Receive buffer reused across frames
+    std::deque<std::string> write_queue_;  // Serialized frames waiting to be written (strand only)
+    std::mutex pending_mutex_;  // Protects pending_, encoder_ and frame_pool_
+    struct PendingRequest {
+        ResponseHandler handler;  // Completion callback
+        std::uint64_t queued_ticks;  // TscClock when the request was registered
+        std::int64_t sent_ns;  // Wall clock at registration, for the exchange-side split
+    };
+    std::unordered_map<int, PendingRequest> pending_;  // Outstanding requests keyed by JSON-RPC id
+    OrderEncoder encoder_;  // Order-entry templates
+    std::vector<std::string> frame_pool_;  // Reusable frame buffers so encoding does not allocate
+    NotificationHandler notification_handler_;  // Receiver for frames that are not responses
+
+    std::uint64_t write_started_ticks_ = 0;  // TscClock when the current async_write began (strand only)
+    LatencyHistogram& encode_latency_ = LatencyRegistry::instance().histogram("client.encode");  // Request -> frame
+    LatencyHistogram& write_latency_ = LatencyRegistry::instance().histogram("client.write");  // async_write duration
+    LatencyHistogram& wire_latency_ = LatencyRegistry::instance().histogram("client.wire_wait");  // Registered -> response read
+    LatencyHistogram& parse_latency_ = LatencyRegistry::instance().histogram("client.parse");  // Response frame -> DOM
+    LatencyHistogram& to_exchange_latency_ = LatencyRegistry::instance().histogram("client.to_exchange");  // Registered -> usIn
+    LatencyHistogram& in_exchange_latency_ = LatencyRegistry::instance().histogram("client.in_exchange");  // usIn -> usOut
+    LatencyHistogram& from_exchange_latency_ = LatencyRegistry::instance().histogram("client.from_exchange");  // usOut -> frame read
 };
 
 
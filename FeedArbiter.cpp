@@ -0,0 +1,68 @@
+#include "FeedArbiter.hpp"
+
+// Register the per-leg lag histograms ("feed.arb.A.behind", "feed.arb.B.behind")
+FeedArbiter::FeedArbiter() {
+    for (int leg = 0; leg < kLegs; ++leg) {
+        legs_[leg].behind = &LatencyRegistry::instance().histogram(std::string("feed.arb.") + leg_name(leg) + ".behind");
+    }
+}
+
+// Counters for one leg
+LegStats FeedArbiter::stats(int leg) const {
+    const Leg &state = legs_[leg];
+    return LegStats{state.wins.load(std::memory_order_relaxed), state.duplicates.load(std::memory_order_relaxed),
+                    state.last_receive_ns.load(std::memory_order_relaxed)};
+}
+
+// Channel state for the channel name (event type and symbol when the name is unknown); the shared table is
+// only locked the first time a leg sees a channel
+FeedArbiter::Channel &FeedArbiter::channel(int leg, std::string_view channel_name, const MarketEvent &event) {
+    Leg &state = legs_[leg];
+    if (!channel_name.empty()) {
+        state.key.assign(channel_name.data(), channel_name.size());
+    } else {
+        state.key.assign(1, static_cast<char>('0' + static_cast<int>(event.type)));
+        state.key.append(event.symbol);
+    }
+    auto cached = state.cache.find(state.key);
+    if (cached != state.cache.end()) {
+        return *cached->second;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto &slot = channels_[state.key];
+    if (!slot) {
+        slot = std::make_unique<Channel>();
+    }
+    state.cache.emplace(state.key, slot.get());
+    return *slot;
+}
+
+// True if this copy is the first arrival of its update; records it as the channel's newest
+bool FeedArbiter::first_arrival(Channel &slot, int leg, const MarketEvent &event) {
+    std::int64_t key;
+    if (event.type == EventType::Book) {
+        const BookEvent &book = event.book;
+        if (!book.snapshot && book.prev_change_id == book.change_id) {
+            return slot.owner == leg && slot.last_key == book.change_id;  // Continuation fragment: same leg as its head
+        }
+        if (book.change_id <= slot.last_key && !(book.snapshot && slot.needs_snapshot)) {
+            return false;  // Already applied, or a snapshot no newer than the book
+        }
+        if (book.snapshot) {
+            slot.needs_snapshot = false;
+        }
+        key = book.change_id;
+    } else {
+        key = event.type == EventType::Trade ? event.trade.trade_seq : event.exchange_ts;
+        // Millisecond timestamps repeat across distinct ticker and index updates: an equal key is new when it
+        // comes from the leg that delivered that millisecond, and a duplicate only from the other leg
+        bool repeat = key == slot.last_key && (event.type == EventType::Trade || slot.owner != leg);
+        if (key < slot.last_key || repeat) {
+            return false;
+        }
+    }
+    slot.last_key = key;
+    slot.owner = leg;
+    slot.won_at_ns = event.receive_ns;
+    return true;
+}
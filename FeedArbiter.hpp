@@ -0,0 +1,86 @@
+#ifndef FEED_ARBITER_HPP
+#define FEED_ARBITER_HPP
+
+#include <atomic>  // Per-leg counters
+#include <cstdint>  // Sequence keys and timestamps
+#include <limits>  // Initial keys
+#include <memory>  // Stable channel state
+#include <mutex>  // Channel table
+#include <string>  // Channel keys
+#include <string_view>  // Channel names
+#include <unordered_map>  // Channel table and per-leg caches
+#include "MarketEvents.hpp"  // Events being arbitrated
+#include "OrderBook.hpp"  // SpinLock
+#include "SpscRing.hpp"  // kCacheLineSize
+#include "LatencyStats.hpp"  // Losing-leg lag histograms
+
+struct LegStats {
+    std::uint64_t wins;  // Updates this leg delivered first
+    std::uint64_t duplicates;  // Updates the other leg had already delivered
+    std::int64_t last_receive_ns;  // Newest arrival on this leg (system_clock ns)
+};
+
+// First-arrival arbitration between two connections subscribed to the same channels (legs A and B).
+// Each update is keyed per channel, by its full name so two intervals or depths of one instrument's
+// book or ticker never share a sequence: book updates by change_id (continuation fragments follow the leg
+// that won their first fragment), trades by trade_seq, tickers and indices by exchange timestamp (several
+// updates may share a millisecond, so they are taken from whichever leg delivered it first). The
+// winning copy is processed under the channel's lock so book updates are applied in change_id order
+// whichever leg delivers them. Called from both reader threads.
+class FeedArbiter {
+public:
+    static constexpr int kLegs = 2;  // A and B
+
+    FeedArbiter();
+
+    // Run process() if this is the first copy of the update to arrive; false for a duplicate. process()
+    // returns false when a book broke its change_id chain, so the next snapshot is taken even if older.
+    template <typename Process>
+    bool offer(int leg, std::string_view channel_name, const MarketEvent &event, Process &&process) {
+        Leg &state = legs_[leg];
+        state.last_receive_ns.store(event.receive_ns, std::memory_order_relaxed);
+        Channel &slot = channel(leg, channel_name, event);
+        std::lock_guard<SpinLock> lock(slot.lock);
+        if (!first_arrival(slot, leg, event)) {
+            state.duplicates.fetch_add(1, std::memory_order_relaxed);
+            if (event.receive_ns > slot.won_at_ns) {
+                state.behind->record(static_cast<std::uint64_t>(event.receive_ns - slot.won_at_ns));
+            }
+            return false;
+        }
+        state.wins.fetch_add(1, std::memory_order_relaxed);
+        if (!process()) {
+            slot.needs_snapshot = true;
+        }
+        return true;
+    }
+
+    LegStats stats(int leg) const;  // Counters for one leg, safe from any thread
+    static char leg_name(int leg) { return static_cast<char>('A' + leg); }  // 'A' / 'B'
+
+private:
+    struct Channel {
+        SpinLock lock;  // Serializes the two legs for this channel
+        std::int64_t last_key = std::numeric_limits<std::int64_t>::min();  // Newest update taken
+        bool needs_snapshot = false;  // The book gapped: take the next snapshot whatever its change_id
+        int owner = -1;  // Leg that delivered last_key (book fragments continue on it)
+        std::int64_t won_at_ns = 0;  // Receive time of the winning copy of last_key
+    };
+    struct alignas(kCacheLineSize) Leg {
+        std::unordered_map<std::string, Channel *> cache;  // Reader-thread-local view of channels_
+        std::string key;  // Reused channel key buffer
+        std::atomic<std::uint64_t> wins{0};  // LegStats::wins
+        std::atomic<std::uint64_t> duplicates{0};  // LegStats::duplicates
+        std::atomic<std::int64_t> last_receive_ns{0};  // LegStats::last_receive_ns
+        LatencyHistogram *behind = nullptr;  // How far this leg trailed when it lost
+    };
+
+    Channel &channel(int leg, std::string_view channel_name, const MarketEvent &event);  // Channel state, cached per leg
+    static bool first_arrival(Channel &slot, int leg, const MarketEvent &event);  // Decide and record the winner (lock held)
+
+    std::mutex mutex_;  // Guards channels_ on a per-leg cache miss
+    std::unordered_map<std::string, std::unique_ptr<Channel>> channels_;  // Every channel seen on either leg
+    Leg legs_[kLegs];  // Per-leg state
+};
+
+#endif
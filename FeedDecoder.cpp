@@ -0,0 +1,200 @@
+#include "FeedDecoder.hpp"
+#include "JsonFields.hpp"
+
+#include <cmath>
+
+namespace {
+
+// Integer field or zero when absent
+std::int64_t integer_or_zero(const json::object& obj, std::string_view key) {
+    const auto* field = obj.if_contains(key);
+    return (field && field->is_number()) ? field->to_number<std::int64_t>() : 0;
+}
+
+bool starts_with(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+}  // namespace
+
+// Constructor: the arena wraps one up-front buffer so the parser never needs the global heap for typical frames
+FeedDecoder::FeedDecoder(EventHandler handler)
+    : handler_(std::move(handler)), arena_buffer_(new unsigned char[kArenaSize]),
+      arena_(arena_buffer_.get(), kArenaSize), event_{} {}
+
+// Decode one frame; non-subscription frames (RPC responses, heartbeats) produce no events
+std::size_t FeedDecoder::decode(std::string_view frame, std::int64_t receive_ns) {
+    test_requested_ = false;
+    arena_.release();  // The previous message's DOM is gone; rewind the arena
+    parser_.reset(&arena_);
+    boost::system::error_code ec;
+    parser_.write(frame.data(), frame.size(), ec);
+    if (ec) {
+        ++malformed_;
+        return 0;
+    }
+    json::value message = parser_.release();
+
+    const auto* root = message.if_object();
+    const auto* params = root ? root->if_contains("params") : nullptr;
+    if (!params || !params->is_object()) {
+        return 0;
+    }
+    const auto& params_obj = params->as_object();
+    if (string_or_empty(*root, "method") == "heartbeat") {
+        test_requested_ = string_or_empty(params_obj, "type") == "test_request";
+        return 0;
+    }
+    std::string_view channel = string_or_empty(params_obj, "channel");
+    const auto* data = params_obj.if_contains("data");
+    if (channel.empty() || !data) {
+        return 0;
+    }
+
+    emitted_ = 0;
+    channel_ = channel;
+    event_.receive_ns = receive_ns;
+    if (starts_with(channel, "book.") && data->is_object()) {
+        decode_book(data->as_object());
+    } else if (starts_with(channel, "trades.") && data->is_array()) {
+        decode_trades(data->as_array());
+    } else if (starts_with(channel, "ticker.") && data->is_object()) {
+        decode_ticker(data->as_object());
+    } else if (starts_with(channel, "deribit_price_index.") && data->is_object()) {
+        decode_price_index(data->as_object());
+    }
+    return emitted_;
+}
+
+// Stamp the exchange-to-client latency and pass the scratch event to the consumer
+void FeedDecoder::emit() {
+    event_.exchange_latency_ns = ClockSync::instance().one_way_ns(event_.exchange_ts * 1000000, event_.receive_ns);
+    handler_(event_);
+    ++emitted_;
+}
+
+// Copy the name and stamp its registry id; consecutive events usually repeat the previous name
+void FeedDecoder::set_symbol(std::string_view symbol) {
+    if (event_.instrument_id != kNoInstrument && symbol == event_.symbol_view()) {
+        return;
+    }
+    copy_symbol(event_.symbol, symbol);
+    auto it = instrument_ids_.find(symbol);
+    if (it == instrument_ids_.end()) {
+        it = instrument_ids_.emplace(std::string(symbol), InstrumentRegistry::instance().intern(symbol)).first;
+    }
+    event_.instrument_id = it->second;
+}
+
+// deribit_price_index.*: {"index_name", "price", "timestamp"}
+void FeedDecoder::decode_price_index(const json::object& data) {
+    event_.type = EventType::PriceIndex;
+    set_symbol(string_or_empty(data, "index_name"));
+    event_.exchange_ts = integer_or_zero(data, "timestamp");
+    event_.index.price = number_or(data, "price");
+    emit();
+}
+
+// book.*: snapshot or delta, split into fixed-size fragments
+void FeedDecoder::decode_book(const json::object& data) {
+    event_.type = EventType::Book;
+    set_symbol(string_or_empty(data, "instrument_name"));
+    event_.exchange_ts = integer_or_zero(data, "timestamp");
+
+    // Grouped books have no prev_change_id and every message is a full snapshot
+    const auto* prev = data.if_contains("prev_change_id");
+    BookEvent& book = event_.book;
+    book.change_id = integer_or_zero(data, "change_id");
+    book.prev_change_id = (prev && prev->is_number()) ? prev->to_number<std::int64_t>() : 0;
+    book.snapshot = !prev || string_or_empty(data, "type") == "snapshot";
+    book.count = 0;
+
+    emit_book_levels(data.if_contains("bids"), BookSide::Bid);
+    emit_book_levels(data.if_contains("asks"), BookSide::Ask);
+    flush_book(true);
+}
+
+// Append one side's levels to the current fragment, flushing whenever it fills up
+void FeedDecoder::emit_book_levels(const json::value* side_levels, BookSide side) {
+    if (!side_levels || !side_levels->is_array()) {
+        return;
+    }
+    for (const auto& entry : side_levels->as_array()) {
+        const auto* level = entry.if_array();
+        if (!level) {
+            continue;
+        }
+        LevelChange change{side, LevelAction::New, 0.0, 0.0};
+        if (level->size() == 3) {  // ["new"|"change"|"delete", price, amount]
+            const auto* verb = (*level)[0].if_string();
+            if (verb && *verb == "delete") {
+                change.action = LevelAction::Delete;
+            } else if (verb && *verb == "change") {
+                change.action = LevelAction::Change;
+            }
+            change.price = (*level)[1].to_number<double>();
+            change.amount = (*level)[2].to_number<double>();
+        } else if (level->size() == 2) {  // Grouped books send plain [price, amount]
+            change.price = (*level)[0].to_number<double>();
+            change.amount = (*level)[1].to_number<double>();
+        } else {
+            continue;
+        }
+        if (event_.book.count == kLevelsPerBookEvent) {
+            flush_book(false);
+        }
+        event_.book.levels[event_.book.count++] = change;
+    }
+}
+
+// Hand the current fragment to the consumer; later fragments chain onto it via prev_change_id
+void FeedDecoder::flush_book(bool last_fragment) {
+    BookEvent& book = event_.book;
+    book.last_fragment = last_fragment;
+    emit();
+    book.snapshot = false;
+    book.prev_change_id = book.change_id;
+    book.count = 0;
+}
+
+// trades.*: an array of trades, one event per trade
+void FeedDecoder::decode_trades(const json::array& data) {
+    event_.type = EventType::Trade;
+    for (const auto& entry : data) {
+        const auto* trade = entry.if_object();
+        if (!trade) {
+            continue;
+        }
+        set_symbol(string_or_empty(*trade, "instrument_name"));
+        event_.exchange_ts = integer_or_zero(*trade, "timestamp");
+        event_.trade.price = number_or(*trade, "price");
+        event_.trade.amount = number_or(*trade, "amount");
+        event_.trade.index_price = number_or(*trade, "index_price");
+        event_.trade.mark_price = number_or(*trade, "mark_price");
+        event_.trade.trade_seq = integer_or_zero(*trade, "trade_seq");
+        event_.trade.buy = string_or_empty(*trade, "direction") == "buy";
+        copy_symbol(event_.trade.trade_id, string_or_empty(*trade, "trade_id"));
+        emit();
+    }
+}
+
+// ticker.*: top of book, marks and (for options) implied volatilities
+void FeedDecoder::decode_ticker(const json::object& data) {
+    event_.type = EventType::Ticker;
+    set_symbol(string_or_empty(data, "instrument_name"));
+    event_.exchange_ts = integer_or_zero(data, "timestamp");
+    TickerEvent& ticker = event_.ticker;
+    ticker.best_bid_price = number_or(data, "best_bid_price");
+    ticker.best_bid_amount = number_or(data, "best_bid_amount");
+    ticker.best_ask_price = number_or(data, "best_ask_price");
+    ticker.best_ask_amount = number_or(data, "best_ask_amount");
+    ticker.last_price = number_or(data, "last_price", NAN);
+    ticker.mark_price = number_or(data, "mark_price");
+    ticker.index_price = number_or(data, "index_price");
+    ticker.underlying_price = number_or(data, "underlying_price", ticker.index_price);
+    ticker.mark_iv = number_or(data, "mark_iv", NAN);
+    ticker.bid_iv = number_or(data, "bid_iv", NAN);
+    ticker.ask_iv = number_or(data, "ask_iv", NAN);
+    ticker.open_interest = number_or(data, "open_interest");
+    emit();
+}
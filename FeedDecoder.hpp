@@ -0,0 +1,55 @@
+#ifndef FEED_DECODER_HPP
+#define FEED_DECODER_HPP
+
+#include <boost/json.hpp>  // Reusable parser and monotonic arena
+#include <cstdint>  // Timestamps
+#include <functional>  // Event sink
+#include <map>  // Symbol -> instrument id cache
+#include <memory>  // Arena storage
+#include <string_view>  // Frames are decoded in place
+#include "MarketEvents.hpp"  // Typed events produced by the decoder
+#include "ClockSync.hpp"  // Exchange-to-client latency of each event
+#include "InstrumentRegistry.hpp"  // Dense ids stamped on each event
+
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+// Turns subscription frames into typed MarketEvents without touching the global heap in steady state:
+// one parser is reused for every frame and the DOM lives in a fixed arena that is rewound per message.
+class FeedDecoder {
+public:
+    using EventHandler = std::function<void(const MarketEvent&)>;  // Receives each decoded event; valid only during the call
+
+    explicit FeedDecoder(EventHandler handler);  // Construct with the consumer of decoded events
+    FeedDecoder(const FeedDecoder&) = delete;
+    FeedDecoder& operator=(const FeedDecoder&) = delete;
+
+    std::size_t decode(std::string_view frame, std::int64_t receive_ns);  // Decode one frame, returns events emitted
+    std::uint64_t malformed_frames() const { return malformed_; }  // Frames that failed to parse
+    bool test_requested() const { return test_requested_; }  // The last frame was a heartbeat test_request, to be answered with public/test
+    std::string_view channel() const { return channel_; }  // Channel of the frame being decoded; valid inside the handler only
+
+private:
+    void decode_price_index(const json::object& data);  // deribit_price_index.*
+    void decode_book(const json::object& data);  // book.*
+    void decode_trades(const json::array& data);  // trades.*
+    void decode_ticker(const json::object& data);  // ticker.*
+    void emit_book_levels(const json::value* side_levels, BookSide side);  // Append levels, flushing full fragments
+    void flush_book(bool last_fragment);  // Hand the current book fragment to the handler
+    void emit();  // Pass event_ to the handler
+    void set_symbol(std::string_view symbol);  // Fill event_.symbol and event_.instrument_id
+
+    static constexpr std::size_t kArenaSize = 256 * 1024;  // Covers full-depth snapshots without falling back to the heap
+
+    EventHandler handler_;  // Consumer of decoded events
+    std::unique_ptr<unsigned char[]> arena_buffer_;  // Backing store for the per-message DOM, allocated once
+    json::monotonic_resource arena_;  // Rewound before every frame
+    json::parser parser_;  // Reused across frames
+    MarketEvent event_;  // Scratch event filled in place and passed by reference
+    std::map<std::string, InstrumentId, std::less<>> instrument_ids_;  // Registry ids seen by this decoder, so the registry lock is taken once per name
+    std::size_t emitted_ = 0;  // Events emitted for the current frame
+    std::uint64_t malformed_ = 0;  // Frames that failed to parse
+    bool test_requested_ = false;  // Set by decode() for heartbeat test_request frames
+    std::string_view channel_;  // Channel of the current frame, pointing into the arena
+};
+
+#endif
@@ -0,0 +1,290 @@
+#include "FeedShard.hpp"
+
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+const std::string TARGET = "/ws/api/v2";
+constexpr int kMaxConflatedChannels = 4096;  // Channels beyond this fall back to keep-all
+
+// Deribit channel family for an event type, used to match conflation rules
+static const char *channel_prefix(EventType type) {
+    switch (type) {
+    case EventType::PriceIndex: return "deribit_price_index.";
+    case EventType::Book: return "book.";
+    case EventType::Trade: return "trades.";
+    case EventType::Ticker: return "ticker.";
+    default: return "";
+    }
+}
+
+// Every channel to subscribe: each template applied to each instrument, then the literal channels
+std::vector<std::string> FeedConfig::expand() const {
+    std::vector<std::string> expanded;
+    expanded.reserve(instruments.size() * channel_templates.size() + channels.size());
+    for (const auto &instrument : instruments) {
+        for (const auto &channel_template : channel_templates) {
+            std::string channel = channel_template;
+            auto placeholder = channel.find("{}");
+            if (placeholder != std::string::npos) {
+                channel.replace(placeholder, 2, instrument);
+            }
+            expanded.push_back(std::move(channel));
+        }
+    }
+    expanded.insert(expanded.end(), channels.begin(), channels.end());
+    return expanded;
+}
+
+// Prepare the connection objects; nothing touches the network until start()
+FeedShard::FeedShard(int index, std::size_t ring_capacity, const ConflationRules &conflation_rules, EventHandler handler)
+    : index_(index), ctx_(ssl::context::tlsv12_client), handler_(std::move(handler)),
+      decoder_([this](const MarketEvent &event) { handler_(*this, event); }),
+      ring_(ring_capacity), conflation_rules_(conflation_rules),
+      conflated_slots_(new ConflatedSlot[kMaxConflatedChannels]) {
+    ctx_.set_default_verify_paths();
+}
+
+// Point this connection at a feed server
+void FeedShard::set_endpoint(const std::string &host, const std::string &port) {
+    host_ = host;
+    port_ = port;
+}
+
+// Run the reader loop on its own thread
+void FeedShard::start() {
+    thread_ = std::thread(&FeedShard::connect, this);
+}
+
+// Wait for the reader thread to exit
+void FeedShard::join() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+// Snapshot of the ring counters
+FeedStats FeedShard::stats() const {
+    return FeedStats{published_count_.load(std::memory_order_relaxed), dropped_count_.load(std::memory_order_relaxed),
+                     conflated_count_.load(std::memory_order_relaxed), high_water_.load(std::memory_order_relaxed)};
+}
+
+// Write a public/subscribe or public/unsubscribe request on this connection
+void FeedShard::send_subscription(const std::string &method, const std::vector<std::string> &channel_list) {
+    json::array channel_array;
+    for (const auto &channel : channel_list) {
+        channel_array.push_back(json::value(channel));
+    }
+    send_rpc(method, json::object{{"channels", channel_array}});
+}
+
+// Write a request on this connection (reader thread); the decoder skips its response
+void FeedShard::send_rpc(const std::string &method, json::object params) {
+    json::value request = {
+        {"jsonrpc", "2.0"},
+        {"id", next_request_id_++},
+        {"method", method},
+        {"params", std::move(params)}
+    };
+    ws_->write(net::buffer(json::serialize(request)));
+}
+
+// Re-subscribe so Deribit sends fresh snapshots (reader thread)
+void FeedShard::resubscribe(const std::vector<std::string> &channel_list) {
+    send_subscription("public/unsubscribe", channel_list);
+    send_subscription("public/subscribe", channel_list);
+}
+
+// Decode one frame in place into typed events
+void FeedShard::on_message(std::string_view message) {
+    auto receive_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    last_receive_ns_.store(receive_ns, std::memory_order_relaxed);
+    ScopedLatency timer(decode_latency_);
+    if (decoder_.decode(message, receive_ns) == 0 && decoder_.test_requested()) {
+        send_rpc("public/test", json::object());  // Deribit closes connections that leave a test_request unanswered
+    }
+}
+
+// Reader-only: resolve (once) and return the conflation state of the event's channel
+FeedShard::ChannelState &FeedShard::channel_state(const MarketEvent &event) {
+    channel_key_.assign(channel_prefix(event.type));
+    channel_key_.append(event.symbol);
+    auto it = channel_states_.find(channel_key_);
+    if (it != channel_states_.end()) {
+        return it->second;
+    }
+
+    ConflationPolicy policy = ConflationPolicy::KeepAll;
+    std::size_t best_match = 0;
+    for (const auto &[prefix, rule_policy] : conflation_rules_) {
+        if (prefix.size() >= best_match && channel_key_.compare(0, prefix.size(), prefix) == 0) {
+            best_match = prefix.size();
+            policy = rule_policy;
+        }
+    }
+    int slot = -1;
+    if (policy == ConflationPolicy::LatestOnly && event.type != EventType::Book  // Conflating deltas would corrupt books
+        && conflated_slot_count_ < kMaxConflatedChannels) {
+        slot = conflated_slot_count_++;
+    } else {
+        policy = ConflationPolicy::KeepAll;
+    }
+    return channel_states_.emplace(channel_key_, ChannelState{policy, slot}).first->second;
+}
+
+// Reader-only: push an event, or for latest-only channels overwrite the slot and queue at most one token
+void FeedShard::publish(const MarketEvent &event) {
+    ChannelState &state = channel_state(event);
+    bool pushed;
+    if (state.slot < 0) {
+        pushed = ring_.try_emplace([&event](FeedEntry &entry) {
+            entry.conflated_slot = -1;
+            entry.receive_ns = event.receive_ns;
+            entry.event = event;
+        });
+    } else {
+        ConflatedSlot &slot = conflated_slots_[state.slot];
+        std::uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.event = event;
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+
+        if (slot.queued.exchange(true, std::memory_order_acq_rel)) {
+            conflated_count_.fetch_add(1, std::memory_order_relaxed);  // Consumer will pick up this value with the pending token
+            return;
+        }
+        int index = state.slot;
+        std::int64_t receive_ns = event.receive_ns;
+        pushed = ring_.try_emplace([index, receive_ns](FeedEntry &entry) {
+            entry.conflated_slot = index;
+            entry.receive_ns = receive_ns;
+        });
+        if (!pushed) {
+            slot.queued.store(false, std::memory_order_release);
+        }
+    }
+
+    if (!pushed) {
+        dropped_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    published_count_.fetch_add(1, std::memory_order_relaxed);
+    std::uint64_t depth = ring_.size();
+    if (depth > high_water_.load(std::memory_order_relaxed)) {
+        high_water_.store(depth, std::memory_order_relaxed);  // Single writer, so no CAS needed
+    }
+}
+
+// Consumer-only: copy the newest value of a conflated channel; false if it was already delivered
+bool FeedShard::read_conflated(int index, MarketEvent &out) {
+    ConflatedSlot &slot = conflated_slots_[index];
+    slot.queued.store(false, std::memory_order_release);  // Clear first so a newer write queues a fresh token
+    std::uint32_t before, after;
+    do {
+        before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            cpu_relax();
+            continue;
+        }
+        out = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    if (before == slot.consumed_sequence) {
+        return false;
+    }
+    slot.consumed_sequence = before;
+    return true;
+}
+
+// Shut the socket down under the reader so its blocking read fails and the connection is dropped. A
+// connection still being set up cannot be shut down yet, so the kick is recorded and read_session()
+// drops it as soon as the handshake completes.
+void FeedShard::kick() {
+    std::lock_guard<std::mutex> lock(socket_mutex_);
+    kick_pending_ = true;
+    if (ws_) {
+        ::shutdown(beast::get_lowest_layer(*ws_).native_handle(), SHUT_RDWR);
+    }
+    last_receive_ns_.store(0, std::memory_order_relaxed);  // Not stale again until the new connection receives
+}
+
+// Turn reconnection off and drop the connection, so the reader loop ends
+void FeedShard::stop() {
+    {
+        std::lock_guard<std::mutex> lock(socket_mutex_);
+        stopping_.store(true, std::memory_order_relaxed);
+    }
+    reconnect_.store(false);
+    kick();
+}
+
+// Reader thread: run connections until one fails, or forever with exponential backoff when reconnecting
+void FeedShard::connect() {
+    if (cpu_ >= 0 && !pin_current_thread(cpu_)) {
+        std::cerr << "Feed shard " << index_ << ": cannot pin to CPU " << cpu_ << std::endl;
+    }
+    auto backoff = std::chrono::milliseconds(100);
+    while (true) {
+        auto started = std::chrono::steady_clock::now();
+        try {
+            read_session();
+        } catch (const std::exception &e) {
+            std::cerr << "Feed shard " << index_ << " exception: " << e.what() << std::endl;
+        }
+        if (!reconnect_) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() - started > std::chrono::seconds(30)) {
+            backoff = std::chrono::milliseconds(100);  // The last connection was healthy for a while
+        }
+        std::this_thread::sleep_for(backoff);
+        if (!reconnect_) {
+            break;  // Stopped while backing off
+        }
+        backoff = std::min<std::chrono::milliseconds>(backoff * 2, std::chrono::seconds(5));
+    }
+    finish();
+}
+
+// Connect, subscribe to this shard's channels and decode frames until the connection fails
+void FeedShard::read_session() {
+    {
+        std::lock_guard<std::mutex> lock(socket_mutex_);
+        if (stopping_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        ws_ = std::make_unique<SecureWebSocket>(ioc_, ctx_);  // A failed TLS stream cannot be reused
+        kick_pending_ = false;  // Kicks aimed at the previous connection are spent
+    }
+    last_receive_ns_.store(0, std::memory_order_relaxed);
+    // Cached DNS answer, verified TLS (resumed when a session is cached) and WebSocket upgrade
+    ConnectionBootstrap::instance().connect(*ws_, host_, port_, TARGET, verify_peer_);
+    {
+        // A stop or kick during resolve, connect or handshake found no open connection to shut down.
+        // From here on the socket is connected, so later ones interrupt the read below.
+        std::lock_guard<std::mutex> lock(socket_mutex_);
+        if (stopping_.load(std::memory_order_relaxed) || kick_pending_) {
+            return;
+        }
+    }
+
+    std::cout << "Feed shard " << index_ << " connected (" << channels_.size() << " channels)" << std::endl;
+    send_subscription("public/subscribe", channels_);
+    if (heartbeat_seconds_ > 0) {
+        send_rpc("public/set_heartbeat", json::object{{"interval", heartbeat_seconds_}});
+    }
+
+    // Read incoming messages into one reused buffer and decode them in place
+    beast::flat_buffer buffer;
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        ws_->read(buffer);
+        on_message(std::string_view(static_cast<const char *>(buffer.cdata().data()), buffer.size()));
+        buffer.consume(buffer.size());
+    }
+}
@@ -0,0 +1,160 @@
+#ifndef FEED_SHARD_HPP
+#define FEED_SHARD_HPP
+
+#include <boost/asio.hpp>  // io_context and resolver
+#include <boost/beast.hpp>  // WebSocket stream and buffers
+#include <boost/beast/ssl.hpp>  // TLS stream
+#include <boost/json.hpp>  // Subscription requests
+#include <atomic>  // Counters and finished flag
+#include <cstdint>  // Counters
+#include <functional>  // Event handler
+#include <memory>  // Conflated slot pool and per-attempt stream
+#include <mutex>  // Stream swap vs kick()
+#include <string>  // Channels and endpoint
+#include <string_view>  // Frames are decoded in place
+#include <thread>  // Reader thread
+#include <unordered_map>  // Channel state cache
+#include <utility>  // Conflation rules
+#include <vector>  // Channel list
+#include "FeedDecoder.hpp"  // Typed decode of subscription frames
+#include "SpscRing.hpp"  // Reader -> consumer hand-off
+#include "LatencyStats.hpp"  // Decode latency histogram
+#include "ConnectionBootstrap.hpp"  // Cached DNS and TLS session resumption
+
+namespace beast = boost::beast;  // Alias for Boost.Beast library
+namespace websocket = beast::websocket;  // Alias for WebSocket functionalities in Beast
+namespace net = boost::asio;  // Alias for Boost.Asio library
+namespace ssl = boost::asio::ssl;  // Alias for Boost.Asio SSL functionality
+namespace json = boost::json;  // Alias for Boost.JSON library
+using tcp = net::ip::tcp;  // Alias for TCP socket type in Boost.Asio
+
+enum class ConflationPolicy { KeepAll, LatestOnly };  // Deliver every update of a channel, or only its newest
+using ConflationRules = std::vector<std::pair<std::string, ConflationPolicy>>;  // Channel prefix -> policy, longest match wins
+
+struct FeedStats {
+    std::uint64_t published;  // Entries handed to the consumer ring
+    std::uint64_t dropped;  // Events lost because the ring was full
+    std::uint64_t conflated;  // Updates superseded before the consumer read them
+    std::uint64_t high_water;  // Deepest ring occupancy observed
+};
+
+// Entry in the reader -> consumer ring: a full event, or a token telling the consumer to read a conflated slot
+struct FeedEntry {
+    int conflated_slot;  // -1 when event holds the update
+    std::int64_t receive_ns;  // Receive time used to merge shards in order
+    MarketEvent event;  // The update itself for keep-all channels
+};
+
+// Subscriptions as instruments x channel templates plus literal channels, spread over several connections
+struct FeedConfig {
+    std::vector<std::string> instruments;  // e.g. "BTC-PERPETUAL", "BTC-27JUN25-60000-C"
+    std::vector<std::string> channel_templates;  // "{}" is replaced by each instrument, e.g. "book.{}.100ms"
+    std::vector<std::string> channels;  // Channels taken as-is, e.g. "deribit_price_index.btc_usd"
+    int shards = 1;  // WebSocket connections, each with its own io_context, reader thread and ring
+    std::vector<int> shard_cpus;  // Optional core per shard reader thread, -1 for unpinned
+    int consumer_cpu = -1;  // Optional core for the merging consumer thread
+    bool redundant = false;  // Mirror every shard on a second connection (leg B) and keep the first copy of each update
+    int stale_after_ms = 2000;  // Redundant mode: reconnect a leg this long silent while its partner is receiving
+    int heartbeat_seconds = 10;  // public/set_heartbeat interval (Deribit minimum 10); a connection silent for 1.5x is dropped; 0 disables
+
+    std::vector<std::string> expand() const;  // Every channel to subscribe, templates first
+};
+
+// One market-data connection: a reader thread with its own io_context decodes frames and hands events
+// to a handler (which applies and publishes them); the consumer drains the shard's ring.
+class FeedShard {
+public:
+    using EventHandler = std::function<void(FeedShard &, const MarketEvent &)>;
+
+    FeedShard(int index, std::size_t ring_capacity, const ConflationRules &conflation_rules, EventHandler handler);
+    FeedShard(const FeedShard &) = delete;
+    FeedShard &operator=(const FeedShard &) = delete;
+
+    void add_channel(const std::string &channel) { channels_.push_back(channel); }  // Call before start()
+    const std::vector<std::string> &channels() const { return channels_; }  // Channels owned by this shard
+    void set_endpoint(const std::string &host, const std::string &port);  // Call before start()
+    void set_cpu(int cpu) { cpu_ = cpu; }  // Pin the reader thread; call before start()
+    void set_verify_peer(bool verify) { verify_peer_ = verify; }  // Disable only for self-signed test servers; call before start()
+    void set_leg(int leg) { leg_ = leg; }  // Redundant mode: 0 for leg A, 1 for its mirror; call before start()
+    void set_reconnect(bool reconnect) { reconnect_.store(reconnect); }  // Reconnect with backoff instead of finishing; call before start()
+    void set_heartbeat(int seconds) { heartbeat_seconds_ = seconds; }  // Ask for heartbeats after subscribing, 0 for none; call before start()
+    int index() const { return index_; }  // Position in the server's shard list
+    int leg() const { return leg_; }  // 0 unless this shard mirrors another
+    std::string_view current_channel() const { return decoder_.channel(); }  // Channel of the event being handled (reader thread)
+    std::int64_t last_receive_ns() const { return last_receive_ns_.load(std::memory_order_relaxed); }  // Newest frame (system_clock ns), 0 before the first
+    void kick();  // Drop the current connection from another thread; the reader reconnects if enabled
+    void stop();  // Drop the connection for good; the reader thread finishes (any thread)
+
+    void start();  // Connect, subscribe and read on a new thread
+    void join();  // Wait for the reader thread
+    void finish() { finished_.store(true, std::memory_order_release); }  // Mark the producer side done
+    bool finished() const { return finished_.load(std::memory_order_acquire); }  // No more entries will be published
+
+    // Reader thread
+    void publish(const MarketEvent &event);  // Push an event (or a conflation token) to the ring
+    void resubscribe(const std::vector<std::string> &channel_list);  // Unsubscribe and subscribe again for a fresh snapshot
+
+    // Consumer thread
+    FeedEntry *front() { return ring_.front(); }  // Oldest entry or nullptr
+    void pop() { ring_.pop(); }  // Release the entry returned by front()
+    bool read_conflated(int slot, MarketEvent &out);  // Newest value of a conflated channel, false if already seen
+
+    std::size_t queued() const { return ring_.size(); }  // Approximate ring occupancy
+    std::size_t capacity() const { return ring_.capacity(); }  // Ring size
+    FeedStats stats() const;  // Ring counters, safe to read from any thread
+
+private:
+    // Latest value of a conflated channel, written by the reader under a sequence lock
+    struct ConflatedSlot {
+        std::atomic<std::uint32_t> sequence{0};  // Odd while the reader is writing
+        std::atomic<bool> queued{false};  // A token for this slot is already in the ring
+        std::uint32_t consumed_sequence = 0;  // Consumer-only: last sequence delivered
+        MarketEvent event;  // Newest update
+    };
+    struct ChannelState {
+        ConflationPolicy policy;  // Resolved from the conflation rules on first sight
+        int slot;  // Index into conflated_slots_, -1 for keep-all
+    };
+
+    void connect();  // Reader thread body
+    void read_session();  // One connection: connect, subscribe and read until it fails
+    void on_message(std::string_view message);  // Decode one frame
+    void send_subscription(const std::string &method, const std::vector<std::string> &channel_list);  // Write a (un)subscribe request
+    void send_rpc(const std::string &method, json::object params);  // Write a request whose response is ignored
+    ChannelState &channel_state(const MarketEvent &event);  // Reader-only lookup of a channel's policy
+
+    int index_;  // Position in the server's shard list
+    net::io_context ioc_;  // Private to this shard's reader thread
+    ssl::context ctx_;  // TLS context for this connection
+    std::unique_ptr<SecureWebSocket> ws_;  // Secure WebSocket stream, recreated for every connection attempt
+    std::mutex socket_mutex_;  // Guards ws_ replacement, kick_pending_ and the stopping_ store against kick()/stop()
+    bool kick_pending_ = false;  // A kick arrived since the current connection attempt began
+    std::atomic<bool> stopping_{false};  // Set by stop(); no further connection is opened or read
+    std::string host_;  // Feed host name
+    std::string port_;  // Feed port
+    std::vector<std::string> channels_;  // Subscribed on connect
+    int cpu_ = -1;  // Reader core, -1 for unpinned
+    int leg_ = 0;  // Redundant leg this connection carries
+    std::atomic<bool> reconnect_{false};  // Keep reconnecting after failures; cleared by stop()
+    int heartbeat_seconds_ = 0;  // public/set_heartbeat interval, 0 for none
+    bool verify_peer_ = true;  // Certificate and host-name verification
+    int next_request_id_ = 1;  // Ids for (un)subscribe requests on this connection
+    EventHandler handler_;  // Applies and publishes decoded events
+    FeedDecoder decoder_;  // Reused parser and arena for every frame
+    SpscRing<FeedEntry> ring_;  // Reader -> consumer hand-off
+    const ConflationRules &conflation_rules_;  // Owned by the server, fixed once shards exist
+    std::unique_ptr<ConflatedSlot[]> conflated_slots_;  // Fixed pool so the consumer never sees a reallocation
+    int conflated_slot_count_ = 0;  // Slots handed out so far (reader-only)
+    std::unordered_map<std::string, ChannelState> channel_states_;  // Reader-only cache keyed by channel name
+    std::string channel_key_;  // Reused buffer for building channel names
+    std::thread thread_;  // Reader thread
+    std::atomic<bool> finished_{false};  // Set when the reader loop exits
+    std::atomic<std::int64_t> last_receive_ns_{0};  // Staleness probe for the redundant-mode watchdog
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> published_count_{0};  // FeedStats::published
+    std::atomic<std::uint64_t> dropped_count_{0};  // FeedStats::dropped
+    std::atomic<std::uint64_t> conflated_count_{0};  // FeedStats::conflated
+    std::atomic<std::uint64_t> high_water_{0};  // FeedStats::high_water
+    LatencyHistogram &decode_latency_ = LatencyRegistry::instance().histogram("feed.decode");  // Frame -> typed events
+};
+
+#endif
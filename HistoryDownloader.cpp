@@ -0,0 +1,408 @@
+#include "HistoryDownloader.hpp"
+#include "JsonFields.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+constexpr std::int64_t kTooManyRequests = 10028;  // Deribit error code for rate-limit rejections
+constexpr std::int64_t kTransportError = -32000;  // DeribitClient's code for a failed connection
+constexpr std::size_t kTradesPerRequest = 1000;  // Largest count get_last_trades_by_instrument_and_time accepts
+constexpr std::int64_t kCandlesPerRequest = 1000;  // Candles asked for in one get_tradingview_chart_data request, well below its cap
+constexpr std::size_t kRowsPerBlock = 1 << 16;  // Completed slices are merged into blocks up to this size
+
+namespace {
+
+// Length of one candle in milliseconds
+std::int64_t resolution_ms(const std::string& resolution) {
+    if (resolution == "1D") {
+        return 24 * 3600 * 1000;
+    }
+    std::int64_t minutes = std::stoll(resolution);
+    if (minutes <= 0) {
+        throw std::invalid_argument("Bad candle resolution " + resolution);
+    }
+    return minutes * 60 * 1000;
+}
+
+// A get_last_trades_by_instrument_and_time result into columns
+bool parse_trades(const json::value& result, TradeRows& rows, bool& has_more) {
+    const auto* object = result.if_object();
+    const auto* trades = object ? object->if_contains("trades") : nullptr;
+    if (!trades || !trades->is_array()) {
+        return false;
+    }
+    for (const auto& item : trades->as_array()) {
+        const auto* trade = item.if_object();
+        if (!trade) {
+            continue;
+        }
+        const auto* direction = trade->if_contains("direction");
+        rows.timestamp.push_back(static_cast<std::int64_t>(number_or(*trade, "timestamp")));
+        rows.sequence.push_back(static_cast<std::int64_t>(number_or(*trade, "trade_seq")));
+        rows.price.push_back(number_or(*trade, "price"));
+        rows.amount.push_back(number_or(*trade, "amount"));
+        rows.index_price.push_back(number_or(*trade, "index_price"));
+        rows.mark_price.push_back(number_or(*trade, "mark_price"));
+        rows.direction.push_back(direction && direction->is_string() && direction->as_string() == "sell" ? -1 : 1);
+    }
+    const auto* more = object->if_contains("has_more");
+    has_more = more && more->is_bool() && more->as_bool();
+    return true;
+}
+
+// A get_tradingview_chart_data result (parallel arrays) into columns
+bool parse_candles(const json::value& result, CandleRows& rows) {
+    const auto* object = result.if_object();
+    if (!object) {
+        return false;
+    }
+    const auto* status = object->if_contains("status");
+    if (status && status->is_string() && status->as_string() == "no_data") {
+        return true;
+    }
+    const json::array* columns[7] = {};
+    const char* names[7] = {"ticks", "open", "high", "low", "close", "volume", "cost"};
+    std::size_t count = static_cast<std::size_t>(-1);
+    for (int c = 0; c < 7; ++c) {
+        const auto* column = object->if_contains(names[c]);
+        columns[c] = column ? column->if_array() : nullptr;
+        count = std::min(count, columns[c] ? columns[c]->size() : 0);
+    }
+    if (!columns[0]) {
+        return false;
+    }
+    std::vector<double>* targets[6] = {&rows.open, &rows.high, &rows.low, &rows.close, &rows.volume, &rows.cost};
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& tick = (*columns[0])[i];
+        rows.tick.push_back(tick.is_number() ? tick.to_number<std::int64_t>() : 0);
+        for (int c = 0; c < 6; ++c) {
+            const auto& value = (*columns[c + 1])[i];
+            targets[c]->push_back(value.is_number() ? value.to_number<double>() : 0.0);
+        }
+    }
+    return true;
+}
+
+// Append row i of src to dst
+void copy_row(TradeRows& dst, const TradeRows& src, std::size_t i) {
+    dst.timestamp.push_back(src.timestamp[i]);
+    dst.sequence.push_back(src.sequence[i]);
+    dst.price.push_back(src.price[i]);
+    dst.amount.push_back(src.amount[i]);
+    dst.index_price.push_back(src.index_price[i]);
+    dst.mark_price.push_back(src.mark_price[i]);
+    dst.direction.push_back(src.direction[i]);
+}
+
+// Append row i of src to dst
+void copy_row(CandleRows& dst, const CandleRows& src, std::size_t i) {
+    dst.tick.push_back(src.tick[i]);
+    dst.open.push_back(src.open[i]);
+    dst.high.push_back(src.high[i]);
+    dst.low.push_back(src.low[i]);
+    dst.close.push_back(src.close[i]);
+    dst.volume.push_back(src.volume[i]);
+    dst.cost.push_back(src.cost[i]);
+}
+
+// Append every row of src to dst and release src's memory
+template <typename Rows>
+void move_rows(Rows& dst, Rows& src) {
+    if (dst.size() == 0) {
+        std::swap(dst, src);
+        return;
+    }
+    for (std::size_t i = 0; i < src.size(); ++i) {
+        copy_row(dst, src, i);
+    }
+    src = Rows();
+}
+
+}  // namespace
+
+// Nothing connects until run()
+HistoryDownloader::HistoryDownloader(const std::string& host, const std::string& port, RateLimiter& limiter,
+                                     HistoryOptions options)
+    : host_(host), port_(port), limiter_(limiter), options_(std::move(options)) {
+    options_.connections = std::max<std::size_t>(options_.connections, 1);
+    options_.requests_per_connection = std::max<std::size_t>(options_.requests_per_connection, 1);
+    options_.max_attempts = std::max(options_.max_attempts, 1);
+}
+
+// Connections close before the files
+HistoryDownloader::~HistoryDownloader() {
+    connections_.clear();
+}
+
+// Open every job's file, find where it resumes and cut the remaining range into slices
+void HistoryDownloader::plan(const std::vector<HistoryJob>& jobs) {
+    std::int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    for (const HistoryJob& spec : jobs) {
+        Job job;
+        job.spec = spec;
+        job.writer = std::make_unique<HistoryWriter>(
+            options_.directory + "/" + history_file_name(spec.instrument, spec.kind, spec.resolution), spec.kind);
+        bool trades = spec.kind == HistoryKind::Trades;
+        std::int64_t step = trades ? std::max<std::int64_t>(options_.trade_slice_ms, 1000)
+                                   : kCandlesPerRequest * resolution_ms(spec.resolution);
+        std::int64_t start = spec.start_ms;
+        if (job.writer->rows() > 0) {  // Trades resume inside the newest millisecond, skipping what is stored
+            std::int64_t resume = job.writer->last_timestamp() + (trades ? 0 : resolution_ms(spec.resolution));
+            start = std::max(start, resume);
+        } else if (start <= 0) {
+            throw std::runtime_error("No start time for " + spec.instrument + " and no history file to continue");
+        }
+        std::int64_t end = spec.end_ms > 0 ? spec.end_ms : now_ms;
+        if (!trades) {
+            // Stop before the candle still forming: it would be stored as final and never revisited, since
+            // the next run resumes one resolution after the newest stored candle
+            std::int64_t resolution = resolution_ms(spec.resolution);
+            end = std::min(end, now_ms / resolution * resolution - 1);
+        }
+
+        job.first_slice = job.next_commit = slices_.size();
+        for (std::int64_t from = start; from <= end; from += step) {
+            Slice slice;
+            slice.job = jobs_.size();
+            slice.start_ms = from;
+            slice.end_ms = std::min(from + step - 1, end);
+            slice.last_sequence = from <= job.writer->last_timestamp() ? job.writer->last_sequence() : 0;
+            slices_.push_back(std::move(slice));
+        }
+        job.end_slice = slices_.size();
+        jobs_.push_back(std::move(job));
+    }
+    for (std::size_t i = 0; i < slices_.size(); ++i) {
+        queue_.push_back(Request{i, slices_[i].start_ms, 0});
+    }
+}
+
+// Build the request for one page of a slice and send it without waiting
+void HistoryDownloader::send(std::size_t connection, const Request& request) {
+    const Slice& slice = slices_[request.slice];  // Ranges and specs are fixed once planned
+    const HistoryJob& spec = jobs_[slice.job].spec;
+    json::value payload;
+    if (spec.kind == HistoryKind::Trades) {
+        payload = {
+            {"jsonrpc", "2.0"},
+            {"method", "public/get_last_trades_by_instrument_and_time"},
+            {"params", { {"instrument_name", spec.instrument}, {"start_timestamp", request.from_ms},
+                         {"end_timestamp", slice.end_ms}, {"count", kTradesPerRequest}, {"sorting", "asc"} }}
+        };
+    } else {
+        payload = {
+            {"jsonrpc", "2.0"},
+            {"method", "public/get_tradingview_chart_data"},
+            {"params", { {"instrument_name", spec.instrument}, {"start_timestamp", slice.start_ms},
+                         {"end_timestamp", slice.end_ms}, {"resolution", spec.resolution} }}
+        };
+    }
+    connections_[connection]->async_request(std::move(payload), track(connection, request));
+}
+
+// Handler run on the connection's strand
+ResponseHandler HistoryDownloader::track(std::size_t connection, Request request) {
+    std::uint64_t sent_ticks = TscClock::now();
+    return [this, connection, request, sent_ticks](json::value response) {
+        latency_.record_ticks(sent_ticks);
+        on_response(connection, request, response);
+    };
+}
+
+// Parse outside the lock, then keep the rows the slice does not have yet and queue the next page; errors
+// are retried ahead of new slices so the oldest data, which gates appending, arrives first
+void HistoryDownloader::on_response(std::size_t connection, Request request, const json::value& response) {
+    const auto* message = response.if_object();
+    const auto* result = message ? message->if_contains("result") : nullptr;
+    std::int64_t code = 0;
+    if (const auto* error = message ? message->if_contains("error") : nullptr; error && error->is_object()) {
+        code = static_cast<std::int64_t>(number_or(error->as_object(), "code"));
+    }
+    bool trades = jobs_[slices_[request.slice].job].spec.kind == HistoryKind::Trades;
+    TradeRows trade_page;
+    CandleRows candle_page;
+    bool has_more = false;
+    bool ok = result && (trades ? parse_trades(*result, trade_page, has_more) : parse_candles(*result, candle_page));
+    if (code == kTooManyRequests) {
+        limiter_.on_throttled(RateLimiter::Pool::NonMatching);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    --in_flight_[connection];
+    ++requests_;
+    Slice& slice = slices_[request.slice];
+    if (!ok) {
+        broken_[connection] = broken_[connection] || code == kTransportError;
+        if (++request.attempts < options_.max_attempts) {
+            ++retries_;
+            throttled_ += code == kTooManyRequests ? 1 : 0;
+            queue_.push_front(request);
+        } else {
+            slice.failed = true;
+            std::size_t job = slice.job;
+            queue_.erase(std::remove_if(queue_.begin(), queue_.end(),
+                                        [&](const Request& queued) { return slices_[queued.slice].job == job; }),
+                         queue_.end());
+            std::cerr << "Giving up on " << jobs_[job].spec.instrument << " from " << request.from_ms
+                      << " after " << request.attempts << " attempts\n";
+        }
+        changed_.notify_all();
+        return;
+    }
+
+    if (trades) {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < trade_page.size(); ++i) {
+            if (trade_page.sequence[i] > slice.last_sequence) {
+                copy_row(slice.trades, trade_page, i);
+                slice.last_sequence = trade_page.sequence[i];
+                ++kept;
+            }
+        }
+        if (has_more && trade_page.size() > 0) {
+            std::int64_t next_from = trade_page.timestamp.back();  // Same millisecond again; seen trades are skipped
+            if (next_from <= request.from_ms && kept == 0) {
+                next_from = request.from_ms + 1;  // A page full of one millisecond; move past it
+            }
+            if (next_from <= slice.end_ms) {
+                queue_.push_front(Request{request.slice, next_from, 0});
+                changed_.notify_all();
+                return;
+            }
+        }
+    } else {
+        std::int64_t last = slice.candles.size() > 0 ? slice.candles.tick.back() : slice.start_ms - 1;
+        for (std::size_t i = 0; i < candle_page.size(); ++i) {
+            if (candle_page.tick[i] > last && candle_page.tick[i] <= slice.end_ms) {
+                copy_row(slice.candles, candle_page, i);
+                last = candle_page.tick[i];
+            }
+        }
+    }
+    slice.done = true;
+    changed_.notify_all();
+}
+
+// Merge each job's oldest completed slices into blocks and append them. Writers are only touched by the
+// thread in run(), so the disk writes happen with the lock released.
+void HistoryDownloader::commit(std::unique_lock<std::mutex>& lock) {
+    for (Job& job : jobs_) {
+        while (!job.failed && job.next_commit < job.end_slice) {
+            TradeRows trades;
+            CandleRows candles;
+            while (job.next_commit < job.end_slice && trades.size() + candles.size() < kRowsPerBlock) {
+                Slice& slice = slices_[job.next_commit];
+                if (slice.failed) {
+                    job.failed = true;
+                    break;
+                }
+                if (!slice.done) {
+                    break;
+                }
+                move_rows(trades, slice.trades);
+                move_rows(candles, slice.candles);
+                ++job.next_commit;
+            }
+            if (trades.size() + candles.size() == 0) {
+                break;
+            }
+            rows_ += trades.size() + candles.size();
+            lock.unlock();
+            if (trades.size() > 0) {
+                job.writer->append(trades);
+            } else {
+                job.writer->append(candles);
+            }
+            lock.lock();
+        }
+    }
+}
+
+// Connect, then keep every connection's pipeline full until each slice is in and appended
+HistoryReport HistoryDownloader::run(const std::vector<HistoryJob>& jobs) {
+    auto start = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        plan(jobs);
+    }
+    for (std::size_t i = 0; i < options_.connections; ++i) {
+        auto client = std::make_unique<DeribitClient>(host_, port_, "", "");
+        client->set_verify_peer(verify_peer_);
+        client->connect();
+        connections_.push_back(std::move(client));
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    in_flight_.assign(connections_.size(), 0);
+    broken_.assign(connections_.size(), false);
+    while (true) {
+        commit(lock);
+        std::size_t busy = 0;
+        std::size_t best = connections_.size();
+        for (std::size_t c = 0; c < connections_.size(); ++c) {
+            busy += in_flight_[c];
+            if (!broken_[c] && in_flight_[c] < options_.requests_per_connection &&
+                (best == connections_.size() || in_flight_[c] < in_flight_[best])) {
+                best = c;
+            }
+        }
+        if (queue_.empty() && busy == 0) {
+            break;
+        }
+        if (!queue_.empty() && best < connections_.size()) {
+            Request request = queue_.front();
+            queue_.pop_front();
+            ++in_flight_[best];
+            lock.unlock();
+            limiter_.acquire(RateLimiter::Pool::NonMatching);
+            send(best, request);
+            lock.lock();
+            continue;
+        }
+        if (!queue_.empty() && busy == 0 &&
+            std::all_of(broken_.begin(), broken_.end(), [](bool broken) { return broken; })) {
+            std::cerr << "Every history connection failed; " << queue_.size() << " requests not sent\n";
+            for (const Request& request : queue_) {
+                slices_[request.slice].failed = true;
+            }
+            queue_.clear();
+            continue;
+        }
+        changed_.wait(lock);
+    }
+
+    std::uint64_t failed_jobs = 0;
+    for (Job& job : jobs_) {
+        failed_jobs += job.failed ? 1 : 0;
+        job.writer->sync();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    HistoryReport report{requests_, rows_, retries_, throttled_, failed_jobs, seconds};
+    lock.unlock();
+    connections_.clear();
+    return report;
+}
+
+// Achieved request and row rates and the round-trip distribution in microseconds
+void HistoryDownloader::print_report(const HistoryReport& report, std::ostream& out) const {
+    double request_rate = report.seconds > 0 ? static_cast<double>(report.requests) / report.seconds : 0;
+    double row_rate = report.seconds > 0 ? static_cast<double>(report.rows) / report.seconds : 0;
+    out << "\n========== History ==========\n";
+    out << "Requests " << report.requests << ", rows " << report.rows << ", retries " << report.retries
+        << " (throttled " << report.throttled << "), failed jobs " << report.failed_jobs << " in " << std::fixed
+        << std::setprecision(3) << report.seconds << " s -> " << std::setprecision(1) << request_rate
+        << " requests/s, " << row_rate << " rows/s\n";
+    out << std::setprecision(1) << "Latency us: p50 " << latency_.percentile(50) / 1000.0
+        << "  p99 " << latency_.percentile(99) / 1000.0
+        << "  max " << latency_.max() / 1000.0 << "\n";
+    for (const Job& job : jobs_) {
+        out << job.spec.instrument << ": " << job.writer->rows() << " rows up to " << job.writer->last_timestamp()
+            << (job.failed ? " (incomplete)" : "") << "\n";
+    }
+    out << "=============================\n";
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,114 @@
+#ifndef HISTORY_DOWNLOADER_HPP
+#define HISTORY_DOWNLOADER_HPP
+
+#include <condition_variable>  // Waiting for responses
+#include <cstdint>  // Timestamps and counters
+#include <deque>  // Requests waiting for a connection
+#include <memory>  // Connections and writers
+#include <mutex>  // Shared with response handlers
+#include <ostream>  // Report
+#include <string>  // Instruments, resolutions and paths
+#include <vector>  // Jobs, slices and connections
+#include "DeribitClient.hpp"  // Pipelined public requests
+#include "RateLimiter.hpp"  // Credit-based pacing
+#include "HistoryStore.hpp"  // Columnar output files
+#include "LatencyStats.hpp"  // Round-trip distribution
+
+// One instrument's history to fetch into <directory>/history_file_name(...)
+struct HistoryJob {
+    std::string instrument;  // e.g. BTC-PERPETUAL
+    HistoryKind kind = HistoryKind::Trades;  // Trades or candles
+    std::string resolution = "1";  // Candles: minutes (1, 3, 5, 10, 15, 30, 60, 120, 180, 360, 720) or 1D
+    std::int64_t start_ms = 0;  // First timestamp; 0 continues after the newest row already in the file
+    std::int64_t end_ms = 0;  // Last timestamp; 0 means now
+};
+
+struct HistoryOptions {
+    std::string directory = ".";  // Where the history files live
+    std::size_t connections = 4;  // WebSocket connections sharing the requests
+    std::size_t requests_per_connection = 4;  // Requests in flight on each connection
+    std::int64_t trade_slice_ms = 6 * 3600 * 1000;  // Time range of one trades request chain
+    int max_attempts = 5;  // Tries per request before its job stops at that point
+};
+
+struct HistoryReport {
+    std::uint64_t requests;  // Requests answered
+    std::uint64_t rows;  // Rows appended
+    std::uint64_t retries;  // Requests sent again after an error
+    std::uint64_t throttled;  // too_many_requests rejections among the retries
+    std::uint64_t failed_jobs;  // Jobs stopped short by a request that kept failing
+    double seconds;  // First request to last append
+};
+
+// Bulk history backfill. Each job's time range is cut into slices that are fetched concurrently over
+// several connections: trades with public/get_last_trades_by_instrument_and_time (paged with has_more
+// inside a slice), candles with public/get_tradingview_chart_data. Every request is paced by the
+// RateLimiter's non-matching pool. Slices complete in any order but are appended to the job's file
+// strictly in time order, so a run that stops early leaves a file that the next run extends from its
+// newest row.
+class HistoryDownloader {
+public:
+    HistoryDownloader(const std::string& host, const std::string& port, RateLimiter& limiter,
+                      HistoryOptions options = HistoryOptions());  // limiter must outlive the downloader
+    ~HistoryDownloader();
+    HistoryDownloader(const HistoryDownloader&) = delete;
+    HistoryDownloader& operator=(const HistoryDownloader&) = delete;
+
+    void set_verify_peer(bool verify) { verify_peer_ = verify; }  // Disable only for self-signed test servers
+    HistoryReport run(const std::vector<HistoryJob>& jobs);  // Connect, download, append; blocks until done
+    void print_report(const HistoryReport& report, std::ostream& out) const;  // Throughput and latency summary
+
+private:
+    struct Slice {
+        std::size_t job;  // Owning job
+        std::int64_t start_ms;  // Inclusive
+        std::int64_t end_ms;  // Inclusive
+        std::int64_t last_sequence;  // Newest trade_seq kept; later pages skip up to it
+        TradeRows trades;  // Rows fetched so far
+        CandleRows candles;
+        bool done = false;  // Every page is in
+        bool failed = false;  // Gave up after max_attempts
+    };
+
+    struct Request {
+        std::size_t slice;  // Slice being fetched
+        std::int64_t from_ms;  // Page start inside the slice
+        int attempts;  // Tries so far
+    };
+
+    struct Job {
+        HistoryJob spec;  // What to fetch
+        std::unique_ptr<HistoryWriter> writer;  // Output file
+        std::size_t first_slice = 0;  // Slices [first_slice, end_slice) belong to this job
+        std::size_t end_slice = 0;
+        std::size_t next_commit = 0;  // Oldest slice not yet appended
+        bool failed = false;  // A slice failed; nothing after it is appended
+    };
+
+    void plan(const std::vector<HistoryJob>& jobs);  // Open files and cut ranges into slices
+    void send(std::size_t connection, const Request& request);  // Build and send one request
+    ResponseHandler track(std::size_t connection, Request request);  // Completion handler (connection strand)
+    void on_response(std::size_t connection, Request request, const json::value& response);  // Rows into the slice, next page or retry
+    void commit(std::unique_lock<std::mutex>& lock);  // Append every job's completed slices in order; writes with the lock released
+
+    std::string host_, port_;  // Endpoint
+    RateLimiter& limiter_;  // Pacing
+    HistoryOptions options_;  // Behaviour
+    bool verify_peer_ = true;  // Passed to every connection
+    std::vector<std::unique_ptr<DeribitClient>> connections_;  // Open connections
+    LatencyHistogram latency_;  // Send -> response
+
+    std::mutex mutex_;  // Guards everything below
+    std::condition_variable changed_;  // Signalled on every response
+    std::vector<Job> jobs_;  // One per HistoryJob
+    std::vector<Slice> slices_;  // All jobs' slices, in job then time order
+    std::deque<Request> queue_;  // Requests waiting to be sent
+    std::vector<std::size_t> in_flight_;  // Per connection
+    std::vector<bool> broken_;  // Per connection: the transport failed
+    std::uint64_t requests_ = 0;  // HistoryReport fields
+    std::uint64_t rows_ = 0;
+    std::uint64_t retries_ = 0;
+    std::uint64_t throttled_ = 0;
+};
+
+#endif
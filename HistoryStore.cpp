@@ -0,0 +1,265 @@
+#include "HistoryStore.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'X', 'H', 'I', 'S', 'T', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kMaxColumns = 7;  // Both kinds have seven columns
+
+struct BlockHeader {
+    std::uint32_t length;  // Whole block including the header
+    std::uint32_t rows;  // Rows in the block
+    std::int64_t first_timestamp;  // Oldest row
+    std::int64_t last_timestamp;  // Newest row
+    std::uint64_t reserved;
+};
+static_assert(sizeof(BlockHeader) == 32, "block header must stay 32 bytes");
+static_assert(sizeof(HistoryHeader) == 64, "history header must stay 64 bytes");
+
+constexpr std::uint8_t kTradeWidths[kMaxColumns] = {8, 8, 8, 8, 8, 8, 1};  // TradeColumn order
+constexpr std::uint8_t kCandleWidths[kMaxColumns] = {8, 8, 8, 8, 8, 8, 8};  // CandleColumn order
+
+constexpr std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+[[noreturn]] void throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+const std::uint8_t *widths_of(HistoryKind kind) {
+    return kind == HistoryKind::Trades ? kTradeWidths : kCandleWidths;
+}
+
+// Write all of buffer at offset, retrying short writes
+void write_at(int fd, const void *buffer, std::size_t length, std::size_t offset, const std::string &path) {
+    const char *cursor = static_cast<const char *>(buffer);
+    while (length > 0) {
+        ssize_t written = ::pwrite(fd, cursor, length, static_cast<off_t>(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("Cannot write history " + path);
+        }
+        cursor += written;
+        offset += static_cast<std::size_t>(written);
+        length -= static_cast<std::size_t>(written);
+    }
+}
+
+}  // namespace
+
+// Drop every row
+void TradeRows::clear() {
+    timestamp.clear();
+    sequence.clear();
+    price.clear();
+    amount.clear();
+    index_price.clear();
+    mark_price.clear();
+    direction.clear();
+}
+
+// Drop every row
+void CandleRows::clear() {
+    tick.clear();
+    open.clear();
+    high.clear();
+    low.clear();
+    close.clear();
+    volume.clear();
+    cost.clear();
+}
+
+// File name of an instrument's history; candles carry their resolution
+std::string history_file_name(const std::string &instrument, HistoryKind kind, const std::string &resolution) {
+    if (kind == HistoryKind::Trades) {
+        return instrument + ".trades.gtxh";
+    }
+    return instrument + ".candles." + resolution + ".gtxh";
+}
+
+// Create a new file, or reopen an existing one and continue after its last complete block
+HistoryWriter::HistoryWriter(const std::string &path, HistoryKind kind) : path_(path) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw_errno("Cannot open history " + path);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw_errno("Cannot stat history " + path);
+    }
+    if (st.st_size >= static_cast<off_t>(sizeof(HistoryHeader))) {
+        if (::pread(fd_, &header_, sizeof(header_), 0) != static_cast<ssize_t>(sizeof(header_)) ||
+            std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 || header_.version != kVersion) {
+            ::close(fd_);
+            throw std::runtime_error("Not a GoTradeX history file: " + path);
+        }
+        if (header_.kind != static_cast<std::uint8_t>(kind)) {
+            ::close(fd_);
+            throw std::runtime_error("History file holds another kind of data: " + path);
+        }
+        return;
+    }
+    std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+    header_.version = kVersion;
+    header_.header_size = sizeof(HistoryHeader);
+    header_.kind = static_cast<std::uint8_t>(kind);
+    header_.columns = kMaxColumns;
+    header_.write_offset = sizeof(HistoryHeader);
+    write_at(fd_, &header_, sizeof(header_), 0, path_);
+}
+
+// Close; blocks are already complete on disk
+HistoryWriter::~HistoryWriter() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+// Lay the columns out behind a block header, write the block, then publish it through the file header.
+// A crash between the two writes leaves the block past write_offset, where readers never look.
+void HistoryWriter::write_block(std::size_t rows, std::int64_t first, std::int64_t last, std::int64_t sequence,
+                                const void *const *columns) {
+    if (rows == 0) {
+        return;
+    }
+    if (header_.row_count > 0 && first < header_.last_timestamp) {
+        throw std::runtime_error("History rows must be appended in time order: " + path_);
+    }
+    const std::uint8_t *widths = widths_of(static_cast<HistoryKind>(header_.kind));
+    std::size_t length = sizeof(BlockHeader);
+    for (std::size_t c = 0; c < kMaxColumns; ++c) {
+        length += align8(rows * widths[c]);
+    }
+    block_.assign(length, 0);
+    BlockHeader block{};
+    block.length = static_cast<std::uint32_t>(length);
+    block.rows = static_cast<std::uint32_t>(rows);
+    block.first_timestamp = first;
+    block.last_timestamp = last;
+    std::memcpy(block_.data(), &block, sizeof(block));
+    std::size_t offset = sizeof(BlockHeader);
+    for (std::size_t c = 0; c < kMaxColumns; ++c) {
+        std::memcpy(block_.data() + offset, columns[c], rows * widths[c]);
+        offset += align8(rows * widths[c]);
+    }
+
+    write_at(fd_, block_.data(), length, header_.write_offset, path_);
+    header_.write_offset += length;
+    header_.row_count += rows;
+    ++header_.block_count;
+    header_.last_timestamp = last;
+    header_.last_sequence = sequence;
+    write_at(fd_, &header_, sizeof(header_), 0, path_);
+}
+
+// One block of trades
+void HistoryWriter::append(const TradeRows &rows) {
+    if (header_.kind != static_cast<std::uint8_t>(HistoryKind::Trades)) {
+        throw std::runtime_error("Trades appended to a candles file: " + path_);
+    }
+    std::size_t n = rows.size();
+    if (n == 0) {
+        return;
+    }
+    const void *columns[kMaxColumns] = {rows.timestamp.data(), rows.sequence.data(), rows.price.data(),
+                                        rows.amount.data(), rows.index_price.data(), rows.mark_price.data(),
+                                        rows.direction.data()};
+    write_block(n, rows.timestamp.front(), rows.timestamp.back(), rows.sequence.back(), columns);
+}
+
+// One block of candles
+void HistoryWriter::append(const CandleRows &rows) {
+    if (header_.kind != static_cast<std::uint8_t>(HistoryKind::Candles)) {
+        throw std::runtime_error("Candles appended to a trades file: " + path_);
+    }
+    std::size_t n = rows.size();
+    if (n == 0) {
+        return;
+    }
+    const void *columns[kMaxColumns] = {rows.tick.data(), rows.open.data(), rows.high.data(), rows.low.data(),
+                                        rows.close.data(), rows.volume.data(), rows.cost.data()};
+    write_block(n, rows.tick.front(), rows.tick.back(), 0, columns);
+}
+
+// Force written blocks to disk
+void HistoryWriter::sync() {
+    ::fdatasync(fd_);
+}
+
+// Map an existing file read-only and walk its block chain
+HistoryReader::HistoryReader(const std::string &path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw_errno("Cannot open history " + path);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(HistoryHeader))) {
+        ::close(fd_);
+        throw std::runtime_error("History file too short: " + path);
+    }
+    mapped_ = static_cast<std::size_t>(st.st_size);
+    void *address = ::mmap(nullptr, mapped_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED) {
+        ::close(fd_);
+        throw_errno("Cannot map history " + path);
+    }
+    base_ = static_cast<const char *>(address);
+
+    const HistoryHeader &file = header();
+    if (std::memcmp(file.magic, kMagic, sizeof(kMagic)) != 0 || file.version != kVersion ||
+        file.columns != kMaxColumns) {
+        ::munmap(address, mapped_);
+        ::close(fd_);
+        throw std::runtime_error("Not a GoTradeX history file: " + path);
+    }
+    std::size_t end = std::min<std::size_t>(file.write_offset, mapped_);
+    for (std::size_t offset = file.header_size; offset + sizeof(BlockHeader) <= end;) {
+        const auto *block = reinterpret_cast<const BlockHeader *>(base_ + offset);
+        if (block->length < sizeof(BlockHeader) || offset + block->length > end) {
+            break;  // Torn tail
+        }
+        blocks_.push_back(offset);
+        offset += block->length;
+    }
+}
+
+// Unmap
+HistoryReader::~HistoryReader() {
+    if (base_) {
+        ::munmap(const_cast<char *>(base_), mapped_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+// Rows in a block
+std::size_t HistoryReader::block_rows(std::size_t block) const {
+    return reinterpret_cast<const BlockHeader *>(base_ + blocks_.at(block))->rows;
+}
+
+// Start of a column inside a block: columns follow each other, each padded to 8 bytes
+const void *HistoryReader::column_data(std::size_t block, std::size_t column, std::size_t width) const {
+    const std::uint8_t *widths = widths_of(kind());
+    if (column >= kMaxColumns || widths[column] != width) {
+        throw std::invalid_argument("History column type mismatch");
+    }
+    std::size_t rows = block_rows(block);
+    std::size_t offset = blocks_[block] + sizeof(BlockHeader);
+    for (std::size_t c = 0; c < column; ++c) {
+        offset += align8(rows * widths[c]);
+    }
+    return base_ + offset;
+}
@@ -0,0 +1,123 @@
+#ifndef HISTORY_STORE_HPP
+#define HISTORY_STORE_HPP
+
+#include <cstddef>  // Sizes and offsets
+#include <cstdint>  // On-disk field widths
+#include <string>  // File paths
+#include <vector>  // Row batches and the block index
+
+enum class HistoryKind : std::uint8_t { Trades, Candles };  // What a history file holds
+
+enum class TradeColumn : std::uint8_t { Timestamp, Sequence, Price, Amount, IndexPrice, MarkPrice, Direction };  // Trades file columns
+enum class CandleColumn : std::uint8_t { Tick, Open, High, Low, Close, Volume, Cost };  // Candles file columns
+
+// Trades from public/get_last_trades_by_instrument_and_time, one vector per column
+struct TradeRows {
+    std::vector<std::int64_t> timestamp;  // Exchange time (ms)
+    std::vector<std::int64_t> sequence;  // trade_seq, increasing per instrument
+    std::vector<double> price;  // Trade price
+    std::vector<double> amount;  // Trade amount
+    std::vector<double> index_price;  // Underlying index at the trade
+    std::vector<double> mark_price;  // Mark price at the trade
+    std::vector<std::int8_t> direction;  // 1 buy, -1 sell (taker side)
+
+    std::size_t size() const { return timestamp.size(); }
+    void clear();  // Drop every row
+};
+
+// Candles from public/get_tradingview_chart_data, one vector per column
+struct CandleRows {
+    std::vector<std::int64_t> tick;  // Candle open time (ms)
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<double> volume;  // Amount traded
+    std::vector<double> cost;  // Quote currency traded
+
+    std::size_t size() const { return tick.size(); }
+    void clear();  // Drop every row
+};
+
+// Columnar history file: a 64-byte header followed by append-only blocks. Each block is a 32-byte block
+// header and then every column of its rows stored contiguously, each column padded to 8 bytes, so a
+// mapped file is read as plain arrays. The header's write_offset marks the end of the last complete
+// block; a block cut short by a crash is ignored and overwritten by the next append.
+struct HistoryHeader {
+    char magic[8];  // "GTXHIST1"
+    std::uint32_t version;  // Format version
+    std::uint32_t header_size;  // Offset of the first block
+    std::uint8_t kind;  // HistoryKind
+    std::uint8_t columns;  // Columns per block
+    std::uint8_t reserved[6];
+    std::uint64_t write_offset;  // End of the last complete block
+    std::uint64_t row_count;  // Rows in every block
+    std::uint64_t block_count;  // Blocks written
+    std::int64_t last_timestamp;  // Timestamp (or tick) of the newest row, resume point of a refresh
+    std::int64_t last_sequence;  // trade_seq of the newest trade; 0 for candles
+};
+
+// Appends row batches to a history file as blocks. Single writer.
+class HistoryWriter {
+public:
+    HistoryWriter(const std::string &path, HistoryKind kind);  // Create, or reopen and append; throws on a kind mismatch
+    ~HistoryWriter();  // Close
+    HistoryWriter(const HistoryWriter &) = delete;
+    HistoryWriter &operator=(const HistoryWriter &) = delete;
+
+    void append(const TradeRows &rows);  // One block; rows must be newer than last_timestamp()
+    void append(const CandleRows &rows);  // One block; rows must be newer than last_timestamp()
+    void sync();  // fdatasync the file
+
+    std::uint64_t rows() const { return header_.row_count; }  // Rows in the file
+    std::int64_t last_timestamp() const { return header_.last_timestamp; }  // Newest row, 0 when empty
+    std::int64_t last_sequence() const { return header_.last_sequence; }  // Newest trade_seq, 0 when empty
+
+private:
+    void write_block(std::size_t rows, std::int64_t first, std::int64_t last, std::int64_t sequence,
+                     const void *const *columns);  // Block, then header
+
+    int fd_ = -1;  // History file
+    HistoryHeader header_{};  // In-memory copy, written after each block
+    std::vector<char> block_;  // Reused block buffer
+    std::string path_;  // For error messages
+};
+
+// Maps a history file read-only and exposes each block's columns as arrays
+class HistoryReader {
+public:
+    explicit HistoryReader(const std::string &path);  // Map the file and index its blocks
+    ~HistoryReader();  // Unmap
+    HistoryReader(const HistoryReader &) = delete;
+    HistoryReader &operator=(const HistoryReader &) = delete;
+
+    HistoryKind kind() const { return static_cast<HistoryKind>(header().kind); }  // Trades or candles
+    std::uint64_t rows() const { return header().row_count; }  // Rows in every block
+    std::size_t blocks() const { return blocks_.size(); }  // Complete blocks
+    std::size_t block_rows(std::size_t block) const;  // Rows in a block
+    std::int64_t last_timestamp() const { return header().last_timestamp; }  // Newest row
+
+    // Column of a block; T must match the column's type (int64_t, double, or int8_t for Direction)
+    template <typename T>
+    const T *column(std::size_t block, TradeColumn column) const {
+        return static_cast<const T *>(column_data(block, static_cast<std::size_t>(column), sizeof(T)));
+    }
+    template <typename T>
+    const T *column(std::size_t block, CandleColumn column) const {
+        return static_cast<const T *>(column_data(block, static_cast<std::size_t>(column), sizeof(T)));
+    }
+
+private:
+    const HistoryHeader &header() const { return *reinterpret_cast<const HistoryHeader *>(base_); }
+    const void *column_data(std::size_t block, std::size_t column, std::size_t width) const;  // Throws on a type mismatch
+
+    int fd_ = -1;  // History file
+    const char *base_ = nullptr;  // Mapped file
+    std::size_t mapped_ = 0;  // Mapped length
+    std::vector<std::size_t> blocks_;  // Offset of each block
+};
+
+std::string history_file_name(const std::string &instrument, HistoryKind kind,
+                              const std::string &resolution = std::string());  // e.g. BTC-PERPETUAL.trades.gtxh
+
+#endif
@@ -0,0 +1,51 @@
+#include "ImbalanceStrategy.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include "AsyncLogger.hpp"
+
+// Store the parameters
+ImbalanceStrategy::ImbalanceStrategy(ImbalanceConfig config) : config_(std::move(config)) {}
+
+// Pre-render the buy and sell templates so the first order formats only its numbers
+void ImbalanceStrategy::on_start(OrderGateway *orders, const MarketAnalytics *) {
+    orders_ = orders;
+    if (orders_) {
+        orders_->warm(OrderSide::Buy, config_.instrument, "limit");
+        orders_->warm(OrderSide::Sell, config_.instrument, "limit");
+    }
+}
+
+// Trade when the best bid and ask sizes are lopsided past the threshold
+void ImbalanceStrategy::on_book(const MarketEvent &event, const OrderBook *book) {
+    if (!orders_ || !book || sent_ >= config_.max_orders || event.symbol_view() != config_.instrument) {
+        return;
+    }
+    if (!event.book.last_fragment || event.exchange_ts - last_order_ts_ < config_.cooldown_ms) {
+        return;  // Wait for the whole update, and do not fire on every tick
+    }
+    PriceLevel bid, ask;
+    if (!book->top_of_book(bid, ask) || bid.amount + ask.amount <= 0.0) {
+        return;
+    }
+    double imbalance = (bid.amount - ask.amount) / (bid.amount + ask.amount);
+    if (std::fabs(imbalance) < config_.threshold) {
+        return;
+    }
+    if (imbalance > 0) {
+        orders_->buy(config_.instrument, "limit", config_.amount, ask.price);  // Bids are heavier: lift the offer
+    } else {
+        orders_->sell(config_.instrument, "limit", config_.amount, bid.price);  // Offers are heavier: hit the bid
+    }
+    ++sent_;
+    last_order_ts_ = event.exchange_ts;
+}
+
+// Report each acknowledgement or order notification through the async logger
+void ImbalanceStrategy::on_order_update(const OrderUpdate &update) {
+    char line[192];
+    std::snprintf(line, sizeof(line), "[strategy] request %d order %s %s filled %g/%g @ %g rtt_us=%lld%s",
+                  update.request_id, update.order_id, update.state, update.filled_amount, update.amount, update.price,
+                  static_cast<long long>(update.round_trip_ns / 1000), update.ok ? "" : " (rejected)");
+    AsyncLogger::instance().log(line);
+}
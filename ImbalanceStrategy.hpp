@@ -0,0 +1,37 @@
+#ifndef IMBALANCE_STRATEGY_HPP
+#define IMBALANCE_STRATEGY_HPP
+
+#include <cstdint>  // Timestamps
+#include <string>  // Instrument
+#include "Strategy.hpp"  // Callback interface
+#include "OrderGateway.hpp"  // Inline order entry
+
+struct ImbalanceConfig {
+    std::string instrument = "BTC-PERPETUAL";  // Book to watch and trade
+    int amount = 10;  // Order size (USD contracts for perpetuals)
+    double threshold = 0.8;  // |bid - ask| / (bid + ask) of the top-of-book sizes that triggers an order
+    int max_orders = 10;  // Stop after this many orders
+    std::int64_t cooldown_ms = 1000;  // Minimum exchange time between orders
+};
+
+// Sample strategy: when the top of the book is lopsided enough, cross the spread in the direction of the
+// heavier side with a limit order at the opposite best price. Illustrates the callback flow and gives a
+// tick-to-trade figure; it is not meant to make money.
+class ImbalanceStrategy : public Strategy {
+public:
+    explicit ImbalanceStrategy(ImbalanceConfig config);
+
+    void on_start(OrderGateway *orders, const MarketAnalytics *analytics) override;  // Keep the gateway and pre-render both order templates
+    void on_book(const MarketEvent &event, const OrderBook *book) override;  // Check the imbalance, maybe trade
+    void on_order_update(const OrderUpdate &update) override;  // Log acknowledgements and fills
+
+    int orders_sent() const { return sent_; }  // Orders sent so far
+
+private:
+    ImbalanceConfig config_;  // Parameters
+    OrderGateway *orders_ = nullptr;  // Order entry, owned by the caller
+    int sent_ = 0;  // Orders sent
+    std::int64_t last_order_ts_ = 0;  // Exchange time (ms) of the event that triggered the last order
+};
+
+#endif
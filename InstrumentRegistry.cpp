@@ -0,0 +1,321 @@
+#include "InstrumentRegistry.hpp"
+#include "JsonFields.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+constexpr double kTolerance = 1e-6;  // Relative slack for floating-point multiples
+
+// True when value is a whole multiple of step, within rounding
+bool is_multiple(double value, double step) {
+    double steps = value / step;
+    return std::fabs(steps - std::round(steps)) <= kTolerance * std::max(1.0, std::fabs(steps));
+}
+
+InstrumentKind parse_kind(std::string_view kind) {
+    if (kind == "future") return InstrumentKind::Future;
+    if (kind == "option") return InstrumentKind::Option;
+    if (kind == "spot") return InstrumentKind::Spot;
+    if (kind == "future_combo") return InstrumentKind::FutureCombo;
+    if (kind == "option_combo") return InstrumentKind::OptionCombo;
+    return InstrumentKind::Unknown;
+}
+
+const char* kind_name(InstrumentKind kind) {
+    switch (kind) {
+    case InstrumentKind::Future: return "future";
+    case InstrumentKind::Option: return "option";
+    case InstrumentKind::Spot: return "spot";
+    case InstrumentKind::FutureCombo: return "future_combo";
+    case InstrumentKind::OptionCombo: return "option_combo";
+    default: return "unknown";
+    }
+}
+
+// Deribit instrument object -> spec
+InstrumentSpec parse_spec(const json::object& instrument) {
+    InstrumentSpec spec{};
+    spec.kind = parse_kind(string_or_empty(instrument, "kind"));
+    std::string_view option_type = string_or_empty(instrument, "option_type");
+    spec.option_type = option_type == "call" ? OptionType::Call : option_type == "put" ? OptionType::Put : OptionType::None;
+    const auto* active = instrument.if_contains("is_active");
+    spec.active = !active || !active->is_bool() || active->as_bool();
+    copy_symbol(spec.base_currency, string_or_empty(instrument, "base_currency"));
+    copy_symbol(spec.quote_currency, string_or_empty(instrument, "quote_currency"));
+    copy_symbol(spec.settlement_currency, string_or_empty(instrument, "settlement_currency"));
+    spec.tick_size = number_or(instrument, "tick_size");
+    spec.contract_size = number_or(instrument, "contract_size");
+    spec.min_trade_amount = number_or(instrument, "min_trade_amount");
+    spec.strike = number_or(instrument, "strike");
+    spec.expiration_ms = static_cast<std::int64_t>(number_or(instrument, "expiration_timestamp"));
+    const auto* steps = instrument.if_contains("tick_size_steps");
+    if (steps && steps->is_array()) {
+        for (const auto& step : steps->as_array()) {
+            if (!step.is_object() || spec.tick_steps == 4) {
+                continue;
+            }
+            spec.step_above[spec.tick_steps] = number_or(step.as_object(), "above_price");
+            spec.step_tick[spec.tick_steps] = number_or(step.as_object(), "tick_size");
+            ++spec.tick_steps;
+        }
+    }
+    return spec;
+}
+
+// Spec -> Deribit-shaped instrument object, so the snapshot is read back with parse_spec
+json::object spec_json(std::string_view name, const InstrumentSpec& spec) {
+    json::array steps;
+    for (std::uint8_t i = 0; i < spec.tick_steps; ++i) {
+        steps.push_back(json::object{{"above_price", spec.step_above[i]}, {"tick_size", spec.step_tick[i]}});
+    }
+    json::object instrument{
+        {"instrument_name", name},
+        {"kind", kind_name(spec.kind)},
+        {"is_active", spec.active},
+        {"base_currency", spec.base_currency},
+        {"quote_currency", spec.quote_currency},
+        {"settlement_currency", spec.settlement_currency},
+        {"tick_size", spec.tick_size},
+        {"tick_size_steps", steps},
+        {"contract_size", spec.contract_size},
+        {"min_trade_amount", spec.min_trade_amount},
+        {"expiration_timestamp", spec.expiration_ms}
+    };
+    if (spec.kind == InstrumentKind::Option) {
+        instrument["strike"] = spec.strike;
+        instrument["option_type"] = spec.option_type == OptionType::Call ? "call" : "put";
+    }
+    return instrument;
+}
+
+}  // namespace
+
+// Human-readable reason for a local rejection
+const char* describe(OrderCheck check) {
+    switch (check) {
+    case OrderCheck::Ok: return "ok";
+    case OrderCheck::UnknownInstrument: return "unknown instrument";
+    case OrderCheck::Inactive: return "instrument is not active";
+    case OrderCheck::Expired: return "instrument has expired";
+    case OrderCheck::BadAmount: return "amount must be positive";
+    case OrderCheck::AmountTooSmall: return "amount is below the minimum trade amount";
+    case OrderCheck::AmountNotMultiple: return "amount is not a multiple of the minimum trade amount";
+    case OrderCheck::BadPrice: return "price must be positive";
+    case OrderCheck::PriceNotOnTick: return "price is not a multiple of the tick size";
+    }
+    return "invalid order";
+}
+
+// The shared registry
+InstrumentRegistry& InstrumentRegistry::instance() {
+    static InstrumentRegistry registry;
+    return registry;
+}
+
+// Storage of an id, without locking
+InstrumentRegistry::Entry* InstrumentRegistry::entry(InstrumentId id) const {
+    if (id == kNoInstrument || id > count_.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    std::size_t index = id - 1;
+    Entry* chunk = chunks_[index / kChunkSize].load(std::memory_order_acquire);
+    return chunk ? &chunk[index % kChunkSize] : nullptr;
+}
+
+// Id of name, assigned on first use
+InstrumentId InstrumentRegistry::intern(std::string_view name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return intern_locked(name);
+}
+
+// Look up or append; the name is written before count_ publishes the id
+InstrumentId InstrumentRegistry::intern_locked(std::string_view name) {
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    std::uint32_t index = count_.load(std::memory_order_relaxed);
+    if (index == kMaxInstruments - 1 || name.empty()) {
+        return kNoInstrument;
+    }
+    std::size_t chunk = index / kChunkSize;
+    if (!owned_chunks_[chunk]) {
+        owned_chunks_[chunk].reset(new Entry[kChunkSize]);
+        chunks_[chunk].store(owned_chunks_[chunk].get(), std::memory_order_release);
+    }
+    copy_symbol(owned_chunks_[chunk][index % kChunkSize].name, name);
+    InstrumentId id = index + 1;
+    ids_.emplace(std::string(name), id);
+    count_.store(id, std::memory_order_release);
+    return id;
+}
+
+// Id of name, or kNoInstrument
+InstrumentId InstrumentRegistry::find(std::string_view name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    return it == ids_.end() ? kNoInstrument : it->second;
+}
+
+// Interned name of an id
+std::string_view InstrumentRegistry::name(InstrumentId id) const {
+    const Entry* slot = entry(id);
+    return slot ? std::string_view(slot->name) : std::string_view();
+}
+
+// Write a spec so lock-free readers never see half of it
+void InstrumentRegistry::store_spec(Entry& slot, const InstrumentSpec& spec) {
+    std::uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.spec = spec;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    slot.has_spec.store(true, std::memory_order_release);
+}
+
+// Consistent copy of an id's reference data
+bool InstrumentRegistry::spec(InstrumentId id, InstrumentSpec& out) const {
+    const Entry* slot = entry(id);
+    if (!slot || !slot->has_spec.load(std::memory_order_acquire)) {
+        return false;
+    }
+    std::uint32_t before, after;
+    do {
+        before = slot->sequence.load(std::memory_order_acquire);
+        out = slot->spec;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot->sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return true;
+}
+
+// Validate by name (takes the name lock; hot paths keep the id and call the overload)
+OrderCheck InstrumentRegistry::check_order(std::string_view instrument, std::string_view type, double amount,
+                                           double price) const {
+    return check_order(find(instrument), type, amount, price);
+}
+
+// Validate amount and price against the instrument's reference data
+OrderCheck InstrumentRegistry::check_order(InstrumentId id, std::string_view type, double amount, double price) const {
+    if (!std::isfinite(amount) || amount <= 0.0) {
+        return OrderCheck::BadAmount;
+    }
+    InstrumentSpec limits;
+    if (!spec(id, limits)) {
+        return downloaded() ? OrderCheck::UnknownInstrument : OrderCheck::Ok;
+    }
+    if (!limits.active) {
+        return OrderCheck::Inactive;
+    }
+    std::int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (limits.expiration_ms > 0 && limits.expiration_ms < now_ms) {
+        return OrderCheck::Expired;
+    }
+    if (limits.min_trade_amount > 0.0) {
+        if (amount < limits.min_trade_amount * (1.0 - kTolerance)) {
+            return OrderCheck::AmountTooSmall;
+        }
+        if (!is_multiple(amount, limits.min_trade_amount)) {
+            return OrderCheck::AmountNotMultiple;
+        }
+    }
+    if (type.find("limit") == std::string_view::npos) {
+        return OrderCheck::Ok;  // market and stop_market orders carry no price to check
+    }
+    bool combo = limits.kind == InstrumentKind::FutureCombo || limits.kind == InstrumentKind::OptionCombo;
+    if (!std::isfinite(price) || (price <= 0.0 && !combo)) {
+        return OrderCheck::BadPrice;  // Combo spreads may trade at zero or below
+    }
+    double tick = limits.tick_size;
+    for (std::uint8_t i = 0; i < limits.tick_steps; ++i) {
+        if (std::fabs(price) > limits.step_above[i]) {
+            tick = limits.step_tick[i];
+        }
+    }
+    if (tick > 0.0 && !is_multiple(price, tick)) {
+        return OrderCheck::PriceNotOnTick;
+    }
+    return OrderCheck::Ok;
+}
+
+// Intern and store every instrument object; a download also marks the registry authoritative and
+// rewrites the snapshot
+std::size_t InstrumentRegistry::apply_instruments(const json::value& instruments, bool from_exchange) {
+    if (!instruments.is_array()) {
+        return 0;
+    }
+    std::size_t applied = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& instrument : instruments.as_array()) {
+            if (!instrument.is_object()) {
+                continue;
+            }
+            InstrumentId id = intern_locked(string_or_empty(instrument.as_object(), "instrument_name"));
+            if (Entry* slot = entry(id)) {
+                store_spec(*slot, parse_spec(instrument.as_object()));
+                ++applied;
+            }
+        }
+    }
+    if (from_exchange && applied > 0) {
+        downloaded_.store(true, std::memory_order_release);
+        save_snapshot();
+    }
+    return applied;
+}
+
+// Load the previous run's reference data so orders are validated before the download completes
+void InstrumentRegistry::set_snapshot_file(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        snapshot_file_ = path;
+    }
+    std::ifstream in(path);
+    if (!in) {
+        return;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    boost::system::error_code ec;
+    json::value snapshot = json::parse(contents.str(), ec);
+    if (!ec && snapshot.is_object() && snapshot.as_object().contains("instruments")) {
+        apply_instruments(snapshot.as_object().at("instruments"), false);
+    }
+}
+
+// Rewrite the snapshot atomically
+void InstrumentRegistry::save_snapshot() {
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        path = snapshot_file_;
+    }
+    if (path.empty()) {
+        return;
+    }
+    json::array instruments;
+    for (InstrumentId id = 1; id <= size(); ++id) {
+        InstrumentSpec stored;
+        if (spec(id, stored)) {
+            instruments.push_back(spec_json(name(id), stored));
+        }
+    }
+    std::int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::trunc);
+        if (!out) {
+            return;
+        }
+        out << json::serialize(json::object{{"saved_at", now_ms}, {"instruments", instruments}});
+    }
+    std::rename(temporary.c_str(), path.c_str());
+}
@@ -0,0 +1,99 @@
+#ifndef INSTRUMENT_REGISTRY_HPP
+#define INSTRUMENT_REGISTRY_HPP
+
+#include <boost/json.hpp>  // get_instruments results and the snapshot file
+#include <array>  // Chunk directory
+#include <atomic>  // Lock-free id lookups and spec sequence locks
+#include <cstdint>  // Ids and timestamps
+#include <map>  // Name -> id without allocating a key
+#include <memory>  // Chunk storage
+#include <mutex>  // Interning and loading
+#include <string>  // Names and paths
+#include <string_view>  // Lookups
+#include "MarketEvents.hpp"  // kSymbolSize
+
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+using InstrumentId = std::uint32_t;  // Dense id of an interned name; 0 means none
+constexpr InstrumentId kNoInstrument = 0;  // Zero-initialized events carry no id
+constexpr std::size_t kMaxInstruments = 1 << 16;  // Ids ever handed out in one process
+
+enum class InstrumentKind : std::uint8_t { Unknown, Future, Option, Spot, FutureCombo, OptionCombo };  // Deribit "kind"
+enum class OptionType : std::uint8_t { None, Call, Put };  // Deribit "option_type"
+
+// Reference data of one instrument from public/get_instruments
+struct InstrumentSpec {
+    InstrumentKind kind;  // future, option, spot, ...
+    OptionType option_type;  // Options only
+    bool active;  // is_active
+    char base_currency[8];  // e.g. BTC
+    char quote_currency[8];  // e.g. USD
+    char settlement_currency[8];  // e.g. BTC
+    double tick_size;  // Price increment below the first step
+    double contract_size;  // Amount of one contract
+    double min_trade_amount;  // Smallest amount, and the amount increment
+    double strike;  // Options only
+    std::int64_t expiration_ms;  // Expiry (far future for perpetuals)
+    std::uint8_t tick_steps;  // Valid entries in step_above/step_tick
+    double step_above[4];  // tick_size_steps, ascending: above this price...
+    double step_tick[4];  // ...this tick applies
+};
+
+enum class OrderCheck : std::uint8_t { Ok, UnknownInstrument, Inactive, Expired, BadAmount, AmountTooSmall,
+                                       AmountNotMultiple, BadPrice, PriceNotOnTick };  // Local pre-trade validation
+
+const char* describe(OrderCheck check);  // Human-readable reason
+
+// Process-wide instrument reference cache. Names are interned into dense ids (1, 2, ...) that never
+// change during the process, so hot paths index arrays instead of hashing strings; name() and spec()
+// by id take no lock. Reference data comes from public/get_instruments (apply_instruments) and is
+// persisted to a snapshot file so the next start can validate orders before the download finishes.
+class InstrumentRegistry {
+public:
+    static InstrumentRegistry& instance();  // The shared registry
+    InstrumentRegistry(const InstrumentRegistry&) = delete;
+    InstrumentRegistry& operator=(const InstrumentRegistry&) = delete;
+
+    InstrumentId intern(std::string_view name);  // Id of name, assigned on first use; kNoInstrument when full
+    InstrumentId find(std::string_view name) const;  // Id of name, or kNoInstrument if never interned
+    std::string_view name(InstrumentId id) const;  // Lock-free; empty for unknown ids
+    bool spec(InstrumentId id, InstrumentSpec& out) const;  // Lock-free consistent copy; false without reference data
+    std::size_t size() const { return count_.load(std::memory_order_acquire); }  // Ids handed out
+
+    // Validate an order locally: amount must be a positive multiple of min_trade_amount and a limit
+    // price must sit on the instrument's tick (tick_size_steps included). Instruments without reference
+    // data pass until a download has completed; after that an unknown name is rejected.
+    OrderCheck check_order(std::string_view instrument, std::string_view type, double amount, double price) const;
+    OrderCheck check_order(InstrumentId id, std::string_view type, double amount, double price) const;
+
+    std::size_t apply_instruments(const json::value& instruments, bool from_exchange);  // Array of instrument objects; returns count applied
+    void set_snapshot_file(const std::string& path);  // Load the snapshot at path (if any) and save there after downloads
+    void save_snapshot();  // Write every instrument with reference data to the snapshot file
+    bool downloaded() const { return downloaded_.load(std::memory_order_acquire); }  // A get_instruments answer has been applied
+
+private:
+    InstrumentRegistry() = default;
+
+    static constexpr std::size_t kChunkSize = 1024;  // Entries per lazily allocated chunk
+
+    struct Entry {
+        char name[kSymbolSize];  // Interned name, final before the id is published
+        std::atomic<std::uint32_t> sequence{0};  // Odd while spec is written
+        std::atomic<bool> has_spec{false};  // spec holds reference data
+        InstrumentSpec spec{};  // Latest reference data
+    };
+
+    Entry* entry(InstrumentId id) const;  // Null for ids not handed out
+    InstrumentId intern_locked(std::string_view name);  // intern() with mutex_ held
+    void store_spec(Entry& entry, const InstrumentSpec& spec);  // Sequence-locked write
+
+    mutable std::mutex mutex_;  // Guards ids_ and chunk allocation
+    std::map<std::string, InstrumentId, std::less<>> ids_;  // Name -> id
+    std::array<std::atomic<Entry*>, kMaxInstruments / kChunkSize> chunks_{};  // Entry storage, id - 1 indexed
+    std::array<std::unique_ptr<Entry[]>, kMaxInstruments / kChunkSize> owned_chunks_;  // Owners of chunks_
+    std::atomic<std::uint32_t> count_{0};  // Ids handed out
+    std::atomic<bool> downloaded_{false};  // Set by apply_instruments(..., true)
+    std::string snapshot_file_;  // Empty when not persisted
+};
+
+#endif
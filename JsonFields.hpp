@@ -0,0 +1,25 @@
+#ifndef JSON_FIELDS_HPP
+#define JSON_FIELDS_HPP
+
+#include <boost/json.hpp>  // Objects being read
+#include <string_view>  // Keys and string fields
+
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+// Numeric field (integer or double) of a JSON object; fallback when absent, null or not a number
+inline double number_or(const json::object& obj, std::string_view key, double fallback = 0.0) {
+    const auto* field = obj.if_contains(key);
+    return (field && field->is_number()) ? field->to_number<double>() : fallback;
+}
+
+// String field of a JSON object without copying; empty when absent or not a string. Valid while obj is.
+inline std::string_view string_or_empty(const json::object& obj, std::string_view key) {
+    const auto* field = obj.if_contains(key);
+    if (!field || !field->is_string()) {
+        return std::string_view();
+    }
+    const auto& text = field->as_string();
+    return std::string_view(text.data(), text.size());
+}
+
+#endif
@@ -0,0 +1,165 @@
+#include "LatencyStats.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+// Ratio of nanoseconds to ticks, measured on first use
+double TscClock::ns_per_tick() {
+    static const double ratio = calibrate();
+    return ratio;
+}
+
+// Count ticks over a short steady_clock interval
+double TscClock::calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+    auto wall_start = std::chrono::steady_clock::now();
+    std::uint64_t tick_start = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    auto wall_end = std::chrono::steady_clock::now();
+    std::uint64_t tick_end = now();
+    double elapsed_ns = std::chrono::duration<double, std::nano>(wall_end - wall_start).count();
+    return tick_end > tick_start ? elapsed_ns / static_cast<double>(tick_end - tick_start) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+// Small values map one-to-one; larger ones keep their top kSubBucketBits+1 bits
+std::size_t LatencyHistogram::bucket_index(std::uint64_t ns) {
+    if (ns < 2 * kSubBuckets) {
+        return static_cast<std::size_t>(ns);
+    }
+    unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(ns));
+    if (msb > kMaxExponent) {
+        return kBucketCount - 1;
+    }
+    unsigned shift = msb - kSubBucketBits;
+    return (shift + 1) * kSubBuckets + static_cast<std::size_t>((ns >> shift) - kSubBuckets);
+}
+
+// Highest value that falls into a bucket
+std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index) {
+    if (index < 2 * kSubBuckets) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>(index / kSubBuckets) - 1;
+    std::uint64_t sub = index % kSubBuckets + kSubBuckets;
+    return ((sub + 1) << shift) - 1;
+}
+
+// Add one sample
+void LatencyHistogram::record(std::uint64_t ns) {
+    buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+    std::uint64_t current = max_.load(std::memory_order_relaxed);
+    while (ns > current && !max_.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {
+    }
+}
+
+// Average sample
+double LatencyHistogram::mean() const {
+    std::uint64_t n = count();
+    return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+// Walk buckets until the requested fraction of samples is covered
+std::uint64_t LatencyHistogram::percentile(double p) const {
+    std::uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+    auto target = static_cast<std::uint64_t>(p / 100.0 * total + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(bucket_upper_bound(i), max());
+        }
+    }
+    return max();
+}
+
+// Drop all samples
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+// The shared registry
+LatencyRegistry& LatencyRegistry::instance() {
+    static LatencyRegistry registry;
+    return registry;
+}
+
+// Stop the dump thread before the histograms go away
+LatencyRegistry::~LatencyRegistry() {
+    stop_periodic_dump();
+}
+
+// Existing or new histogram; the reference stays valid for the life of the process
+LatencyHistogram& LatencyRegistry::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) {
+        slot = std::make_unique<LatencyHistogram>();
+    }
+    return *slot;
+}
+
+// Table of count / p50 / p99 / p99.9 / max in microseconds
+void LatencyRegistry::report(std::ostream& os) {
+    auto us = [](std::uint64_t ns) { return ns / 1000.0; };
+    std::lock_guard<std::mutex> lock(mutex_);
+    os << std::left << std::setw(24) << "operation" << std::right << std::setw(10) << "count"
+       << std::setw(12) << "p50 us" << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us"
+       << std::setw(12) << "max us" << "\n";
+    os << std::fixed << std::setprecision(1);
+    for (const auto& [name, histogram] : histograms_) {
+        if (histogram->count() == 0) {
+            continue;
+        }
+        os << std::left << std::setw(24) << name << std::right << std::setw(10) << histogram->count()
+           << std::setw(12) << us(histogram->percentile(50.0)) << std::setw(12) << us(histogram->percentile(99.0))
+           << std::setw(12) << us(histogram->percentile(99.9)) << std::setw(12) << us(histogram->max()) << "\n";
+    }
+    os << std::defaultfloat;
+}
+
+// Append a timestamped report to path every interval
+void LatencyRegistry::start_periodic_dump(const std::string& path, std::chrono::seconds interval) {
+    stop_periodic_dump();
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    dump_running_ = true;
+    dump_thread_ = std::thread([this, path, interval]() {
+        std::unique_lock<std::mutex> lock(dump_mutex_);
+        while (!dump_cv_.wait_for(lock, interval, [this] { return !dump_running_; })) {
+            std::ofstream out(path, std::ios::app);
+            std::time_t now = std::time(nullptr);
+            out << "# " << std::put_time(std::localtime(&now), "%F %T") << "\n";
+            report(out);
+            out << "\n";
+        }
+    });
+}
+
+// Stop and join the dump thread
+void LatencyRegistry::stop_periodic_dump() {
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex_);
+        dump_running_ = false;
+    }
+    dump_cv_.notify_all();
+    if (dump_thread_.joinable()) {
+        dump_thread_.join();
+    }
+}
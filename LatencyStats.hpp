@@ -0,0 +1,100 @@
+#ifndef LATENCY_STATS_HPP
+#define LATENCY_STATS_HPP
+
+#include <array>  // Bucket storage
+#include <atomic>  // Lock-free recording
+#include <chrono>  // Calibration and dump interval
+#include <condition_variable>  // Stopping the dump thread
+#include <cstdint>  // Tick and nanosecond values
+#include <map>  // Named histograms
+#include <memory>  // Stable histogram addresses
+#include <mutex>  // Registry creation and dump thread control
+#include <ostream>  // Reports
+#include <string>  // Histogram names
+#include <thread>  // Periodic dump
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  // __rdtsc
+#endif
+
+// Cheap monotonic timestamps: the TSC on x86, steady_clock elsewhere. Converted to nanoseconds with a
+// ratio measured once against steady_clock, so only the reporting side pays for the conversion.
+class TscClock {
+public:
+    static std::uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    static std::uint64_t to_ns(std::uint64_t ticks) { return static_cast<std::uint64_t>(ticks * ns_per_tick()); }  // Tick delta -> ns
+    static double ns_per_tick();  // Calibrated once on first use
+
+private:
+    static double calibrate();  // Measure ticks against steady_clock
+};
+
+// HDR-style log-linear histogram of nanosecond values: 32 sub-buckets per power of two (~3% precision)
+// from 1 ns to ~2.4 hours. Recording is a couple of relaxed atomic adds, safe from any thread.
+class LatencyHistogram {
+public:
+    void record(std::uint64_t ns);  // Add one sample
+    void record_ticks(std::uint64_t start_ticks) { record(TscClock::to_ns(TscClock::now() - start_ticks)); }  // Sample from a TscClock start
+    std::uint64_t count() const { return count_.load(std::memory_order_relaxed); }  // Samples recorded
+    std::uint64_t max() const { return max_.load(std::memory_order_relaxed); }  // Largest sample
+    double mean() const;  // Average sample
+    std::uint64_t percentile(double p) const;  // Upper bound of the bucket holding the p-th percentile (0-100)
+    void reset();  // Drop all samples
+
+private:
+    static constexpr unsigned kSubBucketBits = 5;  // 32 sub-buckets per octave
+    static constexpr unsigned kSubBuckets = 1u << kSubBucketBits;
+    static constexpr unsigned kMaxExponent = 43;  // Values up to 2^43 ns
+    static constexpr std::size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBuckets + 2 * kSubBuckets;
+
+    static std::size_t bucket_index(std::uint64_t ns);  // Value -> bucket
+    static std::uint64_t bucket_upper_bound(std::size_t index);  // Bucket -> highest value it holds
+
+    std::array<std::atomic<std::uint64_t>, kBucketCount> buckets_{};  // Sample counts
+    std::atomic<std::uint64_t> count_{0};  // Total samples
+    std::atomic<std::uint64_t> sum_{0};  // Sum of samples for the mean
+    std::atomic<std::uint64_t> max_{0};  // Largest sample
+};
+
+// Measures the lifetime of a scope into a histogram
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram& histogram) : histogram_(histogram), start_(TscClock::now()) {}
+    ~ScopedLatency() { histogram_.record_ticks(start_); }
+
+private:
+    LatencyHistogram& histogram_;  // Destination
+    std::uint64_t start_;  // TscClock at construction
+};
+
+// Process-wide set of named histograms, e.g. "op.buy" or "client.wire_wait". Look a histogram up once
+// and keep the reference; lookups lock, recording does not.
+class LatencyRegistry {
+public:
+    static LatencyRegistry& instance();  // The shared registry
+    ~LatencyRegistry();  // Stops the dump thread
+
+    LatencyHistogram& histogram(const std::string& name);  // Existing or new histogram
+    void report(std::ostream& os);  // Table of count / p50 / p99 / p99.9 / max in microseconds
+    void start_periodic_dump(const std::string& path, std::chrono::seconds interval);  // Append a report to path every interval
+    void stop_periodic_dump();  // Stop and join the dump thread
+
+private:
+    LatencyRegistry() = default;
+
+    std::mutex mutex_;  // Guards histograms_
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;  // Sorted so reports group by prefix
+    std::mutex dump_mutex_;  // Guards the dump thread state
+    std::condition_variable dump_cv_;  // Wakes the dump thread for shutdown
+    std::thread dump_thread_;  // Periodic writer
+    bool dump_running_ = false;  // Dump thread should keep going
+};
+
+#endif
@@ -0,0 +1,293 @@
+#include "MarketAnalytics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "SpscRing.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define GOTRADEX_AVX2_KERNELS 1
+#endif
+
+constexpr double kMsPerYear = 365.0 * 24 * 3600 * 1000;  // Annualization of realized variance
+
+#ifdef GOTRADEX_AVX2_KERNELS
+// Sum of n doubles, eight per iteration in two AVX2 accumulators
+__attribute__((target("avx2"))) static double sum_avx2(const double *values, std::size_t n) {
+    __m256d low = _mm256_setzero_pd();
+    __m256d high = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        low = _mm256_add_pd(low, _mm256_loadu_pd(values + i));
+        high = _mm256_add_pd(high, _mm256_loadu_pd(values + i + 4));
+    }
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(low, high));
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        total += values[i];
+    }
+    return total;
+}
+#endif
+
+// Sum of n doubles with four independent accumulators, which compilers vectorize with the baseline ISA
+static double sum_scalar(const double *values, std::size_t n) {
+    double lanes[4] = {0.0, 0.0, 0.0, 0.0};
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        lanes[0] += values[i];
+        lanes[1] += values[i + 1];
+        lanes[2] += values[i + 2];
+        lanes[3] += values[i + 3];
+    }
+    double total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        total += values[i];
+    }
+    return total;
+}
+
+// Window recompute kernel, chosen once for the running CPU
+static double vector_sum(const double *values, std::size_t n) {
+#ifdef GOTRADEX_AVX2_KERNELS
+    static const auto kernel = __builtin_cpu_supports("avx2") ? sum_avx2 : sum_scalar;
+#else
+    static const auto kernel = sum_scalar;
+#endif
+    return kernel(values, n);
+}
+
+// Sum of count ring entries starting at head: at most two contiguous runs
+static double ring_sum(const std::vector<double> &values, std::size_t head, std::size_t count) {
+    std::size_t first = std::min(count, values.size() - head);
+    return vector_sum(values.data() + head, first) + vector_sum(values.data(), count - first);
+}
+
+// Allocate both windows up front so updates never allocate
+InstrumentAnalytics::InstrumentAnalytics(const AnalyticsConfig &config)
+    : config_(config),
+      trade_ts_(config.max_trades),
+      trade_notional_(config.max_trades),
+      trade_amount_(config.max_trades),
+      trade_signed_(config.max_trades),
+      return_sq_(config.max_returns),
+      return_ms_(config.max_returns) {
+    auto power_of_two = [](std::size_t n) { return n >= 2 && (n & (n - 1)) == 0; };
+    if (!power_of_two(config.max_trades) || !power_of_two(config.max_returns)) {
+        throw std::invalid_argument("Analytics window sizes must be powers of two");
+    }
+}
+
+// Route a decoded event to the trade window or the quote metrics
+void InstrumentAnalytics::on_event(const MarketEvent &event, const OrderBook *book) {
+    switch (event.type) {
+    case EventType::Trade:
+        add_trade(event.exchange_ts, event.trade.price, event.trade.amount, event.trade.buy);
+        break;
+    case EventType::Book: {
+        if (!event.book.last_fragment || !book) {
+            return;  // Sample whole updates only
+        }
+        quotes_from_book_ = true;
+        PriceLevel bid, ask;
+        if (book->top_of_book(bid, ask)) {
+            update_quote(event.exchange_ts, bid.price, bid.amount, ask.price, ask.amount);
+        }
+        break;
+    }
+    case EventType::Ticker:
+        if (!quotes_from_book_) {
+            const TickerEvent &ticker = event.ticker;
+            update_quote(event.exchange_ts, ticker.best_bid_price, ticker.best_bid_amount, ticker.best_ask_price,
+                         ticker.best_ask_amount);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Push a trade into the window, evicting by age and by count
+void InstrumentAnalytics::add_trade(std::int64_t timestamp, double price, double amount, bool buy) {
+    expire_trades(timestamp);
+    if (trade_count_ == trade_ts_.size()) {
+        drop_oldest_trade();
+    }
+    std::size_t slot = (trade_head_ + trade_count_) & (trade_ts_.size() - 1);
+    trade_ts_[slot] = timestamp;
+    trade_notional_[slot] = price * amount;
+    trade_amount_[slot] = amount;
+    trade_signed_[slot] = buy ? amount : -amount;
+    sum_notional_ += trade_notional_[slot];
+    sum_amount_ += amount;
+    sum_signed_ += trade_signed_[slot];
+    ++trade_count_;
+    if (++trade_updates_ >= config_.recompute_every) {
+        recompute_trades();
+    }
+    current_.timestamp = std::max(current_.timestamp, timestamp);
+    publish();
+}
+
+// New top of book: spread, mid and microprice now, and a mid sample for volatility when one is due
+void InstrumentAnalytics::update_quote(std::int64_t timestamp, double bid, double bid_amount, double ask,
+                                       double ask_amount) {
+    expire_trades(timestamp);
+    if (bid <= 0.0 || ask <= 0.0 || ask < bid) {
+        return;  // One side missing or the book is momentarily crossed
+    }
+    current_.best_bid = bid;
+    current_.best_ask = ask;
+    current_.spread = ask - bid;
+    current_.mid = (bid + ask) / 2;
+    double resting = bid_amount + ask_amount;
+    current_.microprice = resting > 0.0 ? (bid * ask_amount + ask * bid_amount) / resting : current_.mid;
+
+    if (sampled_mid_ <= 0.0) {
+        sampled_mid_ = current_.mid;
+        sampled_ts_ = timestamp;
+    } else if (timestamp - sampled_ts_ >= config_.sample_ms) {
+        add_return(std::log(current_.mid / sampled_mid_), timestamp - sampled_ts_);
+        sampled_mid_ = current_.mid;
+        sampled_ts_ = timestamp;
+    }
+    current_.timestamp = std::max(current_.timestamp, timestamp);
+    publish();
+}
+
+// Evict trades that fell out of the time window
+void InstrumentAnalytics::expire_trades(std::int64_t now) {
+    while (trade_count_ > 0 && now - trade_ts_[trade_head_] > config_.window_ms) {
+        drop_oldest_trade();
+    }
+}
+
+// Remove the oldest trade from the window sums
+void InstrumentAnalytics::drop_oldest_trade() {
+    sum_notional_ -= trade_notional_[trade_head_];
+    sum_amount_ -= trade_amount_[trade_head_];
+    sum_signed_ -= trade_signed_[trade_head_];
+    trade_head_ = (trade_head_ + 1) & (trade_ts_.size() - 1);
+    if (--trade_count_ == 0) {
+        sum_notional_ = sum_amount_ = sum_signed_ = 0.0;  // An empty window has exactly zero sums
+    }
+    ++trade_updates_;
+}
+
+// Push one mid return, dropping the oldest when the window is full
+void InstrumentAnalytics::add_return(double log_return, std::int64_t elapsed_ms) {
+    std::size_t mask = return_sq_.size() - 1;
+    if (return_count_ == return_sq_.size()) {
+        sum_sq_ -= return_sq_[return_head_];
+        sum_ms_ -= return_ms_[return_head_];
+        return_head_ = (return_head_ + 1) & mask;
+        --return_count_;
+    }
+    std::size_t slot = (return_head_ + return_count_) & mask;
+    return_sq_[slot] = log_return * log_return;
+    return_ms_[slot] = static_cast<double>(elapsed_ms);
+    sum_sq_ += return_sq_[slot];
+    sum_ms_ += return_ms_[slot];
+    ++return_count_;
+    if (++return_updates_ >= config_.recompute_every) {
+        recompute_returns();
+    }
+}
+
+// Rebuild the trade sums from the window
+void InstrumentAnalytics::recompute_trades() {
+    sum_notional_ = ring_sum(trade_notional_, trade_head_, trade_count_);
+    sum_amount_ = ring_sum(trade_amount_, trade_head_, trade_count_);
+    sum_signed_ = ring_sum(trade_signed_, trade_head_, trade_count_);
+    trade_updates_ = 0;
+}
+
+// Rebuild the return sums from the window
+void InstrumentAnalytics::recompute_returns() {
+    sum_sq_ = ring_sum(return_sq_, return_head_, return_count_);
+    sum_ms_ = ring_sum(return_ms_, return_head_, return_count_);
+    return_updates_ = 0;
+}
+
+// Derive the window fields and copy current_ out under the sequence lock
+void InstrumentAnalytics::publish() {
+    current_.trades = static_cast<std::uint32_t>(trade_count_);
+    current_.volume = sum_amount_;
+    current_.vwap = sum_amount_ > 0.0 ? sum_notional_ / sum_amount_ : 0.0;
+    current_.trade_imbalance = sum_amount_ > 0.0 ? std::clamp(sum_signed_ / sum_amount_, -1.0, 1.0) : 0.0;
+    current_.returns = static_cast<std::uint32_t>(return_count_);
+    current_.realized_vol = sum_ms_ > 0.0 ? 100.0 * std::sqrt(std::max(0.0, sum_sq_) / sum_ms_ * kMsPerYear) : 0.0;
+
+    std::uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    published_ = current_;
+    sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+// Consistent copy of the published snapshot
+AnalyticsSnapshot InstrumentAnalytics::read() const {
+    AnalyticsSnapshot copy;
+    std::uint32_t before, after;
+    do {
+        before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            cpu_relax();
+            continue;
+        }
+        copy = published_;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence_.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return copy;
+}
+
+// Keep the configuration for instruments created later
+MarketAnalytics::MarketAnalytics(AnalyticsConfig config) : config_(config) {}
+
+// Analytics for instrument, created empty on first use
+InstrumentAnalytics &MarketAnalytics::get_or_create(std::string_view instrument) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = analytics_.find(instrument);
+    if (it == analytics_.end()) {
+        it = analytics_.emplace(std::string(instrument), std::make_unique<InstrumentAnalytics>(config_)).first;
+    }
+    return *it->second;
+}
+
+// Analytics for instrument, or nullptr if never seen
+const InstrumentAnalytics *MarketAnalytics::find(std::string_view instrument) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = analytics_.find(instrument);
+    return it == analytics_.end() ? nullptr : it->second.get();
+}
+
+// Published snapshot of instrument; false if it has never been seen
+bool MarketAnalytics::snapshot(std::string_view instrument, AnalyticsSnapshot &out) const {
+    const InstrumentAnalytics *analytics = find(instrument);
+    if (!analytics) {
+        return false;
+    }
+    out = analytics->read();
+    return true;
+}
+
+// Names of every instrument seen so far, sorted
+std::vector<std::string> MarketAnalytics::instruments() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> names;
+    names.reserve(analytics_.size());
+    for (const auto &entry : analytics_) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+// Look the instrument up and apply the event
+void MarketAnalytics::on_event(const MarketEvent &event, const OrderBook *book) {
+    if (event.type == EventType::Trade || event.type == EventType::Book || event.type == EventType::Ticker) {
+        get_or_create(event.symbol_view()).on_event(event, book);
+    }
+}
@@ -0,0 +1,108 @@
+#ifndef MARKET_ANALYTICS_HPP
+#define MARKET_ANALYTICS_HPP
+
+#include <atomic>  // Snapshot sequence lock
+#include <cstddef>  // Window sizes
+#include <cstdint>  // Timestamps
+#include <map>  // Instrument -> analytics lookup without allocating a key
+#include <memory>  // Stable analytics addresses inside the registry
+#include <mutex>  // Protects the instrument map
+#include <string>  // Instrument names
+#include <string_view>  // Heterogeneous lookups
+#include <vector>  // Window storage
+#include "MarketEvents.hpp"  // Decoded trades, books and tickers
+#include "OrderBook.hpp"  // Top of book for quote-driven metrics
+
+struct AnalyticsConfig {
+    std::int64_t window_ms = 60000;  // Trades older than this (exchange time) leave the VWAP and imbalance window
+    std::size_t max_trades = 4096;  // Count bound of the trade window; power of two
+    std::size_t max_returns = 512;  // Mid-price returns kept for realized volatility; power of two
+    std::int64_t sample_ms = 1000;  // Minimum exchange time between two mid samples
+    std::uint32_t recompute_every = 4096;  // Window updates between full recomputes that shed rounding drift
+};
+
+// Point-in-time analytics of one instrument
+struct AnalyticsSnapshot {
+    std::int64_t timestamp;  // Exchange time (ms) of the last trade or quote applied
+    double vwap;  // Volume-weighted trade price over the window, 0 without trades
+    double volume;  // Traded amount over the window
+    std::uint32_t trades;  // Trades in the window
+    double trade_imbalance;  // (buy - sell) / (buy + sell) aggressor volume over the window, in [-1, 1]
+    double best_bid;  // Last quote
+    double best_ask;  // Last quote
+    double spread;  // best_ask - best_bid
+    double mid;  // (best_bid + best_ask) / 2
+    double microprice;  // Size-weighted mid: leans towards the side with less resting size
+    double realized_vol;  // Annualized volatility of the sampled mid (percent, like the ticker IVs)
+    std::uint32_t returns;  // Mid returns behind realized_vol
+};
+
+// Rolling analytics of one instrument. Every update is O(1): window sums are adjusted as samples
+// enter and leave, and every recompute_every updates they are rebuilt from the window with the
+// vectorized kernels so rounding error cannot accumulate. One writer thread; read() is safe from any.
+class InstrumentAnalytics {
+public:
+    explicit InstrumentAnalytics(const AnalyticsConfig &config);
+
+    // Apply a decoded event (writer thread). Trades feed the trade window; the last fragment of a book
+    // update samples the top of book; tickers are used for quotes only while no book has been seen.
+    void on_event(const MarketEvent &event, const OrderBook *book);
+    void add_trade(std::int64_t timestamp, double price, double amount, bool buy);  // Writer thread
+    void update_quote(std::int64_t timestamp, double bid, double bid_amount, double ask, double ask_amount);  // Writer thread
+    const AnalyticsSnapshot &current() const { return current_; }  // Writer thread only, no copy
+    AnalyticsSnapshot read() const;  // Consistent copy of the last published snapshot, any thread
+
+private:
+    void expire_trades(std::int64_t now);  // Drop trades older than the window
+    void drop_oldest_trade();  // Take the oldest trade out of the window sums
+    void add_return(double log_return, std::int64_t elapsed_ms);  // Push one mid return
+    void recompute_trades();  // Rebuild the trade sums from the window
+    void recompute_returns();  // Rebuild the return sums from the window
+    void publish();  // Derive the trade and volatility fields and publish current_
+
+    AnalyticsConfig config_;  // Window parameters
+
+    // Trade window, structure of arrays so the recompute kernels stream contiguous doubles
+    std::vector<std::int64_t> trade_ts_;  // Exchange time of each trade
+    std::vector<double> trade_notional_;  // price * amount
+    std::vector<double> trade_amount_;  // amount
+    std::vector<double> trade_signed_;  // +amount for buys, -amount for sells
+    std::size_t trade_head_ = 0;  // Oldest trade
+    std::size_t trade_count_ = 0;  // Trades in the window
+    double sum_notional_ = 0.0, sum_amount_ = 0.0, sum_signed_ = 0.0;  // Window sums
+    std::uint32_t trade_updates_ = 0;  // Since the last recompute
+
+    // Mid-return window for realized volatility
+    std::vector<double> return_sq_;  // Squared log return
+    std::vector<double> return_ms_;  // Exchange time the return spans
+    std::size_t return_head_ = 0;  // Oldest return
+    std::size_t return_count_ = 0;  // Returns in the window
+    double sum_sq_ = 0.0, sum_ms_ = 0.0;  // Window sums
+    std::uint32_t return_updates_ = 0;  // Since the last recompute
+    double sampled_mid_ = 0.0;  // Mid at the last sample
+    std::int64_t sampled_ts_ = 0;  // Exchange time of the last sample
+    bool quotes_from_book_ = false;  // A book update has been seen; ignore ticker quotes from then on
+
+    AnalyticsSnapshot current_{};  // Writer's copy
+    std::atomic<std::uint32_t> sequence_{0};  // Odd while published_ is being written
+    AnalyticsSnapshot published_{};  // Reader copy
+};
+
+// Owns one InstrumentAnalytics per instrument, created on first sight
+class MarketAnalytics {
+public:
+    explicit MarketAnalytics(AnalyticsConfig config = AnalyticsConfig());
+
+    InstrumentAnalytics &get_or_create(std::string_view instrument);  // Writer thread; keep the reference, it stays valid
+    const InstrumentAnalytics *find(std::string_view instrument) const;  // Analytics for instrument, or nullptr if never seen
+    bool snapshot(std::string_view instrument, AnalyticsSnapshot &out) const;  // Any thread; false if never seen
+    std::vector<std::string> instruments() const;  // Every instrument seen so far
+    void on_event(const MarketEvent &event, const OrderBook *book);  // Look up (or create) the instrument and apply the event
+
+private:
+    AnalyticsConfig config_;  // Passed to every new instrument
+    mutable std::mutex mutex_;  // Guards the map itself, not the analytics
+    std::map<std::string, std::unique_ptr<InstrumentAnalytics>, std::less<>> analytics_;  // Instrument -> analytics
+};
+
+#endif
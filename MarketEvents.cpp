@@ -0,0 +1,31 @@
+#include "MarketEvents.hpp"
+
+// Print a decoded event on one line
+std::ostream &operator<<(std::ostream &os, const MarketEvent &event) {
+    switch (event.type) {
+    case EventType::PriceIndex:
+        os << "[index] " << event.symbol << " price=" << event.index.price;
+        break;
+    case EventType::Book:
+        os << "[book] " << event.symbol << (event.book.snapshot ? " snapshot" : " delta")
+           << " change_id=" << event.book.change_id << " levels=" << event.book.count;
+        break;
+    case EventType::Trade:
+        os << "[trade] " << event.symbol << (event.trade.buy ? " buy " : " sell ")
+           << event.trade.amount << " @ " << event.trade.price;
+        break;
+    case EventType::Ticker:
+        os << "[ticker] " << event.symbol << " bid=" << event.ticker.best_bid_amount << " @ "
+           << event.ticker.best_bid_price << " ask=" << event.ticker.best_ask_amount << " @ "
+           << event.ticker.best_ask_price << " mark=" << event.ticker.mark_price;
+        break;
+    default:
+        os << "[unknown] " << event.symbol;
+        break;
+    }
+    os << " ts=" << event.exchange_ts;
+    if (event.exchange_latency_ns != 0) {
+        os << " latency_us=" << event.exchange_latency_ns / 1000;
+    }
+    return os;
+}
@@ -0,0 +1,98 @@
+#ifndef MARKET_EVENTS_HPP
+#define MARKET_EVENTS_HPP
+
+#include <cstddef>  // Sizes of fixed arrays
+#include <cstdint>  // Fixed-width ids and timestamps
+#include <cstring>  // Bounded symbol copies
+#include <ostream>  // Event printing
+#include <string_view>  // Symbol views
+
+constexpr std::size_t kSymbolSize = 48;  // Longest Deribit instrument/index name plus terminator, rounded up
+constexpr std::size_t kLevelsPerBookEvent = 16;  // Larger book updates are split into several events
+
+enum class BookSide : std::uint8_t { Bid, Ask };  // Side of the book a level belongs to
+enum class LevelAction : std::uint8_t { New, Change, Delete };  // Deribit level update verbs
+
+struct PriceLevel {
+    double price;  // Level price
+    double amount;  // Total amount resting at the price
+};
+
+struct LevelChange {
+    BookSide side;  // Which side the change applies to
+    LevelAction action;  // new / change / delete
+    double price;  // Level price
+    double amount;  // New amount (ignored for delete)
+};
+
+enum class EventType : std::uint8_t { None, PriceIndex, Book, Trade, Ticker };  // Decoded channel families
+
+struct PriceIndexEvent {
+    double price;  // Index value
+};
+
+// One fragment of a book.* update. Continuation fragments carry prev_change_id == change_id so
+// they chain onto the fragment before them; consumers that need whole updates wait for last_fragment.
+struct BookEvent {
+    std::int64_t change_id;  // Exchange change id of this update
+    std::int64_t prev_change_id;  // Change id this update follows
+    bool snapshot;  // First fragment of a full snapshot
+    bool last_fragment;  // No more fragments follow for this change_id
+    std::uint16_t count;  // Number of valid entries in levels
+    LevelChange levels[kLevelsPerBookEvent];  // Level changes, bids and asks mixed
+};
+
+struct TradeEvent {
+    double price;  // Trade price
+    double amount;  // Trade amount
+    double index_price;  // Index at the time of the trade
+    double mark_price;  // Mark at the time of the trade
+    std::int64_t trade_seq;  // Per-instrument trade sequence
+    bool buy;  // Aggressor side
+    char trade_id[24];  // Exchange trade id
+};
+
+struct TickerEvent {
+    double best_bid_price;  // Top of book bid
+    double best_bid_amount;  // Size at best bid
+    double best_ask_price;  // Top of book ask
+    double best_ask_amount;  // Size at best ask
+    double last_price;  // Last traded price
+    double mark_price;  // Exchange mark price
+    double index_price;  // Underlying index
+    double underlying_price;  // Forward/underlying used for option marks
+    double mark_iv;  // Option mark implied volatility (percent)
+    double bid_iv;  // Option bid implied volatility (percent)
+    double ask_iv;  // Option ask implied volatility (percent)
+    double open_interest;  // Open interest
+};
+
+// Fixed-size, trivially copyable event handed from the decoder to consumers.
+struct MarketEvent {
+    EventType type;  // Which member of the union is valid
+    std::uint32_t instrument_id;  // InstrumentRegistry id of symbol in this process; 0 when not interned (replays, other processes)
+    char symbol[kSymbolSize];  // Instrument name (book/trade/ticker) or index name (price index)
+    std::int64_t exchange_ts;  // Exchange timestamp in milliseconds
+    std::int64_t receive_ns;  // Local wall-clock receive time in nanoseconds
+    std::int64_t exchange_latency_ns;  // exchange_ts -> receive_ns on the local clock via ClockSync (ms-granular stamp); 0 if unknown
+    union {
+        PriceIndexEvent index;
+        BookEvent book;
+        TradeEvent trade;
+        TickerEvent ticker;
+    };
+
+    std::string_view symbol_view() const { return std::string_view(symbol); }  // Symbol without copying
+};
+
+// Copy a name into a fixed buffer, truncating if it does not fit
+template <std::size_t N>
+inline void copy_symbol(char (&dst)[N], std::string_view src) {
+    std::size_t n = src.size() < N - 1 ? src.size() : N - 1;
+    std::memcpy(dst, src.data(), n);
+    dst[n] = '\0';
+}
+
+std::ostream &operator<<(std::ostream &os, const MarketEvent &event);  // One-line human readable form
+
+#endif
@@ -0,0 +1,330 @@
+#include "MarketJournal.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'X', 'J', 'R', 'N', 'L', '1'};
+constexpr std::uint32_t kVersion = 1;
+constexpr std::size_t kMaxRecordSize = 1024;  // Upper bound of any encoded record
+
+struct RecordHeader {
+    std::uint32_t length;  // Whole record including padding
+    std::uint8_t type;  // EventType
+    std::uint8_t symbol_length;  // Symbol bytes following the header
+    std::uint16_t level_count;  // Book levels (book records only)
+    std::int64_t receive_ns;  // Local receive time
+    std::int64_t exchange_ts;  // Exchange timestamp (ms)
+};
+static_assert(sizeof(RecordHeader) == 24, "record header must stay 24 bytes");
+static_assert(sizeof(JournalHeader) == 64, "journal header must stay 64 bytes");
+
+constexpr std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+[[noreturn]] void throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+template <typename T>
+char *put(char *dst, const T &value) {
+    std::memcpy(dst, &value, sizeof(T));
+    return dst + sizeof(T);
+}
+
+template <typename T>
+const char *get(const char *src, T &value) {
+    std::memcpy(&value, src, sizeof(T));
+    return src + sizeof(T);
+}
+
+// Serialize one event; returns the aligned record length
+std::size_t encode_record(char *dst, const MarketEvent &event) {
+    RecordHeader header{};
+    header.type = static_cast<std::uint8_t>(event.type);
+    std::size_t symbol_length = std::strlen(event.symbol);
+    header.symbol_length = static_cast<std::uint8_t>(symbol_length);
+    header.receive_ns = event.receive_ns;
+    header.exchange_ts = event.exchange_ts;
+
+    char *cursor = dst + sizeof(RecordHeader);
+    std::memcpy(cursor, event.symbol, symbol_length);
+    cursor = dst + align8(sizeof(RecordHeader) + symbol_length);
+
+    switch (event.type) {
+    case EventType::PriceIndex:
+        cursor = put(cursor, event.index.price);
+        break;
+    case EventType::Book: {
+        const BookEvent &book = event.book;
+        header.level_count = book.count;
+        cursor = put(cursor, book.change_id);
+        cursor = put(cursor, book.prev_change_id);
+        std::uint8_t flags = (book.snapshot ? 1 : 0) | (book.last_fragment ? 2 : 0);
+        cursor = put(cursor, flags);
+        for (std::uint16_t i = 0; i < book.count; ++i) {  // Side and action packed into one byte per level
+            std::uint8_t code = static_cast<std::uint8_t>(static_cast<unsigned>(book.levels[i].side) << 2
+                                                          | static_cast<unsigned>(book.levels[i].action));
+            cursor = put(cursor, code);
+        }
+        cursor = dst + align8(static_cast<std::size_t>(cursor - dst));
+        for (std::uint16_t i = 0; i < book.count; ++i) {
+            cursor = put(cursor, book.levels[i].price);
+            cursor = put(cursor, book.levels[i].amount);
+        }
+        break;
+    }
+    case EventType::Trade: {
+        const TradeEvent &trade = event.trade;
+        cursor = put(cursor, trade.price);
+        cursor = put(cursor, trade.amount);
+        cursor = put(cursor, trade.index_price);
+        cursor = put(cursor, trade.mark_price);
+        cursor = put(cursor, trade.trade_seq);
+        cursor = put(cursor, static_cast<std::uint8_t>(trade.buy));
+        std::uint8_t id_length = static_cast<std::uint8_t>(std::strlen(trade.trade_id));
+        cursor = put(cursor, id_length);
+        std::memcpy(cursor, trade.trade_id, id_length);
+        cursor += id_length;
+        break;
+    }
+    case EventType::Ticker:
+        cursor = put(cursor, event.ticker);  // Twelve doubles, already compact
+        break;
+    default:
+        break;
+    }
+
+    header.length = static_cast<std::uint32_t>(align8(static_cast<std::size_t>(cursor - dst)));
+    std::memcpy(dst, &header, sizeof(header));
+    return header.length;
+}
+
+// Deserialize one record written by encode_record
+void decode_record(const char *src, MarketEvent &event) {
+    RecordHeader header;
+    std::memcpy(&header, src, sizeof(header));
+    event.type = static_cast<EventType>(header.type);
+    event.receive_ns = header.receive_ns;
+    event.exchange_ts = header.exchange_ts;
+    event.exchange_latency_ns = 0;  // Clock offset of the capture is not recorded
+    event.instrument_id = 0;  // Ids belong to the capturing process; the replayer interns its own
+    std::size_t symbol_length = std::min<std::size_t>(header.symbol_length, kSymbolSize - 1);
+    std::memcpy(event.symbol, src + sizeof(RecordHeader), symbol_length);
+    event.symbol[symbol_length] = '\0';
+    const char *cursor = src + align8(sizeof(RecordHeader) + header.symbol_length);
+
+    switch (event.type) {
+    case EventType::PriceIndex:
+        get(cursor, event.index.price);
+        break;
+    case EventType::Book: {
+        BookEvent &book = event.book;
+        book.count = std::min<std::uint16_t>(header.level_count, kLevelsPerBookEvent);
+        cursor = get(cursor, book.change_id);
+        cursor = get(cursor, book.prev_change_id);
+        std::uint8_t flags;
+        cursor = get(cursor, flags);
+        book.snapshot = flags & 1;
+        book.last_fragment = flags & 2;
+        for (std::uint16_t i = 0; i < header.level_count; ++i) {
+            std::uint8_t code;
+            cursor = get(cursor, code);
+            if (i < book.count) {
+                book.levels[i].side = static_cast<BookSide>(code >> 2);
+                book.levels[i].action = static_cast<LevelAction>(code & 3);
+            }
+        }
+        cursor = src + align8(static_cast<std::size_t>(cursor - src));
+        for (std::uint16_t i = 0; i < book.count; ++i) {
+            cursor = get(cursor, book.levels[i].price);
+            cursor = get(cursor, book.levels[i].amount);
+        }
+        break;
+    }
+    case EventType::Trade: {
+        TradeEvent &trade = event.trade;
+        cursor = get(cursor, trade.price);
+        cursor = get(cursor, trade.amount);
+        cursor = get(cursor, trade.index_price);
+        cursor = get(cursor, trade.mark_price);
+        cursor = get(cursor, trade.trade_seq);
+        std::uint8_t buy, id_length;
+        cursor = get(cursor, buy);
+        cursor = get(cursor, id_length);
+        trade.buy = buy != 0;
+        std::size_t copy = std::min<std::size_t>(id_length, sizeof(trade.trade_id) - 1);
+        std::memcpy(trade.trade_id, cursor, copy);
+        trade.trade_id[copy] = '\0';
+        break;
+    }
+    case EventType::Ticker:
+        get(cursor, event.ticker);
+        break;
+    default:
+        break;
+    }
+}
+
+}  // namespace
+
+// Create a new journal, or reopen an existing one and continue after its last record
+JournalWriter::JournalWriter(const std::string &path, std::size_t chunk_bytes)
+    : chunk_bytes_(chunk_bytes) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw_errno("Cannot open journal " + path);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        throw_errno("Cannot stat journal " + path);
+    }
+
+    if (st.st_size >= static_cast<off_t>(sizeof(JournalHeader))) {
+        map(static_cast<std::size_t>(st.st_size));
+        auto *header = reinterpret_cast<JournalHeader *>(base_);
+        if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+            throw std::runtime_error("Not a GoTradeX journal: " + path);
+        }
+    } else {
+        if (::ftruncate(fd_, static_cast<off_t>(chunk_bytes_)) != 0) {
+            throw_errno("Cannot size journal " + path);
+        }
+        map(chunk_bytes_);
+        auto *header = reinterpret_cast<JournalHeader *>(base_);
+        std::memset(header, 0, sizeof(JournalHeader));
+        std::memcpy(header->magic, kMagic, sizeof(kMagic));
+        header->version = kVersion;
+        header->header_size = sizeof(JournalHeader);
+        header->write_offset = sizeof(JournalHeader);
+    }
+}
+
+// Trim the file to the data written so the journal carries no trailing zero chunk
+JournalWriter::~JournalWriter() {
+    if (base_) {
+        std::uint64_t end = reinterpret_cast<JournalHeader *>(base_)->write_offset;
+        ::msync(base_, mapped_, MS_SYNC);
+        ::munmap(base_, mapped_);
+        if (::ftruncate(fd_, static_cast<off_t>(end)) != 0) {
+            // Leaving the preallocated tail is harmless; readers stop at write_offset
+        }
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+// (Re)map the whole file
+void JournalWriter::map(std::size_t size) {
+    if (base_) {
+        ::munmap(base_, mapped_);
+        base_ = nullptr;
+    }
+    void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED) {
+        throw_errno("Cannot map journal");
+    }
+    base_ = static_cast<char *>(address);
+    mapped_ = size;
+}
+
+// Grow by whole chunks when the next record might not fit
+void JournalWriter::ensure_capacity(std::size_t bytes) {
+    std::uint64_t end = reinterpret_cast<JournalHeader *>(base_)->write_offset;
+    if (end + bytes <= mapped_) {
+        return;
+    }
+    std::size_t new_size = mapped_ + chunk_bytes_;
+    if (::ftruncate(fd_, static_cast<off_t>(new_size)) != 0) {
+        throw_errno("Cannot grow journal");
+    }
+    map(new_size);
+}
+
+// Encode the event straight into the mapping and publish it by advancing write_offset
+void JournalWriter::append(const MarketEvent &event) {
+    ensure_capacity(kMaxRecordSize);
+    auto *header = reinterpret_cast<JournalHeader *>(base_);
+    std::size_t length = encode_record(base_ + header->write_offset, event);
+    header->write_offset += length;
+    ++header->record_count;
+}
+
+// Force the mapped data to disk
+void JournalWriter::flush() {
+    ::msync(base_, mapped_, MS_ASYNC);
+}
+
+// Records in the journal
+std::uint64_t JournalWriter::records() const {
+    return reinterpret_cast<const JournalHeader *>(base_)->record_count;
+}
+
+// Map an existing journal read-only
+JournalReader::JournalReader(const std::string &path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw_errno("Cannot open journal " + path);
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(JournalHeader))) {
+        throw std::runtime_error("Journal too short: " + path);
+    }
+    mapped_ = static_cast<std::size_t>(st.st_size);
+    void *address = ::mmap(nullptr, mapped_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (address == MAP_FAILED) {
+        throw_errno("Cannot map journal " + path);
+    }
+    base_ = static_cast<const char *>(address);
+    ::madvise(address, mapped_, MADV_SEQUENTIAL);
+
+    const auto *header = reinterpret_cast<const JournalHeader *>(base_);
+    if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) {
+        throw std::runtime_error("Not a GoTradeX journal: " + path);
+    }
+    end_ = std::min<std::size_t>(header->write_offset, mapped_);
+    rewind();
+}
+
+// Unmap
+JournalReader::~JournalReader() {
+    if (base_) {
+        ::munmap(const_cast<char *>(base_), mapped_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+// Decode the next record, false at the end
+bool JournalReader::next(MarketEvent &event) {
+    if (offset_ + sizeof(RecordHeader) > end_) {
+        return false;
+    }
+    std::uint32_t length;
+    std::memcpy(&length, base_ + offset_, sizeof(length));
+    if (length < sizeof(RecordHeader) || offset_ + length > end_) {
+        return false;  // Torn tail
+    }
+    decode_record(base_ + offset_, event);
+    offset_ += length;
+    return true;
+}
+
+// Start again from the first record
+void JournalReader::rewind() {
+    offset_ = reinterpret_cast<const JournalHeader *>(base_)->header_size;
+}
+
+// Records in the journal
+std::uint64_t JournalReader::records() const {
+    return reinterpret_cast<const JournalHeader *>(base_)->record_count;
+}
@@ -0,0 +1,63 @@
+#ifndef MARKET_JOURNAL_HPP
+#define MARKET_JOURNAL_HPP
+
+#include <cstddef>  // Sizes and offsets
+#include <cstdint>  // On-disk field widths
+#include <string>  // File paths
+#include "MarketEvents.hpp"  // Records are typed MarketEvents
+
+// Binary market-data journal: a 64-byte header followed by compact, 8-byte aligned typed records
+// (a 24-byte record header, the symbol, then a per-type payload). The header's write_offset marks the
+// end of valid data, so a journal cut short by a crash is readable up to its last complete record.
+struct JournalHeader {
+    char magic[8];  // "GTXJRNL1"
+    std::uint32_t version;  // Format version
+    std::uint32_t header_size;  // Offset of the first record
+    std::uint64_t write_offset;  // End of the last complete record
+    std::uint64_t record_count;  // Records written
+    std::uint8_t reserved[32];  // Pads the header to 64 bytes
+};
+
+// Appends events to a memory-mapped journal, growing the file in large chunks. Single writer.
+class JournalWriter {
+public:
+    explicit JournalWriter(const std::string &path, std::size_t chunk_bytes = 64u << 20);  // Create, or reopen and append
+    ~JournalWriter();  // Trim the file to the data written and unmap
+    JournalWriter(const JournalWriter &) = delete;
+    JournalWriter &operator=(const JournalWriter &) = delete;
+
+    void append(const MarketEvent &event);  // Write one record
+    void flush();  // msync the mapped range
+    std::uint64_t records() const;  // Records in the journal
+
+private:
+    void map(std::size_t size);  // (Re)map the file at the given size
+    void ensure_capacity(std::size_t bytes);  // Grow the file so another record fits
+
+    int fd_ = -1;  // Journal file
+    char *base_ = nullptr;  // Mapped file
+    std::size_t mapped_ = 0;  // Mapped length
+    std::size_t chunk_bytes_;  // Growth step
+};
+
+// Reads records back from a journal mapped read-only
+class JournalReader {
+public:
+    explicit JournalReader(const std::string &path);  // Map the journal
+    ~JournalReader();  // Unmap
+    JournalReader(const JournalReader &) = delete;
+    JournalReader &operator=(const JournalReader &) = delete;
+
+    bool next(MarketEvent &event);  // Decode the next record, false at the end
+    void rewind();  // Start again from the first record
+    std::uint64_t records() const;  // Records in the journal
+
+private:
+    int fd_ = -1;  // Journal file
+    const char *base_ = nullptr;  // Mapped file
+    std::size_t mapped_ = 0;  // Mapped length
+    std::size_t offset_ = 0;  // Next record
+    std::size_t end_ = 0;  // write_offset at open time
+};
+
+#endif
@@ -0,0 +1,515 @@
+#include "OptionChain.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <iomanip>
+#include <limits>
+#include <numeric>
+#include <tuple>
+#include "InstrumentRegistry.hpp"
+#include "AsyncLogger.hpp"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define GOTRADEX_AVX2_KERNELS 1
+#endif
+
+constexpr double kMsPerYear = 365.0 * 24 * 3600 * 1000;  // Deribit annualizes on calendar time
+constexpr double kInvSqrt2 = 0.70710678118654752440;
+constexpr double kInvSqrt2Pi = 0.39894228040143267794;
+constexpr double kMinYears = 1e-9;  // Floor on time to expiry (about 30 ms) so expiring rows stay finite
+constexpr double kMinStdDev = 1e-9;  // Floor on sigma * sqrt(T)
+constexpr double kMinVega = 1e-12;  // Floor on the Newton step's denominator
+constexpr double kMinVol = 0.01;  // Solver bounds (1% .. 1000%)
+constexpr double kMaxVol = 10.0;
+constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+// Row columns handed to a pricing kernel. iv is read as the solver's starting point and overwritten.
+struct ChainSpan {
+    const double *forward, *strike, *years, *sign, *vol, *target;
+    double *iv, *theo, *delta, *gamma, *vega, *theta;
+    std::size_t count;
+};
+
+// Standard normal distribution function
+static double norm_cdf(double x) {
+    return 0.5 * std::erfc(-x * kInvSqrt2);
+}
+
+// Reference kernel with the C library's exp, log and erfc: Black-76 on the forward with zero rates, prices
+// divided by the forward (Deribit quotes options in the underlying), Greeks on the USD price
+static void price_scalar(const ChainSpan &s, int iterations, double tolerance) {
+    for (std::size_t i = 0; i < s.count; ++i) {
+        double forward = s.forward[i], strike = s.strike[i], phi = s.sign[i], sigma = s.vol[i];
+        if (!(forward > 0.0) || !(strike > 0.0)) {
+            s.theo[i] = s.delta[i] = s.gamma[i] = s.vega[i] = s.theta[i] = s.iv[i] = kNaN;
+            continue;
+        }
+        double sqrt_t = std::sqrt(std::max(s.years[i], kMinYears));
+        double moneyness = strike / forward;
+        double log_fk = std::log(forward / strike);
+
+        double sd = std::max(sigma * sqrt_t, kMinStdDev);
+        double d1 = log_fk / sd + 0.5 * sd;
+        double d2 = d1 - sd;
+        double pdf = kInvSqrt2Pi * std::exp(-0.5 * d1 * d1);
+        double nd1 = norm_cdf(phi * d1);
+        double nd2 = norm_cdf(phi * d2);
+        s.theo[i] = phi * (nd1 - moneyness * nd2);
+        s.delta[i] = phi * nd1;
+        s.gamma[i] = pdf / (forward * sd);
+        s.vega[i] = forward * pdf * sqrt_t * 0.01;
+        s.theta[i] = -forward * pdf * sigma / (2.0 * sqrt_t) / 365.0;
+
+        double target = s.target[i];
+        double lower = std::max(0.0, phi * (1.0 - moneyness));
+        double upper = phi > 0.0 ? 1.0 : moneyness;
+        double guess = s.iv[i] > 0.0 ? s.iv[i] : (sigma > 0.0 ? sigma : 0.5);
+        double residual = std::numeric_limits<double>::infinity();
+        bool solvable = target > lower && target < upper && pdf * sqrt_t * 0.01 > tolerance;  // A vol point must move the price
+        for (int k = 0; solvable && k < iterations; ++k) {
+            double step_sd = std::max(guess * sqrt_t, kMinStdDev);
+            double step_d1 = log_fk / step_sd + 0.5 * step_sd;
+            double price = phi * (norm_cdf(phi * step_d1) - moneyness * norm_cdf(phi * (step_d1 - step_sd)));
+            residual = price - target;
+            if (std::fabs(residual) <= tolerance) {
+                break;  // Warm starts usually stop here on the first step
+            }
+            double vega = std::max(kInvSqrt2Pi * std::exp(-0.5 * step_d1 * step_d1) * sqrt_t, kMinVega);
+            guess = std::min(std::max(guess - residual / vega, kMinVol), kMaxVol);
+        }
+        s.iv[i] = solvable && std::fabs(residual) <= tolerance ? guess : kNaN;
+    }
+}
+
+#ifdef GOTRADEX_AVX2_KERNELS
+// exp of four doubles: x = k ln2 + r with |r| <= ln2 / 2, a degree-11 Taylor polynomial for e^r (error
+// below 1e-14) and 2^k assembled in the exponent bits. NaN passes through.
+__attribute__((target("avx2,fma"))) static inline __m256d exp_avx2(__m256d x) {
+    x = _mm256_max_pd(_mm256_set1_pd(-708.0), _mm256_min_pd(_mm256_set1_pd(708.0), x));
+    __m256d k = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(1.44269504088896340736)),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256d r = _mm256_fnmadd_pd(k, _mm256_set1_pd(6.93147180369123816490e-01), x);
+    r = _mm256_fnmadd_pd(k, _mm256_set1_pd(1.90821492927058770002e-10), r);
+    static constexpr double kTaylor[] = {1.0 / 3628800, 1.0 / 362880, 1.0 / 40320, 1.0 / 5040, 1.0 / 720,
+                                         1.0 / 120,     1.0 / 24,     1.0 / 6,     0.5,        1.0,  1.0};
+    __m256d p = _mm256_set1_pd(1.0 / 39916800);
+    for (double c : kTaylor) {
+        p = _mm256_fmadd_pd(p, r, _mm256_set1_pd(c));
+    }
+    __m256i k64 = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k));
+    __m256i scale = _mm256_slli_epi64(_mm256_add_epi64(k64, _mm256_set1_epi64x(1023)), 52);
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(scale));
+}
+
+// log of four positive normal doubles: x = 2^e m with m in [sqrt(1/2), sqrt(2)], and
+// log m = 2 atanh((m - 1) / (m + 1)) summed to the f^21 term
+__attribute__((target("avx2,fma"))) static inline __m256d log_avx2(__m256d x) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d two52 = _mm256_set1_pd(4503599627370496.0);
+    __m256i bits = _mm256_castpd_si256(x);
+    __m256d e = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_castpd_si256(two52)));
+    e = _mm256_sub_pd(e, _mm256_add_pd(two52, _mm256_set1_pd(1023.0)));
+    __m256d m = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)),
+                                                    _mm256_set1_epi64x(0x3FF0000000000000LL)));
+    __m256d big = _mm256_cmp_pd(m, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+    m = _mm256_blendv_pd(m, _mm256_mul_pd(m, _mm256_set1_pd(0.5)), big);
+    e = _mm256_add_pd(e, _mm256_and_pd(big, one));
+    __m256d f = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d f2 = _mm256_mul_pd(f, f);
+    __m256d series = _mm256_set1_pd(1.0 / 21);
+    for (int odd = 19; odd >= 1; odd -= 2) {
+        series = _mm256_fmadd_pd(series, f2, _mm256_set1_pd(1.0 / odd));
+    }
+    __m256d log_m = _mm256_mul_pd(_mm256_add_pd(f, f), series);
+    __m256d low = _mm256_fmadd_pd(e, _mm256_set1_pd(1.90821492927058770002e-10), log_m);
+    return _mm256_fmadd_pd(e, _mm256_set1_pd(6.93147180369123816490e-01), low);
+}
+
+// Normal distribution function of four doubles from the Chebyshev fit of erfc in Numerical Recipes
+// (relative error below 1.2e-7, a thousandth of Deribit's option tick)
+__attribute__((target("avx2,fma"))) static inline __m256d norm_cdf_avx2(__m256d x) {
+    static constexpr double kErfc[] = {-0.82215223, 1.48851587, -1.13520398, 0.27886807, -0.18628806,
+                                       0.09678418,  0.37409196, 1.00002368,  -1.26551223};
+    __m256d u = _mm256_mul_pd(x, _mm256_set1_pd(-kInvSqrt2));
+    __m256d z = _mm256_andnot_pd(_mm256_set1_pd(-0.0), u);
+    __m256d t = _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_fmadd_pd(z, _mm256_set1_pd(0.5), _mm256_set1_pd(1.0)));
+    __m256d poly = _mm256_set1_pd(0.17087277);
+    for (double c : kErfc) {
+        poly = _mm256_fmadd_pd(poly, t, _mm256_set1_pd(c));
+    }
+    __m256d erfc = _mm256_mul_pd(t, exp_avx2(_mm256_fnmadd_pd(z, z, poly)));
+    __m256d negative = _mm256_cmp_pd(u, _mm256_setzero_pd(), _CMP_LT_OQ);
+    erfc = _mm256_blendv_pd(erfc, _mm256_sub_pd(_mm256_set1_pd(2.0), erfc), negative);
+    return _mm256_mul_pd(erfc, _mm256_set1_pd(0.5));
+}
+
+// Four lanes of a column, or the first lanes through mask for the chain's tail
+__attribute__((target("avx2,fma"))) static inline __m256d load_lanes(const double *at, std::size_t lanes, __m256i mask) {
+    return lanes == 4 ? _mm256_loadu_pd(at) : _mm256_maskload_pd(at, mask);
+}
+
+// Store counterpart of load_lanes
+__attribute__((target("avx2,fma"))) static inline void store_lanes(double *at, std::size_t lanes, __m256i mask, __m256d value) {
+    if (lanes == 4) {
+        _mm256_storeu_pd(at, value);
+    } else {
+        _mm256_maskstore_pd(at, mask, value);
+    }
+}
+
+// Four rows of price_scalar; a short tail is loaded and stored through a lane mask
+__attribute__((target("avx2,fma"))) static void price_block_avx2(const ChainSpan &s, std::size_t i, std::size_t lanes,
+                                                                 int iterations, double tolerance) {
+    const __m256i mask = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(lanes)),
+                                            _mm256_setr_epi64x(0, 1, 2, 3));
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d half = _mm256_set1_pd(0.5);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d inv_sqrt_2pi = _mm256_set1_pd(kInvSqrt2Pi);
+    const __m256d min_sd = _mm256_set1_pd(kMinStdDev);
+
+    __m256d forward = load_lanes(s.forward + i, lanes, mask);
+    __m256d strike = load_lanes(s.strike + i, lanes, mask);
+    __m256d phi = load_lanes(s.sign + i, lanes, mask);
+    __m256d sigma = load_lanes(s.vol + i, lanes, mask);
+    __m256d valid = _mm256_and_pd(_mm256_cmp_pd(forward, zero, _CMP_GT_OQ), _mm256_cmp_pd(strike, zero, _CMP_GT_OQ));
+    forward = _mm256_blendv_pd(one, forward, valid);  // Keep the maths finite in empty lanes
+    strike = _mm256_blendv_pd(one, strike, valid);
+    __m256d sqrt_t = _mm256_sqrt_pd(_mm256_max_pd(_mm256_set1_pd(kMinYears), load_lanes(s.years + i, lanes, mask)));
+    __m256d inv_forward = _mm256_div_pd(one, forward);
+    __m256d moneyness = _mm256_mul_pd(strike, inv_forward);
+    __m256d log_fk = _mm256_sub_pd(zero, log_avx2(moneyness));
+
+    __m256d sd = _mm256_max_pd(min_sd, _mm256_mul_pd(sigma, sqrt_t));
+    __m256d inv_sd = _mm256_div_pd(one, sd);
+    __m256d d1 = _mm256_fmadd_pd(half, sd, _mm256_mul_pd(log_fk, inv_sd));
+    __m256d pdf = _mm256_mul_pd(inv_sqrt_2pi, exp_avx2(_mm256_mul_pd(_mm256_set1_pd(-0.5), _mm256_mul_pd(d1, d1))));
+    __m256d nd1 = norm_cdf_avx2(_mm256_mul_pd(phi, d1));
+    __m256d nd2 = norm_cdf_avx2(_mm256_mul_pd(phi, _mm256_sub_pd(d1, sd)));
+    __m256d nan = _mm256_set1_pd(kNaN);
+    __m256d theo = _mm256_mul_pd(phi, _mm256_fnmadd_pd(moneyness, nd2, nd1));
+    store_lanes(s.theo + i, lanes, mask, _mm256_blendv_pd(nan, theo, valid));
+    store_lanes(s.delta + i, lanes, mask, _mm256_blendv_pd(nan, _mm256_mul_pd(phi, nd1), valid));
+    store_lanes(s.gamma + i, lanes, mask, _mm256_blendv_pd(nan, _mm256_mul_pd(pdf, _mm256_mul_pd(inv_forward, inv_sd)), valid));
+    __m256d forward_pdf = _mm256_mul_pd(forward, pdf);
+    __m256d vega = _mm256_mul_pd(_mm256_mul_pd(forward_pdf, sqrt_t), _mm256_set1_pd(0.01));
+    store_lanes(s.vega + i, lanes, mask, _mm256_blendv_pd(nan, vega, valid));
+    __m256d theta = _mm256_div_pd(_mm256_mul_pd(forward_pdf, sigma), _mm256_mul_pd(sqrt_t, _mm256_set1_pd(-730.0)));
+    store_lanes(s.theta + i, lanes, mask, _mm256_blendv_pd(nan, theta, valid));
+
+    __m256d target = load_lanes(s.target + i, lanes, mask);
+    __m256d call = _mm256_cmp_pd(phi, zero, _CMP_GT_OQ);
+    __m256d lower = _mm256_max_pd(zero, _mm256_mul_pd(phi, _mm256_sub_pd(one, moneyness)));
+    __m256d upper = _mm256_blendv_pd(moneyness, one, call);
+    __m256d solvable = _mm256_and_pd(valid, _mm256_and_pd(_mm256_cmp_pd(target, lower, _CMP_GT_OQ),
+                                                          _mm256_cmp_pd(target, upper, _CMP_LT_OQ)));
+    __m256d point_vega = _mm256_mul_pd(_mm256_mul_pd(pdf, sqrt_t), _mm256_set1_pd(0.01));
+    solvable = _mm256_and_pd(solvable, _mm256_cmp_pd(point_vega, _mm256_set1_pd(tolerance), _CMP_GT_OQ));
+    __m256d previous = load_lanes(s.iv + i, lanes, mask);
+    __m256d fallback = _mm256_blendv_pd(half, sigma, _mm256_cmp_pd(sigma, zero, _CMP_GT_OQ));
+    __m256d guess = _mm256_blendv_pd(fallback, previous, _mm256_cmp_pd(previous, zero, _CMP_GT_OQ));
+    __m256d residual = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    const __m256d sign_bit = _mm256_set1_pd(-0.0);
+    const __m256d tol = _mm256_set1_pd(tolerance);
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    for (int k = 0; k < iterations; ++k) {
+        __m256d step_sd = _mm256_max_pd(min_sd, _mm256_mul_pd(guess, sqrt_t));
+        __m256d step_d1 = _mm256_fmadd_pd(half, step_sd, _mm256_div_pd(log_fk, step_sd));
+        __m256d n1 = norm_cdf_avx2(_mm256_mul_pd(phi, step_d1));
+        __m256d n2 = norm_cdf_avx2(_mm256_mul_pd(phi, _mm256_sub_pd(step_d1, step_sd)));
+        residual = _mm256_fmsub_pd(phi, _mm256_fnmadd_pd(moneyness, n2, n1), target);
+        __m256d within = _mm256_cmp_pd(_mm256_andnot_pd(sign_bit, residual), tol, _CMP_LE_OQ);
+        if (_mm256_movemask_pd(_mm256_or_pd(within, _mm256_andnot_pd(solvable, all_lanes))) == 0xF) {
+            break;  // Every lane has converged or has nothing to solve
+        }
+        __m256d density = exp_avx2(_mm256_mul_pd(_mm256_set1_pd(-0.5), _mm256_mul_pd(step_d1, step_d1)));
+        __m256d slope = _mm256_mul_pd(_mm256_mul_pd(inv_sqrt_2pi, density), sqrt_t);
+        guess = _mm256_sub_pd(guess, _mm256_div_pd(residual, _mm256_max_pd(_mm256_set1_pd(kMinVega), slope)));
+        guess = _mm256_max_pd(_mm256_set1_pd(kMinVol), _mm256_min_pd(_mm256_set1_pd(kMaxVol), guess));
+    }
+    __m256d converged = _mm256_cmp_pd(_mm256_andnot_pd(sign_bit, residual), tol, _CMP_LE_OQ);
+    store_lanes(s.iv + i, lanes, mask, _mm256_blendv_pd(nan, guess, _mm256_and_pd(solvable, converged)));
+}
+
+// The chain four rows at a time
+__attribute__((target("avx2,fma"))) static void price_avx2(const ChainSpan &s, int iterations, double tolerance) {
+    for (std::size_t i = 0; i < s.count; i += 4) {
+        price_block_avx2(s, i, std::min<std::size_t>(4, s.count - i), iterations, tolerance);
+    }
+}
+#endif
+
+// Pricing kernel for this CPU; the scalar reference when AVX2 and FMA are missing or not wanted
+static void run_kernel(const ChainSpan &span, int iterations, double tolerance, bool vectorized) {
+#ifdef GOTRADEX_AVX2_KERNELS
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    if (vectorized && avx2) {
+        price_avx2(span, iterations, tolerance);
+        return;
+    }
+#endif
+    (void)vectorized;
+    price_scalar(span, iterations, tolerance);
+}
+
+// Expiry, strike and type from a name such as BTC-27DEC24-40000-C or XRP_USDC-30MAY25-0d625-P
+bool parse_option_name(std::string_view instrument, std::int64_t &expiration_ms, double &strike, bool &call) {
+    std::size_t first = instrument.find('-');
+    std::size_t second = first == std::string_view::npos ? first : instrument.find('-', first + 1);
+    std::size_t third = second == std::string_view::npos ? second : instrument.find('-', second + 1);
+    if (third == std::string_view::npos || third + 2 != instrument.size()) {
+        return false;
+    }
+    char type = instrument.back();
+    if (type != 'C' && type != 'P') {
+        return false;
+    }
+    std::string date(instrument.substr(first + 1, second - first - 1));
+    static const char *kMonths[] = {"JAN", "FEB", "MAR", "APR", "MAY", "JUN", "JUL", "AUG", "SEP", "OCT", "NOV", "DEC"};
+    std::size_t digits = date.find_first_not_of("0123456789");
+    if (digits == 0 || digits == std::string::npos || date.size() != digits + 5) {
+        return false;
+    }
+    auto month = std::find_if(std::begin(kMonths), std::end(kMonths),
+                              [&](const char *name) { return date.compare(digits, 3, name) == 0; });
+    if (month == std::end(kMonths)) {
+        return false;
+    }
+    std::tm tm{};
+    tm.tm_mday = std::stoi(date.substr(0, digits));
+    tm.tm_mon = static_cast<int>(month - std::begin(kMonths));
+    tm.tm_year = 100 + std::stoi(date.substr(digits + 3));
+    tm.tm_hour = 8;  // Deribit options expire at 08:00 UTC
+    expiration_ms = static_cast<std::int64_t>(timegm(&tm)) * 1000;
+
+    std::string strike_text(instrument.substr(second + 1, third - second - 1));
+    std::replace(strike_text.begin(), strike_text.end(), 'd', '.');
+    char *end = nullptr;
+    strike = std::strtod(strike_text.c_str(), &end);
+    call = type == 'C';
+    return end && *end == '\0' && strike > 0.0;
+}
+
+OptionChain::OptionChain(OptionChainConfig config) : config_(std::move(config)) {}
+
+// Add a row for an option of the configured currency. Strike, expiry and type come from the registry's
+// reference data when it has them, otherwise from the name.
+bool OptionChain::add_option(std::string_view instrument) {
+    if (instrument.substr(0, instrument.find('-')) != config_.currency) {
+        return false;
+    }
+    std::int64_t expiration_ms;
+    double strike;
+    bool call;
+    if (!parse_option_name(instrument, expiration_ms, strike, call)) {
+        return false;
+    }
+    InstrumentId id = InstrumentRegistry::instance().intern(instrument);
+    InstrumentSpec spec;
+    if (InstrumentRegistry::instance().spec(id, spec) && spec.kind == InstrumentKind::Option) {
+        expiration_ms = spec.expiration_ms;
+        strike = spec.strike;
+        call = spec.option_type == OptionType::Call;
+    }
+    if (id == kNoInstrument || (id < row_of_id_.size() && row_of_id_[id] >= 0)) {
+        return false;
+    }
+    if (id >= row_of_id_.size()) {
+        row_of_id_.resize(id + 1, -1);
+    }
+    row_of_id_[id] = static_cast<std::int32_t>(names_.size());
+    names_.emplace_back(instrument);
+    expiration_ms_.push_back(expiration_ms);
+    expiry_.push_back(static_cast<std::uint32_t>(expiry_slot(expiration_ms)));
+    strike_.push_back(strike);
+    sign_.push_back(call ? 1.0 : -1.0);
+    forward_.push_back(0.0);
+    years_.push_back(0.0);
+    vol_.push_back(kNaN);
+    target_.push_back(kNaN);
+    iv_.push_back(kNaN);
+    for (auto *column : {&theo_, &delta_, &gamma_, &vega_, &theta_}) {
+        column->push_back(kNaN);
+    }
+    return true;
+}
+
+// Every option of the currency in a public/get_instruments result
+std::size_t OptionChain::add_options(const json::value &instruments) {
+    std::size_t added = 0;
+    if (!instruments.is_array()) {
+        return added;
+    }
+    for (const auto &instrument : instruments.as_array()) {
+        const auto *name = instrument.is_object() ? instrument.as_object().if_contains("instrument_name") : nullptr;
+        if (name && name->is_string() && add_option(std::string_view(name->as_string().data(), name->as_string().size()))) {
+            ++added;
+        }
+    }
+    return added;
+}
+
+// Basis slot shared by the options of one expiry
+std::size_t OptionChain::expiry_slot(std::int64_t expiration_ms) {
+    auto it = std::find(expiries_.begin(), expiries_.end(), expiration_ms);
+    if (it != expiries_.end()) {
+        return static_cast<std::size_t>(it - expiries_.begin());
+    }
+    expiries_.push_back(expiration_ms);
+    basis_.push_back(0.0);
+    return expiries_.size() - 1;
+}
+
+// Index channel plus one 100 ms ticker per option
+FeedConfig OptionChain::feed_config() const {
+    FeedConfig feed;
+    feed.instruments = names_;
+    feed.channel_templates = {"ticker.{}.100ms"};
+    feed.channels = {"deribit_price_index." + config_.index_name};
+    return feed;
+}
+
+// Row of an instrument
+bool OptionChain::find(std::string_view instrument, std::size_t &row) const {
+    InstrumentId id = InstrumentRegistry::instance().find(instrument);
+    if (id == kNoInstrument || id >= row_of_id_.size() || row_of_id_[id] < 0) {
+        return false;
+    }
+    row = static_cast<std::size_t>(row_of_id_[id]);
+    return true;
+}
+
+// Mark volatility, quoted mid and the expiry's basis from a ticker; the row is repriced against the
+// current index right away, the rest of its expiry on the next index update
+void OptionChain::on_ticker(const MarketEvent &event) {
+    InstrumentId id = event.instrument_id;
+    std::size_t row;
+    if (id != kNoInstrument && id < row_of_id_.size() && row_of_id_[id] >= 0) {
+        row = static_cast<std::size_t>(row_of_id_[id]);
+    } else if (!find(event.symbol_view(), row)) {
+        return;
+    }
+    ScopedLatency timer(row_latency_);
+    const TickerEvent &ticker = event.ticker;
+    vol_[row] = ticker.mark_iv / 100.0;
+    bool quoted = ticker.best_bid_price > 0.0 && ticker.best_ask_price >= ticker.best_bid_price;
+    target_[row] = quoted ? (ticker.best_bid_price + ticker.best_ask_price) / 2 : kNaN;
+    if (ticker.underlying_price > 0.0 && ticker.index_price > 0.0) {
+        basis_[expiry_[row]] = ticker.underlying_price - ticker.index_price;
+    }
+    if (index_ <= 0.0 && ticker.index_price > 0.0) {
+        index_ = ticker.index_price;  // Until the first index update
+    }
+    forward_[row] = index_ + basis_[expiry_[row]];
+    years_[row] = std::max<std::int64_t>(0, expiration_ms_[row] - event.exchange_ts) / kMsPerYear;
+    reprice(row, 1);
+    ++stats_.row_reprices;
+}
+
+// deribit_price_index.<index_name>
+void OptionChain::on_index(const MarketEvent &event) {
+    if (event.symbol_view() == config_.index_name) {
+        set_index(event.index.price, event.exchange_ts);
+    }
+}
+
+// New index price: reprice everything, and log the per-expiry summary when one is due
+void OptionChain::set_index(double index_price, std::int64_t timestamp_ms) {
+    if (!(index_price > 0.0)) {
+        return;
+    }
+    index_ = index_price;
+    reprice_all(timestamp_ms);
+    if (config_.report_every_ms > 0 && timestamp_ms - last_report_ms_ >= config_.report_every_ms) {
+        last_report_ms_ = timestamp_ms;
+        report(timestamp_ms);
+    }
+}
+
+// Forwards and times to expiry for every row, then one kernel pass over the whole chain
+void OptionChain::reprice_all(std::int64_t now_ms) {
+    ScopedLatency timer(chain_latency_);
+    for (std::size_t i = 0; i < names_.size(); ++i) {
+        forward_[i] = index_ + basis_[expiry_[i]];
+        years_[i] = static_cast<double>(std::max<std::int64_t>(0, expiration_ms_[i] - now_ms)) / kMsPerYear;
+    }
+    reprice(0, names_.size());
+    ++stats_.chain_reprices;
+}
+
+// Run the kernel over a contiguous range of rows and count the mids it could not invert
+void OptionChain::reprice(std::size_t first, std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    ChainSpan span{forward_.data() + first, strike_.data() + first, years_.data() + first, sign_.data() + first,
+                   vol_.data() + first,     target_.data() + first, iv_.data() + first,    theo_.data() + first,
+                   delta_.data() + first,   gamma_.data() + first,  vega_.data() + first,  theta_.data() + first,
+                   count};
+    run_kernel(span, config_.iv_iterations, config_.iv_tolerance, config_.vectorized);
+    for (std::size_t i = first; i < first + count; ++i) {
+        stats_.iv_failures += !std::isnan(target_[i]) && std::isnan(iv_[i]);
+    }
+}
+
+// One row's inputs and model values
+OptionGreeks OptionChain::greeks(std::size_t row) const {
+    return OptionGreeks{forward_[row], years_[row], vol_[row],  theo_[row],  iv_[row],
+                        delta_[row],   gamma_[row], vega_[row], theta_[row]};
+}
+
+// Every row, grouped by expiry and sorted by strike, calls before puts
+void OptionChain::print(std::ostream &out) const {
+    std::vector<std::size_t> order(names_.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+        return std::tie(expiration_ms_[a], strike_[a], sign_[b]) < std::tie(expiration_ms_[b], strike_[b], sign_[a]);
+    });
+    out << std::left << std::setw(28) << "Instrument" << std::right << std::setw(11) << "Forward" << std::setw(9)
+        << "Mark IV" << std::setw(9) << "Mid IV" << std::setw(10) << "Theo" << std::setw(9) << "Delta"
+        << std::setw(11) << "Gamma" << std::setw(10) << "Vega" << std::setw(10) << "Theta" << "\n";
+    out << std::fixed;
+    for (std::size_t row : order) {
+        out << std::left << std::setw(28) << names_[row] << std::right << std::setprecision(1) << std::setw(11)
+            << forward_[row] << std::setprecision(2) << std::setw(9) << vol_[row] * 100 << std::setw(9)
+            << iv_[row] * 100 << std::setprecision(4) << std::setw(10) << theo_[row] << std::setw(9) << delta_[row]
+            << std::setprecision(7) << std::setw(11) << gamma_[row] << std::setprecision(2) << std::setw(10)
+            << vega_[row] << std::setw(10) << theta_[row] << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+// Per expiry: forward, the at-the-money strike and its mark and mid volatilities
+void OptionChain::report(std::int64_t now_ms) const {
+    for (std::size_t slot = 0; slot < expiries_.size(); ++slot) {
+        if (expiries_[slot] <= now_ms) {
+            continue;
+        }
+        double forward = index_ + basis_[slot];
+        std::size_t atm = names_.size();
+        std::size_t quoted = 0;
+        for (std::size_t i = 0; i < names_.size(); ++i) {
+            if (expiry_[i] != slot) {
+                continue;
+            }
+            quoted += !std::isnan(iv_[i]);
+            if (atm == names_.size() || std::fabs(strike_[i] - forward) < std::fabs(strike_[atm] - forward) ||
+                (strike_[i] == strike_[atm] && sign_[i] > 0.0)) {
+                atm = i;
+            }
+        }
+        if (atm == names_.size()) {
+            continue;
+        }
+        const std::string &name = names_[atm];
+        std::size_t dash = name.find('-');
+        std::string expiry = name.substr(dash + 1, name.find('-', dash + 1) - dash - 1);
+        char line[96];
+        std::snprintf(line, sizeof(line), "[options] %s fwd %.1f atm %.0f mark_iv %.2f mid_iv %.2f solved %zu",
+                      expiry.c_str(), forward, strike_[atm], vol_[atm] * 100, iv_[atm] * 100, quoted);
+        AsyncLogger::instance().log(line);
+    }
+}
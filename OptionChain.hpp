@@ -0,0 +1,115 @@
+#ifndef OPTION_CHAIN_HPP
+#define OPTION_CHAIN_HPP
+
+#include <boost/json.hpp>  // get_instruments results
+#include <cstddef>  // Row counts
+#include <cstdint>  // Timestamps and ids
+#include <ostream>  // Chain table
+#include <string>  // Names and channels
+#include <string_view>  // Lookups
+#include <vector>  // Structure-of-arrays columns
+#include "MarketEvents.hpp"  // Index and ticker events
+#include "Strategy.hpp"  // Feed callbacks
+#include "FeedShard.hpp"  // FeedConfig for the subscriptions
+#include "LatencyStats.hpp"  // Reprice timings
+
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+struct OptionChainConfig {
+    std::string currency = "BTC";  // Options whose base currency this is
+    std::string index_name = "btc_usd";  // deribit_price_index.<index_name> moves every forward
+    int iv_iterations = 4;  // Newton steps per implied-vol solve, warm-started from the previous solve
+    double iv_tolerance = 1e-6;  // Accepted |model - market| in underlying units (the tick is 1e-4)
+    bool vectorized = true;  // AVX2 kernels when the CPU has them; false forces the scalar reference
+    std::int64_t report_every_ms = 5000;  // Exchange time between per-expiry summaries in the log, 0 for none
+};
+
+// Model values of one option, in Deribit's conventions: prices in underlying units, Greeks in USD
+struct OptionGreeks {
+    double forward;  // Index plus the expiry's basis
+    double years;  // Time to expiry
+    double mark_iv;  // Exchange mark volatility (fraction) the price and Greeks use
+    double theo;  // Black-76 price at mark_iv and the current forward
+    double iv;  // Implied volatility of the quoted mid (fraction), NaN without a two-sided quote or a solution
+    double delta;  // dPrice/dForward of the USD price
+    double gamma;  // dDelta/dForward (per USD)
+    double vega;  // USD per volatility point
+    double theta;  // USD per calendar day
+};
+
+struct OptionChainStats {
+    std::uint64_t chain_reprices;  // Whole-chain passes, one per index update
+    std::uint64_t row_reprices;  // Single-strike passes, one per ticker update
+    std::uint64_t iv_failures;  // Quoted mids outside the arbitrage bounds or not converged
+};
+
+// Live valuation of every option on one underlying. The chain is stored as a structure of arrays, one
+// column per input and output, so a reprice streams contiguous doubles through a SIMD kernel: Black-76
+// price and Greeks at the mark volatility, plus a Newton inversion of the quoted mid, four options per
+// AVX2 iteration. An index update moves every forward (index + the expiry's basis from its tickers) and
+// reprices the whole chain; a ticker update refreshes its own row only. Runs as a Strategy on the feed
+// consumer thread and is read from that thread only.
+class OptionChain : public Strategy {
+public:
+    explicit OptionChain(OptionChainConfig config = OptionChainConfig());
+
+    bool add_option(std::string_view instrument);  // Add a row from its name (or registry reference data); false for non-options
+    std::size_t add_options(const json::value &instruments);  // public/get_instruments result; returns rows added
+    FeedConfig feed_config() const;  // The index channel plus ticker.<option>.100ms for every row
+
+    void on_ticker(const MarketEvent &event) override;  // Quotes, mark vol and basis of one row, then reprice it
+    void on_index(const MarketEvent &event) override;  // New index: reprice the whole chain
+    void set_index(double index_price, std::int64_t timestamp_ms);  // Same as an index event
+    void reprice_all(std::int64_t now_ms);  // Refresh every forward and time to expiry, then run the kernel on every row
+
+    std::size_t size() const { return names_.size(); }  // Rows
+    const std::string &name(std::size_t row) const { return names_[row]; }  // Instrument of a row
+    bool find(std::string_view instrument, std::size_t &row) const;  // Row of an instrument
+    OptionGreeks greeks(std::size_t row) const;  // One row's model values
+    const OptionChainStats &stats() const { return stats_; }
+    void print(std::ostream &out) const;  // Table of every row, by expiry then strike
+    void report(std::int64_t now_ms) const;  // One line per expiry to the async logger
+
+    // Columns, for consumers that scan the whole chain
+    const double *delta() const { return delta_.data(); }
+    const double *gamma() const { return gamma_.data(); }
+    const double *vega() const { return vega_.data(); }
+    const double *theta() const { return theta_.data(); }
+    const double *theo() const { return theo_.data(); }
+    const double *implied_vol() const { return iv_.data(); }
+
+private:
+    std::size_t expiry_slot(std::int64_t expiration_ms);  // Basis slot of an expiry, created on first use
+    void reprice(std::size_t first, std::size_t count);  // Kernel over rows [first, first + count)
+
+    OptionChainConfig config_;  // Parameters
+    double index_ = 0.0;  // Latest index price
+    std::int64_t last_report_ms_ = 0;  // Exchange time of the last summary
+
+    // Row columns, all indexed by row
+    std::vector<std::string> names_;  // Instrument names
+    std::vector<std::int64_t> expiration_ms_;  // Expiry time
+    std::vector<std::uint32_t> expiry_;  // Slot in the per-expiry columns
+    std::vector<double> strike_;  // Strike (USD)
+    std::vector<double> sign_;  // +1 call, -1 put
+    std::vector<double> forward_;  // Index + basis, refreshed on every reprice
+    std::vector<double> years_;  // Time to expiry, refreshed on every reprice
+    std::vector<double> vol_;  // mark_iv as a fraction, NaN until the first ticker
+    std::vector<double> target_;  // Quoted mid (underlying units), NaN without both sides
+    std::vector<double> iv_;  // Solved mid volatility; also the next solve's starting point
+    std::vector<double> theo_, delta_, gamma_, vega_, theta_;  // Kernel outputs
+    std::vector<std::int32_t> row_of_id_;  // InstrumentRegistry id -> row, -1 for none
+
+    // Per-expiry columns
+    std::vector<std::int64_t> expiries_;  // Expiry time of each slot
+    std::vector<double> basis_;  // underlying_price - index_price from the expiry's latest ticker
+
+    OptionChainStats stats_{};  // Counters
+    LatencyHistogram &chain_latency_ = LatencyRegistry::instance().histogram("options.chain");  // Whole-chain reprice
+    LatencyHistogram &row_latency_ = LatencyRegistry::instance().histogram("options.row");  // One-row reprice
+};
+
+bool parse_option_name(std::string_view instrument, std::int64_t &expiration_ms, double &strike,
+                       bool &call);  // e.g. BTC-27DEC24-40000-C; expiries are at 08:00 UTC
+
+#endif
@@ -0,0 +1,225 @@
+#include "OrderBatch.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+constexpr std::int64_t kTooManyRequests = 10028;  // Deribit error code for rate-limit rejections
+
+// Bind the batch to a connected, authenticated client
+OrderBatch::OrderBatch(DeribitClient& client, RateLimiter& limiter)
+    : client_(client), limiter_(limiter) {
+}
+
+// Send every command as fast as the limiter allows, then wait for the last response
+BatchReport OrderBatch::run(std::istream& commands) {
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+    while (std::getline(commands, line)) {
+        auto first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        send_retries();  // Throttled requests go ahead of new commands
+        if (!execute(line.substr(first))) {
+            std::cerr << "Skipping malformed command: " << line << "\n";
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++failed_;
+        }
+    }
+    wait_idle();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return BatchReport{sent_, succeeded_, failed_, throttled_, seconds};
+}
+
+// Parse one command and send it without waiting for the response
+bool OrderBatch::execute(const std::string& line) {
+    std::istringstream fields(line);
+    std::string verb;
+    fields >> verb;
+
+    if (verb == "buy" || verb == "sell") {
+        std::string instrument, type;
+        int amount;
+        double price;
+        if (!(fields >> instrument >> type >> amount >> price)) {
+            return false;
+        }
+        int index;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            index = static_cast<int>(placed_.size());
+            placed_.emplace_back();
+            ++sent_;
+        }
+        send(Request{verb == "buy" ? Command::Buy : Command::Sell, instrument, type, static_cast<double>(amount), price,
+                     index, 0});
+        return true;
+    }
+
+    if (verb == "cancel" || verb == "edit") {
+        std::string reference;
+        double amount = 0, price = 0;
+        if (!(fields >> reference) || (verb == "edit" && !(fields >> amount >> price))) {
+            return false;
+        }
+        std::string order_id = resolve_order(reference);
+        if (order_id.empty()) {
+            return false;  // $N out of range, or that order was rejected
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++sent_;
+        }
+        send(Request{verb == "cancel" ? Command::Cancel : Command::Edit, order_id, std::string(), amount, price, -1, 0});
+        return true;
+    }
+
+    if (verb == "wait") {
+        wait_idle();
+        return true;
+    }
+    return false;
+}
+
+// Pace one request on the matching-engine pool and hand it to the client
+void OrderBatch::send(Request request) {
+    limiter_.acquire(RateLimiter::Pool::Matching);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++in_flight_;
+    }
+    ++request.attempts;
+    switch (request.command) {
+    case Command::Buy:
+        client_.async_place_order(request.target, request.type, static_cast<int>(request.amount), request.price,
+                                  track(request));
+        break;
+    case Command::Sell:
+        client_.async_sell_order(request.target, request.type, static_cast<int>(request.amount), request.price,
+                                 track(request));
+        break;
+    case Command::Cancel:
+        client_.async_cancel_order(request.target, track(request));
+        break;
+    case Command::Edit:
+        client_.async_modify_order(request.target, request.amount, request.price, track(request));
+        break;
+    }
+}
+
+// Send what was throttled since the last call, oldest first
+void OrderBatch::send_retries() {
+    std::deque<Request> retries;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retries.swap(retries_);
+    }
+    for (Request& request : retries) {
+        send(std::move(request));
+    }
+}
+
+// Literal order ids pass through; "$N" waits for the N-th order of this batch to be acknowledged
+std::string OrderBatch::resolve_order(const std::string& reference) {
+    if (reference.empty() || reference[0] != '$') {
+        return reference;
+    }
+    std::size_t n = 0;
+    try {
+        n = std::stoul(reference.substr(1));
+    } catch (const std::exception&) {
+        return {};
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (n < 1 || n > placed_.size()) {
+        return {};
+    }
+    wait_until(lock, [&] { return placed_[n - 1].has_value(); });
+    return *placed_[n - 1];
+}
+
+// Handler run on the client's strand: time the round trip, classify the outcome, remember order ids. A
+// throttled request is queued for the sending thread, which paces it again; the strand never blocks.
+ResponseHandler OrderBatch::track(Request request) {
+    std::uint64_t sent_ticks = TscClock::now();
+    return [this, request = std::move(request), sent_ticks](json::value response) mutable {
+        latency_.record_ticks(sent_ticks);
+        const auto& message = response.as_object();
+        const auto* result = message.if_contains("result");
+        bool throttled = false;
+        if (const auto* error = message.if_contains("error"); error && error->is_object()) {
+            const auto* code = error->as_object().if_contains("code");
+            throttled = code && code->is_int64() && code->as_int64() == kTooManyRequests;
+        }
+        if (throttled) {
+            limiter_.on_throttled(RateLimiter::Pool::Matching);
+        }
+
+        std::string order_id;
+        if (result && result->is_object()) {
+            const auto* order = result->as_object().if_contains("order");
+            if (order && order->is_object()) {
+                const auto* id = order->as_object().if_contains("order_id");
+                if (id && id->is_string()) {
+                    order_id.assign(id->as_string().data(), id->as_string().size());
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --in_flight_;
+        throttled_ += throttled ? 1 : 0;
+        if (throttled && request.attempts < kMaxAttempts) {
+            retries_.push_back(std::move(request));
+            changed_.notify_all();
+            return;
+        }
+        if (result) {
+            ++succeeded_;
+        } else {
+            ++failed_;
+        }
+        if (request.placed_index >= 0) {
+            placed_[request.placed_index] = std::move(order_id);
+        }
+        changed_.notify_all();
+    };
+}
+
+// Wait (lock held) until done() holds, sending throttled requests again as they come back
+void OrderBatch::wait_until(std::unique_lock<std::mutex>& lock, const std::function<bool()>& done) {
+    while (true) {
+        changed_.wait(lock, [&] { return done() || !retries_.empty(); });
+        if (done()) {
+            return;
+        }
+        lock.unlock();
+        send_retries();
+        lock.lock();
+    }
+}
+
+// Block until every sent request has been answered and none waits for a resend
+void OrderBatch::wait_idle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    wait_until(lock, [this] { return in_flight_ == 0 && retries_.empty(); });
+}
+
+// Achieved rate and round-trip distribution in microseconds
+void OrderBatch::print_report(const BatchReport& report, std::ostream& out) const {
+    double rate = report.seconds > 0 ? static_cast<double>(report.sent) / report.seconds : 0;
+    out << "\n========== Batch ==========\n";
+    out << "Sent " << report.sent << ", ok " << report.succeeded << ", failed " << report.failed
+        << " (throttled " << report.throttled << ") in " << std::fixed << std::setprecision(3)
+        << report.seconds << " s -> " << std::setprecision(1) << rate << " orders/s\n";
+    out << std::setprecision(1) << "Latency us: p50 " << latency_.percentile(50) / 1000.0
+        << "  p99 " << latency_.percentile(99) / 1000.0
+        << "  p99.9 " << latency_.percentile(99.9) / 1000.0
+        << "  max " << latency_.max() / 1000.0 << "\n";
+    out << "===========================\n";
+    out.unsetf(std::ios::floatfield);
+}
@@ -0,0 +1,82 @@
+#ifndef ORDER_BATCH_HPP
+#define ORDER_BATCH_HPP
+
+#include <condition_variable>  // Waiting for responses
+#include <cstdint>  // Counters
+#include <deque>  // Throttled requests awaiting a resend
+#include <functional>  // Wait conditions
+#include <istream>  // Command source
+#include <mutex>  // Shared with response handlers
+#include <optional>  // Order ids not yet known
+#include <ostream>  // Report
+#include <string>  // Commands and ids
+#include <vector>  // Orders placed by the batch
+#include "DeribitClient.hpp"  // Pipelined order entry
+#include "RateLimiter.hpp"  // Credit-based pacing
+#include "LatencyStats.hpp"  // Round-trip distribution
+
+struct BatchReport {
+    std::uint64_t sent;  // Commands sent (a throttled command that was re-sent counts once)
+    std::uint64_t succeeded;  // Responses with a result
+    std::uint64_t failed;  // Error responses, unparseable commands and commands still throttled after kMaxAttempts
+    std::uint64_t throttled;  // too_many_requests rejections, each followed by a resend while attempts remain
+    double seconds;  // First send to last response
+};
+
+// Non-interactive order entry. Reads one command per line and sends it pipelined through DeribitClient,
+// paced by a RateLimiter; blank lines and lines starting with '#' are skipped.
+//
+//   buy <instrument> <type> <amount> <price>
+//   sell <instrument> <type> <amount> <price>
+//   cancel <order_id | $N>
+//   edit <order_id | $N> <amount> <price>
+//   wait                                      (let every outstanding request complete)
+//
+// $N is the order id returned for the N-th buy/sell of this batch (1-based); using it waits only for
+// that order's response. A request the exchange throttles (too_many_requests) is sent again once the
+// limiter allows, ahead of the next command, up to kMaxAttempts times.
+class OrderBatch {
+public:
+    OrderBatch(DeribitClient& client, RateLimiter& limiter);  // Both must outlive the batch
+
+    BatchReport run(std::istream& commands);  // Send every command, then wait for all responses
+    void print_report(const BatchReport& report, std::ostream& out) const;  // Throughput and latency summary
+
+private:
+    static constexpr int kMaxAttempts = 5;  // Sends per command before a throttled one counts as failed
+
+    enum class Command { Buy, Sell, Cancel, Edit };
+
+    struct Request {
+        Command command;  // What to send
+        std::string target;  // Instrument for buy/sell, order id for cancel/edit
+        std::string type;  // Order type (buy/sell)
+        double amount;  // Order or edited amount
+        double price;  // Limit or edited price
+        int placed_index;  // Slot in placed_ for buy/sell, -1 otherwise
+        int attempts;  // Sends so far
+    };
+
+    bool execute(const std::string& line);  // Parse and send one command; false if it is malformed
+    void send(Request request);  // Pace and send one request without waiting for the response
+    void send_retries();  // Send every throttled request queued so far
+    std::string resolve_order(const std::string& reference);  // Order id, or the id behind "$N"
+    ResponseHandler track(Request request);  // Completion handler recording latency and outcome
+    void wait_until(std::unique_lock<std::mutex>& lock, const std::function<bool()>& done);  // Resend throttled requests while waiting
+    void wait_idle();  // Block until no request is outstanding or waiting for a resend
+
+    DeribitClient& client_;  // Order entry
+    RateLimiter& limiter_;  // Pacing
+    LatencyHistogram latency_;  // Send -> response for this batch
+    std::mutex mutex_;  // Guards everything below
+    std::condition_variable changed_;  // Signalled on every response
+    std::size_t in_flight_ = 0;  // Requests awaiting a response
+    std::deque<Request> retries_;  // Throttled requests to send again
+    std::vector<std::optional<std::string>> placed_;  // Ids of the batch's buys/sells, empty string if rejected
+    std::uint64_t sent_ = 0;  // BatchReport::sent
+    std::uint64_t succeeded_ = 0;  // BatchReport::succeeded
+    std::uint64_t failed_ = 0;  // BatchReport::failed
+    std::uint64_t throttled_ = 0;  // BatchReport::throttled
+};
+
+#endif
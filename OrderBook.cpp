@@ -0,0 +1,230 @@
+#include "OrderBook.hpp"
+
+#include <algorithm>
+
+// Constructor: empty book waiting for its first snapshot
+OrderBook::OrderBook(std::string instrument)
+    : instrument_(std::move(instrument)) {
+    bids_.reserve(256);
+    asks_.reserve(256);
+}
+
+// Apply a snapshot or an incremental update. Continuation fragments (prev_change_id == change_id) are
+// collected behind their first fragment; the whole update goes in with the last one.
+bool OrderBook::apply(bool snapshot, std::int64_t change_id, std::int64_t prev_change_id, std::int64_t timestamp,
+                      const LevelChange* changes, std::size_t count, bool last_fragment) {
+    if (!snapshot && prev_change_id == change_id) {
+        if (!staging_ || staged_change_id_ != change_id) {
+            staging_ = false;  // Its first fragment never arrived
+            staged_.clear();
+            std::lock_guard<SpinLock> lock(lock_);
+            synced_ = false;
+            return false;
+        }
+        staged_.insert(staged_.end(), changes, changes + count);
+        if (!last_fragment) {
+            return true;
+        }
+        staging_ = false;
+        bool applied = publish(staged_snapshot_, change_id, staged_prev_change_id_, timestamp, staged_.data(),
+                               staged_.size());
+        staged_.clear();
+        return applied;
+    }
+    staging_ = false;  // An unfinished update is abandoned; the next one then fails the chain check
+    staged_.clear();
+    if (!last_fragment) {
+        staging_ = true;
+        staged_snapshot_ = snapshot;
+        staged_change_id_ = change_id;
+        staged_prev_change_id_ = prev_change_id;
+        staged_.assign(changes, changes + count);
+        return true;
+    }
+    return publish(snapshot, change_id, prev_change_id, timestamp, changes, count);
+}
+
+// Apply a whole snapshot or incremental update, checking the change_id chain
+bool OrderBook::publish(bool snapshot, std::int64_t change_id, std::int64_t prev_change_id, std::int64_t timestamp,
+                        const LevelChange* changes, std::size_t count) {
+    std::lock_guard<SpinLock> lock(lock_);
+    if (snapshot) {
+        bids_.clear();
+        asks_.clear();
+        synced_ = true;
+    } else if (!synced_ || prev_change_id != change_id_) {
+        synced_ = false;  // Gap: stay unsynced until the next snapshot
+        return false;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        apply_level(changes[i]);
+    }
+    change_id_ = change_id;
+    timestamp_ = timestamp;
+    return true;
+}
+
+// Insert, update or erase one level; both sides keep the best price at back()
+void OrderBook::apply_level(const LevelChange& change) {
+    auto& levels = (change.side == BookSide::Bid) ? bids_ : asks_;
+    auto it = (change.side == BookSide::Bid)
+        ? std::lower_bound(levels.begin(), levels.end(), change.price,
+                           [](const PriceLevel& level, double price) { return level.price < price; })
+        : std::lower_bound(levels.begin(), levels.end(), change.price,
+                           [](const PriceLevel& level, double price) { return level.price > price; });
+    bool found = it != levels.end() && it->price == change.price;
+
+    if (change.action == LevelAction::Delete || change.amount == 0.0) {
+        if (found) {
+            levels.erase(it);
+        }
+    } else if (found) {
+        it->amount = change.amount;
+    } else {
+        levels.insert(it, PriceLevel{change.price, change.amount});
+    }
+}
+
+// Best bid and ask; false if either side is empty or the book is not trustworthy
+bool OrderBook::top_of_book(PriceLevel& bid, PriceLevel& ask) const {
+    std::lock_guard<SpinLock> lock(lock_);
+    if (!synced_ || bids_.empty() || asks_.empty()) {
+        return false;
+    }
+    bid = bids_.back();
+    ask = asks_.back();
+    return true;
+}
+
+// Copy up to max_levels levels of one side, best price first
+std::size_t OrderBook::depth(BookSide side, PriceLevel* out, std::size_t max_levels) const {
+    std::lock_guard<SpinLock> lock(lock_);
+    const auto& levels = (side == BookSide::Bid) ? bids_ : asks_;
+    std::size_t n = std::min(max_levels, levels.size());
+    std::copy(levels.rbegin(), levels.rbegin() + n, out);
+    return n;
+}
+
+// True once a snapshot has been applied and no gap has been seen since
+bool OrderBook::is_synced() const {
+    std::lock_guard<SpinLock> lock(lock_);
+    return synced_;
+}
+
+// Last applied change id
+std::int64_t OrderBook::change_id() const {
+    std::lock_guard<SpinLock> lock(lock_);
+    return change_id_;
+}
+
+// Exchange timestamp of the last applied update
+std::int64_t OrderBook::timestamp() const {
+    std::lock_guard<SpinLock> lock(lock_);
+    return timestamp_;
+}
+
+// Book for instrument, created unsynced on first use
+OrderBook& OrderBookManager::get_or_create(std::string_view instrument) {
+    std::lock_guard<std::mutex> lock(books_mutex_);
+    auto it = books_.find(instrument);
+    if (it == books_.end()) {
+        std::string name(instrument);
+        it = books_.emplace(name, std::make_unique<OrderBook>(name)).first;
+    }
+    return *it->second;
+}
+
+// Book for instrument, or nullptr if never seen
+OrderBook* OrderBookManager::find(std::string_view instrument) const {
+    std::lock_guard<std::mutex> lock(books_mutex_);
+    auto it = books_.find(instrument);
+    return it == books_.end() ? nullptr : it->second.get();
+}
+
+// Book for a registry id; the map is only consulted the first time an id is seen
+OrderBook& OrderBookManager::get_or_create(InstrumentId id, std::string_view instrument) {
+    if (id == kNoInstrument || id >= kMaxInstruments) {
+        return get_or_create(instrument);
+    }
+    OrderBook* book = by_id_[id].load(std::memory_order_acquire);
+    if (!book) {
+        book = &get_or_create(instrument);
+        by_id_[id].store(book, std::memory_order_release);
+    }
+    return *book;
+}
+
+// Book for a registry id, or nullptr if not yet looked up by id
+OrderBook* OrderBookManager::find(InstrumentId id) const {
+    return id < kMaxInstruments ? by_id_[id].load(std::memory_order_acquire) : nullptr;
+}
+
+// Install the gap recovery hook
+void OrderBookManager::set_resync_handler(ResyncHandler handler) {
+    resync_handler_ = std::move(handler);
+}
+
+// Translate one side of a book.* payload into level changes
+static void collect_levels(const json::value* side_levels, BookSide side, std::vector<LevelChange>& out) {
+    if (!side_levels || !side_levels->is_array()) {
+        return;
+    }
+    for (const auto& entry : side_levels->as_array()) {
+        const auto& level = entry.as_array();
+        if (level.size() == 3) {  // ["new"|"change"|"delete", price, amount]
+            const auto& verb = level[0].as_string();
+            LevelAction action = verb == "delete" ? LevelAction::Delete
+                               : verb == "change" ? LevelAction::Change
+                                                  : LevelAction::New;
+            out.push_back({side, action, level[1].to_number<double>(), level[2].to_number<double>()});
+        } else if (level.size() == 2) {  // Grouped books send plain [price, amount]
+            out.push_back({side, LevelAction::New, level[0].to_number<double>(), level[1].to_number<double>()});
+        }
+    }
+}
+
+// Apply a book.* notification payload; requests a resync when the change_id chain breaks
+bool OrderBookManager::apply(const json::object& data) {
+    const auto* name = data.if_contains("instrument_name");
+    if (!name || !name->is_string()) {
+        return true;
+    }
+    std::string_view instrument(name->as_string().data(), name->as_string().size());
+
+    // Grouped books have no prev_change_id and every message is a full snapshot
+    const auto* prev = data.if_contains("prev_change_id");
+    const auto* type = data.if_contains("type");
+    bool snapshot = !prev || (type && type->is_string() && type->as_string() == "snapshot");
+    std::int64_t change_id = data.contains("change_id") ? data.at("change_id").to_number<std::int64_t>() : 0;
+    std::int64_t prev_change_id = prev ? prev->to_number<std::int64_t>() : 0;
+    std::int64_t timestamp = data.contains("timestamp") ? data.at("timestamp").to_number<std::int64_t>() : 0;
+
+    static thread_local std::vector<LevelChange> changes;
+    changes.clear();
+    collect_levels(data.if_contains("bids"), BookSide::Bid, changes);
+    collect_levels(data.if_contains("asks"), BookSide::Ask, changes);
+
+    return apply(get_or_create(instrument), snapshot, change_id, prev_change_id, timestamp,
+                 changes.data(), changes.size());
+}
+
+// Apply a decoded book event fragment
+bool OrderBookManager::apply(const MarketEvent& event) {
+    const BookEvent& update = event.book;
+    return apply(get_or_create(event.instrument_id, event.symbol_view()), update.snapshot, update.change_id, update.prev_change_id,
+                 event.exchange_ts, update.levels, update.count, update.last_fragment);
+}
+
+// Apply an update to one book and ask for a resync when its change_id chain breaks
+bool OrderBookManager::apply(OrderBook& book, bool snapshot, std::int64_t change_id, std::int64_t prev_change_id,
+                             std::int64_t timestamp, const LevelChange* changes, std::size_t count, bool last_fragment) {
+    bool was_synced = book.is_synced();
+    if (book.apply(snapshot, change_id, prev_change_id, timestamp, changes, count, last_fragment)) {
+        return true;
+    }
+    if (was_synced && resync_handler_) {  // Ask once per gap, not for every delta until the snapshot lands
+        resync_handler_(book.instrument());
+    }
+    return false;
+}
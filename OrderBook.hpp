@@ -0,0 +1,100 @@
+#ifndef ORDER_BOOK_HPP
+#define ORDER_BOOK_HPP
+
+#include <boost/json.hpp>  // JSON access for book.* notification payloads
+#include <atomic>  // Spin lock flag
+#include <cstdint>  // Fixed-width change ids and timestamps
+#include <functional>  // Resync callback
+#include <map>  // Instrument -> book lookup without allocating a key
+#include <memory>  // Stable book addresses inside the manager
+#include <mutex>  // Protects the instrument map
+#include <string>  // Instrument names
+#include <string_view>  // Heterogeneous lookups
+#include <vector>  // Flat price-level storage
+#include "MarketEvents.hpp"  // PriceLevel, LevelChange and decoded book events
+#include "InstrumentRegistry.hpp"  // Id-indexed book lookups
+
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+// Minimal test-and-test-and-set lock; book critical sections are a handful of loads and stores.
+class SpinLock {
+public:
+    void lock() {
+        while (flag_.exchange(true, std::memory_order_acquire)) {
+            while (flag_.load(std::memory_order_relaxed)) {
+            }
+        }
+    }
+    void unlock() { flag_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> flag_{false};
+};
+
+// L2 book for one instrument kept in two flat vectors, best price at the back of each so that
+// the hot end of the book is updated without shifting the rest of the levels.
+class OrderBook {
+public:
+    explicit OrderBook(std::string instrument);  // Construct an empty, unsynced book
+
+    // Apply a snapshot (replaces the book) or an incremental update. Returns false when the update
+    // does not chain onto the current change_id; the book is then marked unsynced until a snapshot arrives.
+    // Fragments of one update (last_fragment false) are staged and published together with the last one,
+    // so readers never see a half-applied update.
+    bool apply(bool snapshot, std::int64_t change_id, std::int64_t prev_change_id, std::int64_t timestamp,
+               const LevelChange* changes, std::size_t count, bool last_fragment = true);
+
+    bool top_of_book(PriceLevel& bid, PriceLevel& ask) const;  // Best bid/ask; false if either side is empty or unsynced
+    std::size_t depth(BookSide side, PriceLevel* out, std::size_t max_levels) const;  // Copy best-first levels, returns count
+    bool is_synced() const;  // True once a snapshot has been applied and no gap has been seen since
+    std::int64_t change_id() const;  // Last applied change id
+    std::int64_t timestamp() const;  // Exchange timestamp (ms) of the last applied update
+    const std::string& instrument() const { return instrument_; }  // Instrument this book tracks
+
+private:
+    bool publish(bool snapshot, std::int64_t change_id, std::int64_t prev_change_id, std::int64_t timestamp,
+                 const LevelChange* changes, std::size_t count);  // Apply a whole update under the lock
+    void apply_level(const LevelChange& change);  // Insert, update or erase one level
+
+    std::string instrument_;  // Instrument name
+
+    // Writer-side staging of a fragmented update; never read by other threads
+    std::vector<LevelChange> staged_;  // Level changes of the fragments so far
+    bool staging_ = false;  // A first fragment is waiting for its last one
+    bool staged_snapshot_ = false;  // The staged update is a snapshot
+    std::int64_t staged_change_id_ = 0;  // change_id of the staged update
+    std::int64_t staged_prev_change_id_ = 0;  // prev_change_id of its first fragment
+
+    mutable SpinLock lock_;  // Guards everything below; held for nanoseconds
+    std::vector<PriceLevel> bids_;  // Ascending price, best bid at back()
+    std::vector<PriceLevel> asks_;  // Descending price, best ask at back()
+    std::int64_t change_id_ = 0;  // Last applied change id
+    std::int64_t timestamp_ = 0;  // Last exchange timestamp
+    bool synced_ = false;  // Snapshot received and chain unbroken
+};
+
+// Owns one OrderBook per instrument and maps book.* notifications onto them.
+class OrderBookManager {
+public:
+    using ResyncHandler = std::function<void(const std::string& instrument)>;  // Called when a book must be re-snapshotted
+
+    OrderBook& get_or_create(std::string_view instrument);  // Book for instrument, created unsynced on first use
+    OrderBook* find(std::string_view instrument) const;  // Book for instrument, or nullptr if never seen
+    OrderBook& get_or_create(InstrumentId id, std::string_view instrument);  // Lock-free once the id has been seen
+    OrderBook* find(InstrumentId id) const;  // Lock-free; nullptr until get_or_create(id, ...) has run
+    bool apply(const json::object& data);  // Apply a book.* notification payload; false if a resync was requested
+    bool apply(const MarketEvent& event);  // Apply a decoded book event; false if a resync was requested
+    void set_resync_handler(ResyncHandler handler);  // Install before updates start flowing
+
+private:
+    mutable std::mutex books_mutex_;  // Guards the map itself, not the books
+    std::map<std::string, std::unique_ptr<OrderBook>, std::less<>> books_;  // Instrument -> book
+    std::unique_ptr<std::atomic<OrderBook*>[]> by_id_{new std::atomic<OrderBook*>[kMaxInstruments]()};  // Registry id -> book, filled on first use
+    ResyncHandler resync_handler_;  // Gap recovery hook
+
+    bool apply(OrderBook& book, bool snapshot, std::int64_t change_id, std::int64_t prev_change_id,
+               std::int64_t timestamp, const LevelChange* changes, std::size_t count,
+               bool last_fragment = true);  // Apply and resync on gap
+};
+
+#endif
@@ -0,0 +1,322 @@
+#include "OrderCache.hpp"
+#include "JsonFields.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+
+// Settlement currency of an instrument: USDC/USDT for linear "BTC_USDC-..." names, else the prefix
+static std::string currency_of(const std::string& instrument) {
+    if (instrument.find("_USDC") != std::string::npos) {
+        return "USDC";
+    }
+    if (instrument.find("_USDT") != std::string::npos) {
+        return "USDT";
+    }
+    return instrument.substr(0, instrument.find_first_of("-_"));
+}
+
+// Instrument kind from its name: options carry strike and type ("BTC-27JUN25-60000-C")
+static std::string kind_of(const std::string& instrument) {
+    auto dashes = std::count(instrument.begin(), instrument.end(), '-');
+    if (dashes >= 3) {
+        return "option";
+    }
+    if (dashes == 0) {
+        return "spot";
+    }
+    return "future";
+}
+
+// Private channels the cache is fed from
+std::vector<std::string> OrderCache::channels() {
+    return {"user.orders.any.any.raw", "user.trades.any.any.raw", "user.portfolio.any"};
+}
+
+// Subscribe first, then call this and request both snapshots; notifications queue up meanwhile
+void OrderCache::begin_sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    syncing_ = true;
+    orders_loaded_ = false;
+    positions_loaded_ = false;
+    buffered_.clear();
+}
+
+// Load working orders from a private/get_open_orders response
+void OrderCache::apply_orders_snapshot(const json::value& response) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto* result = response.as_object().if_contains("result");
+    if (!result || !result->is_array()) {
+        std::cerr << "Open orders snapshot failed: " << json::serialize(response) << "\n";
+        syncing_ = false;  // Stay unsynced; callers fall back to REST
+        buffered_.clear();
+        return;
+    }
+    for (const auto& order : result->as_array()) {
+        if (order.is_object()) {
+            upsert_order(order.as_object());
+        }
+    }
+    orders_loaded_ = true;
+    finish_sync();
+}
+
+// Load positions from a private/get_positions response; usOut dates the snapshot for trade replay
+void OrderCache::apply_positions_snapshot(const json::value& response) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto* result = response.as_object().if_contains("result");
+    if (!result || !result->is_array()) {
+        std::cerr << "Positions snapshot failed: " << json::serialize(response) << "\n";
+        syncing_ = false;
+        buffered_.clear();
+        return;
+    }
+    positions_.clear();
+    for (const auto& position : result->as_array()) {
+        if (position.is_object()) {
+            set_position(position.as_object());
+        }
+    }
+    positions_snapshot_ms_ = static_cast<std::int64_t>(number_or(response.as_object(), "usOut") / 1000);
+    positions_loaded_ = true;
+    finish_sync();
+}
+
+// Route a user.* notification, buffering it while the snapshots are outstanding
+bool OrderCache::apply_notification(std::string_view channel, const json::value& data) {
+    if (channel.substr(0, 5) != "user.") {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (syncing_) {
+        buffered_.emplace_back(std::string(channel), data);
+        return true;
+    }
+    apply(channel, data);
+    return true;
+}
+
+// Record the order (and any immediate fills) returned by buy, sell, edit or cancel
+void OrderCache::record_order_response(const json::value& response) {
+    const auto* result = response.as_object().if_contains("result");
+    if (!result || !result->is_object()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto& object = result->as_object();
+    if (const auto* order = object.if_contains("order"); order && order->is_object()) {
+        upsert_order(order->as_object());
+    } else if (object.contains("order_id")) {
+        upsert_order(object);  // private/cancel returns the order itself
+    }
+    if (const auto* trades = object.if_contains("trades"); trades && trades->is_array()) {
+        for (const auto& trade : trades->as_array()) {
+            if (trade.is_object()) {
+                apply_trade(trade.as_object());
+            }
+        }
+    }
+}
+
+// Both snapshots applied
+bool OrderCache::is_synced() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return orders_loaded_ && positions_loaded_ && !syncing_;
+}
+
+// Orders still working, oldest update first
+std::vector<CachedOrder> OrderCache::open_orders() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CachedOrder> open;
+    for (const auto& [id, order] : orders_) {
+        if (order.state == "open" || order.state == "untriggered") {
+            open.push_back(order);
+        }
+    }
+    std::sort(open.begin(), open.end(), [](const CachedOrder& a, const CachedOrder& b) {
+        return a.last_update < b.last_update;
+    });
+    return open;
+}
+
+// An open order, or a final one updated within kRetentionMs
+std::optional<CachedOrder> OrderCache::find_order(const std::string& order_id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = orders_.find(order_id);
+    if (it == orders_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+// Non-zero positions for a currency and kind, as private/get_positions would filter them
+std::vector<CachedPosition> OrderCache::positions(const std::string& currency, const std::string& kind) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<CachedPosition> matching;
+    for (const auto& [instrument, position] : positions_) {
+        if (position.size == 0) {
+            continue;
+        }
+        if (currency != "any" && !currency.empty() && currency_of(instrument) != currency) {
+            continue;
+        }
+        if (kind != "any" && !kind.empty() && position.kind != kind) {
+            continue;
+        }
+        matching.push_back(position);
+    }
+    return matching;
+}
+
+// Latest account summary per currency
+std::vector<PortfolioSummary> OrderCache::portfolio() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PortfolioSummary> summaries;
+    for (const auto& [currency, summary] : portfolio_) {
+        summaries.push_back(summary);
+    }
+    return summaries;
+}
+
+// Apply one notification by channel family
+void OrderCache::apply(std::string_view channel, const json::value& data) {
+    if (channel.substr(0, 12) == "user.orders.") {
+        if (data.is_object()) {
+            upsert_order(data.as_object());
+        } else if (data.is_array()) {  // Interval channels batch orders
+            for (const auto& order : data.as_array()) {
+                if (order.is_object()) {
+                    upsert_order(order.as_object());
+                }
+            }
+        }
+    } else if (channel.substr(0, 12) == "user.trades.") {
+        if (data.is_array()) {
+            for (const auto& trade : data.as_array()) {
+                if (trade.is_object()) {
+                    apply_trade(trade.as_object());
+                }
+            }
+        }
+    } else if (channel.substr(0, 15) == "user.portfolio." && data.is_object()) {
+        const auto& object = data.as_object();
+        PortfolioSummary summary;
+        summary.currency = string_or_empty(object, "currency");
+        summary.equity = number_or(object, "equity");
+        summary.balance = number_or(object, "balance");
+        summary.available_funds = number_or(object, "available_funds");
+        summary.initial_margin = number_or(object, "initial_margin");
+        summary.maintenance_margin = number_or(object, "maintenance_margin");
+        summary.total_pl = number_or(object, "total_pl");
+        portfolio_[summary.currency] = summary;
+    }
+}
+
+// Keep the newest version of an order; an older update arriving late is ignored
+void OrderCache::upsert_order(const json::object& order) {
+    std::string order_id(string_or_empty(order, "order_id"));
+    if (order_id.empty()) {
+        return;
+    }
+    auto timestamp = static_cast<std::int64_t>(number_or(order, "last_update_timestamp"));
+    CachedOrder& cached = orders_[order_id];
+    if (!cached.order_id.empty() && timestamp < cached.last_update) {
+        return;
+    }
+    cached.order_id = std::move(order_id);
+    cached.instrument = string_or_empty(order, "instrument_name");
+    cached.direction = string_or_empty(order, "direction");
+    cached.order_type = string_or_empty(order, "order_type");
+    cached.state = string_or_empty(order, "order_state");
+    cached.label = string_or_empty(order, "label");
+    cached.price = number_or(order, "price");
+    cached.amount = number_or(order, "amount");
+    cached.filled_amount = number_or(order, "filled_amount");
+    cached.average_price = number_or(order, "average_price");
+    cached.last_update = timestamp;
+    newest_ms_ = std::max(newest_ms_, timestamp);
+    if (++updates_since_prune_ >= kPruneEvery) {
+        prune();
+    }
+}
+
+// Move a position by one fill. Mark price and PnL stay as of the last snapshot; size and entry
+// price follow every trade.
+void OrderCache::apply_trade(const json::object& trade) {
+    auto timestamp = static_cast<std::int64_t>(number_or(trade, "timestamp"));
+    if (positions_loaded_ && timestamp <= positions_snapshot_ms_) {
+        return;  // Already part of the positions snapshot
+    }
+    std::string trade_id(string_or_empty(trade, "trade_id"));
+    if (!trade_id.empty() && !applied_trades_.emplace(std::move(trade_id), timestamp).second) {
+        return;  // Already seen on another path (order response or user.trades)
+    }
+    newest_ms_ = std::max(newest_ms_, timestamp);
+    if (++updates_since_prune_ >= kPruneEvery) {
+        prune();
+    }
+    std::string instrument(string_or_empty(trade, "instrument_name"));
+    double price = number_or(trade, "price");
+    double amount = number_or(trade, "amount");
+    double signed_amount = string_or_empty(trade, "direction") == "sell" ? -amount : amount;
+
+    CachedPosition& position = positions_[instrument];
+    if (position.instrument.empty()) {
+        position.instrument = instrument;
+        position.kind = kind_of(instrument);
+    }
+    double new_size = position.size + signed_amount;
+    if (position.size == 0 || (position.size > 0) != (new_size > 0) || new_size == 0) {
+        position.average_price = new_size == 0 ? 0 : price;  // Opened, flipped or closed
+    } else if (std::fabs(new_size) > std::fabs(position.size)) {
+        position.average_price = (std::fabs(position.size) * position.average_price + amount * price) / std::fabs(new_size);
+    }
+    position.size = new_size;
+    position.last_update = timestamp;
+}
+
+// Replace a position from a snapshot entry
+void OrderCache::set_position(const json::object& position) {
+    CachedPosition cached;
+    cached.instrument = string_or_empty(position, "instrument_name");
+    cached.kind = string_or_empty(position, "kind");
+    if (cached.kind.empty()) {
+        cached.kind = kind_of(cached.instrument);
+    }
+    cached.size = number_or(position, "size");
+    cached.average_price = number_or(position, "average_price");
+    cached.mark_price = number_or(position, "mark_price");
+    cached.floating_profit_loss = number_or(position, "floating_profit_loss");
+    cached.realized_profit_loss = number_or(position, "realized_profit_loss");
+    positions_[cached.instrument] = std::move(cached);
+}
+
+// Once both snapshots are in, replay what arrived meanwhile and switch to live updates
+void OrderCache::finish_sync() {
+    if (!syncing_ || !orders_loaded_ || !positions_loaded_) {
+        return;
+    }
+    for (const auto& [channel, data] : buffered_) {
+        apply(channel, data);
+    }
+    buffered_.clear();
+    syncing_ = false;
+}
+
+// Forget final orders and applied trade ids that are older than the retention window, measured on the
+// exchange clock. A trade is only ever repeated within moments (order response vs user.trades), and
+// trades up to the positions snapshot are recognised by their timestamp alone.
+void OrderCache::prune() {
+    updates_since_prune_ = 0;
+    std::int64_t cutoff = newest_ms_ - kRetentionMs;
+    for (auto it = orders_.begin(); it != orders_.end();) {
+        const CachedOrder& order = it->second;
+        bool ended = order.state == "filled" || order.state == "cancelled" || order.state == "rejected";
+        it = ended && order.last_update < cutoff ? orders_.erase(it) : std::next(it);
+    }
+    for (auto it = applied_trades_.begin(); it != applied_trades_.end();) {
+        bool covered = positions_loaded_ && it->second <= positions_snapshot_ms_;
+        it = covered || it->second < cutoff ? applied_trades_.erase(it) : std::next(it);
+    }
+}
@@ -0,0 +1,98 @@
+#ifndef ORDER_CACHE_HPP
+#define ORDER_CACHE_HPP
+
+#include <boost/json.hpp>  // Responses and notifications
+#include <cstdint>  // Timestamps
+#include <map>  // Positions and portfolio ordered for display
+#include <mutex>  // Shared between the client strand and the menu
+#include <optional>  // Order lookup
+#include <string>  // Ids and instrument names
+#include <string_view>  // Channel names
+#include <unordered_map>  // Orders by id
+#include <utility>  // Buffered notifications
+#include <vector>  // Query results
+
+namespace json = boost::json;  // Alias for Boost.JSON
+
+struct CachedOrder {
+    std::string order_id;  // Exchange order id
+    std::string instrument;  // Instrument name
+    std::string direction;  // "buy" / "sell"
+    std::string order_type;  // "limit", "market", ...
+    std::string state;  // "open", "filled", "cancelled", ...
+    std::string label;  // User label, may be empty
+    double price = 0;  // Limit price
+    double amount = 0;  // Order size
+    double filled_amount = 0;  // Executed so far
+    double average_price = 0;  // Average fill price
+    std::int64_t last_update = 0;  // Exchange timestamp (ms) of this version
+};
+
+struct CachedPosition {
+    std::string instrument;  // Instrument name
+    std::string kind;  // "future", "option", "spot", ...
+    double size = 0;  // Signed size, negative when short
+    double average_price = 0;  // Average entry price
+    double mark_price = 0;  // Mark price at the last snapshot
+    double floating_profit_loss = 0;  // Unrealized PnL at the last snapshot
+    double realized_profit_loss = 0;  // Realized PnL at the last snapshot
+    std::int64_t last_update = 0;  // Exchange timestamp (ms) of the last change
+};
+
+struct PortfolioSummary {
+    std::string currency;  // Account currency
+    double equity = 0;  // Account equity
+    double balance = 0;  // Cash balance
+    double available_funds = 0;  // Funds available for new orders
+    double initial_margin = 0;  // Initial margin in use
+    double maintenance_margin = 0;  // Maintenance margin in use
+    double total_pl = 0;  // Session profit and loss
+};
+
+// Orders, positions and account summaries kept locally from private/get_open_orders and
+// private/get_positions snapshots plus the user.orders, user.trades and user.portfolio channels.
+// Notifications that arrive before both snapshots are buffered and applied on top of them, so the
+// cache never goes backwards. Updated on the client strand, read from any thread.
+class OrderCache {
+public:
+    static std::vector<std::string> channels();  // Private channels the cache is fed from
+
+    void begin_sync();  // Start buffering notifications until both snapshots have been applied
+    void apply_orders_snapshot(const json::value& response);  // private/get_open_orders response
+    void apply_positions_snapshot(const json::value& response);  // private/get_positions response
+    bool apply_notification(std::string_view channel, const json::value& data);  // False if the channel is not a user.* channel
+    void record_order_response(const json::value& response);  // Buy, sell, edit or cancel response
+
+    bool is_synced() const;  // Both snapshots applied
+    std::vector<CachedOrder> open_orders() const;  // Orders still working, oldest update first
+    std::optional<CachedOrder> find_order(const std::string& order_id) const;  // Open orders, and final ones for kRetentionMs
+    std::vector<CachedPosition> positions(const std::string& currency, const std::string& kind) const;  // Non-zero positions; "any" matches everything
+    std::vector<PortfolioSummary> portfolio() const;  // Latest summary per currency
+
+    static constexpr std::int64_t kRetentionMs = 10 * 60 * 1000;  // Final orders and applied trade ids are kept this long
+
+private:
+    static constexpr std::size_t kPruneEvery = 1024;  // Order and trade updates between pruning passes
+
+    void apply(std::string_view channel, const json::value& data);  // Route one notification (lock held)
+    void upsert_order(const json::object& order);  // Keep the newest version of an order (lock held)
+    void apply_trade(const json::object& trade);  // Move a position by a fill (lock held)
+    void set_position(const json::object& position);  // Replace a position from a snapshot (lock held)
+    void finish_sync();  // Apply buffered notifications once both snapshots are in (lock held)
+    void prune();  // Drop final orders and trade ids older than kRetentionMs of exchange time (lock held)
+
+    mutable std::mutex mutex_;  // Guards everything below
+    std::unordered_map<std::string, CachedOrder> orders_;  // Open orders and recently finished ones
+    std::map<std::string, CachedPosition> positions_;  // Keyed by instrument
+    std::map<std::string, PortfolioSummary> portfolio_;  // Keyed by currency
+    std::unordered_map<std::string, std::int64_t> applied_trades_;  // Trade id -> timestamp, for trades reflected in positions_
+    std::int64_t newest_ms_ = 0;  // Newest exchange timestamp seen on an order or trade
+    std::size_t updates_since_prune_ = 0;  // Order and trade updates since the last prune()
+    std::vector<std::pair<std::string, json::value>> buffered_;  // Notifications received while syncing
+    bool syncing_ = false;  // Between begin_sync() and the second snapshot
+    bool orders_loaded_ = false;  // Open-orders snapshot applied
+    bool positions_loaded_ = false;  // Positions snapshot applied
+    std::int64_t positions_snapshot_ms_ = 0;  // Server time of the positions snapshot
+};
+
+#endif
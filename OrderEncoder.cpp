@@ -0,0 +1,137 @@
+#include "OrderEncoder.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Append an integer without going through iostreams or locale handling
+void append_integer(std::string& out, long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Append the shortest representation that round-trips; JSON has no NaN or infinity
+void append_number(std::string& out, double value) {
+    if (!std::isfinite(value)) {
+        throw std::invalid_argument("Order field is not a finite number");
+    }
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Append a string body with the escaping JSON requires; instrument names and order ids never need it in practice
+void append_escaped(std::string& out, std::string_view text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out.push_back('\\');
+            out.push_back(c);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            out.append("\\u00");
+            out.push_back(hex[(c >> 4) & 0xF]);
+            out.push_back(hex[c & 0xF]);
+        } else {
+            out.push_back(c);
+        }
+    }
+}
+
+}  // namespace
+
+// Render (once) everything of a buy/sell request that precedes the amount
+const std::string& OrderEncoder::warm(OrderSide side, std::string_view instrument, std::string_view type, bool post_only) {
+    auto& by_instrument = templates_[static_cast<int>(side)][post_only ? 1 : 0];
+    auto instrument_it = by_instrument.find(instrument);
+    if (instrument_it == by_instrument.end()) {
+        instrument_it = by_instrument.emplace(std::string(instrument), TypeTemplates{}).first;
+    }
+    auto& by_type = instrument_it->second;
+    auto type_it = by_type.find(type);
+    if (type_it == by_type.end()) {
+        std::string prefix = side == OrderSide::Buy
+            ? R"({"jsonrpc":"2.0","method":"private/buy","params":{"instrument_name":")"
+            : R"({"jsonrpc":"2.0","method":"private/sell","params":{"instrument_name":")";
+        append_escaped(prefix, instrument);
+        prefix.append(R"(","type":")");
+        append_escaped(prefix, type);
+        prefix.append(post_only ? R"(","post_only":true,"amount":)" : R"(","amount":)");
+        type_it = by_type.emplace(std::string(type), std::move(prefix)).first;
+    }
+    return type_it->second;
+}
+
+// {"jsonrpc":"2.0","method":"private/buy|sell","params":{...,"amount":A,"price":P},"id":N}
+void OrderEncoder::encode_order(std::string& out, OrderSide side, std::string_view instrument, std::string_view type,
+                                int id, int amount, double price, bool post_only) {
+    const std::string& prefix = warm(side, instrument, type, post_only);
+    out.clear();
+    out.append(prefix);
+    append_integer(out, amount);
+    out.append(R"(,"price":)");
+    append_number(out, price);
+    out.append(R"(},"id":)");
+    append_integer(out, id);
+    out.push_back('}');
+}
+
+// {"jsonrpc":"2.0","method":"private/edit","params":{"order_id":"X","amount":A,"price":P},"id":N}
+void OrderEncoder::encode_edit(std::string& out, int id, std::string_view order_id, double amount, double price) {
+    out.clear();
+    out.append(R"({"jsonrpc":"2.0","method":"private/edit","params":{"order_id":")");
+    append_escaped(out, order_id);
+    out.append(R"(","amount":)");
+    append_number(out, amount);
+    out.append(R"(,"price":)");
+    append_number(out, price);
+    out.append(R"(},"id":)");
+    append_integer(out, id);
+    out.push_back('}');
+}
+
+// {"jsonrpc":"2.0","method":"private/cancel","params":{"order_id":"X"},"id":N}
+void OrderEncoder::encode_cancel(std::string& out, int id, std::string_view order_id) {
+    out.clear();
+    out.append(R"({"jsonrpc":"2.0","method":"private/cancel","params":{"order_id":")");
+    append_escaped(out, order_id);
+    out.append(R"("},"id":)");
+    append_integer(out, id);
+    out.push_back('}');
+}
+
+// {"jsonrpc":"2.0","method":"private/cancel_all_by_instrument","params":{"instrument_name":"X"},"id":N}
+void OrderEncoder::encode_cancel_instrument(std::string& out, int id, std::string_view instrument) {
+    out.clear();
+    out.append(R"({"jsonrpc":"2.0","method":"private/cancel_all_by_instrument","params":{"instrument_name":")");
+    append_escaped(out, instrument);
+    out.append(R"("},"id":)");
+    append_integer(out, id);
+    out.push_back('}');
+}
+
+// {"jsonrpc":"2.0","method":"private/mass_quote","params":{"quote_id":"Q","mmp_group":"G","quotes":[
+//   {"instrument_name":"X","side":"buy","amount":A,"price":P},...]},"id":N}
+void OrderEncoder::encode_mass_quote(std::string& out, int id, std::string_view quote_id, std::string_view mmp_group,
+                                     const MassQuoteEntry* quotes, std::size_t count) {
+    out.clear();
+    out.append(R"({"jsonrpc":"2.0","method":"private/mass_quote","params":{"quote_id":")");
+    append_escaped(out, quote_id);
+    out.append(R"(","mmp_group":")");
+    append_escaped(out, mmp_group);
+    out.append(R"(","quotes":[)");
+    for (std::size_t i = 0; i < count; ++i) {
+        out.append(i == 0 ? R"({"instrument_name":")" : R"(,{"instrument_name":")");
+        append_escaped(out, quotes[i].instrument);
+        out.append(quotes[i].side == OrderSide::Buy ? R"(","side":"buy","amount":)" : R"(","side":"sell","amount":)");
+        append_number(out, quotes[i].amount);
+        out.append(R"(,"price":)");
+        append_number(out, quotes[i].price);
+        out.push_back('}');
+    }
+    out.append(R"(]},"id":)");
+    append_integer(out, id);
+    out.push_back('}');
+}
@@ -0,0 +1,42 @@
+#ifndef ORDER_ENCODER_HPP
+#define ORDER_ENCODER_HPP
+
+#include <functional>  // std::less<> for heterogeneous lookups
+#include <map>  // Template cache keyed without allocating
+#include <string>  // Output frames and cached templates
+#include <string_view>  // Instrument and order id views
+
+enum class OrderSide { Buy, Sell };  // private/buy or private/sell
+
+// One side of one instrument in a private/mass_quote request
+struct MassQuoteEntry {
+    std::string_view instrument;  // Instrument name
+    OrderSide side;  // Bid or ask
+    double amount;  // Quote size
+    double price;  // Quote price
+};
+
+// Renders order-entry JSON-RPC frames from cached, pre-rendered request templates. Only the
+// id, amount, price and order_id are formatted per call, with std::to_chars, into a caller-owned
+// string whose capacity is reused. Not thread-safe; the owner serializes access.
+class OrderEncoder {
+public:
+    // Pre-render the template for a side/instrument/type so the first order pays nothing extra
+    const std::string& warm(OrderSide side, std::string_view instrument, std::string_view type, bool post_only = false);
+
+    void encode_order(std::string& out, OrderSide side, std::string_view instrument, std::string_view type,
+                      int id, int amount, double price, bool post_only = false);  // private/buy or private/sell
+    void encode_edit(std::string& out, int id, std::string_view order_id, double amount, double price);  // private/edit
+    void encode_cancel(std::string& out, int id, std::string_view order_id);  // private/cancel
+    void encode_cancel_instrument(std::string& out, int id, std::string_view instrument);  // private/cancel_all_by_instrument
+    void encode_mass_quote(std::string& out, int id, std::string_view quote_id, std::string_view mmp_group,
+                           const MassQuoteEntry* quotes, std::size_t count);  // private/mass_quote
+
+private:
+    using TypeTemplates = std::map<std::string, std::string, std::less<>>;  // Order type -> rendered prefix
+    using InstrumentTemplates = std::map<std::string, TypeTemplates, std::less<>>;  // Instrument -> per-type prefixes
+
+    InstrumentTemplates templates_[2][2];  // Indexed by OrderSide, then post_only
+};
+
+#endif
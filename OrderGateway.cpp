@@ -0,0 +1,359 @@
+#include "OrderGateway.hpp"
+#include "JsonFields.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+// Copy a JSON string field into a fixed buffer, empty when absent
+template <std::size_t N>
+static void copy_field(char (&dst)[N], const json::object &obj, std::string_view key) {
+    const auto *field = obj.if_contains(key);
+    if (field && field->is_string()) {
+        copy_symbol(dst, std::string_view(field->as_string().data(), field->as_string().size()));
+    } else {
+        dst[0] = '\0';
+    }
+}
+
+// Prepare the connection objects; nothing touches the network until connect()
+OrderGateway::OrderGateway(const std::string &host, const std::string &port, const std::string &client_id,
+                           const std::string &client_secret)
+    : ws_(ioc_, ctx_), host_(host), port_(port), client_id_(client_id), client_secret_(client_secret) {
+    ctx_.set_default_verify_paths();
+}
+
+// Connect and authenticate synchronously, then arm the read that poll() completes
+void OrderGateway::connect(bool subscribe_orders) {
+    ConnectionBootstrap::instance().connect(ws_, host_, port_, "/ws/api/v2", verify_peer_);
+    json::value auth = request({
+        {"jsonrpc", "2.0"},
+        {"method", "public/auth"},
+        {"params", {
+            {"grant_type", "client_credentials"},
+            {"client_id", client_id_},
+            {"client_secret", client_secret_}
+        }}
+    });
+    if (!auth.as_object().contains("result")) {
+        throw std::runtime_error("Order gateway authentication failed: " + json::serialize(auth));
+    }
+    if (subscribe_orders) {
+        json::value subscribed = request({
+            {"jsonrpc", "2.0"},
+            {"method", "private/subscribe"},
+            {"params", { {"channels", json::array{"user.orders.any.any.raw"}} }}
+        });
+        if (!subscribed.as_object().contains("result")) {
+            std::cerr << "Order gateway: no user.orders updates: " << json::serialize(subscribed) << "\n";
+        }
+    }
+    do_read();
+}
+
+// Write a request and read until its response arrives (connect() only, before the read loop starts)
+json::value OrderGateway::request(const json::value &payload) {
+    json::value message = payload;
+    int id = ++next_id_;
+    message.as_object()["id"] = id;
+    ws_.write(net::buffer(json::serialize(message)));
+    while (true) {
+        beast::flat_buffer buffer;
+        ws_.read(buffer);
+        json::value response = json::parse(beast::buffers_to_string(buffer.data()));
+        const auto *response_id = response.is_object() ? response.as_object().if_contains("id") : nullptr;
+        if (response_id && response_id->is_number() && response_id->to_number<std::int64_t>() == id) {
+            return response;
+        }
+    }
+}
+
+// A written frame's buffer, so encoding reuses its capacity
+std::string OrderGateway::take_frame() {
+    if (frame_pool_.empty()) {
+        return std::string();
+    }
+    std::string frame = std::move(frame_pool_.back());
+    frame_pool_.pop_back();
+    return frame;
+}
+
+// Buy from cached templates
+int OrderGateway::buy(std::string_view instrument, std::string_view type, int amount, double price, bool post_only) {
+    return send_order(OrderSide::Buy, instrument, type, amount, price, post_only);
+}
+
+// Sell from cached templates
+int OrderGateway::sell(std::string_view instrument, std::string_view type, int amount, double price, bool post_only) {
+    return send_order(OrderSide::Sell, instrument, type, amount, price, post_only);
+}
+
+// Encode a buy or sell into a pooled buffer and send it
+int OrderGateway::send_order(OrderSide side, std::string_view instrument, std::string_view type, int amount, double price,
+                             bool post_only) {
+    int id = ++next_id_;
+    auto instrument_id = instrument_ids_.find(instrument);
+    if (instrument_id == instrument_ids_.end()) {
+        instrument_id = instrument_ids_.emplace(std::string(instrument), InstrumentRegistry::instance().intern(instrument)).first;
+    }
+    OrderCheck check = InstrumentRegistry::instance().check_order(instrument_id->second, type, amount, price);
+    if (check != OrderCheck::Ok) {
+        reject_locally(id, instrument, amount, price, -32602);  // Invalid params, as the exchange would answer
+        return id;
+    }
+    if (RiskEngine::instance().check_order(instrument_id->second, side, type, amount, price) != RiskCheck::Ok) {
+        reject_locally(id, instrument, amount, price, -32000);
+        return id;
+    }
+    std::string frame = take_frame();
+    try {
+        encoder_.encode_order(frame, side, instrument, type, id, amount, price, post_only);
+    } catch (const std::invalid_argument &) {
+        RiskEngine::instance().release(instrument_id->second, side, amount);  // Never sent
+        frame.clear();
+        frame_pool_.push_back(std::move(frame));
+        reject_locally(id, instrument, amount, price, -32602);
+        return id;
+    }
+    return send(frame, id, Pending{0, instrument_id->second, side, static_cast<double>(amount)});
+}
+
+// An order that failed local validation: nothing is sent, and the rejection reaches the listener from
+// the next poll() so callbacks are never re-entered from inside buy()/sell()
+void OrderGateway::reject_locally(int id, std::string_view instrument, double amount, double price, int error_code) {
+    OrderUpdate rejected{};
+    rejected.request_id = id;
+    rejected.error_code = error_code;
+    copy_symbol(rejected.instrument, instrument);
+    copy_symbol(rejected.state, "rejected");
+    rejected.price = price;
+    rejected.amount = amount;
+    net::post(ioc_, [this, rejected]() {
+        if (listener_) {
+            listener_->on_order_update(rejected);
+        }
+    });
+}
+
+// Change the amount and price of an open order. The edit passes the same limits as a new order; the
+// instrument, side and current amount come from the risk engine's view of the order.
+int OrderGateway::edit(std::string_view order_id, double amount, double price) {
+    int id = ++next_id_;
+    InstrumentId instrument = kNoInstrument;
+    OrderSide side = OrderSide::Buy;
+    double previous_amount = 0;
+    RiskEngine::instance().find_order(order_id, instrument, side, previous_amount);  // Unknown orders: limits only
+    if (RiskEngine::instance().check_edit(instrument, side, previous_amount, amount, price) != RiskCheck::Ok) {
+        reject_locally(id, std::string_view(), amount, price, -32000);
+        return id;
+    }
+    Pending pending{0, instrument, side, amount, true, previous_amount};
+    std::string frame = take_frame();
+    try {
+        encoder_.encode_edit(frame, id, order_id, amount, price);
+    } catch (const std::invalid_argument &) {
+        settle(pending, false);
+        frame.clear();
+        frame_pool_.push_back(std::move(frame));
+        reject_locally(id, std::string_view(), amount, price, -32602);
+        return id;
+    }
+    return send(frame, id, pending);
+}
+
+// Cancel an open order
+int OrderGateway::cancel(std::string_view order_id) {
+    int id = ++next_id_;
+    RiskEngine::instance().count_cancel();
+    std::string frame = take_frame();
+    encoder_.encode_cancel(frame, id, order_id);
+    return send(frame, id, Pending{});
+}
+
+// Cancel every open order of an instrument with one message
+int OrderGateway::cancel_instrument(std::string_view instrument) {
+    int id = ++next_id_;
+    RiskEngine::instance().count_cancel();
+    std::string frame = take_frame();
+    encoder_.encode_cancel_instrument(frame, id, instrument);
+    return send(frame, id, Pending{});
+}
+
+// Replace quotes on many instruments with one message. Not reserved against position limits: the
+// exchange replaces each instrument side's quote rather than adding orders; the kill switch and the
+// message rate still apply.
+int OrderGateway::mass_quote(std::string_view quote_id, std::string_view mmp_group, const MassQuoteEntry *quotes,
+                             std::size_t count) {
+    int id = ++next_id_;
+    if (RiskEngine::instance().kill_switch() || !RiskEngine::instance().allow_message()) {
+        reject_locally(id, std::string_view(), 0, 0, -32000);
+        return id;
+    }
+    std::string frame = take_frame();
+    encoder_.encode_mass_quote(frame, id, quote_id, mmp_group, quotes, count);
+    return send(frame, id, Pending{});
+}
+
+// A refused request gives its reservation back; an answered edit moves it to the new amount
+void OrderGateway::settle(const Pending &pending, bool accepted) {
+    if (pending.edit) {
+        RiskEngine::instance().finish_edit(pending.instrument, pending.side, pending.previous_amount, pending.amount,
+                                           accepted);
+    } else if (!accepted && pending.amount > 0) {
+        RiskEngine::instance().release(pending.instrument, pending.side, pending.amount);
+    }
+}
+
+// Register the request and start the write now: the TLS record is built and sent from this call when
+// no other write is in progress. Tick-to-trade is measured here, from the triggering event's receipt.
+int OrderGateway::send(std::string &frame, int id, Pending pending) {
+    pending.sent_ticks = TscClock::now();
+    pending_.emplace(id, pending);
+    write_queue_.push_back(std::move(frame));
+    if (write_queue_.size() == 1) {
+        do_write();
+    }
+    if (trigger_ns_ != 0) {
+        tick_to_trade_.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, ClockSync::now_ns() - trigger_ns_)));
+    }
+    return id;
+}
+
+// Write the head of the queue; the next one starts when it completes (inside poll())
+void OrderGateway::do_write() {
+    ws_.async_write(net::buffer(write_queue_.front()), [this](beast::error_code ec, std::size_t) {
+        if (ec) {
+            std::cerr << "Order gateway write error: " << ec.message() << "\n";
+        }
+        frame_pool_.push_back(std::move(write_queue_.front()));
+        frame_pool_.back().clear();
+        write_queue_.pop_front();
+        if (ec) {
+            for (std::string &frame : write_queue_) {  // Never going out on this connection
+                frame.clear();
+                frame_pool_.push_back(std::move(frame));
+            }
+            write_queue_.clear();
+            fail_pending();
+        } else if (!write_queue_.empty()) {
+            do_write();
+        }
+    });
+}
+
+// The connection broke: give back every reservation and report each outstanding request as rejected
+void OrderGateway::fail_pending() {
+    std::unordered_map<int, Pending> failed_requests;
+    failed_requests.swap(pending_);  // The listener may send new orders from its callback
+    for (const auto &[id, pending] : failed_requests) {
+        settle(pending, false);
+        OrderUpdate failed{};
+        failed.request_id = id;
+        failed.error_code = -32000;
+        copy_symbol(failed.state, "rejected");
+        if (listener_) {
+            listener_->on_order_update(failed);
+        }
+    }
+}
+
+// Run whatever completions are ready without blocking
+void OrderGateway::poll() {
+    ioc_.poll();
+    if (ioc_.stopped()) {
+        ioc_.restart();  // poll() stops the context when it runs out of work; the read keeps it busy again
+    }
+}
+
+// Arm the next read
+void OrderGateway::do_read() {
+    ws_.async_read(read_buffer_, [this](beast::error_code ec, std::size_t) { on_read(ec); });
+}
+
+// Route a response to its request, or a user.orders notification to the listener
+void OrderGateway::on_read(beast::error_code ec) {
+    if (ec) {
+        std::cerr << "Order gateway read error: " << ec.message() << "\n";
+        fail_pending();
+        return;
+    }
+    std::uint64_t received = TscClock::now();
+    boost::system::error_code parse_error;
+    json::value message = json::parse(
+        json::string_view(static_cast<const char *>(read_buffer_.cdata().data()), read_buffer_.size()), parse_error);
+    read_buffer_.consume(read_buffer_.size());
+
+    if (const auto *obj = parse_error ? nullptr : message.if_object()) {
+        const auto *id = obj->if_contains("id");
+        if (id && id->is_number()) {
+            auto it = pending_.find(static_cast<int>(id->to_number<std::int64_t>()));
+            if (it != pending_.end()) {
+                int request_id = it->first;
+                Pending pending = it->second;
+                std::uint64_t sent_ticks = pending.sent_ticks;
+                pending_.erase(it);
+                round_trip_.record(TscClock::to_ns(received - sent_ticks));
+                const auto *result = obj->if_contains("result");
+                if (result) {
+                    settle(pending, true);
+                }
+                if (result && result->is_object()) {
+                    const auto &result_obj = result->as_object();
+                    const auto *order = result_obj.if_contains("order");
+                    deliver(order && order->is_object() ? order->as_object() : result_obj, request_id, sent_ticks);  // cancel returns the order itself
+                } else if (result) {
+                    deliver(json::object(), request_id, sent_ticks);  // cancel_all_by_instrument answers with a count
+                } else {
+                    settle(pending, false);
+                    if (listener_) {
+                        OrderUpdate rejected{};
+                        rejected.request_id = request_id;
+                        const auto *error = obj->if_contains("error");
+                        if (error && error->is_object()) {
+                            rejected.error_code = static_cast<int>(number_or(error->as_object(), "code"));
+                        }
+                        copy_symbol(rejected.state, "rejected");
+                        rejected.round_trip_ns = static_cast<std::int64_t>(TscClock::to_ns(received - sent_ticks));
+                        listener_->on_order_update(rejected);
+                    }
+                }
+            }
+        } else if (const auto *params = obj->if_contains("params"); params && params->is_object()) {
+            const auto *data = params->as_object().if_contains("data");
+            if (data && data->is_object()) {
+                deliver(data->as_object(), 0, 0);
+            } else if (data && data->is_array()) {
+                for (const auto &order : data->as_array()) {
+                    if (order.is_object()) {
+                        deliver(order.as_object(), 0, 0);
+                    }
+                }
+            }
+        }
+    }
+    do_read();
+}
+
+// Fill an OrderUpdate from a Deribit order object and hand it to the listener
+void OrderGateway::deliver(const json::object &order, int request_id, std::uint64_t sent_ticks) {
+    RiskEngine::instance().on_order(order);  // Fills and final states, before the listener sees them
+    if (!listener_) {
+        return;
+    }
+    OrderUpdate update{};
+    update.request_id = request_id;
+    update.ok = true;
+    copy_field(update.order_id, order, "order_id");
+    copy_field(update.instrument, order, "instrument_name");
+    copy_field(update.state, order, "order_state");
+    const auto *direction = order.if_contains("direction");
+    update.buy = direction && direction->is_string() && direction->as_string() == "buy";
+    update.price = number_or(order, "price");
+    update.amount = number_or(order, "amount");
+    update.filled_amount = number_or(order, "filled_amount");
+    if (sent_ticks != 0) {
+        update.round_trip_ns = static_cast<std::int64_t>(TscClock::to_ns(TscClock::now() - sent_ticks));
+    }
+    listener_->on_order_update(update);
+}
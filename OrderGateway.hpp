@@ -0,0 +1,101 @@
+#ifndef ORDER_GATEWAY_HPP
+#define ORDER_GATEWAY_HPP
+
+#include <boost/asio.hpp>  // Private io_context
+#include <boost/beast.hpp>  // WebSocket stream and buffers
+#include <boost/beast/ssl.hpp>  // TLS stream
+#include <boost/json.hpp>  // Responses and notifications
+#include <cstdint>  // Timestamps
+#include <deque>  // Frames waiting behind an in-flight write
+#include <map>  // Instrument -> registry id
+#include <string>  // Credentials and frames
+#include <string_view>  // Instrument and order id views
+#include <unordered_map>  // Requests awaiting a response
+#include <vector>  // Reusable frame buffers
+#include "ConnectionBootstrap.hpp"  // Cached DNS and TLS session resumption
+#include "OrderEncoder.hpp"  // Pre-rendered order-entry frames
+#include "LatencyStats.hpp"  // Tick-to-trade and order round-trip histograms
+#include "Strategy.hpp"  // OrderUpdate and the listener
+#include "ClockSync.hpp"  // Wall clock shared with receive_ns
+#include "InstrumentRegistry.hpp"  // Pre-trade checks against instrument reference data
+#include "RiskEngine.hpp"  // Pre-trade risk gate and fill tracking
+
+namespace beast = boost::beast;  // Alias for Boost.Beast library
+namespace websocket = beast::websocket;  // Alias for WebSocket functionalities in Beast
+namespace net = boost::asio;  // Alias for Boost.Asio library
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+// Order entry for strategies: its own authenticated connection whose io_context is driven by poll() on
+// the thread that runs the strategy (the feed consumer). Nothing is shared with another thread, so
+// buy/sell/edit/cancel encode from cached templates and start the socket write inline with no lock and
+// no hand-off. Unlike DeribitClient this class is single-threaded by design.
+class OrderGateway {
+public:
+    OrderGateway(const std::string &host, const std::string &port, const std::string &client_id,
+                 const std::string &client_secret);
+    OrderGateway(const OrderGateway &) = delete;
+    OrderGateway &operator=(const OrderGateway &) = delete;
+
+    void set_verify_peer(bool verify) { verify_peer_ = verify; }  // Disable only for self-signed test servers; call before connect()
+    void set_listener(Strategy *listener) { listener_ = listener; }  // Receiver of order updates
+    void connect(bool subscribe_orders = true);  // Blocking: TLS, WebSocket, public/auth and optionally user.orders.any.any.raw
+
+    // Owning thread only. Each returns the request id reported back in OrderUpdate::request_id, and the
+    // frame has been handed to the socket (or queued behind a write still in progress) when it returns.
+    int buy(std::string_view instrument, std::string_view type, int amount, double price, bool post_only = false);
+    int sell(std::string_view instrument, std::string_view type, int amount, double price, bool post_only = false);
+    int edit(std::string_view order_id, double amount, double price);
+    int cancel(std::string_view order_id);
+    int cancel_instrument(std::string_view instrument);  // private/cancel_all_by_instrument: every open order of the instrument
+    int mass_quote(std::string_view quote_id, std::string_view mmp_group, const MassQuoteEntry *quotes,
+                   std::size_t count);  // private/mass_quote (market-maker accounts with an MMP group)
+    void warm(OrderSide side, std::string_view instrument, std::string_view type, bool post_only = false) {
+        encoder_.warm(side, instrument, type, post_only);
+    }  // Pre-render a template
+
+    void poll();  // Run ready completions: written frames, responses and notifications (owning thread)
+    void set_trigger(std::int64_t receive_ns) { trigger_ns_ = receive_ns; }  // Receive time of the event being handled, 0 for none
+    std::size_t in_flight() const { return pending_.size(); }  // Requests without a response yet
+
+private:
+    struct Pending {
+        std::uint64_t sent_ticks;  // TscClock when the frame was handed to the socket
+        InstrumentId instrument;  // New orders: risk reservation to give back on rejection
+        OrderSide side;
+        double amount;  // New orders and edits: the amount requested; 0 for cancels
+        bool edit = false;  // An edit, whose reservation is settled with RiskEngine::finish_edit()
+        double previous_amount = 0;  // Edits: the order's amount before the edit
+    };
+
+    int send_order(OrderSide side, std::string_view instrument, std::string_view type, int amount, double price,
+                   bool post_only);  // buy/sell body
+    void reject_locally(int id, std::string_view instrument, double amount, double price, int error_code);  // Report a failed pre-trade check
+    void settle(const Pending &pending, bool accepted);  // Give back or adjust the request's risk reservation
+    std::string take_frame();  // Pooled buffer for the next frame
+    int send(std::string &frame, int id, Pending pending);  // Register, write inline and record tick-to-trade
+    void do_write();  // Start writing the head of the queue; a failed write fails everything queued and pending
+    void fail_pending();  // Release and reject every request awaiting a response
+    void do_read();  // Arm the next read
+    void on_read(beast::error_code ec);  // Turn a frame into OrderUpdates
+    void deliver(const json::object &order, int request_id, std::uint64_t sent_ticks);  // Fill and hand over one update
+    json::value request(const json::value &payload);  // Blocking request used while connecting
+
+    net::io_context ioc_;  // Driven by poll() once connected
+    net::ssl::context ctx_{net::ssl::context::tlsv12_client};  // TLS context for this connection
+    SecureWebSocket ws_;  // Order-entry connection
+    std::string host_, port_, client_id_, client_secret_;  // Connection details
+    bool verify_peer_ = true;  // Certificate and host-name verification
+    int next_id_ = 0;  // JSON-RPC ids
+    Strategy *listener_ = nullptr;  // Receives order updates
+    OrderEncoder encoder_;  // Order-entry templates
+    std::unordered_map<int, Pending> pending_;  // Requests awaiting a response
+    std::map<std::string, InstrumentId, std::less<>> instrument_ids_;  // Registry ids of traded instruments, so checks take no lock
+    std::deque<std::string> write_queue_;  // Frames to write, the one being written first
+    std::vector<std::string> frame_pool_;  // Buffers of written frames, reused by the encoder
+    beast::flat_buffer read_buffer_;  // Receive buffer reused across frames
+    std::int64_t trigger_ns_ = 0;  // Receive time of the event being handled
+    LatencyHistogram &tick_to_trade_ = LatencyRegistry::instance().histogram("strategy.tick_to_trade");  // Event received -> order on the socket
+    LatencyHistogram &round_trip_ = LatencyRegistry::instance().histogram("strategy.order_round_trip");  // Order on the socket -> response read
+};
+
+#endif
@@ -0,0 +1,461 @@
+#include "QuoteEngine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t kMaxLevels = 64;  // Slots per side tracked in one bit mask
+constexpr int kOrderNotFound = 10004;  // Deribit error code for an order that no longer exists
+
+// True for order states that end an order
+bool is_final(const char *state) {
+    return std::strcmp(state, "filled") == 0 || std::strcmp(state, "cancelled") == 0 ||
+           std::strcmp(state, "rejected") == 0;
+}
+
+// True for order states that leave an order resting
+bool is_resting(const char *state) {
+    return std::strcmp(state, "open") == 0 || std::strcmp(state, "untriggered") == 0;
+}
+
+}  // namespace
+
+// Bind to a connected gateway; nothing is sent until the first set_quotes()
+QuoteEngine::QuoteEngine(OrderGateway &gateway, QuoteConfig config) : gateway_(gateway), config_(std::move(config)) {
+    config_.levels = std::clamp<std::size_t>(config_.levels, 1, kMaxLevels);
+    if (config_.mass_quote) {
+        config_.levels = 1;  // A mass quote carries one bid and one ask per instrument
+    }
+}
+
+// Quotes of an instrument, created with empty slots on first use
+QuoteEngine::InstrumentQuotes &QuoteEngine::quotes_for(std::string_view instrument) {
+    auto it = instruments_.find(instrument);
+    if (it == instruments_.end()) {
+        auto quotes = std::make_unique<InstrumentQuotes>();
+        quotes->name = std::string(instrument);
+        for (Side &side : quotes->sides) {
+            side.slots.resize(config_.levels);
+        }
+        gateway_.warm(OrderSide::Buy, instrument, "limit", config_.post_only);
+        gateway_.warm(OrderSide::Sell, instrument, "limit", config_.post_only);
+        it = instruments_.emplace(std::string(instrument), std::move(quotes)).first;
+    }
+    return *it->second;
+}
+
+// Replace the desired ladder; levels past config_.levels or with no amount are dropped
+void QuoteEngine::set_quotes(std::string_view instrument, const QuoteLevel *bids, std::size_t bid_count,
+                             const QuoteLevel *asks, std::size_t ask_count) {
+    InstrumentQuotes &quotes = quotes_for(instrument);
+    const QuoteLevel *levels[2] = {bids, asks};
+    std::size_t counts[2] = {bid_count, ask_count};
+    for (int side = 0; side < 2; ++side) {
+        std::vector<QuoteLevel> &desired = quotes.sides[side].desired;
+        desired.clear();
+        for (std::size_t i = 0; i < counts[side] && desired.size() < config_.levels; ++i) {
+            if (levels[side][i].amount > 0 && std::isfinite(levels[side][i].price)) {
+                desired.push_back(levels[side][i]);
+            }
+        }
+    }
+    if (config_.mass_quote) {
+        if (!quotes.mass_pending) {
+            quotes.mass_pending = true;
+            mass_queue_.push_back(&quotes);
+        }
+        return;
+    }
+    diff(quotes);
+}
+
+// One level per side
+void QuoteEngine::set_quote(std::string_view instrument, double bid_price, int bid_amount, double ask_price,
+                            int ask_amount) {
+    QuoteLevel bid{bid_price, bid_amount};
+    QuoteLevel ask{ask_price, ask_amount};
+    set_quotes(instrument, &bid, 1, &ask, 1);
+}
+
+// Cancel every quote of the instrument
+void QuoteEngine::pull(std::string_view instrument) {
+    set_quotes(instrument, nullptr, 0, nullptr, 0);
+}
+
+// Cancel every quote
+void QuoteEngine::pull_all() {
+    for (auto &[name, quotes] : instruments_) {
+        pull(name);
+    }
+    flush();
+}
+
+// Prices equal within the configured tolerance
+bool QuoteEngine::within(double a, double b) const {
+    return std::fabs(a - b) <= config_.price_tolerance + 1e-12 * std::max(std::fabs(a), std::fabs(b));
+}
+
+// Pulling more than one live quote costs a single instrument cancel, provided none is mid-flight
+// (a new order still in flight would survive the cancel)
+void QuoteEngine::diff(InstrumentQuotes &quotes) {
+    if (config_.cancel_by_instrument && quotes.sides[0].desired.empty() && quotes.sides[1].desired.empty()) {
+        std::size_t live = 0;
+        bool busy = false;
+        for (const Side &side : quotes.sides) {
+            for (const Slot &slot : side.slots) {
+                live += slot.state == SlotState::Live;
+                busy |= slot.state == SlotState::PendingNew || slot.state == SlotState::PendingEdit;
+            }
+        }
+        if (live >= 2 && !busy) {
+            int id = gateway_.cancel_instrument(quotes.name);
+            ++stats_.instrument_cancels;
+            for (Side &side : quotes.sides) {
+                for (Slot &slot : side.slots) {
+                    if (slot.state == SlotState::Live) {
+                        slot.state = SlotState::PendingCancel;
+                        slot.request_id = id;
+                    }
+                }
+            }
+            requests_[id] = SlotRef{&quotes, OrderSide::Buy, kAllSlots};
+            return;
+        }
+    }
+    diff_side(quotes, OrderSide::Buy);
+    diff_side(quotes, OrderSide::Sell);
+}
+
+// Match desired levels to quotes already at (or on their way to) that price, move idle quotes to the
+// remaining levels, fill empty slots, and cancel what is left. Busy slots mark the side dirty.
+void QuoteEngine::diff_side(InstrumentQuotes &quotes, OrderSide side_index) {
+    Side &side = quotes.sides[static_cast<int>(side_index)];
+    bool was_dirty = side.dirty;
+    side.dirty = false;
+    std::uint64_t matched_slots = 0;
+    std::uint64_t matched_levels = 0;
+
+    for (std::size_t level = 0; level < side.desired.size(); ++level) {
+        for (std::size_t i = 0; i < side.slots.size(); ++i) {
+            Slot &slot = side.slots[i];
+            bool targeted = slot.state == SlotState::Live || slot.state == SlotState::PendingNew ||
+                            slot.state == SlotState::PendingEdit;
+            if ((matched_slots >> i & 1) || !targeted || !within(slot.price, side.desired[level].price)) {
+                continue;
+            }
+            matched_slots |= std::uint64_t{1} << i;
+            matched_levels |= std::uint64_t{1} << level;
+            if (slot.amount != side.desired[level].amount) {
+                if (slot.state == SlotState::Live) {
+                    send_edit(quotes, side_index, i, side.desired[level]);
+                } else {
+                    side.dirty = true;
+                }
+            }
+            break;
+        }
+    }
+
+    for (std::size_t level = 0; level < side.desired.size(); ++level) {
+        if (matched_levels >> level & 1) {
+            continue;
+        }
+        std::size_t target = side.slots.size();
+        for (std::size_t i = 0; i < side.slots.size(); ++i) {
+            if (!(matched_slots >> i & 1) && side.slots[i].state == SlotState::Live) {
+                target = i;
+                break;
+            }
+        }
+        if (target == side.slots.size()) {
+            for (std::size_t i = 0; i < side.slots.size(); ++i) {
+                if (!(matched_slots >> i & 1) && side.slots[i].state == SlotState::Empty) {
+                    target = i;
+                    break;
+                }
+            }
+        }
+        if (target == side.slots.size()) {
+            side.dirty = true;  // Every free slot is busy; place this level when one answers
+            continue;
+        }
+        matched_slots |= std::uint64_t{1} << target;
+        if (side.slots[target].state == SlotState::Live) {
+            send_edit(quotes, side_index, target, side.desired[level]);
+        } else {
+            send_new(quotes, side_index, target, side.desired[level]);
+        }
+    }
+
+    for (std::size_t i = 0; i < side.slots.size(); ++i) {
+        if (matched_slots >> i & 1) {
+            continue;
+        }
+        if (side.slots[i].state == SlotState::Live) {
+            send_cancel(quotes, side_index, i);
+        } else if (side.slots[i].state == SlotState::PendingNew || side.slots[i].state == SlotState::PendingEdit) {
+            side.dirty = true;  // Cancel it once it is acknowledged
+        }
+    }
+    if (side.dirty && !was_dirty) {
+        ++stats_.coalesced;
+    }
+}
+
+// Place a new quote in an empty slot
+void QuoteEngine::send_new(InstrumentQuotes &quotes, OrderSide side, std::size_t index, const QuoteLevel &level) {
+    Slot &slot = quotes.sides[static_cast<int>(side)].slots[index];
+    slot.request_id = side == OrderSide::Buy
+        ? gateway_.buy(quotes.name, "limit", level.amount, level.price, config_.post_only)
+        : gateway_.sell(quotes.name, "limit", level.amount, level.price, config_.post_only);
+    slot.state = SlotState::PendingNew;
+    slot.price = level.price;
+    slot.amount = level.amount;
+    slot.filled = 0;
+    requests_[slot.request_id] = SlotRef{&quotes, side, index};
+    ++stats_.new_orders;
+}
+
+// Move a live quote; private/edit takes the total amount, so what already filled is added back
+void QuoteEngine::send_edit(InstrumentQuotes &quotes, OrderSide side, std::size_t index, const QuoteLevel &level) {
+    Slot &slot = quotes.sides[static_cast<int>(side)].slots[index];
+    slot.request_id = gateway_.edit(slot.order_id, slot.filled + level.amount, level.price);
+    slot.state = SlotState::PendingEdit;
+    slot.live_price = slot.price;
+    slot.live_amount = slot.amount;
+    slot.price = level.price;
+    slot.amount = level.amount;
+    requests_[slot.request_id] = SlotRef{&quotes, side, index};
+    ++stats_.edits;
+}
+
+// Cancel a live quote
+void QuoteEngine::send_cancel(InstrumentQuotes &quotes, OrderSide side, std::size_t index) {
+    Slot &slot = quotes.sides[static_cast<int>(side)].slots[index];
+    slot.request_id = gateway_.cancel(slot.order_id);
+    slot.state = SlotState::PendingCancel;
+    requests_[slot.request_id] = SlotRef{&quotes, side, index};
+    ++stats_.cancels;
+}
+
+// Back to an empty slot
+void QuoteEngine::forget(Slot &slot) {
+    if (!slot.order_id.empty()) {
+        orders_.erase(slot.order_id);
+    }
+    slot = Slot();
+}
+
+// An edit or cancel was refused (locally, rate-limited, post-only, ...) but the order is still resting:
+// keep tracking it at its previous price and amount, and converge again on the next diff
+void QuoteEngine::restore(InstrumentQuotes &quotes, OrderSide side, Slot &slot) {
+    if (slot.state == SlotState::PendingEdit) {
+        slot.price = slot.live_price;
+        slot.amount = slot.live_amount;
+    }
+    slot.state = SlotState::Live;
+    slot.request_id = 0;
+    quotes.sides[static_cast<int>(side)].dirty = true;
+}
+
+// Apply the response to a slot's message. A slot is only forgotten once its order is known to be gone:
+// a final state (in the response or notified while it was pending), a rejected new order, or "order not found".
+void QuoteEngine::finish(InstrumentQuotes &quotes, OrderSide side, Slot &slot, const OrderUpdate &update) {
+    if (slot.ended) {
+        forget(slot);  // Filled or cancelled under the message, whatever the response says
+        return;
+    }
+    bool gone = update.ok ? is_final(update.state) : update.error_code == kOrderNotFound;
+    switch (slot.state) {
+    case SlotState::PendingNew:
+    case SlotState::PendingEdit:
+        if (slot.state == SlotState::PendingEdit && !update.ok && !gone) {
+            restore(quotes, side, slot);
+        } else if (update.ok && (is_resting(update.state) || update.state[0] == '\0')) {
+            if (update.order_id[0] != '\0' && slot.order_id != update.order_id) {
+                if (!slot.order_id.empty()) {
+                    orders_.erase(slot.order_id);
+                }
+                slot.order_id = update.order_id;
+                std::size_t index = static_cast<std::size_t>(&slot - quotes.sides[static_cast<int>(side)].slots.data());
+                orders_[slot.order_id] = SlotRef{&quotes, side, index};
+            }
+            if (update.amount > 0) {
+                slot.filled = update.filled_amount;
+                slot.amount = static_cast<int>(update.amount - update.filled_amount);
+                slot.price = update.price;
+            }
+            slot.state = SlotState::Live;
+            slot.request_id = 0;
+        } else {
+            forget(slot);  // Rejected, or filled or cancelled before it could rest
+        }
+        break;
+    case SlotState::PendingCancel:
+        if (update.ok || gone) {
+            forget(slot);  // Cancelled, or already gone
+        } else {
+            restore(quotes, side, slot);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// Responses are matched by request id, notifications by order id (or, for mass quotes, by instrument and side)
+bool QuoteEngine::on_order_update(const OrderUpdate &update) {
+    if (update.request_id != 0) {
+        auto request = requests_.find(update.request_id);
+        if (request == requests_.end()) {
+            return false;
+        }
+        SlotRef ref = request->second;
+        requests_.erase(request);
+        if (!update.ok) {
+            ++stats_.rejected;
+        }
+        if (ref.slot != kAllSlots) {
+            finish(*ref.instrument, ref.side, ref.instrument->sides[static_cast<int>(ref.side)].slots[ref.slot], update);
+            Side &side = ref.instrument->sides[static_cast<int>(ref.side)];
+            if (side.dirty && update.ok) {  // After a refusal, retry on the next set_quotes() rather than in a loop
+                diff_side(*ref.instrument, ref.side);
+            }
+            return true;
+        }
+        for (auto &[name, quotes] : instruments_) {  // Instrument cancel or mass quote: every slot it covered
+            if (ref.instrument && ref.instrument != quotes.get()) {
+                continue;
+            }
+            bool touched = false;
+            for (int side = 0; side < 2; ++side) {
+                for (Slot &slot : quotes->sides[side].slots) {
+                    if (slot.request_id == update.request_id) {
+                        finish(*quotes, static_cast<OrderSide>(side), slot, update);
+                        touched = true;
+                    }
+                }
+            }
+            if (touched && update.ok && !config_.mass_quote && (quotes->sides[0].dirty || quotes->sides[1].dirty)) {
+                diff(*quotes);
+            } else if (touched && config_.mass_quote && !quotes->mass_pending &&
+                       (quotes->sides[0].dirty || quotes->sides[1].dirty)) {
+                quotes->mass_pending = true;  // Changed while the mass quote was in flight
+                mass_queue_.push_back(quotes.get());
+            }
+        }
+        return true;
+    }
+
+    Slot *slot = nullptr;
+    auto order = orders_.find(update.order_id);
+    if (order != orders_.end()) {
+        slot = &order->second.instrument->sides[static_cast<int>(order->second.side)].slots[order->second.slot];
+    } else if (config_.mass_quote) {
+        auto instrument = instruments_.find(std::string_view(update.instrument));
+        if (instrument != instruments_.end()) {
+            OrderSide side = update.buy ? OrderSide::Buy : OrderSide::Sell;
+            slot = &instrument->second->sides[static_cast<int>(side)].slots[0];
+            if (slot->state == SlotState::Live && slot->order_id.empty() && update.order_id[0] != '\0') {
+                slot->order_id = update.order_id;
+                orders_[slot->order_id] = SlotRef{instrument->second.get(), side, 0};
+            }
+        }
+    }
+    if (!slot) {
+        return false;
+    }
+    if (slot->state != SlotState::Live) {
+        if (is_final(update.state) && !slot->order_id.empty() && slot->order_id == update.order_id) {
+            slot->ended = true;  // Settled by its response, which must not bring the order back
+        }
+        return true;
+    }
+    if (is_final(update.state)) {
+        forget(*slot);  // Filled or cancelled elsewhere; requoted on the next set_quotes()
+    } else {
+        slot->filled = update.filled_amount;
+        slot->amount = static_cast<int>(update.amount - update.filled_amount);
+    }
+    return true;
+}
+
+// One private/mass_quote for every queued instrument side whose quote differs from its target; pulled
+// instruments are cancelled by instrument
+void QuoteEngine::flush() {
+    if (!config_.mass_quote || mass_queue_.empty()) {
+        return;
+    }
+    mass_entries_.clear();
+    std::vector<std::pair<Slot *, SlotState>> included;
+    for (InstrumentQuotes *quotes : mass_queue_) {
+        quotes->mass_pending = false;
+        bool pulled = quotes->sides[0].desired.empty() && quotes->sides[1].desired.empty();
+        bool busy = false;
+        for (int side = 0; side < 2; ++side) {
+            Side &ladder = quotes->sides[side];
+            Slot &slot = ladder.slots[0];
+            if (slot.state == SlotState::PendingNew || slot.state == SlotState::PendingEdit ||
+                slot.state == SlotState::PendingCancel) {
+                ladder.dirty = true;  // Sent again once the message in flight is answered
+                busy = true;
+                ++stats_.coalesced;
+                continue;
+            }
+            ladder.dirty = false;
+            if (pulled || ladder.desired.empty()) {
+                continue;
+            }
+            const QuoteLevel &level = ladder.desired[0];
+            if (slot.state == SlotState::Live && within(slot.price, level.price) && slot.amount == level.amount) {
+                continue;
+            }
+            mass_entries_.push_back(MassQuoteEntry{quotes->name, static_cast<OrderSide>(side),
+                                                   static_cast<double>(level.amount), level.price});
+            included.emplace_back(&slot, slot.state == SlotState::Live ? SlotState::PendingEdit : SlotState::PendingNew);
+            slot.live_price = slot.price;
+            slot.live_amount = slot.amount;
+            slot.price = level.price;
+            slot.amount = level.amount;
+        }
+        bool live = quotes->sides[0].slots[0].state == SlotState::Live || quotes->sides[1].slots[0].state == SlotState::Live;
+        if (pulled && live && !busy) {
+            int id = gateway_.cancel_instrument(quotes->name);
+            ++stats_.instrument_cancels;
+            for (Side &ladder : quotes->sides) {
+                if (ladder.slots[0].state == SlotState::Live) {
+                    ladder.slots[0].state = SlotState::PendingCancel;
+                    ladder.slots[0].request_id = id;
+                }
+            }
+            requests_[id] = SlotRef{quotes, OrderSide::Buy, kAllSlots};
+        }
+    }
+    mass_queue_.clear();
+    if (mass_entries_.empty()) {
+        return;
+    }
+    std::string quote_id = "gtx-" + std::to_string(++mass_sequence_);
+    int id = gateway_.mass_quote(quote_id, config_.mmp_group, mass_entries_.data(), mass_entries_.size());
+    ++stats_.mass_quotes;
+    for (auto &[slot, state] : included) {
+        slot->state = state;
+        slot->request_id = id;
+    }
+    requests_[id] = SlotRef{nullptr, OrderSide::Buy, kAllSlots};
+}
+
+// Slots with a resting or requested quote
+std::size_t QuoteEngine::live_quotes() const {
+    std::size_t live = 0;
+    for (const auto &[name, quotes] : instruments_) {
+        for (const Side &side : quotes->sides) {
+            for (const Slot &slot : side.slots) {
+                live += slot.state != SlotState::Empty;
+            }
+        }
+    }
+    return live;
+}
@@ -0,0 +1,123 @@
+#ifndef QUOTE_ENGINE_HPP
+#define QUOTE_ENGINE_HPP
+
+#include <cstddef>  // Level counts
+#include <cstdint>  // Statistics
+#include <map>  // Instrument -> quotes without allocating a key
+#include <memory>  // Stable per-instrument state
+#include <string>  // Instrument names and order ids
+#include <string_view>  // Lookups
+#include <unordered_map>  // Request and order id -> slot
+#include <vector>  // Ladders and slots
+#include "OrderGateway.hpp"  // Order entry on the owning thread
+#include "Strategy.hpp"  // OrderUpdate
+
+// One rung of a desired quote ladder; amount 0 means no quote
+struct QuoteLevel {
+    double price;  // Limit price
+    int amount;  // Quote size
+};
+
+struct QuoteConfig {
+    std::size_t levels = 1;  // Ladder depth per side
+    bool post_only = true;  // Quotes never take liquidity
+    double price_tolerance = 0;  // A live quote within this distance of its target is left alone
+    bool cancel_by_instrument = true;  // Pull a whole instrument with one private/cancel_all_by_instrument
+    bool mass_quote = false;  // Send top-of-ladder quotes through private/mass_quote on flush() (needs an MMP group)
+    std::string mmp_group;  // Market-maker protection group for mass quotes
+};
+
+// Messages the engine sent, and the reprices it absorbed
+struct QuoteStats {
+    std::uint64_t new_orders = 0;  // private/buy and private/sell
+    std::uint64_t edits = 0;  // private/edit
+    std::uint64_t cancels = 0;  // private/cancel
+    std::uint64_t instrument_cancels = 0;  // private/cancel_all_by_instrument
+    std::uint64_t mass_quotes = 0;  // private/mass_quote
+    std::uint64_t coalesced = 0;  // Quote updates that found a message in flight and were folded into the next one
+    std::uint64_t rejected = 0;  // Quote messages the exchange (or a local check) refused
+};
+
+// Keeps each instrument's live quotes converging on the desired ladder with the fewest messages.
+// A desired level already covered by a live quote (within price_tolerance) costs nothing; otherwise
+// an idle live quote is edited, an empty slot gets a new order, and live quotes no longer wanted are
+// cancelled, by instrument when the whole instrument is pulled. A slot has at most one message in
+// flight: further changes while it waits are coalesced and the slot is re-diffed against the latest
+// target when the response arrives. Owning thread of the gateway only; route every OrderUpdate
+// through on_order_update().
+class QuoteEngine {
+public:
+    explicit QuoteEngine(OrderGateway &gateway, QuoteConfig config = QuoteConfig());
+    QuoteEngine(const QuoteEngine &) = delete;
+    QuoteEngine &operator=(const QuoteEngine &) = delete;
+
+    void set_quotes(std::string_view instrument, const QuoteLevel *bids, std::size_t bid_count, const QuoteLevel *asks,
+                    std::size_t ask_count);  // Replace the desired ladder (best first) and send what differs
+    void set_quote(std::string_view instrument, double bid_price, int bid_amount, double ask_price,
+                   int ask_amount);  // One level per side
+    void pull(std::string_view instrument);  // Cancel every quote of the instrument
+    void pull_all();  // Cancel every quote
+    void flush();  // Send the pending mass quote (mass_quote mode); no-op otherwise
+    bool on_order_update(const OrderUpdate &update);  // Apply a response or notification; false if not a quote's
+
+    const QuoteStats &stats() const { return stats_; }  // Messages so far
+    std::size_t live_quotes() const;  // Slots with a resting or requested quote
+
+private:
+    enum class SlotState : std::uint8_t { Empty, PendingNew, Live, PendingEdit, PendingCancel };
+
+    struct Slot {
+        SlotState state = SlotState::Empty;  // Lifecycle
+        double price = 0;  // Live price, or the price being requested
+        int amount = 0;  // Live (remaining) amount, or the amount being requested
+        double filled = 0;  // Filled part of the live order, added back when editing the total amount
+        double live_price = 0;  // Resting price while an edit is in flight, restored if it is refused
+        int live_amount = 0;  // Resting amount while an edit is in flight, restored if it is refused
+        int request_id = 0;  // Message in flight
+        bool ended = false;  // A final state was notified while the message was in flight
+        std::string order_id;  // Exchange id once live
+    };
+
+    struct Side {
+        std::vector<QuoteLevel> desired;  // Target ladder, best first, amounts > 0
+        std::vector<Slot> slots;  // config_.levels slots
+        bool dirty = false;  // Changed while a slot was busy; re-diff on the next response
+    };
+
+    struct InstrumentQuotes {
+        std::string name;  // Instrument name, referenced by the encoder
+        Side sides[2];  // Indexed by OrderSide
+        bool mass_pending = false;  // Queued for the next mass quote
+    };
+
+    struct SlotRef {
+        InstrumentQuotes *instrument;  // Owner
+        OrderSide side;  // Ladder side
+        std::size_t slot;  // Slot index; kAllSlots for an instrument cancel or mass quote
+    };
+
+    static constexpr std::size_t kAllSlots = static_cast<std::size_t>(-1);
+
+    InstrumentQuotes &quotes_for(std::string_view instrument);  // Created on first use
+    void diff(InstrumentQuotes &quotes);  // Both sides, using an instrument cancel when both are empty
+    void diff_side(InstrumentQuotes &quotes, OrderSide side);  // Converge one side
+    bool within(double a, double b) const;  // Prices equal within price_tolerance
+    void send_new(InstrumentQuotes &quotes, OrderSide side, std::size_t index, const QuoteLevel &level);
+    void send_edit(InstrumentQuotes &quotes, OrderSide side, std::size_t index, const QuoteLevel &level);
+    void send_cancel(InstrumentQuotes &quotes, OrderSide side, std::size_t index);
+    void finish(InstrumentQuotes &quotes, OrderSide side, Slot &slot, const OrderUpdate &update);  // Apply a response to one slot
+    void restore(InstrumentQuotes &quotes, OrderSide side, Slot &slot);  // Refused edit or cancel: the order still rests
+    void forget(Slot &slot);  // Back to Empty, dropping the order id index
+
+    OrderGateway &gateway_;  // Order entry
+    QuoteConfig config_;  // Behaviour
+    QuoteStats stats_;  // Counters
+    std::map<std::string, std::unique_ptr<InstrumentQuotes>, std::less<>> instruments_;  // Name -> quotes
+    std::unordered_map<int, SlotRef> requests_;  // Request id -> slot awaiting its response
+    std::unordered_map<std::string, SlotRef> orders_;  // Order id -> live slot, for notifications
+    std::vector<InstrumentQuotes *> mass_queue_;  // Instruments for the next mass quote
+    std::vector<MassQuoteEntry> mass_entries_;  // Reused by flush()
+    std::uint64_t mass_sequence_ = 0;  // quote_id suffix
+};
+
+#endif
@@ -0,0 +1,56 @@
+#include "RateLimiter.hpp"
+
+#include <algorithm>
+#include <thread>
+
+// Start with full pools, as a freshly connected session does
+RateLimiter::RateLimiter(CreditPool matching, CreditPool non_matching)
+    : matching_{matching, matching.max_credits, std::chrono::steady_clock::now()},
+      non_matching_{non_matching, non_matching.max_credits, std::chrono::steady_clock::now()} {
+}
+
+// Add the credits earned since the last refill, capped at the pool size
+void RateLimiter::refill(Bucket &bucket, std::chrono::steady_clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - bucket.updated).count();
+    bucket.credits = std::min(bucket.limits.max_credits, bucket.credits + elapsed * bucket.limits.refill_per_second);
+    bucket.updated = now;
+}
+
+// Charge one request if the pool can pay for it now
+bool RateLimiter::try_acquire(Pool pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket &b = bucket(pool);
+    refill(b, std::chrono::steady_clock::now());
+    if (b.credits < b.limits.cost) {
+        return false;
+    }
+    b.credits -= b.limits.cost;
+    return true;
+}
+
+// Sleep until the pool has earned enough credits for one request, then charge it
+void RateLimiter::acquire(Pool pool) {
+    while (true) {
+        std::chrono::duration<double> wait;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Bucket &b = bucket(pool);
+            refill(b, std::chrono::steady_clock::now());
+            if (b.credits >= b.limits.cost) {
+                b.credits -= b.limits.cost;
+                return;
+            }
+            wait = std::chrono::duration<double>((b.limits.cost - b.credits) / b.limits.refill_per_second);
+        }
+        std::this_thread::sleep_for(wait);
+    }
+}
+
+// Our model drifted from the exchange's (another session shares the account, or the tier is lower):
+// start again from an empty pool
+void RateLimiter::on_throttled(Pool pool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Bucket &b = bucket(pool);
+    b.credits = 0;
+    b.updated = std::chrono::steady_clock::now();
+}
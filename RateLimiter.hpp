@@ -0,0 +1,46 @@
+#ifndef RATE_LIMITER_HPP
+#define RATE_LIMITER_HPP
+
+#include <chrono>  // Refill clock
+#include <mutex>  // Shared by the sending thread and response handlers
+
+// One Deribit credit pool: each request costs `cost` credits, the pool refills at `refill_per_second`
+// up to `max_credits`. Sustained rate = refill_per_second / cost, burst = max_credits / cost.
+struct CreditPool {
+    double max_credits;  // Pool size
+    double refill_per_second;  // Credits added per second
+    double cost;  // Credits charged per request
+};
+
+// Client-side model of Deribit's two rate-limit pools, so requests are paced before the exchange
+// would answer too_many_requests (10028). Matching-engine requests (buy, sell, edit, cancel) and every
+// other request draw from separate pools. Defaults are the standard account tier.
+class RateLimiter {
+public:
+    enum class Pool { Matching, NonMatching };
+
+    static constexpr CreditPool kDefaultMatching{10000, 2500, 500};  // 5 requests/s, burst 20
+    static constexpr CreditPool kDefaultNonMatching{50000, 10000, 500};  // 20 requests/s, burst 100
+
+    explicit RateLimiter(CreditPool matching = kDefaultMatching, CreditPool non_matching = kDefaultNonMatching);
+
+    void acquire(Pool pool);  // Block until the pool can pay for one request, then charge it
+    bool try_acquire(Pool pool);  // Charge one request if the pool can pay for it now
+    void on_throttled(Pool pool);  // The exchange rejected a request: empty the pool so sending backs off
+
+private:
+    struct Bucket {
+        CreditPool limits;  // Configuration
+        double credits;  // Credits available at `updated`
+        std::chrono::steady_clock::time_point updated;  // Last refill
+    };
+
+    Bucket &bucket(Pool pool) { return pool == Pool::Matching ? matching_ : non_matching_; }
+    static void refill(Bucket &bucket, std::chrono::steady_clock::time_point now);  // Add credits earned since the last refill
+
+    std::mutex mutex_;  // Guards both buckets
+    Bucket matching_;  // Order entry
+    Bucket non_matching_;  // Everything else
+};
+
+#endif
@@ -0,0 +1,476 @@
+#include "RiskEngine.hpp"
+#include "JsonFields.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <time.h>
+
+namespace {
+
+// atomic<double> has no fetch_add before C++20
+void add(std::atomic<double>& value, double delta) {
+    double current = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(current, current + delta, std::memory_order_acq_rel)) {
+    }
+}
+
+// Subtract without going below zero, for releases of orders this process never reserved
+void subtract_clamped(std::atomic<double>& value, double delta) {
+    double current = value.load(std::memory_order_relaxed);
+    while (!value.compare_exchange_weak(current, std::max(0.0, current - delta), std::memory_order_acq_rel)) {
+    }
+}
+
+}  // namespace
+
+// Human-readable reason for a risk rejection
+const char* describe(RiskCheck check) {
+    switch (check) {
+    case RiskCheck::Ok: return "ok";
+    case RiskCheck::KillSwitch: return "kill switch engaged";
+    case RiskCheck::OrderSize: return "order amount above limit";
+    case RiskCheck::Notional: return "order notional above limit";
+    case RiskCheck::Position: return "position limit would be exceeded";
+    case RiskCheck::PriceBand: return "price outside the band around the reference";
+    case RiskCheck::OpenOrders: return "too many open orders";
+    case RiskCheck::MessageRate: return "message rate limit reached";
+    case RiskCheck::InvalidOrder: return "invalid amount or price";
+    case RiskCheck::NoReference: return "no reference price to size the order";
+    }
+    return "risk check failed";
+}
+
+// The shared engine
+RiskEngine& RiskEngine::instance() {
+    static RiskEngine engine;
+    return engine;
+}
+
+// State of an id; the mutex is only taken the first time a chunk of ids is touched
+RiskEngine::InstrumentRisk* RiskEngine::state(InstrumentId id) {
+    if (id == kNoInstrument || id >= kMaxInstruments) {
+        return nullptr;
+    }
+    std::size_t chunk = id / kChunkSize;
+    InstrumentRisk* states = chunks_[chunk].load(std::memory_order_acquire);
+    if (!states) {
+        std::lock_guard<std::mutex> lock(chunks_mutex_);
+        if (!owned_chunks_[chunk]) {
+            owned_chunks_[chunk].reset(new InstrumentRisk[kChunkSize]);
+            chunks_[chunk].store(owned_chunks_[chunk].get(), std::memory_order_release);
+        }
+        states = owned_chunks_[chunk].get();
+    }
+    return &states[id % kChunkSize];
+}
+
+// State of an id, without allocating
+const RiskEngine::InstrumentRisk* RiskEngine::find_state(InstrumentId id) const {
+    if (id == kNoInstrument || id >= kMaxInstruments) {
+        return nullptr;
+    }
+    const InstrumentRisk* states = chunks_[id / kChunkSize].load(std::memory_order_acquire);
+    return states ? &states[id % kChunkSize] : nullptr;
+}
+
+// Count a rejection
+RiskCheck RiskEngine::reject(RiskCheck reason) {
+    rejected_[static_cast<std::size_t>(reason)].value.fetch_add(1, std::memory_order_relaxed);
+    return reason;
+}
+
+// Fixed one-second windows. The thread that moves the window resets the count, so a message racing
+// with the reset may go uncounted: the cap can be overshot by the number of racing senders.
+std::int64_t RiskEngine::count_message() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);  // A few ms of resolution is plenty for one-second windows, at a fraction of rdtsc's cost
+    std::int64_t second = now.tv_sec;
+    std::int64_t window = window_.value.load(std::memory_order_acquire);
+    if (window != second && window_.value.compare_exchange_strong(window, second, std::memory_order_acq_rel)) {
+        messages_.value.store(0, std::memory_order_relaxed);
+    }
+    return messages_.value.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Count one message unless the window is full
+bool RiskEngine::take_message() {
+    std::int64_t cap = max_messages_.value.load(std::memory_order_relaxed);
+    if (cap <= 0) {
+        return true;
+    }
+    if (count_message() >= cap) {
+        messages_.value.fetch_sub(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+// Undo take_message() for an order rejected after it
+void RiskEngine::return_message() {
+    if (max_messages_.value.load(std::memory_order_relaxed) > 0) {
+        messages_.value.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+// Check in order of cost: flag, per-order limits, then the reservations that other orders contend on
+RiskCheck RiskEngine::check_order(InstrumentId id, OrderSide side, std::string_view type, double amount, double price) {
+    if (!(amount > 0) || !std::isfinite(amount) || !std::isfinite(price)) {
+        return reject(RiskCheck::InvalidOrder);  // NaN compares false everywhere below and would pass as a market order
+    }
+    if (kill_switch_.value.load(std::memory_order_acquire)) {
+        return reject(RiskCheck::KillSwitch);
+    }
+    InstrumentRisk* risk = state(id);
+    RiskCheck limits = check_limits(id, risk, type, amount, price);
+    if (limits != RiskCheck::Ok) {
+        return reject(limits);
+    }
+
+    if (!take_message()) {
+        return reject(RiskCheck::MessageRate);
+    }
+    std::int64_t max_open = max_open_orders_.value.load(std::memory_order_relaxed);
+    if (open_orders_.value.fetch_add(1, std::memory_order_acq_rel) >= max_open && max_open > 0) {
+        open_orders_.value.fetch_sub(1, std::memory_order_acq_rel);
+        return_message();
+        return reject(RiskCheck::OpenOrders);
+    }
+    if (!reserve(risk, side, amount)) {
+        open_orders_.value.fetch_sub(1, std::memory_order_acq_rel);
+        return_message();
+        return reject(RiskCheck::Position);
+    }
+    return RiskCheck::Ok;
+}
+
+// An edit is a limit order of new_amount for the size, notional and band checks; only the growth over
+// old_amount needs position headroom, and it has no open-order slot of its own
+RiskCheck RiskEngine::check_edit(InstrumentId id, OrderSide side, double old_amount, double new_amount, double price) {
+    if (!(new_amount > 0) || !std::isfinite(new_amount) || !std::isfinite(price) || !std::isfinite(old_amount)) {
+        return reject(RiskCheck::InvalidOrder);
+    }
+    if (kill_switch_.value.load(std::memory_order_acquire)) {
+        return reject(RiskCheck::KillSwitch);
+    }
+    InstrumentRisk* risk = state(id);
+    RiskCheck limits = check_limits(id, risk, "limit", new_amount, price);
+    if (limits != RiskCheck::Ok) {
+        return reject(limits);
+    }
+    if (!take_message()) {
+        return reject(RiskCheck::MessageRate);
+    }
+    if (new_amount > old_amount && !reserve(risk, side, new_amount - old_amount)) {
+        return_message();
+        return reject(RiskCheck::Position);
+    }
+    return RiskCheck::Ok;
+}
+
+// Settle an edit's reservation: a refused increase gives its headroom back, an accepted decrease frees
+// what the order no longer needs
+void RiskEngine::finish_edit(InstrumentId id, OrderSide side, double old_amount, double new_amount, bool accepted) {
+    double freed = accepted ? old_amount - new_amount : new_amount - old_amount;
+    InstrumentRisk* risk = state(id);
+    if (risk && freed > 0) {
+        subtract_clamped(side == OrderSide::Buy ? risk->pending_buy : risk->pending_sell, freed);
+    }
+}
+
+// Order size, notional and price band against the instrument's reference price
+RiskCheck RiskEngine::check_limits(InstrumentId id, const InstrumentRisk* risk, std::string_view type, double amount,
+                                   double price) {
+    double max_amount = max_order_amount_.value.load(std::memory_order_relaxed);
+    if (max_amount > 0 && amount > max_amount) {
+        return RiskCheck::OrderSize;
+    }
+
+    InstrumentSpec spec{};
+    bool has_spec = InstrumentRegistry::instance().spec(id, spec);
+    bool option = has_spec && spec.kind == InstrumentKind::Option;
+    double mid = risk ? risk->mid.load(std::memory_order_relaxed) : 0.0;
+    double index = risk ? risk->index.load(std::memory_order_relaxed) : 0.0;
+    double reference = (mid > 0 || option) ? mid : index;  // An option's index is its underlying, not its price
+    bool limit = price > 0 && type.find("limit") != std::string_view::npos;
+    double order_price = limit ? price : reference;
+
+    double max_notional = max_order_notional_.value.load(std::memory_order_relaxed);
+    if (max_notional > 0) {
+        double notional = amount * order_price;
+        double sizing_price = order_price;
+        if (has_spec && spec.kind == InstrumentKind::Future &&
+            std::string_view(spec.settlement_currency) == std::string_view(spec.base_currency)) {
+            notional = amount;  // Inverse contracts are sized in USD already
+            sizing_price = 1;
+        } else if (option) {
+            notional = amount * index;  // Options are sized in the underlying
+            sizing_price = index;
+        }
+        if (!(sizing_price > 0)) {
+            return RiskCheck::NoReference;  // A market order before the first mid or index cannot be sized
+        }
+        if (notional > max_notional) {
+            return RiskCheck::Notional;
+        }
+    }
+    double band = price_band_.value.load(std::memory_order_relaxed);
+    if (band > 0 && limit && reference > 0 && std::fabs(price - reference) > band * reference) {
+        return RiskCheck::PriceBand;
+    }
+    return RiskCheck::Ok;
+}
+
+// Add amount to the side's reservation unless the worst-case position would pass max_position
+bool RiskEngine::reserve(InstrumentRisk* risk, OrderSide side, double amount) {
+    if (!risk) {
+        return true;
+    }
+    std::atomic<double>& pending = side == OrderSide::Buy ? risk->pending_buy : risk->pending_sell;
+    double max_position = max_position_.value.load(std::memory_order_relaxed);
+    double reserved = pending.load(std::memory_order_relaxed);
+    do {
+        double position = risk->position.load(std::memory_order_relaxed);
+        double worst = side == OrderSide::Buy ? position + reserved + amount : reserved + amount - position;
+        if (max_position > 0 && worst > max_position) {
+            return false;
+        }
+    } while (!pending.compare_exchange_weak(reserved, reserved + amount, std::memory_order_acq_rel));
+    return true;
+}
+
+// Count a message against the rate; false when over the cap
+bool RiskEngine::allow_message() {
+    if (take_message()) {
+        return true;
+    }
+    reject(RiskCheck::MessageRate);
+    return false;
+}
+
+// Give back an ended order's open-order slot and unfilled reservation
+void RiskEngine::release(InstrumentId id, OrderSide side, double unfilled) {
+    std::int64_t open = open_orders_.value.load(std::memory_order_relaxed);
+    while (open > 0 && !open_orders_.value.compare_exchange_weak(open, open - 1, std::memory_order_acq_rel)) {
+    }
+    if (InstrumentRisk* risk = state(id)) {
+        subtract_clamped(side == OrderSide::Buy ? risk->pending_buy : risk->pending_sell, unfilled);
+    }
+}
+
+// Move a filled amount from the reservation to the position
+void RiskEngine::on_fill(InstrumentId id, OrderSide side, double amount) {
+    if (InstrumentRisk* risk = state(id)) {
+        subtract_clamped(side == OrderSide::Buy ? risk->pending_buy : risk->pending_sell, amount);
+        add(risk->position, side == OrderSide::Buy ? amount : -amount);
+    }
+}
+
+// Position from an exchange snapshot
+void RiskEngine::set_position(InstrumentId id, double position) {
+    if (InstrumentRisk* risk = state(id)) {
+        risk->position.store(position, std::memory_order_relaxed);
+    }
+}
+
+// Latest reference prices
+void RiskEngine::update_reference(InstrumentId id, double mid, double index) {
+    InstrumentRisk* risk = state(id);
+    if (!risk) {
+        return;
+    }
+    if (mid > 0) {
+        risk->mid.store(mid, std::memory_order_relaxed);
+    }
+    if (index > 0) {
+        risk->index.store(index, std::memory_order_relaxed);
+    }
+}
+
+// Reference prices from a decoded event: the book's mid once an update is complete, the ticker's mid
+// and index, and the index carried by trades
+void RiskEngine::on_event(const MarketEvent& event, const OrderBook* book) {
+    switch (event.type) {
+    case EventType::Book: {
+        PriceLevel bid, ask;
+        if (event.book.last_fragment && book && book->top_of_book(bid, ask)) {
+            update_reference(event.instrument_id, (bid.price + ask.price) / 2, 0);
+        }
+        break;
+    }
+    case EventType::Ticker: {
+        const TickerEvent& ticker = event.ticker;
+        bool two_sided = ticker.best_bid_price > 0 && ticker.best_ask_price > 0;
+        update_reference(event.instrument_id, two_sided ? (ticker.best_bid_price + ticker.best_ask_price) / 2 : 0,
+                         ticker.index_price);
+        break;
+    }
+    case EventType::Trade:
+        update_reference(event.instrument_id, 0, event.trade.index_price);
+        break;
+    default:
+        break;
+    }
+}
+
+// Replace every limit; each field is its own atomic, so a check racing with this may mix old and new
+void RiskEngine::set_limits(const RiskLimits& limits) {
+    max_order_amount_.value.store(limits.max_order_amount, std::memory_order_relaxed);
+    max_order_notional_.value.store(limits.max_order_notional, std::memory_order_relaxed);
+    max_position_.value.store(limits.max_position, std::memory_order_relaxed);
+    price_band_.value.store(limits.price_band, std::memory_order_relaxed);
+    max_open_orders_.value.store(limits.max_open_orders, std::memory_order_relaxed);
+    max_messages_.value.store(limits.max_messages_per_second, std::memory_order_relaxed);
+}
+
+// Current limits
+RiskLimits RiskEngine::limits() const {
+    RiskLimits limits;
+    limits.max_order_amount = max_order_amount_.value.load(std::memory_order_relaxed);
+    limits.max_order_notional = max_order_notional_.value.load(std::memory_order_relaxed);
+    limits.max_position = max_position_.value.load(std::memory_order_relaxed);
+    limits.price_band = price_band_.value.load(std::memory_order_relaxed);
+    limits.max_open_orders = max_open_orders_.value.load(std::memory_order_relaxed);
+    limits.max_messages_per_second = max_messages_.value.load(std::memory_order_relaxed);
+    return limits;
+}
+
+// {"max_order_amount": 1000, "price_band": 0.05, ..., "kill_switch": false}; absent fields stay off
+void RiskEngine::load_limits(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open risk limits file " + path);
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    boost::system::error_code ec;
+    json::value parsed = json::parse(contents.str(), ec);
+    if (ec || !parsed.is_object()) {
+        throw std::runtime_error("Risk limits file " + path + " is not a JSON object");
+    }
+    const json::object& fields = parsed.as_object();
+    RiskLimits limits;
+    limits.max_order_amount = number_or(fields, "max_order_amount");
+    limits.max_order_notional = number_or(fields, "max_order_notional");
+    limits.max_position = number_or(fields, "max_position");
+    limits.price_band = number_or(fields, "price_band");
+    limits.max_open_orders = static_cast<std::int64_t>(number_or(fields, "max_open_orders"));
+    limits.max_messages_per_second = static_cast<std::int64_t>(number_or(fields, "max_messages_per_second"));
+    set_limits(limits);
+    const auto* kill = fields.if_contains("kill_switch");
+    set_kill_switch(kill && kill->is_bool() && kill->as_bool());
+}
+
+// Engage or clear the kill switch
+void RiskEngine::set_kill_switch(bool engaged) {
+    kill_switch_.value.store(engaged, std::memory_order_release);
+}
+
+// Filled position of an instrument
+double RiskEngine::position(InstrumentId id) const {
+    const InstrumentRisk* risk = find_state(id);
+    return risk ? risk->position.load(std::memory_order_relaxed) : 0.0;
+}
+
+// Orders rejected for a reason
+std::uint64_t RiskEngine::rejected(RiskCheck reason) const {
+    return rejected_[static_cast<std::size_t>(reason)].value.load(std::memory_order_relaxed);
+}
+
+// Limits, state and rejection counts
+void RiskEngine::report(std::ostream& os) const {
+    RiskLimits current = limits();
+    os << "Kill switch        " << (kill_switch() ? "ENGAGED" : "off") << "\n"
+       << "Open orders        " << open_orders() << " / " << current.max_open_orders << "\n"
+       << "Max order amount   " << current.max_order_amount << "\n"
+       << "Max order notional " << current.max_order_notional << "\n"
+       << "Max position       " << current.max_position << "\n"
+       << "Price band         " << current.price_band * 100 << " %\n"
+       << "Messages / second  " << current.max_messages_per_second << "\n"
+       << "(0 = no limit)\n";
+    for (std::size_t reason = 1; reason < rejected_.size(); ++reason) {
+        std::uint64_t count = rejected(static_cast<RiskCheck>(reason));
+        if (count != 0) {
+            os << "Rejected: " << std::left << std::setw(44) << describe(static_cast<RiskCheck>(reason)) << count << "\n";
+        }
+    }
+}
+
+// Apply new fills and release the rest once the order has ended
+void RiskEngine::on_order(const json::object& order) {
+    std::string_view order_id = string_or_empty(order, "order_id");
+    if (order_id.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(orders_mutex_);
+    auto it = orders_.find(order_id);
+    if (it == orders_.end()) {
+        TrackedOrder tracked{InstrumentRegistry::instance().intern(string_or_empty(order, "instrument_name")),
+                             string_or_empty(order, "direction") == "sell" ? OrderSide::Sell : OrderSide::Buy, 0.0, 0.0,
+                             false, 0};
+        it = orders_.emplace(std::string(order_id), tracked).first;
+    }
+    TrackedOrder& tracked = it->second;
+    auto timestamp = static_cast<std::int64_t>(number_or(order, "last_update_timestamp"));
+    newest_ms_ = std::max(newest_ms_, timestamp);
+    if (tracked.closed) {
+        return;
+    }
+    if (double amount = number_or(order, "amount"); amount > 0) {
+        tracked.amount = amount;
+    }
+    double filled = number_or(order, "filled_amount");
+    if (filled > tracked.filled) {
+        on_fill(tracked.instrument, tracked.side, filled - tracked.filled);
+        tracked.filled = filled;
+    }
+    std::string_view state = string_or_empty(order, "order_state");
+    if (state == "filled" || state == "cancelled" || state == "rejected") {
+        release(tracked.instrument, tracked.side, std::max(0.0, number_or(order, "amount") - filled));
+        tracked.closed = true;
+        tracked.closed_ms = timestamp > 0 ? timestamp : newest_ms_;
+        if (++closed_since_prune_ >= kPruneEvery) {
+            prune();
+        }
+    }
+}
+
+// Forget closed orders older than the retention window, measured on the exchange clock. A final state
+// is only repeated within moments (order response vs user.orders on each connection), so an order
+// closed this long ago will not be seen again.
+void RiskEngine::prune() {
+    closed_since_prune_ = 0;
+    std::int64_t cutoff = newest_ms_ - kRetentionMs;
+    for (auto it = orders_.begin(); it != orders_.end();) {
+        it = it->second.closed && it->second.closed_ms < cutoff ? orders_.erase(it) : std::next(it);
+    }
+}
+
+// Instrument, side and current amount of an order still open, for checking an edit of it
+bool RiskEngine::find_order(std::string_view order_id, InstrumentId& id, OrderSide& side, double& amount) {
+    std::lock_guard<std::mutex> lock(orders_mutex_);
+    auto it = orders_.find(order_id);
+    if (it == orders_.end() || it->second.closed) {
+        return false;
+    }
+    id = it->second.instrument;
+    side = it->second.side;
+    amount = it->second.amount;
+    return true;
+}
+
+// user.orders.* carries one order (raw) or an array (grouped)
+void RiskEngine::on_orders(const json::value& data) {
+    if (data.is_object()) {
+        on_order(data.as_object());
+    } else if (data.is_array()) {
+        for (const auto& order : data.as_array()) {
+            if (order.is_object()) {
+                on_order(order.as_object());
+            }
+        }
+    }
+}
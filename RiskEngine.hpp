@@ -0,0 +1,143 @@
+#ifndef RISK_ENGINE_HPP
+#define RISK_ENGINE_HPP
+
+#include <boost/json.hpp>  // Limits file and order notifications
+#include <array>  // Chunk directory and per-reason counters
+#include <atomic>  // Lock-free limits, counters and per-instrument state
+#include <cstdint>  // Counters and timestamps
+#include <map>  // Order id -> tracked order
+#include <memory>  // Chunk storage
+#include <mutex>  // Chunk allocation
+#include <ostream>  // Status report
+#include <string>  // Order ids and paths
+#include <string_view>  // Order types
+#include "InstrumentRegistry.hpp"  // Instrument ids and reference data
+#include "MarketEvents.hpp"  // Reference prices from the feed
+#include "OrderBook.hpp"  // Top of book for the reference mid
+#include "OrderEncoder.hpp"  // OrderSide
+#include "SpscRing.hpp"  // kCacheLineSize
+
+enum class RiskCheck : std::uint8_t { Ok, KillSwitch, OrderSize, Notional, Position, PriceBand, OpenOrders,
+                                      MessageRate, InvalidOrder, NoReference };  // Pre-trade risk verdicts
+
+const char* describe(RiskCheck check);  // Human-readable reason
+
+// Limits applied to every new order; zero disables a limit
+struct RiskLimits {
+    double max_order_amount = 0;  // Largest single order, in the instrument's amount units
+    double max_order_notional = 0;  // Largest single order in quote currency (USD for inverse contracts)
+    double max_position = 0;  // Largest absolute position per instrument, open orders included
+    double price_band = 0;  // Largest distance of a limit price from the reference, as a fraction of it
+    std::int64_t max_open_orders = 0;  // Orders accepted and not yet filled, cancelled or rejected
+    std::int64_t max_messages_per_second = 0;  // Orders, edits and cancels sent in any one-second window
+};
+
+// Pre-trade risk gate shared by every order path in the process. Each check reads limits and state from
+// cache-line-padded atomics and reserves open-order and position headroom with compare-and-swap, so
+// the order path never takes a lock; only the first sight of an instrument id allocates. Reference
+// prices come from the feed (on_event) or the book notifications of the menu client (update_reference).
+class RiskEngine {
+public:
+    static RiskEngine& instance();  // The shared engine
+    RiskEngine(const RiskEngine&) = delete;
+    RiskEngine& operator=(const RiskEngine&) = delete;
+
+    // Check an order and, when it passes, reserve its open-order slot, position headroom and message.
+    // A market order (price <= 0 or a type without "limit") is banded and sized at the reference price.
+    RiskCheck check_order(InstrumentId id, OrderSide side, std::string_view type, double amount, double price);
+    // Check an edit of an order from old_amount to new_amount at price: kill switch, size, notional and
+    // band as for a new limit order, then reserve the growth in position headroom. Settle the reservation
+    // with finish_edit() once the exchange answers.
+    RiskCheck check_edit(InstrumentId id, OrderSide side, double old_amount, double new_amount, double price);
+    void finish_edit(InstrumentId id, OrderSide side, double old_amount, double new_amount, bool accepted);
+    bool find_order(std::string_view order_id, InstrumentId& id, OrderSide& side, double& amount);  // A live tracked order; false if unknown or ended
+    bool allow_message();  // Count a message (mass quotes) against the rate; false when over the cap
+    void count_cancel() { count_message(); }  // Cancels use up the rate too but are never blocked
+    void release(InstrumentId id, OrderSide side, double unfilled);  // An accepted order ended or was rejected
+    void on_fill(InstrumentId id, OrderSide side, double amount);  // Part of an accepted order filled
+    void set_position(InstrumentId id, double position);  // Position from an exchange snapshot
+
+    // Post-trade: fills and final states from order responses and user.orders notifications. Orders are
+    // tracked by id, so the same state arriving on several connections is counted once.
+    void on_order(const json::object& order);  // One order object
+    void on_orders(const json::value& data);  // A user.orders payload: one order or an array of them
+
+    void update_reference(InstrumentId id, double mid, double index);  // Latest mid and index; 0 leaves a value unchanged
+    void on_event(const MarketEvent& event, const OrderBook* book);  // Reference prices from a decoded event
+
+    void set_limits(const RiskLimits& limits);  // Replace every limit
+    RiskLimits limits() const;  // Current limits
+    void load_limits(const std::string& path);  // Read limits from a JSON file with RiskLimits' field names; throws on errors
+    void set_kill_switch(bool engaged);  // Reject every new order and edit while engaged; cancels still pass
+    bool kill_switch() const { return kill_switch_.value.load(std::memory_order_acquire); }  // Engaged
+
+    std::int64_t open_orders() const { return open_orders_.value.load(std::memory_order_relaxed); }  // Accepted, not yet ended
+    double position(InstrumentId id) const;  // Filled position of an instrument
+    std::uint64_t rejected(RiskCheck reason) const;  // Orders rejected for reason
+    void report(std::ostream& os) const;  // Limits, state and rejection counts
+
+private:
+    RiskEngine() = default;
+
+    static constexpr std::size_t kChunkSize = 256;  // Instruments per lazily allocated chunk
+
+    template <typename T>
+    struct alignas(kCacheLineSize) Padded {
+        std::atomic<T> value{};  // Alone on its cache line
+    };
+
+    struct alignas(kCacheLineSize) InstrumentRisk {
+        std::atomic<double> position{0};  // Filled position, buys positive
+        std::atomic<double> pending_buy{0};  // Unfilled amount of accepted buys
+        std::atomic<double> pending_sell{0};  // Unfilled amount of accepted sells
+        std::atomic<double> mid{0};  // Reference mid, 0 when unknown
+        std::atomic<double> index{0};  // Underlying index, 0 when unknown
+    };
+
+    InstrumentRisk* state(InstrumentId id);  // Per-instrument state, allocated on first use; null for id 0
+    const InstrumentRisk* find_state(InstrumentId id) const;  // Null when never allocated
+    RiskCheck reject(RiskCheck reason);  // Count and return reason
+    RiskCheck check_limits(InstrumentId id, const InstrumentRisk* risk, std::string_view type, double amount,
+                           double price);  // Size, notional and price band; not counted
+    bool reserve(InstrumentRisk* risk, OrderSide side, double amount);  // Position headroom; false past max_position
+    std::int64_t count_message();  // Count one message in the current window; returns the count before it
+    bool take_message();  // count_message() unless the window is full
+    void return_message();  // Undo take_message() for an order rejected after it
+
+    Padded<bool> kill_switch_;  // Set by set_kill_switch()
+    Padded<double> max_order_amount_;  // RiskLimits fields, read on every check
+    Padded<double> max_order_notional_;
+    Padded<double> max_position_;
+    Padded<double> price_band_;
+    Padded<std::int64_t> max_open_orders_;
+    Padded<std::int64_t> max_messages_;
+    Padded<std::int64_t> open_orders_;  // Accepted orders not yet ended
+    Padded<std::int64_t> window_;  // Second the message count belongs to
+    Padded<std::int64_t> messages_;  // Messages sent in window_
+    std::array<Padded<std::uint64_t>, 10> rejected_;  // Per RiskCheck value
+
+    struct TrackedOrder {
+        InstrumentId instrument;  // Registry id
+        OrderSide side;  // Direction
+        double filled;  // filled_amount already applied
+        double amount;  // Latest total amount, the starting point of an edit
+        bool closed;  // Final state seen; kept for kRetentionMs so late duplicates are ignored
+        std::int64_t closed_ms;  // Exchange time of the final state
+    };
+
+    static constexpr std::int64_t kRetentionMs = 10 * 60 * 1000;  // Closed orders are kept this long
+    static constexpr std::size_t kPruneEvery = 1024;  // Closures between pruning passes
+
+    void prune();  // Drop closed orders older than kRetentionMs of exchange time (orders_mutex_ held)
+
+    std::mutex orders_mutex_;  // Guards orders_ (post-trade path only)
+    std::map<std::string, TrackedOrder, std::less<>> orders_;  // Order id -> tracked state
+    std::int64_t newest_ms_ = 0;  // Newest exchange timestamp seen on an order
+    std::size_t closed_since_prune_ = 0;  // Orders closed since the last prune()
+
+    std::mutex chunks_mutex_;  // Guards chunk allocation
+    std::array<std::atomic<InstrumentRisk*>, kMaxInstruments / kChunkSize> chunks_{};  // Id-indexed state
+    std::array<std::unique_ptr<InstrumentRisk[]>, kMaxInstruments / kChunkSize> owned_chunks_;  // Owners of chunks_
+};
+
+#endif
@@ -3,91 +3,509 @@
 
 #include "Rtm_Server.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
 // Constants for WebSocket connection
 const std::string HOST = "test.deribit.com";
 const std::string PORT = "443";
-const std::string TARGET = "/ws/api/v2";
 
-// Constructor to initialize WebSocket context and connection
-Rtm_Server::Rtm_Server() 
-    : ctx(ssl::context::tlsv12_client), ws(ioc, ctx) {}
+static thread_local FeedShard *applying_shard = nullptr;  // Shard whose reader is inside on_event(), for resync_book()
+
+// Instrument (or index name) a channel belongs to: the second dot-separated field, "BTC-PERPETUAL" in
+// "book.BTC-PERPETUAL.100ms". All channels of one instrument land on the same shard.
+static std::string channel_instrument(const std::string &channel) {
+    auto first = channel.find('.');
+    if (first == std::string::npos) {
+        return channel;
+    }
+    auto second = channel.find('.', first + 1);
+    return channel.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1);
+}
+
+// Constructor; the default subscription is the three price indices the feed always streamed
+Rtm_Server::Rtm_Server(std::size_t ring_capacity) 
+    : host(HOST), port(PORT), ring_capacity(ring_capacity) {
+    config.channels = {"deribit_price_index.btc_usd", "deribit_price_index.algo_usd", "deribit_price_index.bch_usd"};
+    order_books.set_resync_handler([this](const std::string &instrument) { resync_book(instrument); });
+}
+
+// Add a subscription channel, e.g. "book.BTC-PERPETUAL.100ms"; call before run()
+void Rtm_Server::add_channel(const std::string &channel) {
+    config.channels.push_back(channel);
+}
+
+// Replace the subscriptions, shard count and CPU pinning; call before run()
+void Rtm_Server::set_feed_config(const FeedConfig &feed_config) {
+    config = feed_config;
+}
+
+// Point the feed at another server, e.g. the local mock used by the benchmarks
+void Rtm_Server::set_endpoint(const std::string &endpoint_host, const std::string &endpoint_port) {
+    host = endpoint_host;
+    port = endpoint_port;
+}
+
+// Set the conflation policy for every channel starting with channel_prefix; book.* is always keep-all
+void Rtm_Server::set_conflation(const std::string &channel_prefix, ConflationPolicy policy) {
+    conflation_rules.emplace_back(channel_prefix, policy);
+}
+
+// Choose how the consumer waits when the rings are empty
+void Rtm_Server::set_wait_mode(WaitMode mode) {
+    wait_mode = mode;
+}
 
-// Callback function to process incoming messages from WebSocket
-void Rtm_Server::on_message(const std::string &message) {
-    std::lock_guard<std::mutex> lock(data_mutex);  // Thread-safe access to shared data
-    json::value msg_json = json::parse(message);
+// Turn certificate verification off only for self-signed test servers such as the benchmark mock
+void Rtm_Server::set_verify_peer(bool verify) {
+    verify_peer = verify;
+}
+
+// Ring counters summed over the shards (high water is the deepest single ring)
+FeedStats Rtm_Server::stats() const {
+    FeedStats total{0, 0, 0, 0};
+    for (const auto &shard : shards) {
+        FeedStats shard_stats = shard->stats();
+        total.published += shard_stats.published;
+        total.dropped += shard_stats.dropped;
+        total.conflated += shard_stats.conflated;
+        total.high_water = std::max(total.high_water, shard_stats.high_water);
+    }
+    return total;
+}
+
+// Wins and duplicates of one redundant leg
+LegStats Rtm_Server::leg_stats(int leg) const {
+    return arbiter ? arbiter->stats(leg) : LegStats{0, 0, 0};
+}
+
+// Share of first arrivals per leg; how far each leg trailed is in the feed.arb.*.behind histograms
+void Rtm_Server::report_legs(std::ostream &os) const {
+    std::uint64_t total = 0;
+    for (int leg = 0; leg < FeedArbiter::kLegs; ++leg) {
+        total += leg_stats(leg).wins;
+    }
+    for (int leg = 0; leg < FeedArbiter::kLegs; ++leg) {
+        LegStats stats = leg_stats(leg);
+        LatencyHistogram &behind = LatencyRegistry::instance().histogram(
+            std::string("feed.arb.") + FeedArbiter::leg_name(leg) + ".behind");
+        os << "Leg " << FeedArbiter::leg_name(leg) << ": first " << stats.wins << " ("
+           << std::fixed << std::setprecision(1) << (total ? 100.0 * stats.wins / total : 0.0) << "%), behind "
+           << stats.duplicates << ", p50 lag " << behind.percentile(50.0) / 1000.0 << " us, p99 lag "
+           << behind.percentile(99.0) / 1000.0 << " us\n";
+    }
+}
 
-    // Check if message contains "params" and process channel data
-    if (msg_json.as_object().contains("params")) {
-        auto &params = msg_json.at("params").as_object();
-        if (params.contains("channel")) {
-            std::string channel = params["channel"].as_string().c_str();
-            orderbook_data[channel] = params["data"];
-            data_cv.notify_all();  // Notify waiting thread for new data
+// Create the shards and deal instruments out to them round-robin, in subscription order. In redundant
+// mode every shard then gets a mirror on its own connection carrying the same channels (leg B).
+void Rtm_Server::build_shards() {
+    std::vector<std::string> channel_list = config.expand();
+    int shard_count = std::max(1, config.shards);
+    shards.clear();
+    shard_of_instrument.clear();
+    for (int i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<FeedShard>(i, ring_capacity, conflation_rules,
+            [this](FeedShard &shard, const MarketEvent &event) { on_event(shard, event); }));
+        shards.back()->set_endpoint(host, port);
+        shards.back()->set_verify_peer(verify_peer);
+        shards.back()->set_heartbeat(config.heartbeat_seconds);
+        if (i < static_cast<int>(config.shard_cpus.size())) {
+            shards.back()->set_cpu(config.shard_cpus[i]);
         }
     }
+    int next_shard = 0;
+    for (const auto &channel : channel_list) {
+        auto [it, inserted] = shard_of_instrument.emplace(channel_instrument(channel), next_shard);
+        if (inserted) {
+            next_shard = (next_shard + 1) % shard_count;
+        }
+        shards[it->second]->add_channel(channel);
+    }
+    // Shards left without channels would only hold an idle connection open
+    while (shards.size() > 1 && shards.back()->channels().empty()) {
+        shards.pop_back();
+    }
+    arbiter.reset();
+    if (!config.redundant || replaying) {
+        return;
+    }
+    arbiter = std::make_unique<FeedArbiter>();
+    int logical = static_cast<int>(shards.size());
+    for (int i = 0; i < logical; ++i) {
+        int index = logical + i;
+        shards.push_back(std::make_unique<FeedShard>(index, ring_capacity, conflation_rules,
+            [this](FeedShard &shard, const MarketEvent &event) { on_event(shard, event); }));
+        FeedShard &mirror = *shards.back();
+        mirror.set_endpoint(host, port);
+        mirror.set_verify_peer(verify_peer);
+        mirror.set_leg(1);
+        mirror.set_heartbeat(config.heartbeat_seconds);
+        if (index < static_cast<int>(config.shard_cpus.size())) {
+            mirror.set_cpu(config.shard_cpus[index]);
+        }
+        for (const auto &channel : shards[i]->channels()) {
+            mirror.add_channel(channel);
+        }
+    }
+    for (auto &shard : shards) {
+        shard->set_reconnect(true);  // A dropped leg comes back while its partner carries the feed
+    }
 }
 
-// Function to establish WebSocket connection and subscribe to channels
-void Rtm_Server::connect() {
-    try {
-        tcp::resolver resolver(ioc);
-        auto const results = resolver.resolve(HOST, PORT);
-        net::connect(beast::get_lowest_layer(ws), results.begin(), results.end());
+// Record every decoded event to an append-only journal; the mapping survives a crash up to the last record
+void Rtm_Server::enable_capture(const std::string &path) {
+    journal = std::make_unique<JournalWriter>(path);
+}
 
-        ws.next_layer().handshake(ssl::stream_base::client);  // Perform SSL handshake
-        ws.handshake(HOST, TARGET);  // Perform WebSocket handshake
+// Create the shared-memory region now so readers can attach before the feed connects
+void Rtm_Server::enable_shared_memory(const std::string &name) {
+    shared_feed = std::make_unique<SharedFeedPublisher>(name);
+}
 
-        std::cout << "Connected to Deribit test WebSocket!" << std::endl;
+// Re-subscribe to an instrument's book channels so Deribit sends a fresh snapshot. Runs on the reader
+// thread of the shard that applied the update (either leg in redundant mode), which is the only thread
+// writing to that connection.
+void Rtm_Server::resync_book(const std::string &instrument) {
+    if (replaying) {
+        std::cerr << "Order book gap on " << instrument << " in replay" << std::endl;
+        return;
+    }
+    if (!applying_shard) {
+        return;
+    }
+    FeedShard &shard = *applying_shard;
+    std::vector<std::string> book_channels;
+    for (const auto &channel : shard.channels()) {
+        if (channel.rfind("book." + instrument + ".", 0) == 0) {
+            book_channels.push_back(channel);
+        }
+    }
+    if (book_channels.empty()) {
+        return;
+    }
+    std::cerr << "Order book gap on " << instrument << ", resyncing" << std::endl;
+    shard.resubscribe(book_channels);
+}
 
-        // Subscribe to orderbook update channels
-        json::value subscription_message = {
-            {"jsonrpc", "2.0"},
-            {"id", 42},
-            {"method", "public/subscribe"},
-            {"params", {
-                {"channels", json::array{
-                    "deribit_price_index.btc_usd",
-                    "deribit_price_index.algo_usd",
-                    "deribit_price_index.bch_usd"
-                }}
-            }}
-        };
+// Apply a decoded event to local state and hand it to the consumer thread (shard reader thread)
+void Rtm_Server::on_event(FeedShard &shard, const MarketEvent &event) {
+    applying_shard = &shard;
+    auto process = [this, &shard, &event]() {
+        if (journal) {
+            std::lock_guard<SpinLock> lock(journal_lock);
+            journal->append(event);
+        }
+        if (event.exchange_latency_ns > 0) {
+            exchange_latency.record(static_cast<std::uint64_t>(event.exchange_latency_ns));
+        }
+        bool in_sequence = true;
+        if (event.type == EventType::Book) {
+            in_sequence = order_books.apply(event);  // Keep the local book current; this happens before any ring drop
+        }
+        shard.publish(event);
+        return in_sequence;
+    };
+    if (arbiter) {
+        arbiter->offer(shard.leg(), shard.current_channel(), event, process);  // Only the first copy of each update gets this far
+    } else {
+        process();
+    }
+}
 
-        ws.write(net::buffer(json::serialize(subscription_message)));
+// Drop connections that have gone quiet. With heartbeats on, Deribit writes at least every interval, so a
+// connection silent for 1.5 intervals is dead. In redundant mode a leg is also reconnected once it is
+// stale_after_ms behind a partner that is still receiving: the partner already carries the feed, so the
+// swap is invisible downstream. Leg statistics are logged every half minute.
+void Rtm_Server::watch_shards() {
+    std::int64_t dead_after_ns = config.heartbeat_seconds > 0 ? config.heartbeat_seconds * 1500000000LL : 0;
+    std::int64_t stale_after_ns = std::max(100, config.stale_after_ms) * 1000000LL;
+    std::int64_t poll_ns = dead_after_ns > 0 ? dead_after_ns : stale_after_ns;
+    if (arbiter) {
+        poll_ns = std::min(poll_ns, stale_after_ns);
+    }
+    auto poll = std::chrono::nanoseconds(poll_ns / 4);
+    auto next_report = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    std::size_t logical = arbiter ? shards.size() / FeedArbiter::kLegs : shards.size();
+    auto all_finished = [this]() {
+        return std::all_of(shards.begin(), shards.end(), [](const auto &shard) { return shard->finished(); });
+    };
+    while (!all_finished()) {  // feed_finished() also peeks the rings, which only the consumer may do
+        std::this_thread::sleep_for(poll);
+        std::int64_t now_ns = ClockSync::now_ns();
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            FeedShard &shard = *shards[i];
+            std::int64_t own = shard.last_receive_ns();
+            if (own == 0 || shard.finished()) {
+                continue;  // Connecting, or gone for good
+            }
+            const char *reason = nullptr;
+            if (dead_after_ns > 0 && now_ns - own > dead_after_ns) {
+                reason = "no heartbeat";
+            } else if (arbiter) {
+                std::int64_t partner = shards[i < logical ? i + logical : i - logical]->last_receive_ns();
+                if (now_ns - own > stale_after_ns && partner != 0 && now_ns - partner <= stale_after_ns) {
+                    reason = "behind its partner";
+                }
+            }
+            if (reason) {
+                std::cerr << "Feed shard " << shard.index() << " (leg " << FeedArbiter::leg_name(shard.leg())
+                          << ") silent for " << (now_ns - own) / 1000000 << " ms, " << reason << "; dropping" << std::endl;
+                shard.kick();
+            }
+        }
+        if (arbiter && std::chrono::steady_clock::now() >= next_report) {
+            report_legs(std::cerr);
+            next_report += std::chrono::seconds(30);
+        }
+    }
+}
+
+// Run a strategy on the consumer thread; the gateway, if any, is polled there too so the strategy can
+// send orders from its callbacks without locks
+void Rtm_Server::set_strategy(Strategy *strategy_ptr, OrderGateway *gateway_ptr) {
+    strategy = strategy_ptr;
+    gateway = gateway_ptr;
+    if (gateway) {
+        gateway->set_listener(strategy);
+    }
+}
 
-        // Read incoming messages and process them
-        while (true) {
-            beast::flat_buffer buffer;
-            ws.read(buffer);
-            std::string message = beast::buffers_to_string(buffer.data());
-            on_message(message);  // Handle the incoming message
+// Close every feed connection for good; the consumer drains what was already published and run() returns.
+// Whichever of stop() and run() comes second sees the other's flag and stops the shards.
+void Rtm_Server::stop() {
+    stop_requested.store(true);
+    if (shards_started.load()) {
+        for (auto &shard : shards) {
+            shard->stop();
         }
-    } catch (const std::exception &e) {
-        std::cerr << "Exception: " << e.what() << std::endl;  // Handle exceptions
     }
 }
 
-// Function to stream orderbook updates
+// Book and analytics of the event's instrument, indexed by its registry id; the registries are only
+// consulted the first time an id is seen
+Rtm_Server::ConsumerInstrument &Rtm_Server::consumer_instrument(const MarketEvent &event) {
+    InstrumentId id = event.instrument_id;
+    if (id == kNoInstrument) {
+        id = InstrumentRegistry::instance().intern(event.symbol_view());  // Events built outside the decoder
+    }
+    if (id >= consumer_instruments.size()) {
+        consumer_instruments.resize(std::max<std::size_t>(id + 1, consumer_instruments.size() * 2));
+    }
+    ConsumerInstrument &cached = consumer_instruments[id];
+    if (!cached.analytics) {
+        cached.analytics = &market_analytics.get_or_create(event.symbol_view());
+    }
+    if (!cached.book && event.type == EventType::Book) {
+        cached.book = order_books.find(id);  // Created by on_event before the event was published
+        if (!cached.book) {
+            cached.book = order_books.find(event.symbol_view());
+        }
+    }
+    return cached;
+}
+
+// Call the strategy callback for the event's type, with the event's receive time as the tick-to-trade origin
+void Rtm_Server::dispatch(const MarketEvent &event, const OrderBook *book) {
+    if (gateway) {
+        gateway->set_trigger(event.receive_ns);
+    }
+    switch (event.type) {
+    case EventType::Book:
+        strategy->on_book(event, book);
+        break;
+    case EventType::Trade:
+        strategy->on_trade(event);
+        break;
+    case EventType::Ticker:
+        strategy->on_ticker(event);
+        break;
+    case EventType::PriceIndex:
+        strategy->on_index(event);
+        break;
+    default:
+        break;
+    }
+    if (gateway) {
+        gateway->set_trigger(0);
+    }
+}
+
+// True once every shard has stopped and nothing is left in its ring
+bool Rtm_Server::feed_finished() {
+    for (const auto &shard : shards) {
+        if (!shard->finished()) {
+            return false;
+        }
+    }
+    for (const auto &shard : shards) {
+        if (shard->front()) {
+            return false;  // Published before it finished; drain first
+        }
+    }
+    return true;
+}
+
+// Function to stream orderbook updates: merge the shard rings, oldest receive time first. Events are
+// handed to the async logger as compact records, so console or file I/O never stalls this thread.
 void Rtm_Server::stream_orderbook_updates() {
+    if (config.consumer_cpu >= 0 && !pin_current_thread(config.consumer_cpu)) {
+        std::cerr << "Cannot pin the feed consumer to CPU " << config.consumer_cpu << std::endl;
+    }
+    IdleStrategy idle(wait_mode);
+    MarketEvent latest;
+    if (strategy) {
+        strategy->on_start(gateway, &market_analytics);
+    }
+    std::uint32_t since_poll = 0;
     while (true) {
-        std::unique_lock<std::mutex> lock(data_mutex);  // Lock for safe data access
-        data_cv.wait(lock, [this] { return !orderbook_data.empty(); });  // Wait for data
+        FeedShard *source = nullptr;
+        FeedEntry *entry = nullptr;
+        for (auto &shard : shards) {
+            FeedEntry *candidate = shard->front();
+            if (candidate && (!entry || candidate->receive_ns < entry->receive_ns)) {
+                source = shard.get();
+                entry = candidate;
+            }
+        }
+        if (!entry) {
+            if (gateway) {
+                gateway->poll();  // Order responses while the feed is quiet
+            }
+            if (feed_finished()) {
+                AsyncLogger::instance().flush();
+                return;  // Every producer stopped and everything it published has been consumed
+            }
+            idle.idle();  // Spin or back off until a reader publishes
+            continue;
+        }
+        idle.reset();
 
-        // Print out orderbook data from each channel
-        for (const auto &[channel, data] : orderbook_data) {
-            std::cout << "Channel: " << channel << std::endl;
-            std::cout << "Data: " << json::serialize(data) << std::endl;
+        const MarketEvent *event = nullptr;
+        if (entry->conflated_slot < 0) {
+            event = &entry->event;
+        } else if (source->read_conflated(entry->conflated_slot, latest)) {
+            event = &latest;
+        }
+        if (event) {
+            std::int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            handoff_latency.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, now_ns - event->receive_ns)));
+            OrderBook *book = nullptr;
+            if (event->type == EventType::Book || event->type == EventType::Trade || event->type == EventType::Ticker) {
+                ConsumerInstrument &instrument = consumer_instrument(*event);
+                instrument.analytics->on_event(*event, instrument.book);
+                book = instrument.book;
+                RiskEngine::instance().on_event(*event, book);  // Reference prices for the price band
+            }
+            if (shared_feed) {
+                shared_feed->publish(*event, book);
+            }
+            if (strategy) {
+                dispatch(*event, book);
+            }
+            AsyncLogger::instance().log(*event);
+        }
+        source->pop();
+        if (gateway && ++since_poll == 64) {
+            since_poll = 0;
+            gateway->poll();  // Keep order responses flowing under a busy feed
         }
-        orderbook_data.clear();  // Clear data after processing
     }
 }
 
-// Function to run WebSocket connection and data streaming in separate threads
+// Function to run the shard connections and the merging consumer in separate threads
 void Rtm_Server::run() {
-    std::thread ws_thread(&Rtm_Server::connect, this);  // Thread for WebSocket connection
-    std::thread stream_thread(&Rtm_Server::stream_orderbook_updates, this);  // Thread for data streaming
+    start();
+    wait();
+}
+
+// Start the shard connections, the consumer and the watchdog, then return; the feed runs until stop()
+// or until every connection has ended, and wait() joins it
+void Rtm_Server::start() {
+    build_shards();
+    for (auto &shard : shards) {
+        shard->start();  // One reader thread and io_context per connection
+    }
+    shards_started.store(true);
+    if (stop_requested.load()) {
+        for (auto &shard : shards) {
+            shard->stop();
+        }
+    }
+    stream_thread = std::thread(&Rtm_Server::stream_orderbook_updates, this);  // Thread for data streaming
+    if (arbiter || config.heartbeat_seconds > 0) {
+        watchdog_thread = std::thread(&Rtm_Server::watch_shards, this);  // Drop dead connections, fail quiet legs over
+    }
+}
+
+// Wait for every connection to end and the consumer to drain
+void Rtm_Server::wait() {
+    for (auto &shard : shards) {
+        shard->join();
+    }
+    if (stream_thread.joinable()) {
+        stream_thread.join();
+    }
+    if (watchdog_thread.joinable()) {
+        watchdog_thread.join();
+    }
+}
+
+// A started feed is stopped and drained before its state goes away
+Rtm_Server::~Rtm_Server() {
+    if (stream_thread.joinable()) {
+        stop();
+        wait();
+    }
+}
+
+// Replay a captured journal through on_event and the consumer thread. Events are restamped with the
+// replay-time receive clock so hand-off latency stays meaningful; speed 1.0 keeps the recorded gaps,
+// 2.0 halves them and 0 replays as fast as the consumer drains the ring.
+void Rtm_Server::replay(const std::string &path, double speed) {
+    JournalReader reader(path);
+    replaying = true;
+    config.shards = 1;
+    config.instruments.clear();
+    config.channels.clear();
+    build_shards();  // One unconnected shard carries the replayed events
+    FeedShard &shard = *shards.front();
+    std::thread replay_consumer(&Rtm_Server::stream_orderbook_updates, this);
+
+    MarketEvent event;
+    std::int64_t first_receive_ns = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t replayed = 0;
+    std::map<std::string, InstrumentId, std::less<>> instrument_ids;  // Journal names -> this process's ids
+    while (reader.next(event)) {
+        if (replayed++ == 0) {
+            first_receive_ns = event.receive_ns;
+        }
+        auto id = instrument_ids.find(event.symbol_view());
+        if (id == instrument_ids.end()) {
+            id = instrument_ids.emplace(std::string(event.symbol_view()),
+                                        InstrumentRegistry::instance().intern(event.symbol_view())).first;
+        }
+        event.instrument_id = id->second;
+        if (speed > 0) {
+            auto offset = std::chrono::nanoseconds(
+                static_cast<std::int64_t>(static_cast<double>(event.receive_ns - first_receive_ns) / speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+        event.receive_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        if (speed <= 0) {
+            IdleStrategy idle(wait_mode);
+            while (shard.queued() == shard.capacity()) {
+                idle.idle();  // Apply back-pressure instead of dropping when replaying flat out
+            }
+        }
+        on_event(shard, event);
+    }
 
-    ws_thread.join();  // Wait for WebSocket thread to finish
-    stream_thread.join();  // Wait for streaming thread to finish
+    shard.finish();
+    replay_consumer.join();
+    replaying = false;
+    std::cerr << "Replayed " << replayed << " events from " << path << std::endl;
 }
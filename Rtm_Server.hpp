@@ -16,6 +16,19 @@
 #include <mutex>  // Mutex for thread safety
 #include <condition_variable>  // Thread synchronization
 #include <thread>  // Thread management
+#include <vector>  // Subscription list
+#include <memory>  // Owned journal writer
+#include <string_view>  // Frames are decoded in place
+#include "OrderBook.hpp"  // Local L2 books built from book.* channels
+#include "FeedShard.hpp"  // Per-connection reader, decoder and ring
+#include "LatencyStats.hpp"  // Hand-off latency histogram
+#include "MarketJournal.hpp"  // Binary capture and replay
+#include "FeedArbiter.hpp"  // First-arrival arbitration between redundant legs
+#include "AsyncLogger.hpp"  // Event output off the consumer thread
+#include "Strategy.hpp"  // Callbacks on the consumer thread
+#include "OrderGateway.hpp"  // Inline order entry for the strategy
+#include "MarketAnalytics.hpp"  // Rolling per-instrument analytics
+#include "SharedFeed.hpp"  // Fan-out to local processes
 
 
 namespace beast = boost::beast;  // Alias for Boost.Beast library
@@ -27,20 +40,69 @@ using tcp = net::ip::tcp;  // Alias for TCP socket type in Boost.Asio
 
 class Rtm_Server {
 public:
-  Rtm_Server();  // Constructor for WebSocket class
-    void connect();  // Establish WebSocket connection
-    void stream_orderbook_updates();  // Stream real-time orderbook data
-    void run();  // Start WebSocket communication loop
+  explicit Rtm_Server(std::size_t ring_capacity = 16384);  // Constructor for WebSocket class; capacity (per shard) must be a power of two
+    void stream_orderbook_updates();  // Stream real-time orderbook data merged from every shard
+    ~Rtm_Server();  // Stops and joins a feed left running by start()
+    void run();  // start() then wait(): returns when every connection has ended
+    void start();  // Start the shard connections and the consumer without blocking
+    void wait();  // Block until every connection has ended and the consumer has drained
+    bool running() const { return shards_started.load() && !stop_requested.load(); }  // Started and not yet stopped
+    void add_channel(const std::string &channel);  // Add a subscription channel; call before run()
+    void set_feed_config(const FeedConfig &config);  // Replace the subscriptions and sharding; call before run()
+    void set_endpoint(const std::string &endpoint_host, const std::string &endpoint_port);  // Override test.deribit.com:443; call before run()
+    OrderBookManager &books() { return order_books; }  // Local books maintained from book.* channels
+    void set_conflation(const std::string &channel_prefix, ConflationPolicy policy);  // e.g. ("ticker.", LatestOnly); call before run()
+    void set_wait_mode(WaitMode mode);  // Consumer idle behaviour; call before run()
+    void set_verify_peer(bool verify);  // Certificate checks on the feed connections (on by default); call before run()
+    FeedStats stats() const;  // Ring counters summed over the shards, safe to read from any thread
+    LegStats leg_stats(int leg) const;  // Redundant mode: wins and duplicates of leg 0 (A) or 1 (B); zeros otherwise
+    void report_legs(std::ostream &os) const;  // One line per leg: share of first arrivals and lag when losing
+    void enable_capture(const std::string &path);  // Journal every decoded event to path; call before run()
+    void enable_shared_memory(const std::string &name);  // Publish every event and per-instrument state to shared memory; call before run()
+    void replay(const std::string &path, double speed = 1.0);  // Feed a journal through the consumer; speed 0 = as fast as possible
+    void set_strategy(Strategy *strategy, OrderGateway *gateway = nullptr);  // Run strategy callbacks on the consumer thread, which also polls gateway; call before run()
+    void stop();  // Close every feed connection; run() returns once the rings are drained (any thread)
+    const MarketAnalytics &analytics() const { return market_analytics; }  // Updated by the consumer before the strategy sees an event; snapshot() from any thread
 
 private:
-    void on_message(const std::string &message);  // Callback for handling incoming messages
+    void build_shards();  // Create the shards and assign channels to them
+    void on_event(FeedShard &shard, const MarketEvent &event);  // Apply a decoded event and queue it for the consumer
+    void resync_book(const std::string &instrument);  // Re-snapshot a book after a change_id gap
+    void watch_shards();  // Drop connections that miss heartbeats or trail their redundant partner; log leg statistics
+    bool feed_finished();  // Every shard has stopped publishing
+    // Consumer-side handles of one instrument, looked up without the registry locks
+    struct ConsumerInstrument {
+        OrderBook *book = nullptr;  // Null until the instrument's first book event
+        InstrumentAnalytics *analytics = nullptr;  // Updated from every trade, book and ticker event
+    };
+    ConsumerInstrument &consumer_instrument(const MarketEvent &event);  // Cached handles (consumer thread)
+    void dispatch(const MarketEvent &event, const OrderBook *book);  // Hand an event to the strategy (consumer thread)
 
-    net::io_context ioc;  // I/O context for async operations
-    ssl::context ctx;  // SSL context for secure WebSocket connections
-    websocket::stream<beast::ssl_stream<tcp::socket>> ws;  // Secure WebSocket stream
-    std::mutex data_mutex;  // Mutex for protecting shared data
-    std::condition_variable data_cv;  // Condition variable for thread synchronization
-    std::unordered_map<std::string, json::value> orderbook_data;  // Store orderbook data
+    std::string host;  // Feed host name
+    std::string port;  // Feed port
+    std::size_t ring_capacity;  // Ring size of each shard
+    FeedConfig config;  // Channels and sharding
+    OrderBookManager order_books;  // Books for every subscribed book.* channel
+    ConflationRules conflation_rules;  // Channel prefix -> policy, shared by the shards
+    std::vector<std::unique_ptr<FeedShard>> shards;  // Created by run() or replay()
+    std::unordered_map<std::string, int> shard_of_instrument;  // Instrument (or index name) -> owning shard (leg A)
+    std::unique_ptr<FeedArbiter> arbiter;  // Set by build_shards() in redundant mode
+    WaitMode wait_mode = WaitMode::Backoff;  // Consumer idle policy
+    bool verify_peer = true;  // Passed to every shard
+    std::unique_ptr<JournalWriter> journal;  // Set by enable_capture(), written by every shard's reader
+    SpinLock journal_lock;  // Serializes appends from the shard readers
+    bool replaying = false;  // No live connection, so gaps cannot be resynced
+    Strategy *strategy = nullptr;  // Set by set_strategy()
+    OrderGateway *gateway = nullptr;  // Polled by the consumer thread when set
+    std::atomic<bool> shards_started{false};  // run() has built and started the shards
+    std::atomic<bool> stop_requested{false};  // stop() was called, possibly before the shards existed
+    MarketAnalytics market_analytics;  // Written by the consumer thread
+    std::unique_ptr<SharedFeedPublisher> shared_feed;  // Set by enable_shared_memory(); written by the consumer thread
+    std::thread stream_thread;  // Consumer, started by start()
+    std::thread watchdog_thread;  // Heartbeat and leg watchdog, when configured
+    std::vector<ConsumerInstrument> consumer_instruments;  // Consumer-only cache indexed by instrument id, so events take no map lock
+    LatencyHistogram &handoff_latency = LatencyRegistry::instance().histogram("feed.handoff");  // Receive -> consumer
+    LatencyHistogram &exchange_latency = LatencyRegistry::instance().histogram("feed.exchange_to_client");  // Exchange stamp -> receive
 };
 
 #endif
\ No newline at end of file
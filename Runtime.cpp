@@ -0,0 +1,76 @@
+#include "Runtime.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include "SpscRing.hpp"  // pin_current_thread
+
+// The runtime shared by every connection
+Runtime& Runtime::instance() {
+    static Runtime runtime;
+    return runtime;
+}
+
+// Stop the pool at exit
+Runtime::~Runtime() {
+    stop();
+}
+
+// Pool size and cores; ignored once the pool runs
+void Runtime::configure(std::size_t threads, std::vector<int> cpus) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+        std::cerr << "Runtime already running with " << pool_.size() << " threads; configuration ignored\n";
+        return;
+    }
+    threads_ = threads;
+    cpus_ = std::move(cpus);
+}
+
+// Start on first use so processes that never open a request connection run no pool
+net::io_context& Runtime::context() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        start_locked();
+    }
+    return ioc_;
+}
+
+// Pool size
+std::size_t Runtime::threads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!started_) {
+        start_locked();
+    }
+    return pool_.size();
+}
+
+// Default: one thread per core up to four, at least two so a slow handler never stalls every connection
+void Runtime::start_locked() {
+    std::size_t count = threads_;
+    if (count == 0) {
+        count = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 2, 4);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        int cpu = cpus_.empty() ? -1 : cpus_[i % cpus_.size()];
+        pool_.emplace_back([this, cpu]() {
+            if (cpu >= 0 && !pin_current_thread(cpu)) {
+                std::cerr << "Cannot pin a runtime thread to CPU " << cpu << std::endl;
+            }
+            ioc_.run();
+        });
+    }
+    started_ = true;
+}
+
+// Let the pool finish and join it; a stopped runtime is not restarted
+void Runtime::stop() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    work_.reset();
+    ioc_.stop();
+    for (auto& thread : pool_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    pool_.clear();
+}
@@ -0,0 +1,45 @@
+#ifndef RUNTIME_HPP
+#define RUNTIME_HPP
+
+#include <boost/asio.hpp>  // io_context, strands and work guard
+#include <cstddef>  // Thread counts
+#include <mutex>  // Lazy start
+#include <thread>  // Pool threads
+#include <vector>  // Pool and core list
+
+namespace net = boost::asio;  // Alias for Boost.Asio library
+
+using Strand = net::strand<net::io_context::executor_type>;  // Serializes one connection's handlers on the pool
+
+// Process-wide executor for the request/response connections: one io_context run by a pool of threads
+// (optionally pinned), with a strand per connection so each one's handlers never overlap while different
+// connections, their timers and heartbeats progress on different cores. The market-data shards keep
+// their own reader threads, and OrderGateway stays on its owning thread; neither is moved here.
+class Runtime {
+public:
+    static Runtime& instance();  // The shared runtime
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+    void configure(std::size_t threads, std::vector<int> cpus = {});  // Pool size and cores (round-robin); before first use
+    net::io_context& context();  // The shared io_context; starts the pool on first use
+    Strand make_strand() { return net::make_strand(context()); }  // New strand for one connection
+    std::size_t threads();  // Pool size (starts the pool)
+    void stop();  // Stop the pool and join its threads; pending handlers are dropped
+
+private:
+    Runtime() = default;
+    ~Runtime();  // stop()
+
+    void start_locked();  // Start the pool (mutex_ held)
+
+    std::mutex mutex_;  // Guards start and stop
+    net::io_context ioc_;  // Shared by every connection on the runtime
+    net::executor_work_guard<net::io_context::executor_type> work_{ioc_.get_executor()};  // Keeps the pool alive while idle
+    std::vector<std::thread> pool_;  // Threads running ioc_
+    std::size_t threads_ = 0;  // Configured size, 0 for the default
+    std::vector<int> cpus_;  // Cores to pin to, empty for unpinned
+    bool started_ = false;  // Pool running
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "SharedFeed.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+namespace {
+
+constexpr char kMagic[8] = {'G', 'T', 'X', 'S', 'H', 'M', '0', '1'};
+constexpr std::uint32_t kVersion = 2;
+
+[[noreturn]] void throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// POSIX shared-memory names start with a single slash
+std::string shm_name(const std::string &name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+}  // namespace
+
+// Create the region, lay out the header, instrument slots and ring, and mark it ready
+SharedFeedPublisher::SharedFeedPublisher(const std::string &name, std::uint32_t max_instruments,
+                                         std::size_t ring_capacity)
+    : name_(shm_name(name)), mask_(ring_capacity - 1) {
+    if (ring_capacity < 2 || (ring_capacity & (ring_capacity - 1)) != 0 || max_instruments == 0) {
+        throw std::invalid_argument("Shared feed needs a power-of-two ring and at least one instrument slot");
+    }
+    std::size_t instruments_offset = sizeof(SharedFeedHeader);
+    std::size_t ring_offset = instruments_offset + max_instruments * sizeof(SharedInstrumentSlot);
+    size_ = ring_offset + ring_capacity * sizeof(SharedEventSlot);
+
+    ::shm_unlink(name_.c_str());  // A previous publisher's region; its readers keep their mapping
+    int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) {
+        throw_errno("Cannot create shared feed " + name_);
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        throw_errno("Cannot size shared feed " + name_);
+    }
+    void *address = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        ::shm_unlink(name_.c_str());
+        throw_errno("Cannot map shared feed " + name_);
+    }
+    base_ = static_cast<char *>(address);
+
+    header_ = new (base_) SharedFeedHeader();
+    header_->version = kVersion;
+    header_->max_instruments = max_instruments;
+    header_->ring_capacity = ring_capacity;
+    header_->instruments_offset = instruments_offset;
+    header_->ring_offset = ring_offset;
+    header_->region_size = size_;
+    header_->publisher_pid = ::getpid();
+    header_->instrument_count.store(0, std::memory_order_relaxed);
+    header_->published.store(0, std::memory_order_relaxed);
+    instruments_ = reinterpret_cast<SharedInstrumentSlot *>(base_ + instruments_offset);
+    for (std::uint32_t i = 0; i < max_instruments; ++i) {
+        new (&instruments_[i]) SharedInstrumentSlot();
+        instruments_[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    ring_ = reinterpret_cast<SharedEventSlot *>(base_ + ring_offset);
+    for (std::size_t i = 0; i < ring_capacity; ++i) {
+        new (&ring_[i]) SharedEventSlot();
+        ring_[i].sequence.store(0, std::memory_order_relaxed);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, kMagic, sizeof(kMagic));  // Readers may attach from here on
+}
+
+// Unmap and remove the name so new readers cannot attach to a dead feed
+SharedFeedPublisher::~SharedFeedPublisher() {
+    if (base_) {
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+    }
+}
+
+// Slot of a symbol; new symbols take the next free slot and become visible through instrument_count
+SharedInstrumentSlot *SharedFeedPublisher::slot_for(std::string_view symbol) {
+    auto it = slots_.find(symbol);
+    if (it != slots_.end()) {
+        return it->second;
+    }
+    std::uint32_t index = header_->instrument_count.load(std::memory_order_relaxed);
+    if (index == header_->max_instruments) {
+        return nullptr;  // Directory full: the instrument is still in the ring
+    }
+    SharedInstrumentSlot *slot = &instruments_[index];
+    copy_symbol(slot->state.symbol, symbol);
+    slots_.emplace(std::string(symbol), slot);
+    header_->instrument_count.store(index + 1, std::memory_order_release);
+    return slot;
+}
+
+// Fold the event into its instrument's latest state, then append it to the broadcast ring
+void SharedFeedPublisher::publish(const MarketEvent &event, const OrderBook *book) {
+    if (event.type == EventType::None) {
+        return;
+    }
+    if (SharedInstrumentSlot *slot = slot_for(event.symbol_view())) {
+        std::uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+        slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        SharedInstrumentState &state = slot->state;
+        state.exchange_ts = event.exchange_ts;
+        state.receive_ns = event.receive_ns;
+        switch (event.type) {
+        case EventType::Book:
+            if (book && event.book.last_fragment) {  // Copy whole updates only
+                state.change_id = book->change_id();
+                state.bid_count = static_cast<std::uint16_t>(book->depth(BookSide::Bid, state.bids, kSharedBookLevels));
+                state.ask_count = static_cast<std::uint16_t>(book->depth(BookSide::Ask, state.asks, kSharedBookLevels));
+            }
+            break;
+        case EventType::Trade:
+            state.last_price = event.trade.price;
+            state.last_amount = event.trade.amount;
+            state.last_trade_seq = event.trade.trade_seq;
+            state.last_buy = event.trade.buy;
+            state.mark_price = event.trade.mark_price;
+            state.index_price = event.trade.index_price;
+            break;
+        case EventType::Ticker:
+            state.mark_price = event.ticker.mark_price;
+            state.index_price = event.ticker.index_price;
+            break;
+        case EventType::PriceIndex:
+            state.index_price = event.index.price;
+            break;
+        default:
+            break;
+        }
+        slot->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    SharedEventSlot &entry = ring_[next_ & mask_];
+    entry.sequence.store(2 * next_ + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.event = event;
+    entry.sequence.store(2 * next_ + 2, std::memory_order_release);
+    header_->published.store(++next_, std::memory_order_release);
+}
+
+// Map an existing region read-only and start at its newest event
+SharedFeedReader::SharedFeedReader(const std::string &name) : name_(shm_name(name)) {
+    int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        throw_errno("Cannot open shared feed " + name_);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SharedFeedHeader))) {
+        ::close(fd);
+        throw std::runtime_error("Shared feed not ready: " + name_);
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    void *address = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        throw_errno("Cannot map shared feed " + name_);
+    }
+    base_ = static_cast<const char *>(address);
+    header_ = reinterpret_cast<const SharedFeedHeader *>(base_);
+    if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 || header_->version != kVersion) {
+        ::munmap(const_cast<char *>(base_), size_);
+        throw std::runtime_error("Not a GoTradeX shared feed (or not ready yet): " + name_);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header_->region_size > size_) {
+        ::munmap(const_cast<char *>(base_), size_);
+        throw std::runtime_error("Shared feed truncated: " + name_);
+    }
+    instruments_ = reinterpret_cast<const SharedInstrumentSlot *>(base_ + header_->instruments_offset);
+    ring_ = reinterpret_cast<const SharedEventSlot *>(base_ + header_->ring_offset);
+    mask_ = header_->ring_capacity - 1;
+    cursor_ = header_->published.load(std::memory_order_acquire);
+}
+
+// Unmap
+SharedFeedReader::~SharedFeedReader() {
+    if (base_) {
+        ::munmap(const_cast<char *>(base_), size_);
+    }
+}
+
+// Next event in publish order. A reader lapped by the publisher skips ahead to half a ring behind the
+// newest event and counts what it missed.
+bool SharedFeedReader::next(MarketEvent &event) {
+    while (true) {
+        const SharedEventSlot &entry = ring_[cursor_ & mask_];
+        std::uint64_t expected = 2 * cursor_ + 2;
+        std::uint64_t before = entry.sequence.load(std::memory_order_acquire);
+        if (before < expected) {
+            return false;  // Not published yet, or being written right now
+        }
+        if (before == expected) {
+            event = entry.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (entry.sequence.load(std::memory_order_relaxed) == expected) {
+                event.instrument_id = 0;  // Ids are only meaningful inside the publisher
+                ++cursor_;
+                return true;
+            }
+        }
+        std::uint64_t newest = header_->published.load(std::memory_order_acquire);
+        std::uint64_t restart = newest - std::min(newest, (mask_ + 1) / 2);
+        if (restart <= cursor_) {
+            restart = cursor_ + 1;
+        }
+        lost_ += restart - cursor_;
+        cursor_ = restart;
+    }
+}
+
+// Slot lookup; symbols added since the last miss are indexed first
+const SharedInstrumentSlot *SharedFeedReader::find(std::string_view symbol) {
+    auto it = known_.find(symbol);
+    if (it != known_.end()) {
+        return it->second;
+    }
+    std::uint32_t count = header_->instrument_count.load(std::memory_order_acquire);
+    for (; scanned_ < count; ++scanned_) {
+        known_.emplace(std::string(instruments_[scanned_].state.symbol), &instruments_[scanned_]);
+    }
+    it = known_.find(symbol);
+    return it == known_.end() ? nullptr : it->second;
+}
+
+// Consistent copy of an instrument's latest state
+bool SharedFeedReader::latest(std::string_view symbol, SharedInstrumentState &state) {
+    const SharedInstrumentSlot *slot = find(symbol);
+    if (!slot) {
+        return false;
+    }
+    std::uint32_t before, after;
+    do {
+        before = slot->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            cpu_relax();
+            continue;
+        }
+        state = slot->state;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot->sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    return true;
+}
+
+// Slots in use
+std::uint32_t SharedFeedReader::instruments() const {
+    return header_->instrument_count.load(std::memory_order_acquire);
+}
+
+// Name in a slot
+std::string SharedFeedReader::instrument(std::uint32_t index) const {
+    return index < instruments() ? std::string(instruments_[index].state.symbol) : std::string();
+}
+
+// The writing process still exists (EPERM means it does but belongs to another user)
+bool SharedFeedReader::publisher_alive() const {
+    return ::kill(static_cast<pid_t>(header_->publisher_pid), 0) == 0 || errno == EPERM;
+}
@@ -0,0 +1,125 @@
+#ifndef SHARED_FEED_HPP
+#define SHARED_FEED_HPP
+
+#include <atomic>  // Sequence numbers shared between processes
+#include <cstddef>  // Sizes and offsets
+#include <cstdint>  // Fixed-width fields
+#include <map>  // Instrument -> slot lookups without allocating a key
+#include <string>  // Region names
+#include <string_view>  // Instrument lookups
+#include "MarketEvents.hpp"  // Normalized events
+#include "OrderBook.hpp"  // Top levels copied into the instrument slots
+#include "SpscRing.hpp"  // kCacheLineSize, cpu_relax
+
+constexpr std::size_t kSharedBookLevels = 10;  // Levels per side kept in an instrument slot
+
+// Latest normalized state of one instrument or index, copied out of its slot under the slot's sequence lock
+struct SharedInstrumentState {
+    char symbol[kSymbolSize];  // Instrument or index name
+    std::int64_t exchange_ts;  // Exchange time (ms) of the last update of any kind
+    std::int64_t receive_ns;  // Local receive time of that update
+    std::int64_t change_id;  // Book change id behind bids/asks
+    std::uint16_t bid_count;  // Valid entries in bids
+    std::uint16_t ask_count;  // Valid entries in asks
+    PriceLevel bids[kSharedBookLevels];  // Best first
+    PriceLevel asks[kSharedBookLevels];  // Best first
+    double last_price;  // Last trade price
+    double last_amount;  // Last trade amount
+    std::int64_t last_trade_seq;  // Last trade sequence
+    bool last_buy;  // Last trade aggressor side
+    double mark_price;  // From the ticker
+    double index_price;  // Price index channels, or the index carried by trades and tickers
+};
+
+// Region layout: this header, max_instruments slots, then ring_capacity event slots. Everything a
+// reader uses is address-free: plain data guarded by sequence numbers in lock-free atomics.
+struct alignas(kCacheLineSize) SharedFeedHeader {
+    char magic[8];  // "GTXSHM01", written last so a half-built region is never attached
+    std::uint32_t version;  // Layout version
+    std::uint32_t max_instruments;  // Instrument slots
+    std::uint64_t ring_capacity;  // Event slots; power of two
+    std::uint64_t instruments_offset;  // Byte offset of the first instrument slot
+    std::uint64_t ring_offset;  // Byte offset of the first event slot
+    std::uint64_t region_size;  // Total mapped size
+    std::int64_t publisher_pid;  // Process writing the region
+    alignas(kCacheLineSize) std::atomic<std::uint32_t> instrument_count;  // Slots in use; a slot's symbol is final once counted
+    alignas(kCacheLineSize) std::atomic<std::uint64_t> published;  // Events written to the ring so far
+};
+
+struct alignas(kCacheLineSize) SharedInstrumentSlot {
+    std::atomic<std::uint32_t> sequence;  // Odd while the publisher is writing state
+    SharedInstrumentState state;  // Latest values
+};
+
+// Broadcast ring entry: event n lives in slot n % capacity with sequence 2n + 2 once complete
+// (2n + 1 while it is written), so a reader can tell "not yet", "ready" and "overwritten" apart.
+struct alignas(kCacheLineSize) SharedEventSlot {
+    std::atomic<std::uint64_t> sequence;  // 2n + 1 while event n is written, 2n + 2 once it is complete
+    MarketEvent event;  // Event n
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<std::uint64_t>::is_always_lock_free,
+              "shared-memory sequences must be lock-free to be address-free");
+
+// Writes normalized market data into a POSIX shared-memory region for local processes to read:
+// per-instrument latest state (top kSharedBookLevels of the book, last trade, mark and index) and a
+// broadcast ring of every event. Single writer (the feed consumer thread); never blocks on readers,
+// which lose events instead when they fall a whole ring behind.
+class SharedFeedPublisher {
+public:
+    SharedFeedPublisher(const std::string &name, std::uint32_t max_instruments = 1024,
+                        std::size_t ring_capacity = 16384);  // Create (replacing any old region with that name)
+    ~SharedFeedPublisher();  // Unmap and remove the name; attached readers keep their mapping
+    SharedFeedPublisher(const SharedFeedPublisher &) = delete;
+    SharedFeedPublisher &operator=(const SharedFeedPublisher &) = delete;
+
+    void publish(const MarketEvent &event, const OrderBook *book);  // Update the instrument slot and append to the ring
+    std::uint64_t published() const { return next_; }  // Events written
+
+private:
+    SharedInstrumentSlot *slot_for(std::string_view symbol);  // Slot of symbol, allocated on first sight; null when full
+
+    std::string name_;  // shm_open name
+    char *base_ = nullptr;  // Mapped region
+    std::size_t size_ = 0;  // Mapped length
+    SharedFeedHeader *header_ = nullptr;  // Start of the region
+    SharedInstrumentSlot *instruments_ = nullptr;  // Instrument slots
+    SharedEventSlot *ring_ = nullptr;  // Event slots
+    std::uint64_t mask_ = 0;  // ring_capacity - 1
+    std::uint64_t next_ = 0;  // Sequence of the next event
+    std::map<std::string, SharedInstrumentSlot *, std::less<>> slots_;  // Writer-only directory
+};
+
+// Attaches to a publisher's region read-only. Each reader has its own ring cursor starting at the
+// newest event; latest state is read per instrument. One reader object per thread.
+class SharedFeedReader {
+public:
+    explicit SharedFeedReader(const std::string &name);  // Attach; throws if the region is missing or not ready
+    ~SharedFeedReader();  // Unmap
+    SharedFeedReader(const SharedFeedReader &) = delete;
+    SharedFeedReader &operator=(const SharedFeedReader &) = delete;
+
+    bool next(MarketEvent &event);  // Copy the next event from the ring; false when caught up
+    bool latest(std::string_view symbol, SharedInstrumentState &state);  // Consistent copy of an instrument slot; false if unknown
+    std::uint32_t instruments() const;  // Slots in use
+    std::string instrument(std::uint32_t index) const;  // Name in a slot, index < instruments()
+    std::uint64_t lost() const { return lost_; }  // Events overwritten before this reader got to them
+    bool publisher_alive() const;  // The writing process still exists
+
+private:
+    const SharedInstrumentSlot *find(std::string_view symbol);  // Slot lookup, scanning new directory entries on a miss
+
+    std::string name_;  // shm_open name
+    const char *base_ = nullptr;  // Mapped region
+    std::size_t size_ = 0;  // Mapped length
+    const SharedFeedHeader *header_ = nullptr;  // Start of the region
+    const SharedInstrumentSlot *instruments_ = nullptr;  // Instrument slots
+    const SharedEventSlot *ring_ = nullptr;  // Event slots
+    std::uint64_t mask_ = 0;  // ring_capacity - 1
+    std::uint64_t cursor_ = 0;  // Sequence of the next event to read
+    std::uint64_t lost_ = 0;  // Events skipped after being lapped
+    std::uint32_t scanned_ = 0;  // Directory entries already in known_
+    std::map<std::string, const SharedInstrumentSlot *, std::less<>> known_;  // Symbol -> slot
+};
+
+#endif
@@ -0,0 +1,138 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>  // Head/tail indices
+#include <chrono>  // Backoff sleep
+#include <cstddef>  // Sizes
+#include <memory>  // Slot storage
+#include <stdexcept>  // Capacity validation
+#include <thread>  // yield / sleep_for
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>  // _mm_pause
+#endif
+#if defined(__linux__)
+#include <pthread.h>  // pthread_setaffinity_np
+#include <sched.h>  // cpu_set_t
+#endif
+
+constexpr std::size_t kCacheLineSize = 64;  // Padding unit to keep producer and consumer state apart
+
+// Tell the core we are spinning so a sibling hyper-thread gets the pipeline
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Pin the calling thread to one core; false where unsupported or the core is not available
+inline bool pin_current_thread(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Bounded single-producer/single-consumer ring. Capacity must be a power of two; each side caches the
+// other side's index so the shared cache line is only touched when the ring looks full or empty.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity)
+        : slots_(new T[capacity]), mask_(capacity - 1) {
+        if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+            throw std::invalid_argument("SpscRing capacity must be a power of two");
+        }
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: construct the next element in place with fill(T&); false if the ring is full
+    template <typename Fill>
+    bool try_emplace(Fill&& fill) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ > mask_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ > mask_) {
+                return false;
+            }
+        }
+        fill(slots_[tail & mask_]);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer: copy an element in; false if the ring is full
+    bool try_push(const T& value) {
+        return try_emplace([&value](T& slot) { slot = value; });
+    }
+
+    // Consumer: oldest element or nullptr if empty; stays valid until pop()
+    T* front() {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return nullptr;
+            }
+        }
+        return &slots_[head & mask_];
+    }
+
+    // Consumer: release the element returned by front()
+    void pop() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Approximate number of queued elements; exact when called from either endpoint's own thread
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }  // Maximum number of queued elements
+
+private:
+    std::unique_ptr<T[]> slots_;  // Element storage
+    const std::size_t mask_;  // capacity - 1
+    alignas(kCacheLineSize) std::atomic<std::size_t> head_{0};  // Next element to consume (written by consumer)
+    std::size_t cached_tail_ = 0;  // Consumer's last view of tail_
+    alignas(kCacheLineSize) std::atomic<std::size_t> tail_{0};  // Next slot to fill (written by producer)
+    std::size_t cached_head_ = 0;  // Producer's last view of head_
+};
+
+enum class WaitMode { BusySpin, Backoff };  // How a consumer waits when its ring is empty
+
+// Idle strategy for ring consumers: BusySpin never leaves the core, Backoff spins, then yields, then sleeps.
+class IdleStrategy {
+public:
+    explicit IdleStrategy(WaitMode mode) : mode_(mode) {}
+
+    void idle() {
+        if (mode_ == WaitMode::BusySpin || spins_ < kSpinLimit) {
+            ++spins_;
+            cpu_relax();
+        } else if (spins_ < kSpinLimit + kYieldLimit) {
+            ++spins_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    void reset() { spins_ = 0; }  // Call after doing work
+
+private:
+    static constexpr unsigned kSpinLimit = 10000;  // ~ tens of microseconds of pause instructions
+    static constexpr unsigned kYieldLimit = 100;  // Then give the core away a few times
+
+    WaitMode mode_;  // Selected policy
+    unsigned spins_ = 0;  // Idle iterations since the last piece of work
+};
+
+#endif
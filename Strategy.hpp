@@ -0,0 +1,43 @@
+#ifndef STRATEGY_HPP
+#define STRATEGY_HPP
+
+#include <cstdint>  // Ids and latencies
+#include "MarketEvents.hpp"  // Decoded market data
+#include "OrderBook.hpp"  // Local book passed to on_book
+
+class OrderGateway;
+class MarketAnalytics;
+
+// Result of an order request, or an order notification from user.orders.*
+struct OrderUpdate {
+    int request_id;  // Id returned by OrderGateway::buy/sell/edit/cancel, 0 for notifications
+    bool ok;  // False for a rejection or transport error
+    int error_code;  // Deribit error code when !ok
+    char order_id[kSymbolSize];  // Exchange order id, empty when rejected
+    char instrument[kSymbolSize];  // Instrument, when the exchange reports it
+    char state[16];  // order_state: open, filled, cancelled, rejected, untriggered, ...
+    bool buy;  // direction, when the exchange reports it
+    double price;  // Order price
+    double amount;  // Order amount
+    double filled_amount;  // Amount filled so far
+    std::int64_t round_trip_ns;  // Request sent -> update read, 0 for notifications
+};
+
+// Trading logic driven by the feed. Every callback runs on the feed consumer thread, in receive order,
+// and may call the OrderGateway directly: it is owned by the same thread, so an order goes out from
+// inside the callback without locks or thread hops. Callbacks must not block. The analytics passed to
+// on_start are already updated with the event being delivered; keep InstrumentAnalytics pointers from
+// find() and read current() rather than looking them up on every event.
+class Strategy {
+public:
+    virtual ~Strategy() = default;
+
+    virtual void on_start(OrderGateway *, const MarketAnalytics *) {}  // Before the first event; gateway is null when none was given
+    virtual void on_book(const MarketEvent &, const OrderBook *) {}  // Book fragment; the book includes its update (and possibly later ones) from the last fragment on
+    virtual void on_trade(const MarketEvent &) {}  // One public trade
+    virtual void on_ticker(const MarketEvent &) {}  // Ticker update
+    virtual void on_index(const MarketEvent &) {}  // deribit_price_index update
+    virtual void on_order_update(const OrderUpdate &) {}  // Response to one of our requests or a user.orders notification
+};
+
+#endif
@@ -3,33 +3,269 @@
 #include <limits>
 #include <chrono>
 #include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+#include <thread>
 #include "Rtm_Server.hpp"
+#include "LatencyStats.hpp"
 
 // Constructor to initialize the TradingSystem with client connection details.
 TradingSystem::TradingSystem(const std::string& host, const std::string& port, const char* client_id, const char* client_secret)
-    : client(host, port, client_id, client_secret), state_for_full_result(false) {}
+    : client(host, port, client_id, client_secret), state_for_full_result(false), feed_host(host), feed_port(port) {
+    client.set_notification_handler([this](const json::value& message) { on_notification(message); });
+    order_books.set_resync_handler([this](const std::string& instrument) {
+        std::vector<std::string> channel{"book." + instrument + ".100ms"};
+        client.async_unsubscribe(channel);
+        client.async_subscribe(channel);  // Deribit answers a fresh subscription with a snapshot
+    });
+}
+
+// A feed still running from option 8 is stopped before the client goes away.
+TradingSystem::~TradingSystem() {
+    stop_feed();
+}
+
+// Routes subscription notifications (client strand) into the local order books.
+void TradingSystem::on_notification(const json::value& message) {
+    const auto* params = message.as_object().if_contains("params");
+    if (!params || !params->is_object()) {
+        return;
+    }
+    const auto* channel = params->as_object().if_contains("channel");
+    const auto* data = params->as_object().if_contains("data");
+    if (!channel || !channel->is_string() || !data) {
+        return;
+    }
+    std::string_view channel_name(channel->as_string().data(), channel->as_string().size());
+    if (channel_name.substr(0, 5) == "book." && data->is_object()) {
+        order_books.apply(data->as_object());
+        update_analytics(channel_name, *data);
+    } else if (channel_name.substr(0, 7) == "trades.") {
+        update_analytics(channel_name, *data);
+    } else {
+        order_cache.apply_notification(channel_name, *data);
+    }
+}
+
+// Updates the rolling analytics: a book notification samples the (already applied) top of book, a
+// trades notification adds each trade. Client strand, the analytics' only writer.
+void TradingSystem::update_analytics(std::string_view channel, const json::value& data) {
+    if (channel.substr(0, 5) == "book.") {
+        const auto* name = data.as_object().if_contains("instrument_name");
+        const auto* timestamp = data.as_object().if_contains("timestamp");
+        if (!name || !name->is_string() || !timestamp || !timestamp->is_number()) {
+            return;
+        }
+        std::string_view instrument(name->as_string().data(), name->as_string().size());
+        const OrderBook* book = order_books.find(instrument);
+        PriceLevel bid, ask;
+        if (book && book->top_of_book(bid, ask)) {
+            analytics.get_or_create(instrument).update_quote(timestamp->to_number<std::int64_t>(), bid.price,
+                                                             bid.amount, ask.price, ask.amount);
+            RiskEngine::instance().update_reference(InstrumentRegistry::instance().intern(instrument),
+                                                    (bid.price + ask.price) / 2, 0);
+        }
+        return;
+    }
+    if (!data.is_array()) {
+        return;
+    }
+    for (const auto& trade : data.as_array()) {
+        if (!trade.is_object()) {
+            continue;
+        }
+        const auto& fields = trade.as_object();
+        const auto* name = fields.if_contains("instrument_name");
+        const auto* timestamp = fields.if_contains("timestamp");
+        const auto* price = fields.if_contains("price");
+        const auto* amount = fields.if_contains("amount");
+        const auto* direction = fields.if_contains("direction");
+        if (!name || !name->is_string() || !timestamp || !price || !amount || !price->is_number() || !amount->is_number()) {
+            continue;
+        }
+        analytics.get_or_create(std::string_view(name->as_string().data(), name->as_string().size()))
+            .add_trade(timestamp->to_number<std::int64_t>(), price->to_number<double>(), amount->to_number<double>(),
+                       direction && direction->is_string() && direction->as_string() == "buy");
+    }
+}
+
+// Snapshot-then-incremental start-up of the order cache: subscribe first so nothing is missed,
+// buffer notifications, then apply open orders and positions and replay the buffer on top.
+void TradingSystem::start_order_sync() {
+    order_cache.begin_sync();
+    client.async_private_subscribe(OrderCache::channels());
+    client.async_request(json::value{
+        {"jsonrpc", "2.0"},
+        {"method", "private/get_open_orders"},
+        {"params", json::object{}}
+    }, [this](json::value response) { order_cache.apply_orders_snapshot(response); });
+    client.async_request(json::value{
+        {"jsonrpc", "2.0"},
+        {"method", "private/get_positions"},
+        {"params", { {"currency", "any"} }}
+    }, [this](json::value response) {
+        order_cache.apply_positions_snapshot(response);
+        const auto* result = response.as_object().if_contains("result");
+        if (result && result->is_array()) {
+            for (const auto& position : result->as_array()) {
+                const auto* name = position.is_object() ? position.as_object().if_contains("instrument_name") : nullptr;
+                const auto* size = position.is_object() ? position.as_object().if_contains("size") : nullptr;
+                if (name && name->is_string() && size && size->is_number()) {
+                    RiskEngine::instance().set_position(
+                        InstrumentRegistry::instance().intern(std::string_view(name->as_string().data(), name->as_string().size())),
+                        size->to_number<double>());
+                }
+            }
+        }
+    });
+}
+
+// Refresh the instrument registry from every currency's active instruments; until the answer lands,
+// orders are checked against the snapshot of the previous run
+void TradingSystem::start_instrument_download() {
+    client.async_request(json::value{
+        {"jsonrpc", "2.0"},
+        {"method", "public/get_instruments"},
+        {"params", { {"currency", "any"}, {"expired", false} }}
+    }, [](json::value response) {
+        const auto* result = response.is_object() ? response.as_object().if_contains("result") : nullptr;
+        if (result) {
+            InstrumentRegistry::instance().apply_instruments(*result, true);
+        }
+    });
+}
+
+// Lists working orders from the cache and reads a choice: a list number or an order id.
+std::string TradingSystem::choose_order() {
+    std::vector<CachedOrder> open = order_cache.open_orders();
+    if (!open.empty()) {
+        std::cout << "\n========== Open Orders ==========\n";
+        for (std::size_t i = 0; i < open.size(); ++i) {
+            const CachedOrder& order = open[i];
+            std::cout << std::setw(4) << std::left << (i + 1) << std::setw(24) << order.order_id
+                      << std::setw(24) << order.instrument << std::setw(6) << order.direction
+                      << order.amount - order.filled_amount << " @ " << order.price << "\n";
+        }
+        std::cout << "================================\n";
+    }
+    std::string selection;
+    std::cout << (open.empty() ? "Order ID: " : "Order # or ID: ");
+    std::getline(std::cin, selection);
+    if (!selection.empty() && std::all_of(selection.begin(), selection.end(), ::isdigit)) {
+        std::size_t index = std::stoul(selection);
+        if (index >= 1 && index <= open.size()) {
+            return open[index - 1].order_id;
+        }
+    }
+    return selection;
+}
+
+// Prints positions and account summaries from the cache, or asks the exchange while it is still syncing.
+void TradingSystem::show_positions(const std::string& currency, const std::string& kind) {
+    if (!order_cache.is_synced()) {
+        handle_response_all(client.view_positions(currency, kind));
+        return;
+    }
+    std::cout << "\n========== Positions (local) ==========\n";
+    std::cout << std::setw(28) << std::left << "Instrument" << std::setw(14) << "Size"
+              << std::setw(14) << "Avg Price" << std::setw(14) << "Mark" << "Floating PnL\n";
+    for (const CachedPosition& position : order_cache.positions(currency, kind)) {
+        std::cout << std::setw(28) << std::left << position.instrument << std::setw(14) << position.size
+                  << std::setw(14) << position.average_price << std::setw(14) << position.mark_price
+                  << position.floating_profit_loss << "\n";
+    }
+    for (const PortfolioSummary& summary : order_cache.portfolio()) {
+        if (currency == "any" || summary.currency == currency) {
+            std::cout << summary.currency << " equity " << summary.equity << ", available "
+                      << summary.available_funds << ", margin " << summary.initial_margin << "\n";
+        }
+    }
+    std::cout << "================================\n";
+}
+
+// Prints the local order book; the first request for an instrument subscribes and falls back to REST.
+void TradingSystem::show_orderbook(const std::string& instrument, std::size_t levels) {
+    OrderBook* book = order_books.find(instrument);
+    if (!book) {
+        order_books.get_or_create(instrument);
+        client.async_subscribe({"book." + instrument + ".100ms"});
+    }
+    if (!book || !book->is_synced()) {
+        handle_response_all(client.get_orderbook(instrument));  // Local book not ready yet
+        return;
+    }
+
+    std::vector<PriceLevel> bids(levels), asks(levels);
+    bids.resize(book->depth(BookSide::Bid, bids.data(), levels));
+    asks.resize(book->depth(BookSide::Ask, asks.data(), levels));
+
+    std::cout << "\n========== Order Book: " << instrument << " (local, change_id "
+              << book->change_id() << ") ==========\n";
+    std::cout << std::setw(20) << std::left << "Bid" << "Ask\n";
+    for (std::size_t i = 0; i < std::max(bids.size(), asks.size()); ++i) {
+        std::ostringstream bid, ask;
+        if (i < bids.size()) {
+            bid << bids[i].amount << " @ " << bids[i].price;
+        }
+        if (i < asks.size()) {
+            ask << asks[i].amount << " @ " << asks[i].price;
+        }
+        std::cout << std::setw(20) << std::left << bid.str() << ask.str() << "\n";
+    }
+    std::cout << "================================\n";
+}
+
+// Prints the rolling analytics of an instrument; the first request subscribes to its book and trades.
+void TradingSystem::show_analytics(const std::string& instrument) {
+    AnalyticsSnapshot snapshot;
+    if (!analytics.snapshot(instrument, snapshot)) {
+        std::vector<std::string> channels{"trades." + instrument + ".100ms"};
+        if (!order_books.find(instrument)) {
+            order_books.get_or_create(instrument);
+            channels.push_back("book." + instrument + ".100ms");
+        }
+        analytics.get_or_create(instrument);
+        client.async_subscribe(channels);
+        std::cout << "Collecting trades and quotes for " << instrument << "; ask again in a few seconds\n";
+        return;
+    }
+
+    std::cout << "\n========== Analytics: " << instrument << " ==========\n" << std::fixed << std::setprecision(2);
+    std::cout << std::setw(20) << std::left << "Bid / Ask" << snapshot.best_bid << " / " << snapshot.best_ask
+              << " (spread " << snapshot.spread << ")\n";
+    std::cout << std::setw(20) << std::left << "Mid / Microprice" << snapshot.mid << " / " << snapshot.microprice << "\n";
+    std::cout << std::setw(20) << std::left << "VWAP" << snapshot.vwap << " (" << snapshot.trades << " trades, volume "
+              << snapshot.volume << ")\n";
+    std::cout << std::setw(20) << std::left << "Trade imbalance" << snapshot.trade_imbalance << "\n";
+    std::cout << std::setw(20) << std::left << "Realized vol" << snapshot.realized_vol << "% (" << snapshot.returns
+              << " returns)\n";
+    std::cout << std::defaultfloat << "================================\n";
+}
 
 // Handles responses when multiple positions are returned.
 void TradingSystem::handle_response_all(const json::value& response) {
     if (response.as_object().contains("result")) {
         const auto& result = response.at("result");
+        std::ostringstream out;  // Built off the console and written once
 
         if (result.is_array()) {  // Handling multiple positions
-            std::cout << "\n========== Positions ==========\n";
+            out << "\n========== Positions ==========\n";
             for (const auto& item : result.as_array()) {
-                std::cout << "----------------------------------\n";
+                out << "----------------------------------\n";
                 for (const auto& [key, value] : item.as_object()) {
-                    std::cout << std::setw(20) << std::left << key << ": " << json::serialize(value) << "\n";
+                    out << std::setw(20) << std::left << key << ": " << value << "\n";
                 }
             }
-            std::cout << "================================\n";
+            out << "================================\n";
         } else if (result.is_object()) {  // Handling a single object response
-            std::cout << "\n========== Response ==========\n";
+            out << "\n========== Response ==========\n";
             for (const auto& [key, value] : result.as_object()) {
-                std::cout << std::setw(20) << std::left << key << ": " << json::serialize(value) << "\n";
+                out << std::setw(20) << std::left << key << ": " << value << "\n";
             }
-            std::cout << "================================\n";
+            out << "================================\n";
         }
+        std::cout << out.str();
     } else if (response.as_object().contains("error")) {  // Error handling
         std::cerr << "\n[ERROR] " << response.at("error").at("message").as_string() << "\n";
     } else {
@@ -44,6 +280,11 @@ void TradingSystem::handle_response(const json::value& response) {
 
         if (result.contains("order")) {  // Handling order result
             std::cout << "Order ID: " << result.at("order").at("order_id").as_string() << "\n";
+            if (const auto* timing = response.as_object().if_contains("client_timing")) {  // Where the round trip went
+                std::cout << "Latency (us): to exchange " << json::serialize(timing->at("to_exchange_us"))
+                          << ", in exchange " << json::serialize(timing->at("in_exchange_us"))
+                          << ", back " << json::serialize(timing->at("from_exchange_us")) << "\n";
+            }
         } 
         else if (result.contains("bids") && result.at("bids").is_array()) {  // Handling order book bids
             std::cout << "Order Book:\n";
@@ -62,8 +303,55 @@ bool TradingSystem::check_full_result() {
     return check == 'a';
 }
 
+// Prints the risk limits and state and toggles the kill switch; engaging it also cancels every open order.
+void TradingSystem::show_risk_controls() {
+    RiskEngine& risk = RiskEngine::instance();
+    std::cout << "\n========== Risk Controls ==========\n";
+    risk.report(std::cout);
+    std::cout << "================================\n";
+    std::cout << (risk.kill_switch() ? "Release" : "Engage") << " the kill switch? (y/n): ";
+    std::string answer;
+    std::getline(std::cin, answer);
+    if (answer.empty() || std::tolower(static_cast<unsigned char>(answer[0])) != 'y') {
+        return;
+    }
+    bool engage = !risk.kill_switch();
+    risk.set_kill_switch(engage);
+    if (engage) {
+        risk.count_cancel();
+        handle_response(client.async_request(json::value{
+            {"jsonrpc", "2.0"},
+            {"method", "private/cancel_all"},
+            {"params", json::object{}}
+        }).get());
+    }
+    std::cout << "Kill switch " << (engage ? "engaged" : "released") << "\n";
+}
+
+// Sets the journal file the real-time feed is captured to.
+void TradingSystem::set_capture_path(const std::string& path) {
+    capture_path = path;
+}
+
+// Sets the shared-memory region the real-time feed is published to.
+void TradingSystem::set_shared_memory(const std::string& name) {
+    shared_memory_name = name;
+}
+
+// Stop the background feed started by option 8 and wait for it to drain
+void TradingSystem::stop_feed() {
+    if (!feed) {
+        return;
+    }
+    feed->stop();
+    feed->wait();
+    feed.reset();
+    AsyncLogger::instance().flush();
+    std::cout << "Real-time feed stopped\n";
+}
+
 // Displays the main menu options for trading system operations.
-void display_menu() {
+void display_menu(bool feed_running) {
     std::cout << "\033[1;36m\n==============================\n";
     std::cout << "WELCOME TO GOTRADEX TRADING SYSTEM\n";
     std::cout << "==============================\033[0m\n";
@@ -75,30 +363,44 @@ void display_menu() {
     std::cout << "5.  Get Orderbook\n";
     std::cout << "6.  View Positions\n";
     std::cout << "7.  Get Market Price\n";
-    std::cout << "8.  Get Real-Time Data\n";
-    std::cout << "9.  Exit\n\033[0m";
+    std::cout << (feed_running ? "8.  Stop Real-Time Data\n" : "8.  Get Real-Time Data\n");
+    std::cout << "9.  Exit\n";
+    std::cout << "10. Latency Report\n";
+    std::cout << "11. Market Analytics\n";
+    std::cout << "12. Risk Controls\n\033[0m";
 
     std::cout << "\nEnter your choice: ";
 }
 
-// Measures execution time for various operations.
+// Records the execution time of an operation into its "op.<name>" latency histogram (see menu option 10).
 void TradingSystem::measure_execution_time(std::function<void()> func, const std::string& operation_name) {
-    auto start_time = std::chrono::high_resolution_clock::now();
+    LatencyHistogram& histogram = LatencyRegistry::instance().histogram("op." + operation_name);
+    ScopedLatency timer(histogram);
     func();  // Execute the function
-    auto end_time = std::chrono::high_resolution_clock::now();
-    
-    double elapsed_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
-    std::cout << "\033[1;35m⏳ Execution time for " << operation_name << ": " 
-              << elapsed_time << " ms\033[0m\n";
 }
 
 // Main function to handle the trading system logic and display the menu.
 void TradingSystem::main_menu() {
     try {
         measure_execution_time([this]() {
-            client.connect();  // Connect to the trading client
-            client.authenticate();  // Authenticate the client
-        }, "Initialization");
+            // Resolve and TLS-handshake the market-data endpoint alongside the trading connection so
+            // option 8 starts from a cached address and a resumable session
+            std::thread feed_warmup([this]() {
+                ConnectionBootstrap::instance().prewarm(feed_host, feed_port, "/ws/api/v2");
+            });
+            try {
+                client.connect();  // Connect to the trading client
+                client.authenticate();  // Authenticate the client; refresh_token keeps the session alive
+                client.set_heartbeat(10);  // A dead connection is noticed within 15 s
+                client.start_clock_sync();  // Exchange clock offset for the one-way latencies
+            } catch (...) {
+                feed_warmup.join();
+                throw;
+            }
+            start_instrument_download();  // Completes in the background
+            start_order_sync();  // Completes in the background
+            feed_warmup.join();
+        }, "init");
 
     } catch (const std::exception& e) {
         std::cerr << "Initialization failed: " << e.what() << "\n";
@@ -106,7 +408,7 @@ void TradingSystem::main_menu() {
     }
 
     while (true) {
-        display_menu();  // Display the menu to the user
+        display_menu(feed && feed->running());  // Display the menu to the user
         int choice;
         std::cin >> choice;
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // Clean up input buffer
@@ -137,33 +439,35 @@ void TradingSystem::main_menu() {
                 measure_execution_time([this, &instrument, &type, quantity, price, choice, state_for_full_result]() {
                     auto response = (choice == 1) ? client.place_order(instrument, type, quantity, price) 
                                                   : client.sell_order(instrument, type, quantity, price);
+                    order_cache.record_order_response(response);
 
                     if (state_for_full_result) {
                         handle_response_all(response);  // Handle full response
                     } else {
                         handle_response(response);  // Handle normal response
                     }
-                }, (choice == 1) ? "Buy Order" : "Sell Order");
+                }, (choice == 1) ? "buy" : "sell");
 
             } else if (choice == 3) {  // Cancel Order
-                std::string order_id;
-                std::cout << "Order ID: ";
-                std::getline(std::cin, order_id);
+                std::string order_id = choose_order();
 
                 // Measure execution time for canceling the order
                 measure_execution_time([this, &order_id, state_for_full_result]() {
+                    auto response = client.cancel_order(order_id);
+                    order_cache.record_order_response(response);
                     if (state_for_full_result) {
-                        handle_response_all(client.cancel_order(order_id));  // Full response handling
+                        handle_response_all(response);  // Full response handling
                     } else {
-                        handle_response(client.cancel_order(order_id));  // Normal response handling
+                        handle_response(response);  // Normal response handling
                     }
-                }, "Cancel Order");
+                }, "cancel");
 
             } else if (choice == 4) {  // Modify Order
-                std::string order_id;
+                std::string order_id = choose_order();
                 double new_price, amount;
-                std::cout << "Order ID: ";
-                std::getline(std::cin, order_id);
+                if (auto order = order_cache.find_order(order_id)) {
+                    std::cout << "Current: " << order->amount << " @ " << order->price << "\n";
+                }
                 std::cout << "Amount: ";
                 std::cin >> amount;
                 std::cout << "New Price: ";
@@ -172,26 +476,27 @@ void TradingSystem::main_menu() {
 
                 // Measure execution time for modifying the order
                 measure_execution_time([this, &order_id, amount, new_price, state_for_full_result]() {
+                    auto response = client.modify_order(order_id, amount, new_price);
+                    order_cache.record_order_response(response);
                     if (state_for_full_result) {
-                        handle_response_all(client.modify_order(order_id, amount, new_price));
+                        handle_response_all(response);
                     } else {
-                        handle_response(client.modify_order(order_id, amount, new_price));
+                        handle_response(response);
                     }
-                }, "Modify Order");
+                }, "edit");
 
             } else if (choice == 5) {  // Get Orderbook
-                std::string instrument;
+                std::string instrument, depth;
                 std::cout << "Instrument: ";
                 std::getline(std::cin, instrument);
+                std::cout << "Depth (default 5): ";
+                std::getline(std::cin, depth);
+                std::size_t levels = depth.empty() ? 5 : std::stoul(depth);
 
-                // Measure execution time for fetching the orderbook
-                measure_execution_time([this, &instrument, state_for_full_result]() {
-                    if (state_for_full_result) {
-                        handle_response_all(client.get_orderbook(instrument));
-                    } else {
-                        handle_response(client.get_orderbook(instrument));
-                    }
-                }, "Get Orderbook");
+                // Measure execution time for reading the orderbook
+                measure_execution_time([this, &instrument, levels]() {
+                    show_orderbook(instrument, levels);
+                }, "orderbook");
 
             } else if (choice == 6) {  // View Positions
                 std::string currency, kind;
@@ -210,13 +515,9 @@ void TradingSystem::main_menu() {
                 }
 
                 // Measure execution time for viewing positions
-                measure_execution_time([this, &currency, &kind, state_for_full_result]() {
-                    if (state_for_full_result) {
-                        handle_response_all(client.view_positions(currency, kind));
-                    } else {
-                        handle_response(client.view_positions(currency, kind));
-                    }
-                }, "View Positions");
+                measure_execution_time([this, &currency, &kind]() {
+                    show_positions(currency, kind);
+                }, "positions");
 
             } else if (choice == 7) {  // Get Market Price
                 std::string instrument_name;
@@ -230,15 +531,74 @@ void TradingSystem::main_menu() {
                     } else {
                         handle_response(client.get_market_price_by_instruments(instrument_name));
                     }
-                }, "Get Market Price");
+                }, "market_price");
+
+            } else if (choice == 8) {  // Real-Time Data, in the background so the menu stays usable
+                if (feed && feed->running()) {
+                    stop_feed();
+                    continue;
+                }
+                std::string instruments, shards, redundant, log_path;
+                std::cout << "Instruments (comma separated, blank for price indices only): ";
+                std::getline(std::cin, instruments);
+                std::cout << "Connections (default 1): ";
+                std::getline(std::cin, shards);
+                std::cout << "Redundant A/B legs (y/N): ";
+                std::getline(std::cin, redundant);
+                std::cout << "Event log file (blank for the console): ";
+                std::getline(std::cin, log_path);
+
+                FeedConfig config;
+                std::stringstream instrument_list(instruments);
+                for (std::string instrument; std::getline(instrument_list, instrument, ',');) {
+                    instrument.erase(std::remove(instrument.begin(), instrument.end(), ' '), instrument.end());
+                    if (!instrument.empty()) {
+                        config.instruments.push_back(instrument);
+                    }
+                }
+                config.channel_templates = {"book.{}.100ms", "ticker.{}.100ms", "trades.{}.100ms"};
+                config.channels = {"deribit_price_index.btc_usd", "deribit_price_index.algo_usd", "deribit_price_index.bch_usd"};
+                config.shards = shards.empty() ? 1 : std::stoi(shards);
+                config.redundant = !redundant.empty() && std::tolower(static_cast<unsigned char>(redundant[0])) == 'y';
 
-            } else if (choice == 8) {  // Real-Time Data
-                Rtm_Server websocket;
-                websocket.run();
+                if (!log_path.empty()) {
+                    AsyncLogger::instance().set_file(log_path);
+                }
+                feed.reset();  // Join a feed whose connections ended on their own
+                feed = std::make_unique<Rtm_Server>();
+                feed->set_endpoint(feed_host, feed_port);
+                feed->set_feed_config(config);
+                if (!capture_path.empty()) {
+                    feed->enable_capture(capture_path);
+                }
+                if (!shared_memory_name.empty()) {
+                    feed->enable_shared_memory(shared_memory_name);
+                }
+                feed->start();
+                std::cout << "Real-time feed running; choose 8 again to stop it\n";
             }
             else if (choice == 9) {  // Exit
+                stop_feed();
                 break;
             }
+            else if (choice == 11) {  // Market Analytics
+                std::string instrument;
+                std::cout << "Instrument: ";
+                std::getline(std::cin, instrument);
+
+                // Measure execution time for reading the analytics
+                measure_execution_time([this, &instrument]() {
+                    show_analytics(instrument);
+                }, "analytics");
+            }
+            else if (choice == 12) {  // Risk Controls
+                show_risk_controls();
+            }
+            else if (choice == 10) {  // Latency Report
+                std::cout << "\n========== Latency (p50 / p99 / p99.9 / max) ==========\n";
+                LatencyRegistry::instance().report(std::cout);
+                std::cout << "================================\n";
+            }
         } catch (const std::exception& e) {  // Error handling for operations
             std::cerr << "Operation failed: " << e.what() << "\n";
         }
@@ -2,21 +2,49 @@
 #define TRADING_SYSTEM_HPP
 
 #include "DeribitClient.hpp"  // Include custom Deribit client header for interaction with Deribit API
+#include "OrderBook.hpp"  // Local order books fed by book.* subscriptions
+#include "OrderCache.hpp"  // Local orders and positions fed by user.* subscriptions
+#include "MarketAnalytics.hpp"  // Rolling VWAP, microprice and volatility for option 11
+#include "RiskEngine.hpp"  // Pre-trade limits and kill switch for option 12
 
 #include <functional>  // For using std::function to pass functions as arguments
+#include <memory>  // Background feed
+
+class Rtm_Server;  // Real-time feed for option 8
 
 class TradingSystem {
 private:
     DeribitClient client;  // DeribitClient instance for interacting with the Deribit API
     bool state_for_full_result;  // State flag to track full result status
+    OrderBookManager order_books;  // Books maintained from the client's book.* subscriptions
+    std::string capture_path;  // Journal for option 8, empty to disable capture
+    std::string shared_memory_name;  // Shared-memory region option 8 publishes to, empty for none
+    std::string feed_host, feed_port;  // Market-data endpoint for option 8, warmed up during initialization
+    std::unique_ptr<Rtm_Server> feed;  // Option 8's feed, running in the background while the menu stays live
+    OrderCache order_cache;  // Orders, positions and portfolio kept from the client's user.* subscriptions
+    MarketAnalytics analytics;  // Updated from the client's book.* and trades.* subscriptions (client strand)
+
+    void on_notification(const json::value& message);  // Route subscription frames from the client
+    void show_orderbook(const std::string& instrument, std::size_t levels);  // Serve option 5 from the local book
+    void start_order_sync();  // Subscribe to user.* channels and load the order and position snapshots
+    void start_instrument_download();  // Refresh the instrument registry from public/get_instruments
+    std::string choose_order();  // Options 3 and 4: pick an order from the local cache or type its id
+    void show_positions(const std::string& currency, const std::string& kind);  // Serve option 6 from the local cache
+    void update_analytics(std::string_view channel, const json::value& data);  // Feed book and trade notifications to the analytics
+    void show_analytics(const std::string& instrument);  // Serve option 11, subscribing on first use
+    void show_risk_controls();  // Serve option 12: risk state and the kill switch
+    void stop_feed();  // Stop option 8's feed and wait for it to drain
 public:
     TradingSystem(const std::string& host, const std::string& port, const char* client_id, const char* client_secret);  // Constructor to initialize client with connection details
+    ~TradingSystem();  // Stops a feed left running
     void main_menu();  // Display main menu for trading system
     void handle_response_all(const json::value& response);  // Handle full response from API
     void handle_response(const json::value& response);  // Handle specific response from API
     bool check_full_result();  // Check if the full result is available
+    void set_capture_path(const std::string& path);  // Record the real-time feed (option 8) to a binary journal
+    void set_shared_memory(const std::string& name);  // Publish the real-time feed (option 8) to local processes
 
-    void measure_execution_time(std::function<void()> func, const std::string& operation_name);  // Measure execution time of a function using std::function
+    void measure_execution_time(std::function<void()> func, const std::string& operation_name);  // Record execution time of a function into the "op.<name>" histogram
 };
 
 
@@ -0,0 +1,33 @@
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+#include <chrono>  // Wall-clock throughput
+#include <cstdlib>  // strtod
+#include <cstring>  // strcmp
+
+// Value following a "--name" argument, or fallback when absent
+inline double arg_or(int argc, char **argv, const char *name, double fallback) {
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return std::strtod(argv[i + 1], nullptr);
+        }
+    }
+    return fallback;
+}
+
+// True when a bare "--flag" argument is present
+inline bool has_flag(int argc, char **argv, const char *name) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Seconds elapsed since start
+inline double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif
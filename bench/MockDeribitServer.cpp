@@ -0,0 +1,392 @@
+#include "MockDeribitServer.hpp"
+#include "MockMarketData.hpp"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/x509.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace beast = boost::beast;  // Alias for Boost.Beast library
+namespace websocket = beast::websocket;  // Alias for WebSocket functionalities in Beast
+
+namespace {
+
+constexpr std::size_t kMaxQueuedFrames = 65536;  // Stop pushing stream data to a client that cannot keep up
+
+std::int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::int64_t now_us() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// One client connection; Stream is beast::tcp_stream (plain) or beast::ssl_stream<beast::tcp_stream> (TLS)
+template <class Stream>
+class MockSession : public std::enable_shared_from_this<MockSession<Stream>> {
+public:
+    static constexpr bool kTls = !std::is_same<Stream, beast::tcp_stream>::value;
+
+    MockSession(tcp::socket socket, MockDeribitServer &server)
+        : ws_(make_stream(std::move(socket), server)), server_(server), timer_(ws_.get_executor()),
+          market_data_(42, server.options().book_depth) {}
+
+    void start() {
+        if constexpr (kTls) {
+            ws_.next_layer().async_handshake(ssl::stream_base::server,
+                [self = this->shared_from_this()](beast::error_code ec) {
+                    if (!ec) {
+                        self->accept();
+                    }
+                });
+        } else {
+            accept();
+        }
+    }
+
+private:
+    static websocket::stream<Stream> make_stream(tcp::socket socket, MockDeribitServer &server) {
+        if constexpr (kTls) {
+            return websocket::stream<Stream>(std::move(socket), server.tls_context());
+        } else {
+            return websocket::stream<Stream>(std::move(socket));
+        }
+    }
+
+    void accept() {
+        ws_.async_accept([self = this->shared_from_this()](beast::error_code ec) {
+            if (!ec) {
+                self->do_read();
+                self->schedule_stream();
+            }
+        });
+    }
+
+    void do_read() {
+        ws_.async_read(buffer_, [self = this->shared_from_this()](beast::error_code ec, std::size_t) {
+            if (ec) {
+                self->closed_ = true;
+                self->timer_.cancel();
+                return;
+            }
+            std::string request = beast::buffers_to_string(self->buffer_.data());
+            self->buffer_.consume(self->buffer_.size());
+            self->handle_request(request);
+            self->do_read();
+        });
+    }
+
+    // Answer one JSON-RPC request
+    void handle_request(const std::string &text) {
+        std::int64_t received_us = now_us();
+        boost::system::error_code ec;
+        json::value request = json::parse(text, ec);
+        if (ec || !request.is_object()) {
+            return;
+        }
+        const auto &obj = request.as_object();
+        json::value id = obj.contains("id") ? obj.at("id") : json::value(nullptr);
+        std::string method = obj.contains("method") ? std::string(obj.at("method").as_string().c_str()) : "";
+        json::object params = obj.contains("params") && obj.at("params").is_object() ? obj.at("params").as_object()
+                                                                                     : json::object();
+        json::value result;
+        if (method == "public/auth") {
+            result = {{"access_token", "mock-access"}, {"refresh_token", "mock-refresh"}, {"expires_in", 900},
+                      {"scope", "connection mainaccount"}, {"token_type", "bearer"}};
+        } else if (method == "private/buy" || method == "private/sell") {
+            result = {{"order", {
+                          {"order_id", "MOCK-" + std::to_string(server_.next_order_id())},
+                          {"instrument_name", params.contains("instrument_name") ? params.at("instrument_name") : json::value("")},
+                          {"direction", method == "private/buy" ? "buy" : "sell"},
+                          {"amount", params.contains("amount") ? params.at("amount") : json::value(0)},
+                          {"price", params.contains("price") ? params.at("price") : json::value(0)},
+                          {"order_type", params.contains("type") ? params.at("type") : json::value("limit")},
+                          {"order_state", "open"},
+                          {"filled_amount", 0},
+                          {"creation_timestamp", now_ms()}}},
+                      {"trades", json::array()}};
+        } else if (method == "private/edit") {
+            result = {{"order", {
+                          {"order_id", params.contains("order_id") ? params.at("order_id") : json::value("")},
+                          {"amount", params.contains("amount") ? params.at("amount") : json::value(0)},
+                          {"price", params.contains("price") ? params.at("price") : json::value(0)},
+                          {"order_state", "open"},
+                          {"last_update_timestamp", now_ms()}}},
+                      {"trades", json::array()}};
+        } else if (method == "private/cancel") {
+            result = {{"order_id", params.contains("order_id") ? params.at("order_id") : json::value("")},
+                      {"order_state", "cancelled"},
+                      {"last_update_timestamp", now_ms()}};
+        } else if (method == "private/cancel_all_by_instrument") {
+            result = 0;  // Open orders are not tracked; the count is all the client reads
+        } else if (method == "private/mass_quote") {
+            json::array orders;
+            if (params.contains("quotes") && params.at("quotes").is_array()) {
+                for (const auto &quote : params.at("quotes").as_array()) {
+                    json::object entry = quote.as_object();
+                    entry["order_id"] = "MOCK-" + std::to_string(server_.next_order_id());
+                    entry["order_state"] = "open";
+                    orders.push_back(std::move(entry));
+                }
+            }
+            result = {{"orders", std::move(orders)}, {"errors", json::array()}};
+        } else if (method == "public/get_last_trades_by_instrument_and_time") {
+            result = trades_between(params);
+        } else if (method == "public/get_tradingview_chart_data") {
+            result = candles_between(params);
+        } else if (method == "public/get_order_book") {
+            std::string instrument = params.contains("instrument_name")
+                ? std::string(params.at("instrument_name").as_string().c_str()) : "BTC-PERPETUAL";
+            int depth = params.contains("depth") ? static_cast<int>(params.at("depth").to_number<std::int64_t>()) : 5;
+            result = market_data_.order_book(instrument, depth, now_ms());
+        } else if (method == "private/get_positions") {
+            result = json::array{json::value{
+                {"instrument_name", "BTC-PERPETUAL"}, {"kind", "future"}, {"direction", "zero"},
+                {"size", 0}, {"average_price", 0}, {"mark_price", 60000.0}, {"floating_profit_loss", 0}}};
+        } else if (method == "public/subscribe" || method == "public/unsubscribe") {
+            json::array confirmed;
+            if (params.contains("channels") && params.at("channels").is_array()) {
+                for (const auto &channel : params.at("channels").as_array()) {
+                    std::string name(channel.as_string().c_str());
+                    update_subscription(name, method == "public/subscribe");
+                    confirmed.push_back(json::value(name));
+                }
+            }
+            result = confirmed;
+        } else if (method == "private/subscribe") {
+            result = params.contains("channels") ? params.at("channels") : json::value(json::array());  // Confirmed; user.* channels never push
+        } else if (method == "public/test" || method == "public/set_heartbeat") {
+            result = "ok";
+        } else if (method == "public/get_time") {
+            result = now_ms();
+        } else {
+            send(json::serialize(json::value{
+                {"jsonrpc", "2.0"}, {"id", id},
+                {"error", {{"code", -32601}, {"message", "Method not found"}}}}));
+            return;
+        }
+
+        std::int64_t sent_us = now_us();
+        send(json::serialize(json::value{
+            {"jsonrpc", "2.0"}, {"id", id}, {"result", result}, {"testnet", true},
+            {"usIn", received_us}, {"usOut", sent_us}, {"usDiff", sent_us - received_us}}));
+    }
+
+    // Synthetic history: one trade every kTradeSpacingMs, trade_seq = timestamp / kTradeSpacingMs
+    static json::value trades_between(const json::object &params) {
+        constexpr std::int64_t kTradeSpacingMs = 10;
+        std::int64_t start = params.contains("start_timestamp") ? params.at("start_timestamp").to_number<std::int64_t>() : 0;
+        std::int64_t end = params.contains("end_timestamp") ? params.at("end_timestamp").to_number<std::int64_t>() : start;
+        std::int64_t count = params.contains("count") ? params.at("count").to_number<std::int64_t>() : 10;
+        json::array trades;
+        std::int64_t ts = (start + kTradeSpacingMs - 1) / kTradeSpacingMs * kTradeSpacingMs;
+        for (; ts <= end && static_cast<std::int64_t>(trades.size()) < count; ts += kTradeSpacingMs) {
+            std::int64_t seq = ts / kTradeSpacingMs;
+            trades.push_back(json::value{
+                {"trade_seq", seq}, {"trade_id", std::to_string(seq)}, {"timestamp", ts},
+                {"price", 60000.0 + static_cast<double>(seq % 200) * 0.5}, {"amount", 10 * (1 + seq % 5)},
+                {"direction", seq % 2 ? "sell" : "buy"}, {"index_price", 60000.0}, {"mark_price", 60000.0}});
+        }
+        return {{"trades", std::move(trades)}, {"has_more", ts <= end}};
+    }
+
+    // Synthetic candles at the requested resolution (minutes or 1D)
+    static json::value candles_between(const json::object &params) {
+        std::int64_t start = params.contains("start_timestamp") ? params.at("start_timestamp").to_number<std::int64_t>() : 0;
+        std::int64_t end = params.contains("end_timestamp") ? params.at("end_timestamp").to_number<std::int64_t>() : start;
+        std::string resolution = params.contains("resolution") ? std::string(params.at("resolution").as_string().c_str()) : "1";
+        std::int64_t step = resolution == "1D" ? 86400000 : std::max<std::int64_t>(std::atoll(resolution.c_str()), 1) * 60000;
+        json::array ticks, open, high, low, close, volume, cost;
+        for (std::int64_t tick = (start + step - 1) / step * step; tick <= end; tick += step) {
+            double base = 60000.0 + static_cast<double>((tick / step) % 500);
+            ticks.push_back(tick);
+            open.push_back(base);
+            high.push_back(base + 5);
+            low.push_back(base - 5);
+            close.push_back(base + 1);
+            volume.push_back(1.5);
+            cost.push_back(90000.0);
+        }
+        if (ticks.empty()) {
+            return {{"status", "no_data"}};
+        }
+        return {{"status", "ok"}, {"ticks", std::move(ticks)}, {"open", std::move(open)}, {"high", std::move(high)},
+                {"low", std::move(low)}, {"close", std::move(close)}, {"volume", std::move(volume)},
+                {"cost", std::move(cost)}};
+    }
+
+    void update_subscription(const std::string &channel, bool subscribe) {
+        for (auto it = channels_.begin(); it != channels_.end(); ++it) {
+            if (*it == channel) {
+                if (!subscribe) {
+                    channels_.erase(it);
+                }
+                return;
+            }
+        }
+        if (subscribe) {
+            channels_.push_back(channel);
+        }
+    }
+
+    // Push stream frames on a timer; at high rates several frames go out per tick
+    void schedule_stream() {
+        double rate = server_.options().messages_per_second;
+        if (rate <= 0.0) {
+            return;
+        }
+        auto period = std::chrono::microseconds(std::max<long>(1000, static_cast<long>(1e6 / rate)));
+        credit_ += rate * period.count() / 1e6;
+        timer_.expires_after(period);
+        timer_.async_wait([self = this->shared_from_this()](beast::error_code ec) {
+            if (ec || self->closed_) {
+                return;
+            }
+            std::int64_t timestamp = now_ms();
+            while (self->credit_ >= 1.0) {
+                self->credit_ -= 1.0;
+                for (const auto &channel : self->channels_) {
+                    if (self->queue_.size() >= kMaxQueuedFrames) {
+                        break;
+                    }
+                    std::string frame = self->market_data_.next_frame(channel, timestamp);
+                    if (!frame.empty()) {
+                        self->send(std::move(frame));
+                    }
+                }
+            }
+            self->schedule_stream();
+        });
+    }
+
+    void send(std::string frame) {
+        queue_.push_back(std::move(frame));
+        if (queue_.size() == 1) {
+            do_write();
+        }
+    }
+
+    void do_write() {
+        ws_.text(true);
+        ws_.async_write(net::buffer(queue_.front()), [self = this->shared_from_this()](beast::error_code ec, std::size_t) {
+            if (ec) {
+                self->closed_ = true;
+                self->timer_.cancel();
+                return;
+            }
+            self->queue_.pop_front();
+            if (!self->queue_.empty()) {
+                self->do_write();
+            }
+        });
+    }
+
+    websocket::stream<Stream> ws_;  // Client connection
+    MockDeribitServer &server_;  // Owner, for options and order ids
+    net::steady_timer timer_;  // Stream pacing
+    MockMarketData market_data_;  // Per-session market state
+    beast::flat_buffer buffer_;  // Request buffer
+    std::deque<std::string> queue_;  // Outgoing frames
+    std::vector<std::string> channels_;  // Subscribed channels
+    double credit_ = 0.0;  // Fractional frames owed per channel
+    bool closed_ = false;  // Connection is gone
+};
+
+}  // namespace
+
+// Constructor: bind the listening socket and prepare TLS
+MockDeribitServer::MockDeribitServer(Options options)
+    : options_(std::move(options)), acceptor_(ioc_) {
+    tcp::endpoint endpoint(net::ip::make_address(options_.address), options_.port);
+    acceptor_.open(endpoint.protocol());
+    acceptor_.set_option(net::socket_base::reuse_address(true));
+    acceptor_.bind(endpoint);
+    acceptor_.listen();
+    if (options_.tls) {
+        use_self_signed_certificate();
+    }
+}
+
+// Destructor: stop serving
+MockDeribitServer::~MockDeribitServer() {
+    stop();
+}
+
+// Serve on a background thread
+void MockDeribitServer::start() {
+    do_accept();
+    thread_ = std::thread([this]() { ioc_.run(); });
+}
+
+// Stop serving and join the thread
+void MockDeribitServer::stop() {
+    ioc_.stop();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+// Bound port
+unsigned short MockDeribitServer::port() const {
+    return acceptor_.local_endpoint().port();
+}
+
+// Accept connections forever, one session each
+void MockDeribitServer::do_accept() {
+    acceptor_.async_accept([this](beast::error_code ec, tcp::socket socket) {
+        if (!ec) {
+            socket.set_option(tcp::no_delay(true));
+            if (options_.tls) {
+                std::make_shared<MockSession<beast::ssl_stream<beast::tcp_stream>>>(std::move(socket), *this)->start();
+            } else {
+                std::make_shared<MockSession<beast::tcp_stream>>(std::move(socket), *this)->start();
+            }
+        }
+        do_accept();
+    });
+}
+
+// Generate a P-256 key and a one-day self-signed certificate for CN=localhost
+void MockDeribitServer::use_self_signed_certificate() {
+    std::unique_ptr<EVP_PKEY_CTX, decltype(&EVP_PKEY_CTX_free)> key_ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr),
+                                                                        EVP_PKEY_CTX_free);
+    EVP_PKEY *raw_key = nullptr;
+    if (!key_ctx || EVP_PKEY_keygen_init(key_ctx.get()) <= 0
+        || EVP_PKEY_CTX_set_ec_paramgen_curve_nid(key_ctx.get(), NID_X9_62_prime256v1) <= 0
+        || EVP_PKEY_keygen(key_ctx.get(), &raw_key) <= 0) {
+        throw std::runtime_error("Mock server: key generation failed");
+    }
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(raw_key, EVP_PKEY_free);
+
+    std::unique_ptr<X509, decltype(&X509_free)> cert(X509_new(), X509_free);
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 24 * 60 * 60);
+    X509_set_pubkey(cert.get(), key.get());
+    X509_NAME *name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char *>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), name);
+    if (X509_sign(cert.get(), key.get(), EVP_sha256()) <= 0) {
+        throw std::runtime_error("Mock server: certificate signing failed");
+    }
+
+    if (SSL_CTX_use_certificate(ssl_ctx_.native_handle(), cert.get()) != 1
+        || SSL_CTX_use_PrivateKey(ssl_ctx_.native_handle(), key.get()) != 1) {
+        throw std::runtime_error("Mock server: could not install certificate");
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef MOCK_DERIBIT_SERVER_HPP
+#define MOCK_DERIBIT_SERVER_HPP
+
+#include <boost/asio.hpp>  // Acceptor and io_context
+#include <boost/asio/ssl.hpp>  // Self-signed TLS mode
+#include <atomic>  // Order id counter
+#include <cstdint>  // Counters
+#include <string>  // Listen address
+#include <thread>  // Server thread
+
+namespace net = boost::asio;  // Alias for Boost.Asio library
+namespace ssl = boost::asio::ssl;  // Alias for Boost.Asio SSL functionality
+using tcp = net::ip::tcp;  // Alias for TCP socket type in Boost.Asio
+
+// Local stand-in for the Deribit WebSocket API used by the benchmarks. It answers the JSON-RPC methods
+// DeribitClient sends (public/auth, private/buy|sell|edit|cancel, private/cancel_all_by_instrument,
+// private/mass_quote, public/get_order_book, private/get_positions, public/subscribe|unsubscribe,
+// private/subscribe, and synthetic history for public/get_last_trades_by_instrument_and_time and
+// public/get_tradingview_chart_data) and pushes MockMarketData frames to every subscribed channel at a
+// fixed rate. TLS mode uses a certificate generated at start-up.
+class MockDeribitServer {
+public:
+    struct Options {
+        std::string address = "127.0.0.1";  // Listen address
+        unsigned short port = 0;  // 0 picks a free port; see port()
+        bool tls = true;  // Self-signed TLS (what DeribitClient and Rtm_Server speak) or plain WebSocket
+        double messages_per_second = 10.0;  // Push rate per subscribed channel
+        int book_depth = 20;  // Levels per side in book snapshots
+    };
+
+    explicit MockDeribitServer(Options options);  // Bind and prepare; call start() to serve
+    ~MockDeribitServer();  // Stops the server
+    MockDeribitServer(const MockDeribitServer &) = delete;
+    MockDeribitServer &operator=(const MockDeribitServer &) = delete;
+
+    void start();  // Serve on a background thread
+    void stop();  // Stop serving and join the thread
+    unsigned short port() const;  // Bound port
+    const Options &options() const { return options_; }  // Configuration in use
+    std::uint64_t next_order_id() { return ++order_ids_; }  // Shared across sessions
+    ssl::context &tls_context() { return ssl_ctx_; }  // Server-side TLS context
+
+private:
+    void do_accept();  // Accept the next connection
+    void use_self_signed_certificate();  // Generate a throwaway key and certificate for localhost
+
+    Options options_;  // Configuration
+    net::io_context ioc_;  // Drives every session
+    ssl::context ssl_ctx_{ssl::context::tls_server};  // Used in TLS mode
+    tcp::acceptor acceptor_;  // Listening socket
+    std::thread thread_;  // Runs ioc_
+    std::atomic<std::uint64_t> order_ids_{0};  // Source of mock order ids
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "MockMarketData.hpp"
+
+#include <cmath>
+
+namespace {
+
+// Second dot-separated token of a channel name: "book.BTC-PERPETUAL.100ms" -> "BTC-PERPETUAL"
+std::string channel_subject(const std::string &channel) {
+    auto first = channel.find('.');
+    if (first == std::string::npos) {
+        return {};
+    }
+    auto second = channel.find('.', first + 1);
+    return channel.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1);
+}
+
+json::array levels_array(const std::map<double, double> &levels, bool descending, const char *verb, int depth) {
+    json::array out;
+    int n = 0;
+    auto emit = [&](double price, double amount) {
+        if (verb) {
+            out.push_back(json::array{verb, price, amount});
+        } else {
+            out.push_back(json::array{price, amount});
+        }
+        return ++n < depth;
+    };
+    if (descending) {
+        for (auto it = levels.rbegin(); it != levels.rend() && emit(it->first, it->second); ++it) {
+        }
+    } else {
+        for (auto it = levels.begin(); it != levels.end() && emit(it->first, it->second); ++it) {
+        }
+    }
+    return out;
+}
+
+}  // namespace
+
+// Constructor
+MockMarketData::MockMarketData(std::uint64_t seed, int book_depth)
+    : rng_(seed), book_depth_(book_depth) {}
+
+// State for an instrument, with a book seeded around a plausible price
+MockMarketData::InstrumentState &MockMarketData::state(const std::string &instrument) {
+    auto it = instruments_.find(instrument);
+    if (it != instruments_.end()) {
+        return it->second;
+    }
+    InstrumentState &st = instruments_[instrument];
+    st.mid = instrument.rfind("ETH", 0) == 0 || instrument.rfind("eth", 0) == 0 ? 3000.0 : 60000.0;
+    std::uniform_real_distribution<double> amount(10.0, 5000.0);
+    for (int i = 1; i <= book_depth_; ++i) {
+        st.bids[st.mid - i * st.tick] = std::round(amount(rng_));
+        st.asks[st.mid + i * st.tick] = std::round(amount(rng_));
+    }
+    return st;
+}
+
+// Next notification for a channel wrapped in the JSON-RPC subscription envelope
+std::string MockMarketData::next_frame(const std::string &channel, std::int64_t timestamp_ms) {
+    std::string subject = channel_subject(channel);
+    if (subject.empty()) {
+        return {};
+    }
+    InstrumentState &st = state(subject);
+    json::value data;
+    if (channel.rfind("book.", 0) == 0) {
+        data = book_frame(st, subject, timestamp_ms);
+    } else if (channel.rfind("trades.", 0) == 0) {
+        data = trades_frame(st, subject, timestamp_ms);
+    } else if (channel.rfind("ticker.", 0) == 0) {
+        data = ticker_frame(st, subject, timestamp_ms);
+    } else if (channel.rfind("deribit_price_index.", 0) == 0) {
+        data = index_frame(st, subject, timestamp_ms);
+    } else {
+        return {};
+    }
+    json::value frame = {
+        {"jsonrpc", "2.0"},
+        {"method", "subscription"},
+        {"params", { {"channel", channel}, {"data", data} }}
+    };
+    return json::serialize(frame);
+}
+
+// Snapshot on first use, then a delta touching one to three levels near the top
+json::value MockMarketData::book_frame(InstrumentState &st, const std::string &instrument, std::int64_t timestamp_ms) {
+    std::int64_t prev_change_id = st.change_id;
+    st.change_id += 1 + static_cast<std::int64_t>(rng_() % 3);
+    if (!st.snapshot_sent) {
+        st.snapshot_sent = true;
+        return {
+            {"type", "snapshot"},
+            {"timestamp", timestamp_ms},
+            {"instrument_name", instrument},
+            {"change_id", st.change_id},
+            {"bids", levels_array(st.bids, true, "new", book_depth_)},
+            {"asks", levels_array(st.asks, false, "new", book_depth_)}
+        };
+    }
+
+    json::array bids, asks;
+    std::uniform_real_distribution<double> amount(10.0, 5000.0);
+    int changes = 1 + static_cast<int>(rng_() % 3);
+    for (int i = 0; i < changes; ++i) {
+        bool bid_side = rng_() & 1;
+        auto &levels = bid_side ? st.bids : st.asks;
+        int offset = 1 + static_cast<int>(rng_() % book_depth_);
+        double price = bid_side ? st.mid - offset * st.tick : st.mid + offset * st.tick;
+        auto it = levels.find(price);
+        json::array level;
+        if (it == levels.end()) {
+            double size = std::round(amount(rng_));
+            levels[price] = size;
+            level = {"new", price, size};
+        } else if (rng_() % 4 == 0) {
+            levels.erase(it);
+            level = {"delete", price, 0.0};
+        } else {
+            it->second = std::round(amount(rng_));
+            level = {"change", price, it->second};
+        }
+        (bid_side ? bids : asks).push_back(level);
+    }
+    return {
+        {"type", "change"},
+        {"timestamp", timestamp_ms},
+        {"instrument_name", instrument},
+        {"change_id", st.change_id},
+        {"prev_change_id", prev_change_id},
+        {"bids", bids},
+        {"asks", asks}
+    };
+}
+
+// One or two trades at the touch
+json::value MockMarketData::trades_frame(InstrumentState &st, const std::string &instrument, std::int64_t timestamp_ms) {
+    json::array trades;
+    int count = 1 + static_cast<int>(rng_() % 2);
+    for (int i = 0; i < count; ++i) {
+        bool buy = rng_() & 1;
+        ++st.trade_seq;
+        trades.push_back(json::value{
+            {"trade_seq", st.trade_seq},
+            {"trade_id", std::to_string(100000 + st.trade_seq)},
+            {"timestamp", timestamp_ms},
+            {"tick_direction", 0},
+            {"price", buy ? st.mid + st.tick : st.mid - st.tick},
+            {"mark_price", st.mid},
+            {"instrument_name", instrument},
+            {"index_price", st.mid},
+            {"direction", buy ? "buy" : "sell"},
+            {"amount", static_cast<double>(10 * (1 + rng_() % 50))}
+        });
+    }
+    return trades;
+}
+
+// Ticker built from the mock book's touch
+json::value MockMarketData::ticker_frame(InstrumentState &st, const std::string &instrument, std::int64_t timestamp_ms) {
+    double bid = st.bids.empty() ? st.mid - st.tick : st.bids.rbegin()->first;
+    double ask = st.asks.empty() ? st.mid + st.tick : st.asks.begin()->first;
+    return {
+        {"timestamp", timestamp_ms},
+        {"instrument_name", instrument},
+        {"best_bid_price", bid},
+        {"best_bid_amount", st.bids.empty() ? 0.0 : st.bids.rbegin()->second},
+        {"best_ask_price", ask},
+        {"best_ask_amount", st.asks.empty() ? 0.0 : st.asks.begin()->second},
+        {"last_price", st.mid},
+        {"mark_price", st.mid},
+        {"index_price", st.mid},
+        {"open_interest", 1000000.0},
+        {"state", "open"}
+    };
+}
+
+// Random-walk price index
+json::value MockMarketData::index_frame(InstrumentState &st, const std::string &index_name, std::int64_t timestamp_ms) {
+    std::normal_distribution<double> step(0.0, st.mid * 1e-5);
+    st.mid += step(rng_);
+    return {
+        {"index_name", index_name},
+        {"price", st.mid},
+        {"timestamp", timestamp_ms}
+    };
+}
+
+// public/get_order_book result for the mock book
+json::value MockMarketData::order_book(const std::string &instrument, int depth, std::int64_t timestamp_ms) {
+    InstrumentState &st = state(instrument);
+    double bid = st.bids.empty() ? 0.0 : st.bids.rbegin()->first;
+    double ask = st.asks.empty() ? 0.0 : st.asks.begin()->first;
+    return {
+        {"timestamp", timestamp_ms},
+        {"instrument_name", instrument},
+        {"change_id", st.change_id},
+        {"bids", levels_array(st.bids, true, nullptr, depth)},
+        {"asks", levels_array(st.asks, false, nullptr, depth)},
+        {"best_bid_price", bid},
+        {"best_ask_price", ask},
+        {"mark_price", st.mid},
+        {"index_price", st.mid},
+        {"state", "open"}
+    };
+}
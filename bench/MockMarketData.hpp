@@ -0,0 +1,44 @@
+#ifndef MOCK_MARKET_DATA_HPP
+#define MOCK_MARKET_DATA_HPP
+
+#include <boost/json.hpp>  // Frame construction
+#include <cstdint>  // Change ids and sequence numbers
+#include <map>  // Per-channel state and mock book levels
+#include <random>  // Price walks and level churn
+#include <string>  // Channel names and frames
+
+namespace json = boost::json;  // Alias for Boost.JSON library
+
+// Produces Deribit-shaped subscription frames for book.*, trades.*, ticker.* and deribit_price_index.*
+// channels. Books are internally consistent: the first frame of a book channel is a snapshot and later
+// frames are deltas against it with chained change ids, so clients can maintain a correct local book.
+class MockMarketData {
+public:
+    explicit MockMarketData(std::uint64_t seed = 42, int book_depth = 20);  // Deterministic for a given seed
+
+    std::string next_frame(const std::string &channel, std::int64_t timestamp_ms);  // Next notification for channel, empty if unknown
+    json::value order_book(const std::string &instrument, int depth, std::int64_t timestamp_ms);  // public/get_order_book result
+
+private:
+    struct InstrumentState {
+        double mid = 0.0;  // Reference price
+        double tick = 0.5;  // Price increment
+        std::int64_t change_id = 0;  // Last change id sent
+        std::int64_t trade_seq = 0;  // Last trade sequence sent
+        bool snapshot_sent = false;  // Book channel has had its snapshot
+        std::map<double, double> bids;  // Price -> amount
+        std::map<double, double> asks;  // Price -> amount
+    };
+
+    InstrumentState &state(const std::string &instrument);  // State for an instrument, seeded on first use
+    json::value book_frame(InstrumentState &st, const std::string &instrument, std::int64_t timestamp_ms);  // Snapshot or delta
+    json::value trades_frame(InstrumentState &st, const std::string &instrument, std::int64_t timestamp_ms);  // One or two trades
+    json::value ticker_frame(InstrumentState &st, const std::string &instrument, std::int64_t timestamp_ms);  // Top of book and marks
+    json::value index_frame(InstrumentState &st, const std::string &index_name, std::int64_t timestamp_ms);  // Price index
+
+    std::mt19937_64 rng_;  // Source of randomness
+    int book_depth_;  // Levels per side in snapshots
+    std::map<std::string, InstrumentState> instruments_;  // Instrument or index name -> state
+};
+
+#endif
@@ -0,0 +1,70 @@
+// Cost of keeping rolling analytics (VWAP, microprice, trade imbalance, realized volatility) for many
+// instruments, against recomputing the trade window from scratch on every tick.
+//   bench_analytics [--instruments N] [--updates N]
+#include "BenchUtil.hpp"
+#include "MarketAnalytics.hpp"
+#include "LatencyStats.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+    auto instruments = static_cast<std::size_t>(arg_or(argc, argv, "--instruments", 500));
+    auto updates = static_cast<std::size_t>(arg_or(argc, argv, "--updates", 2000000));
+
+    MarketAnalytics analytics;
+    std::vector<InstrumentAnalytics *> handles;
+    std::vector<double> mids(instruments, 60000.0);
+    for (std::size_t i = 0; i < instruments; ++i) {
+        handles.push_back(&analytics.get_or_create("BTC-" + std::to_string(i)));
+    }
+
+    // Half trades, half quotes, on random instruments, 1 ms of exchange time per update
+    std::mt19937_64 rng(11);
+    std::normal_distribution<double> step(0.0, 2.0);
+    LatencyHistogram &update_latency = LatencyRegistry::instance().histogram("bench.analytics_update");
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < updates; ++i) {
+        std::size_t instrument = rng() % instruments;
+        auto timestamp = static_cast<std::int64_t>(i);
+        double &mid = mids[instrument];
+        std::uint64_t t0;
+        if (i & 1) {
+            mid += step(rng);
+            t0 = TscClock::now();
+            handles[instrument]->update_quote(timestamp, mid - 0.5, 10.0 + (i & 7), mid + 0.5, 20.0);
+        } else {
+            t0 = TscClock::now();
+            handles[instrument]->add_trade(timestamp, mid, 1.0 + (i & 3), (i & 2) != 0);
+        }
+        update_latency.record_ticks(t0);
+    }
+    double seconds = seconds_since(start);
+
+    // What each tick would cost if the trade window were re-summed instead
+    std::vector<double> window(AnalyticsConfig().max_trades, 1.0);
+    double checksum = 0.0;
+    std::uint64_t t0 = TscClock::now();
+    for (int repeat = 0; repeat < 1000; ++repeat) {
+        double notional = 0.0, amount = 0.0;
+        for (double value : window) {
+            notional += value * 60000.0;
+            amount += value;
+        }
+        checksum += notional / amount;
+    }
+    double rescan_ns = static_cast<double>(TscClock::to_ns(TscClock::now() - t0)) / 1000.0;
+
+    AnalyticsSnapshot snapshot;
+    analytics.snapshot("BTC-0", snapshot);
+    std::cout << "instruments " << instruments << ", updates " << updates << ": " << updates / seconds << " updates/s\n";
+    std::cout << "update: p50 " << update_latency.percentile(50.0) << " ns, p99 " << update_latency.percentile(99.0)
+              << " ns, max " << update_latency.max() << " ns\n";
+    std::cout << "full trade-window rescan (" << window.size() << " trades): " << rescan_ns << " ns per tick\n";
+    std::cout << "BTC-0: vwap " << snapshot.vwap << " over " << snapshot.trades << " trades, imbalance "
+              << snapshot.trade_imbalance << ", microprice " << snapshot.microprice << ", vol " << snapshot.realized_vol
+              << "% (checksum " << checksum << ")\n";
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Cost of applying incremental updates to OrderBook and of top-of-book / depth queries.
+//   bench_book [--levels N] [--updates N]
+#include "BenchUtil.hpp"
+#include "OrderBook.hpp"
+#include "LatencyStats.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char **argv) {
+    auto levels = static_cast<int>(arg_or(argc, argv, "--levels", 1000));
+    auto updates = static_cast<std::size_t>(arg_or(argc, argv, "--updates", 1000000));
+    const double mid = 60000.0, tick = 0.5;
+
+    OrderBook book("BTC-PERPETUAL");
+    std::vector<LevelChange> snapshot;
+    for (int i = 1; i <= levels; ++i) {
+        snapshot.push_back({BookSide::Bid, LevelAction::New, mid - i * tick, 100.0});
+        snapshot.push_back({BookSide::Ask, LevelAction::New, mid + i * tick, 100.0});
+    }
+    book.apply(true, 1, 0, 0, snapshot.data(), snapshot.size());
+
+    // Updates cluster near the touch like real flow; deletes are re-added so depth stays stable
+    std::mt19937_64 rng(7);
+    std::geometric_distribution<int> distance(0.2);
+    std::vector<LevelChange> deltas(updates);
+    for (auto &delta : deltas) {
+        bool bid = rng() & 1;
+        int offset = 1 + std::min(distance(rng), levels - 1);
+        double price = bid ? mid - offset * tick : mid + offset * tick;
+        int action = static_cast<int>(rng() % 10);
+        delta = {bid ? BookSide::Bid : BookSide::Ask,
+                 action == 0 ? LevelAction::Delete : LevelAction::Change, price, 50.0 + action};
+    }
+
+    LatencyHistogram &apply_latency = LatencyRegistry::instance().histogram("bench.book_apply");
+    auto start = std::chrono::steady_clock::now();
+    std::int64_t change_id = 1;
+    for (const auto &delta : deltas) {
+        LevelChange pair[2] = {delta, delta};
+        std::size_t count = 1;
+        if (delta.action == LevelAction::Delete) {
+            pair[1].action = LevelAction::New;  // Re-add so the book keeps its shape
+            count = 2;
+        }
+        std::uint64_t t0 = TscClock::now();
+        book.apply(false, change_id + 1, change_id, 0, pair, count);
+        apply_latency.record_ticks(t0);
+        ++change_id;
+    }
+    double apply_seconds = seconds_since(start);
+
+    LatencyHistogram &query_latency = LatencyRegistry::instance().histogram("bench.book_top");
+    PriceLevel bid{}, ask{};
+    double checksum = 0.0;
+    for (std::size_t i = 0; i < updates; ++i) {
+        std::uint64_t t0 = TscClock::now();
+        book.top_of_book(bid, ask);
+        query_latency.record_ticks(t0);
+        checksum += bid.price;
+    }
+    PriceLevel depth[10];
+    std::uint64_t t0 = TscClock::now();
+    book.depth(BookSide::Ask, depth, 10);
+    std::uint64_t depth_ns = TscClock::to_ns(TscClock::now() - t0);
+
+    std::cout << "book levels/side " << levels << ", synced " << book.is_synced() << "\n";
+    std::cout << "apply:  " << updates / apply_seconds << " updates/s, p50 " << apply_latency.percentile(50.0)
+              << " ns, p99 " << apply_latency.percentile(99.0) << " ns, max " << apply_latency.max() << " ns\n";
+    std::cout << "top:    p50 " << query_latency.percentile(50.0) << " ns, p99 " << query_latency.percentile(99.0)
+              << " ns (checksum " << checksum << ")\n";
+    std::cout << "depth10: " << depth_ns << " ns\n";
+    return 0;
+}
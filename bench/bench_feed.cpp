@@ -0,0 +1,54 @@
+// Decode throughput of the Rtm_Server feed path (FeedDecoder) over mock book, trade, ticker and index frames.
+//   bench_feed [--frames N] [--instruments N]
+#include "BenchUtil.hpp"
+#include "MockMarketData.hpp"
+#include "FeedDecoder.hpp"
+#include "LatencyStats.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv) {
+    auto frame_count = static_cast<std::size_t>(arg_or(argc, argv, "--frames", 200000));
+    auto instruments = static_cast<int>(arg_or(argc, argv, "--instruments", 20));
+
+    // Pre-render a realistic mix so only decoding is timed
+    std::vector<std::string> channels;
+    for (int i = 0; i < instruments; ++i) {
+        std::string name = "BTC-" + std::to_string(i) + "JAN30-60000-C";
+        channels.push_back("book." + name + ".100ms");
+        channels.push_back("book." + name + ".100ms");
+        channels.push_back("trades." + name + ".100ms");
+        channels.push_back("ticker." + name + ".100ms");
+    }
+    channels.push_back("deribit_price_index.btc_usd");
+
+    MockMarketData market_data;
+    std::vector<std::string> frames;
+    frames.reserve(frame_count);
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < frame_count; ++i) {
+        frames.push_back(market_data.next_frame(channels[i % channels.size()], 1700000000000 + static_cast<std::int64_t>(i)));
+        bytes += frames.back().size();
+    }
+
+    std::size_t events = 0;
+    FeedDecoder decoder([&events](const MarketEvent &) { ++events; });
+    LatencyHistogram &per_frame = LatencyRegistry::instance().histogram("bench.decode_frame");
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &frame : frames) {
+        std::uint64_t frame_start = TscClock::now();
+        decoder.decode(frame, 0);
+        per_frame.record_ticks(frame_start);
+    }
+    double seconds = seconds_since(start);
+
+    std::cout << "frames:   " << frame_count << " (" << bytes / (1024.0 * 1024.0) << " MiB), events " << events << "\n";
+    std::cout << "rate:     " << frame_count / seconds << " frames/s, " << bytes / seconds / (1024.0 * 1024.0) << " MiB/s\n";
+    std::cout << "per frame p50 " << per_frame.percentile(50.0) << " ns, p99 " << per_frame.percentile(99.0)
+              << " ns, p99.9 " << per_frame.percentile(99.9) << " ns\n";
+    std::cout << "malformed " << decoder.malformed_frames() << "\n";
+    return 0;
+}
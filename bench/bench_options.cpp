@@ -0,0 +1,136 @@
+// Cost of repricing a whole option chain (price, Greeks and implied vol of every strike) on an index
+// update, with the AVX2 kernels against the scalar reference, and of a single-strike ticker update.
+//   bench_options [--expiries N] [--strikes N] [--updates N]
+#include "BenchUtil.hpp"
+#include "OptionChain.hpp"
+#include "LatencyStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr std::int64_t kNow = 1893484800000;  // 2030-01-01 00:00 UTC, exchange time of every update
+const char *const kExpiries[] = {"02JAN30", "03JAN30", "04JAN30", "11JAN30", "18JAN30", "25JAN30", "22FEB30",
+                                 "29MAR30", "28JUN30", "27SEP30", "27DEC30", "26DEC31"};
+
+MarketEvent make_ticker(const std::string &name, double mark_iv, double bid, double ask, double index, double basis) {
+    MarketEvent event;
+    std::memset(&event, 0, sizeof(event));
+    event.type = EventType::Ticker;
+    copy_symbol(event.symbol, name);
+    event.exchange_ts = kNow;
+    event.ticker.mark_iv = mark_iv;
+    event.ticker.best_bid_price = bid;
+    event.ticker.best_ask_price = ask;
+    event.ticker.index_price = index;
+    event.ticker.underlying_price = index + basis;
+    return event;
+}
+
+// Same instruments and tickers in both chains; quotes straddle the model price so every mid inverts
+void build(OptionChain &chain, std::size_t expiries, std::size_t strikes, double index) {
+    std::vector<std::string> names;
+    for (std::size_t e = 0; e < expiries; ++e) {
+        for (std::size_t k = 0; k < strikes; ++k) {
+            auto strike = static_cast<long>(index * (0.5 + k / static_cast<double>(strikes)) / 1000.0) * 1000;
+            for (const char *side : {"C", "P"}) {
+                std::string name = std::string("BTC-") + kExpiries[e] + "-" + std::to_string(strike) + "-" + side;
+                if (chain.add_option(name)) {
+                    names.push_back(name);
+                }
+            }
+        }
+    }
+    for (const std::string &name : names) {
+        std::size_t row;
+        chain.find(name, row);
+        std::int64_t expiration;
+        double strike;
+        bool call;
+        parse_option_name(name, expiration, strike, call);
+        double smile = 50.0 + 40.0 * std::pow(std::log(strike / index), 2);  // mark_iv in percent
+        double basis = 2.0e-5 * static_cast<double>(expiration - kNow) / 1000.0;
+        chain.on_ticker(make_ticker(name, smile, 0.0, 0.0, index, basis));  // Mark vol and basis, no quote yet
+        double theo = chain.greeks(row).theo;
+        double half_spread = std::max(1e-4, theo * 0.02);
+        chain.on_ticker(make_ticker(name, smile, std::max(1e-4, theo - half_spread), theo + half_spread, index, basis));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    auto expiries = static_cast<std::size_t>(arg_or(argc, argv, "--expiries", 12));
+    auto strikes = static_cast<std::size_t>(arg_or(argc, argv, "--strikes", 60));
+    auto updates = static_cast<std::size_t>(arg_or(argc, argv, "--updates", 2000));
+    expiries = std::min(expiries, std::size(kExpiries));
+
+    OptionChainConfig config;
+    config.report_every_ms = 0;
+    OptionChain vectorized(config);
+    config.vectorized = false;
+    OptionChain scalar(config);
+    const double index = 60000.0;
+    build(vectorized, expiries, strikes, index);
+    build(scalar, expiries, strikes, index);
+
+    // Random-walk index, each update repricing the whole chain once per kernel
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> step(0.0, 5.0);
+    LatencyHistogram &simd_latency = LatencyRegistry::instance().histogram("bench.options_chain_avx2");
+    LatencyHistogram &scalar_latency = LatencyRegistry::instance().histogram("bench.options_chain_scalar");
+    double price = index;
+    for (std::size_t i = 0; i < updates; ++i) {
+        price += step(rng);
+        std::int64_t now = kNow + static_cast<std::int64_t>(i) * 100;
+        std::uint64_t t0 = TscClock::now();
+        vectorized.set_index(price, now);
+        simd_latency.record_ticks(t0);
+        t0 = TscClock::now();
+        scalar.set_index(price, now);
+        scalar_latency.record_ticks(t0);
+    }
+
+    double max_diff = 0.0;
+    for (const double *(OptionChain::*column)() const :
+         {&OptionChain::theo, &OptionChain::delta, &OptionChain::gamma, &OptionChain::vega, &OptionChain::theta}) {
+        const double *a = (vectorized.*column)();
+        const double *b = (scalar.*column)();
+        for (std::size_t row = 0; row < vectorized.size(); ++row) {
+            max_diff = std::max(max_diff, std::abs(a[row] - b[row]) / std::max(1.0, std::abs(b[row])));
+        }
+    }
+
+    // One ticker on a random strike
+    LatencyHistogram &row_latency = LatencyRegistry::instance().histogram("bench.options_row");
+    for (std::size_t i = 0; i < updates; ++i) {
+        std::size_t row = rng() % vectorized.size();
+        OptionGreeks greeks = vectorized.greeks(row);
+        double mid = std::max(2e-4, greeks.theo);
+        MarketEvent event = make_ticker(vectorized.name(row), greeks.mark_iv * 100.0, mid - 1e-4, mid + 1e-4, price,
+                                        greeks.forward - price);
+        std::uint64_t t0 = TscClock::now();
+        vectorized.on_ticker(event);
+        row_latency.record_ticks(t0);
+    }
+
+    std::cout << "chain " << vectorized.size() << " options (" << expiries << " expiries), " << updates
+              << " index updates\n";
+    std::cout << "avx2 chain reprice:   p50 " << simd_latency.percentile(50.0) << " ns, p99 "
+              << simd_latency.percentile(99.0) << " ns\n";
+    std::cout << "scalar chain reprice: p50 " << scalar_latency.percentile(50.0) << " ns, p99 "
+              << scalar_latency.percentile(99.0) << " ns\n";
+    std::cout << "single-strike ticker: p50 " << row_latency.percentile(50.0) << " ns, p99 "
+              << row_latency.percentile(99.0) << " ns\n";
+    const OptionChainStats &stats = scalar.stats();
+    std::cout << "max relative difference avx2 vs scalar: " << max_diff << ", unsolved mids per reprice "
+              << static_cast<double>(stats.iv_failures) / static_cast<double>(std::max<std::uint64_t>(1, stats.chain_reprices))
+              << " (quotes floored at the 1e-4 tick)\n";
+    return 0;
+}
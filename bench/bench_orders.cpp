@@ -0,0 +1,57 @@
+// Order round-trip latency and pipelined throughput of DeribitClient against the local mock server.
+//   bench_orders [--sequential N] [--burst N] [--window N]
+#include "BenchUtil.hpp"
+#include "MockDeribitServer.hpp"
+#include "DeribitClient.hpp"
+#include "LatencyStats.hpp"
+
+#include <deque>
+#include <iostream>
+
+int main(int argc, char **argv) {
+    auto sequential = static_cast<std::size_t>(arg_or(argc, argv, "--sequential", 2000));
+    auto burst = static_cast<std::size_t>(arg_or(argc, argv, "--burst", 20000));
+    auto window = static_cast<std::size_t>(arg_or(argc, argv, "--window", 256));
+
+    MockDeribitServer::Options options;
+    options.messages_per_second = 0.0;  // No stream traffic competing with order responses
+    MockDeribitServer server(options);
+    server.start();
+
+    DeribitClient client("127.0.0.1", std::to_string(server.port()), "bench-id", "bench-secret");
+    client.set_verify_peer(false);
+    client.connect();
+    client.authenticate();
+
+    // One order at a time: the old interactive path
+    LatencyHistogram &round_trip = LatencyRegistry::instance().histogram("bench.order_round_trip");
+    for (std::size_t i = 0; i < sequential; ++i) {
+        std::uint64_t start = TscClock::now();
+        client.place_order("BTC-PERPETUAL", "limit", 10, 50000.0 + static_cast<double>(i % 100) * 0.5);
+        round_trip.record_ticks(start);
+    }
+
+    // Pipelined: keep up to `window` orders in flight
+    auto burst_start = std::chrono::steady_clock::now();
+    std::deque<std::future<json::value>> in_flight;
+    for (std::size_t i = 0; i < burst; ++i) {
+        in_flight.push_back(i % 2 ? client.async_sell_order("BTC-PERPETUAL", "limit", 10, 70000.0)
+                                  : client.async_place_order("BTC-PERPETUAL", "limit", 10, 50000.0));
+        if (in_flight.size() >= window) {
+            in_flight.front().get();
+            in_flight.pop_front();
+        }
+    }
+    while (!in_flight.empty()) {
+        in_flight.front().get();
+        in_flight.pop_front();
+    }
+    double burst_seconds = seconds_since(burst_start);
+
+    std::cout << "sequential orders:  " << sequential << ", p50 " << round_trip.percentile(50.0) / 1000.0
+              << " us, p99 " << round_trip.percentile(99.0) / 1000.0 << " us\n";
+    std::cout << "pipelined orders:   " << burst << " in " << burst_seconds << " s = "
+              << static_cast<double>(burst) / burst_seconds << " orders/s (window " << window << ")\n\n";
+    LatencyRegistry::instance().report(std::cout);
+    return 0;
+}
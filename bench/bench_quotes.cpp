@@ -0,0 +1,123 @@
+// Reprice a quoted option chain against the local mock server. Each round moves the fair value of a share
+// of the instruments by a few ticks; the engine sends only what changed and the round ends when every
+// response is back. Compared with editing every quote of a moved instrument, one blocking call each.
+//   bench_quotes [--instruments N] [--levels N] [--rounds N] [--moved F] [--tolerance TICKS] [--mass]
+#include "BenchUtil.hpp"
+#include "MockDeribitServer.hpp"
+#include "QuoteEngine.hpp"
+#include "LatencyStats.hpp"
+#include "AsyncLogger.hpp"
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Routes the gateway's order updates into the engine
+class QuoteListener : public Strategy {
+public:
+    void on_order_update(const OrderUpdate &update) override {
+        if (engine_) {
+            engine_->on_order_update(update);
+        }
+    }
+
+    QuoteEngine *engine_ = nullptr;
+};
+
+int main(int argc, char **argv) {
+    auto instruments = static_cast<std::size_t>(arg_or(argc, argv, "--instruments", 200));
+    auto levels = static_cast<std::size_t>(arg_or(argc, argv, "--levels", 3));
+    auto rounds = static_cast<std::size_t>(arg_or(argc, argv, "--rounds", 200));
+    double moved = arg_or(argc, argv, "--moved", 0.3);
+    double tolerance_ticks = arg_or(argc, argv, "--tolerance", 0);
+    bool mass = has_flag(argc, argv, "--mass");
+    constexpr double kTick = 0.0005;
+
+    MockDeribitServer server{MockDeribitServer::Options()};
+    server.start();
+    OrderGateway gateway("127.0.0.1", std::to_string(server.port()), "bench-id", "bench-secret");
+    gateway.set_verify_peer(false);
+    gateway.connect();
+
+    QuoteConfig config;
+    config.levels = levels;
+    config.price_tolerance = tolerance_ticks * kTick;
+    config.mass_quote = mass;
+    config.mmp_group = "bench";
+    QuoteEngine engine(gateway, config);
+    QuoteListener listener;
+    listener.engine_ = &engine;
+    gateway.set_listener(&listener);
+
+    std::vector<std::string> names;
+    std::vector<double> fair(instruments);
+    for (std::size_t i = 0; i < instruments; ++i) {
+        names.push_back("BTC-27DEC24-" + std::to_string(40000 + 1000 * i) + (i % 2 ? "-P" : "-C"));
+        fair[i] = 0.05 + 0.001 * static_cast<double>(i % 50);
+    }
+
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::uniform_int_distribution<int> step(-3, 3);
+    std::vector<QuoteLevel> bids(levels), asks(levels);
+    auto quote = [&](std::size_t i) {
+        for (std::size_t level = 0; level < levels; ++level) {
+            double offset = kTick * static_cast<double>(2 + 2 * level);
+            bids[level] = QuoteLevel{fair[i] - offset, 10};
+            asks[level] = QuoteLevel{fair[i] + offset, 10};
+        }
+        engine.set_quotes(names[i], bids.data(), levels, asks.data(), levels);
+    };
+    auto settle = [&] {
+        engine.flush();
+        while (gateway.in_flight() > 0) {
+            gateway.poll();
+            engine.flush();  // Mass mode: instruments re-queued while their quote was in flight
+        }
+    };
+
+    for (std::size_t i = 0; i < instruments; ++i) {
+        quote(i);
+    }
+    settle();
+    QuoteStats initial = engine.stats();
+
+    LatencyHistogram reprice;
+    std::uint64_t naive_quotes = 0;
+    for (std::size_t round = 0; round < rounds; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < instruments; ++i) {
+            if (coin(rng) >= moved) {
+                continue;
+            }
+            fair[i] += kTick * step(rng);
+            quote(i);
+            naive_quotes += 2 * levels;
+        }
+        settle();
+        reprice.record(static_cast<std::uint64_t>(seconds_since(start) * 1e9));
+    }
+
+    const QuoteStats &stats = engine.stats();
+    std::uint64_t sent = stats.new_orders - initial.new_orders + stats.edits - initial.edits + stats.cancels -
+                         initial.cancels + stats.instrument_cancels - initial.instrument_cancels +
+                         stats.mass_quotes - initial.mass_quotes;
+    std::cout << "\n" << instruments << " instruments x " << levels << " levels x 2 sides, " << rounds
+              << " rounds, " << moved * 100 << "% moved per round" << (mass ? ", mass quote" : "") << "\n";
+    std::cout << "messages sent " << sent << " (new " << stats.new_orders - initial.new_orders << ", edit "
+              << stats.edits - initial.edits << ", cancel " << stats.cancels - initial.cancels << ", mass "
+              << stats.mass_quotes - initial.mass_quotes << "), quotes re-sent without diffing "
+              << naive_quotes << "\n";
+    std::cout << "coalesced " << stats.coalesced << ", rejected " << stats.rejected << ", live quotes "
+              << engine.live_quotes() << "\n";
+    std::cout << "round to all acknowledged p50 " << reprice.percentile(50.0) / 1000.0 << " us, p99 "
+              << reprice.percentile(99.0) / 1000.0 << " us\n";
+
+    engine.pull_all();
+    settle();
+    std::cout << "after pull_all: " << engine.live_quotes() << " live, " << engine.stats().instrument_cancels
+              << " instrument cancels\n\n";
+    AsyncLogger::instance().stop();
+    return 0;
+}
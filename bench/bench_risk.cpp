@@ -0,0 +1,89 @@
+// Cost of the pre-trade risk gate with every limit enabled: one check_order (which reserves) plus the
+// release that a response would trigger, on one thread and with several threads sharing the engine.
+//   bench_risk [--orders N] [--threads N] [--instruments N]
+#include "BenchUtil.hpp"
+#include "RiskEngine.hpp"
+#include "LatencyStats.hpp"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Check and release orders round-robin over ids; returns rejections
+static std::uint64_t run_orders(const std::vector<InstrumentId> &ids, std::size_t orders, std::size_t offset) {
+    RiskEngine &risk = RiskEngine::instance();
+    std::uint64_t rejected = 0;
+    for (std::size_t i = 0; i < orders; ++i) {
+        InstrumentId id = ids[(i + offset) % ids.size()];
+        OrderSide side = (i & 1) ? OrderSide::Sell : OrderSide::Buy;
+        double price = 60000.0 + static_cast<double>(i % 200) - 100.0;
+        if (risk.check_order(id, side, "limit", 10, price) == RiskCheck::Ok) {
+            risk.release(id, side, 10);
+        } else {
+            ++rejected;
+        }
+    }
+    return rejected;
+}
+
+int main(int argc, char **argv) {
+    auto orders = static_cast<std::size_t>(arg_or(argc, argv, "--orders", 10000000));
+    auto threads = static_cast<std::size_t>(arg_or(argc, argv, "--threads", 4));
+    auto instruments = static_cast<std::size_t>(arg_or(argc, argv, "--instruments", 100));
+
+    RiskEngine &risk = RiskEngine::instance();
+    RiskLimits limits;
+    limits.max_order_amount = 1000;
+    limits.max_order_notional = 1e9;
+    limits.max_position = 1e6;
+    limits.price_band = 0.05;
+    limits.max_open_orders = 1000;
+    limits.max_messages_per_second = 1000000000;
+    risk.set_limits(limits);
+
+    std::vector<InstrumentId> ids;
+    for (std::size_t i = 0; i < instruments; ++i) {
+        ids.push_back(InstrumentRegistry::instance().intern("BENCH-" + std::to_string(i)));
+        risk.update_reference(ids.back(), 60000.0, 60000.0);
+    }
+    run_orders(ids, 100000, 0);  // Allocate state and warm the caches
+
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t rejected = run_orders(ids, orders, 0);
+    double elapsed = seconds_since(start);
+    std::cout << "1 thread:  " << elapsed * 1e9 / static_cast<double>(orders) << " ns per check + release, "
+              << rejected << " rejected\n";
+
+    // Sampled single calls, to show the distribution rather than the mean
+    LatencyHistogram &check_latency = LatencyRegistry::instance().histogram("bench.risk_check");
+    for (std::size_t i = 0; i < 1000000; ++i) {
+        InstrumentId id = ids[i % ids.size()];
+        std::uint64_t t0 = TscClock::now();
+        RiskCheck verdict = risk.check_order(id, OrderSide::Buy, "limit", 10, 60000.0);
+        check_latency.record(TscClock::to_ns(TscClock::now() - t0));
+        if (verdict == RiskCheck::Ok) {
+            risk.release(id, OrderSide::Buy, 10);
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::vector<std::uint64_t> thread_rejected(threads);
+    start = std::chrono::steady_clock::now();
+    for (std::size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] { thread_rejected[t] = run_orders(ids, orders / threads, t * 7); });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    elapsed = seconds_since(start);
+    rejected = 0;
+    for (std::uint64_t count : thread_rejected) {
+        rejected += count;
+    }
+    std::cout << threads << " threads: " << elapsed * 1e9 / static_cast<double>(orders / threads * threads)
+              << " ns per check + release (wall clock), " << rejected << " rejected\n";
+    std::cout << "open orders after the run: " << risk.open_orders() << "\n\n";
+    LatencyRegistry::instance().report(std::cout);
+    return 0;
+}
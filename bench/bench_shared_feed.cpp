@@ -0,0 +1,66 @@
+// Publisher-to-reader latency of the shared-memory feed across two processes: the parent publishes
+// trade events through SharedFeedPublisher, a forked child follows them with SharedFeedReader.
+//   bench_shared_feed [--events N] [--rate N]   (rate in events/s, 0 = as fast as possible)
+#include "BenchUtil.hpp"
+#include "SharedFeed.hpp"
+#include "LatencyStats.hpp"
+#include "ClockSync.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <iostream>
+#include <string>
+
+int main(int argc, char **argv) {
+    auto events = static_cast<std::uint64_t>(arg_or(argc, argv, "--events", 1000000));
+    double rate = arg_or(argc, argv, "--rate", 200000);
+    std::string name = "/gotradex_bench_" + std::to_string(::getpid());
+
+    SharedFeedPublisher publisher(name, 16, 65536);
+    pid_t child = ::fork();
+    if (child == 0) {  // Reader process
+        SharedFeedReader reader(name);
+        LatencyHistogram &latency = LatencyRegistry::instance().histogram("bench.shm_publish_to_read");
+        MarketEvent event;
+        std::uint64_t received = 0;
+        while (received + reader.lost() < events) {
+            if (!reader.next(event)) {
+                cpu_relax();
+                continue;
+            }
+            latency.record(static_cast<std::uint64_t>(std::max<std::int64_t>(0, ClockSync::now_ns() - event.receive_ns)));
+            ++received;
+        }
+        SharedInstrumentState state;
+        reader.latest("BTC-PERPETUAL", state);
+        std::cout << "reader: received " << received << ", lost " << reader.lost() << ", last trade seq "
+                  << state.last_trade_seq << "\n";
+        std::cout << "publish -> read: p50 " << latency.percentile(50.0) << " ns, p99 " << latency.percentile(99.0)
+                  << " ns, p99.9 " << latency.percentile(99.9) << " ns\n";
+        std::cout.flush();
+        ::_exit(0);
+    }
+
+    ::usleep(100000);  // Let the reader attach; it starts at the newest event
+    MarketEvent event{};
+    event.type = EventType::Trade;
+    copy_symbol(event.symbol, "BTC-PERPETUAL");
+    event.trade.amount = 10.0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::uint64_t i = 0; i < events; ++i) {
+        if (rate > 0) {
+            while (seconds_since(start) * rate < static_cast<double>(i)) {
+                cpu_relax();
+            }
+        }
+        event.trade.price = 60000.0 + static_cast<double>(i % 100);
+        event.trade.trade_seq = static_cast<std::int64_t>(i);
+        event.receive_ns = ClockSync::now_ns();
+        publisher.publish(event, nullptr);
+    }
+    double seconds = seconds_since(start);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    std::cout << "publisher: " << events << " events in " << seconds << " s = " << events / seconds << " events/s\n";
+    return 0;
+}
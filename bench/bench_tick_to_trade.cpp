@@ -0,0 +1,95 @@
+// Tick-to-trade of the strategy path against the local mock server: book frames arrive on a feed shard,
+// cross the ring to the consumer, reach Strategy::on_book, and the order is written by OrderGateway on
+// the same thread. Measured from the event's receive stamp to the order frame being on the socket.
+//   bench_tick_to_trade [--seconds N] [--rate N] [--every N]
+#include "BenchUtil.hpp"
+#include "MockDeribitServer.hpp"
+#include "Rtm_Server.hpp"
+#include "OrderGateway.hpp"
+#include "LatencyStats.hpp"
+
+#include <iostream>
+#include <thread>
+
+// Sends a far-from-market limit order on every Nth complete book update, alternating sides
+class BenchStrategy : public Strategy {
+public:
+    explicit BenchStrategy(int every) : every_(every) {}
+
+    void on_start(OrderGateway *orders, const MarketAnalytics *) override {
+        orders_ = orders;
+        orders_->warm(OrderSide::Buy, "BTC-PERPETUAL", "limit");
+        orders_->warm(OrderSide::Sell, "BTC-PERPETUAL", "limit");
+    }
+
+    void on_book(const MarketEvent &event, const OrderBook *) override {
+        if (!event.book.last_fragment || ++books_ % every_ != 0) {
+            return;
+        }
+        if (sent_++ % 2 == 0) {
+            orders_->buy("BTC-PERPETUAL", "limit", 10, 1000.0);
+        } else {
+            orders_->sell("BTC-PERPETUAL", "limit", 10, 1000000.0);
+        }
+    }
+
+    void on_order_update(const OrderUpdate &update) override {
+        if (update.request_id != 0) {
+            (update.ok ? acknowledged_ : rejected_)++;
+        }
+    }
+
+    std::uint64_t sent() const { return sent_; }
+    std::uint64_t acknowledged() const { return acknowledged_; }
+    std::uint64_t rejected() const { return rejected_; }
+
+private:
+    int every_;  // Trade on every Nth book update
+    OrderGateway *orders_ = nullptr;
+    std::uint64_t books_ = 0, sent_ = 0, acknowledged_ = 0, rejected_ = 0;
+};
+
+int main(int argc, char **argv) {
+    double seconds = arg_or(argc, argv, "--seconds", 5);
+    double rate = arg_or(argc, argv, "--rate", 1000);
+    auto every = static_cast<int>(arg_or(argc, argv, "--every", 10));
+
+    MockDeribitServer::Options options;
+    options.messages_per_second = rate;
+    MockDeribitServer server(options);
+    server.start();
+    std::string port = std::to_string(server.port());
+
+    OrderGateway gateway("127.0.0.1", port, "bench-id", "bench-secret");
+    gateway.set_verify_peer(false);
+    gateway.connect();
+
+    FeedConfig config;
+    config.instruments = {"BTC-PERPETUAL"};
+    config.channel_templates = {"book.{}.100ms"};
+    config.heartbeat_seconds = 0;
+    Rtm_Server feed;
+    feed.set_endpoint("127.0.0.1", port);
+    feed.set_verify_peer(false);
+    feed.set_feed_config(config);
+    feed.set_wait_mode(WaitMode::BusySpin);
+
+    BenchStrategy strategy(every);
+    feed.set_strategy(&strategy, &gateway);
+    std::thread timer([&feed, seconds] {
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        feed.stop();
+    });
+    feed.run();
+    timer.join();
+    AsyncLogger::instance().stop();
+
+    LatencyHistogram &tick_to_trade = LatencyRegistry::instance().histogram("strategy.tick_to_trade");
+    std::cout << "\norders sent " << strategy.sent() << ", acknowledged " << strategy.acknowledged() << ", rejected "
+              << strategy.rejected() << ", in flight at stop " << gateway.in_flight() << "\n";
+    std::cout << "tick-to-trade p50 " << tick_to_trade.percentile(50.0) / 1000.0 << " us, p99 "
+              << tick_to_trade.percentile(99.0) / 1000.0 << " us, p99.9 " << tick_to_trade.percentile(99.9) / 1000.0
+              << " us\n\n";
+    LatencyRegistry::instance().report(std::cout);
+    return 0;
+}
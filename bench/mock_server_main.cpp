@@ -0,0 +1,22 @@
+// Standalone mock Deribit server for manual runs and CI jobs.
+//   mock_deribit_server [--port N] [--plain] [--rate MSGS_PER_SEC] [--depth LEVELS]
+#include "BenchUtil.hpp"
+#include "MockDeribitServer.hpp"
+
+#include <iostream>
+
+int main(int argc, char **argv) {
+    MockDeribitServer::Options options;
+    options.port = static_cast<unsigned short>(arg_or(argc, argv, "--port", 0));
+    options.tls = !has_flag(argc, argv, "--plain");
+    options.messages_per_second = arg_or(argc, argv, "--rate", 10.0);
+    options.book_depth = static_cast<int>(arg_or(argc, argv, "--depth", 20));
+
+    MockDeribitServer server(options);
+    server.start();
+    std::cout << "Mock Deribit server on " << options.address << ":" << server.port()
+              << (options.tls ? " (TLS, self-signed)" : " (plain)") << std::endl;
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+}
@@ -1,8 +1,244 @@
 #include "TradingSystem.hpp"  // Include TradingSystem class header
+#include "LatencyStats.hpp"  // Periodic latency report dump
+#include "Rtm_Server.hpp"  // Journal replay mode
+#include "OrderBatch.hpp"  // Scripted order entry
+#include "ConnectionBootstrap.hpp"  // Persistent TLS session cache
+#include "InstrumentRegistry.hpp"  // Instrument snapshot file
+#include "RiskEngine.hpp"  // Pre-trade risk limits
+#include "AsyncLogger.hpp"  // Feed output destination
+#include "ImbalanceStrategy.hpp"  // Sample strategy
+#include "SharedFeed.hpp"  // Shared-memory feed reader
+#include "HistoryDownloader.hpp"  // Historical trades and candles
+#include "Runtime.hpp"  // Shared request I/O pool
+#include "OptionChain.hpp"  // Option valuation from the live tickers
 
+#include <cctype>  // Index names
+#include <ctime>  // Date arguments
+#include <iomanip>  // get_time
+#include <sstream>  // Instrument lists and dates
+
+#include <fstream>  // Batch command files
 #include <iostream>  // Standard I/O stream for error messages
+#include <string>  // Command-line flags
+#include <thread>  // Reader idle sleep
+#include <vector>  // History jobs
+
+// Milliseconds since the epoch from "1700000000000", "2024-01-31" or "2024-01-31T12:00" (UTC)
+static std::int64_t parse_time_ms(const std::string& text) {
+    if (text.find('-') == std::string::npos) {
+        return std::stoll(text);
+    }
+    std::tm tm{};
+    std::istringstream in(text);
+    in >> std::get_time(&tm, text.find('T') == std::string::npos ? "%Y-%m-%d" : "%Y-%m-%dT%H:%M");
+    if (in.fail()) {
+        throw std::invalid_argument("Bad date " + text);
+    }
+    return static_cast<std::int64_t>(timegm(&tm)) * 1000;
+}
+
+// Usage: d [--capture <journal>] [--log <file>] [--shm <name>]   (feed events go to stdout without --log)
+//        d --replay <journal> [--speed <x>] [--shm <name>]       (speed 0 = as fast as possible)
+//        d --attach <name>                               (print the feed another d publishes with --shm)
+//        d --batch <file | -> [--rate <orders/s>] [--burst <orders>]
+//        d --strategy <instrument> [--capture <journal>] [--log <file>]   (sample imbalance strategy on the live feed)
+//        d --history <instrument[,instrument...]> [--from <date | ms>] [--to <date | ms>] [--candles <resolution>]
+//          [--dir <directory>] [--connections <N>] [--rate <requests/s>] [--burst <requests>]
+//                                                        (without --from, extend the files already in --dir)
+//        d --options <currency> [--shards <N>] [--log <file>]   (price the currency's option chain and its Greeks live)
+//        any order-sending mode also takes [--risk <limits.json>]   (pre-trade risk limits, see RiskLimits)
+//        any connecting mode also takes [--io-threads <N>] [--io-cpus <cpu[,cpu...]>]   (shared request I/O pool, see Runtime)
+int main(int argc, char* argv[]) {
+    std::string capture_path;  // Record the real-time feed (menu option 8)
+    std::string replay_path;  // Replay a journal instead of starting the trading menu
+    double replay_speed = 1.0;  // Multiple of the recorded pace
+    std::string batch_path;  // Order commands to send instead of starting the menu; "-" reads stdin
+    CreditPool matching = RateLimiter::kDefaultMatching;  // Order-entry pacing
+    CreditPool non_matching = RateLimiter::kDefaultNonMatching;  // History request pacing
+    std::string strategy_instrument;  // Run the sample strategy on this instrument instead of the menu
+    std::string shared_memory_name;  // Publish the feed to this shared-memory region
+    std::string attach_name;  // Read a published feed instead of connecting
+    std::string history_instruments;  // Comma-separated instruments to backfill instead of starting the menu
+    HistoryJob history_template;  // Range and kind shared by every history job
+    HistoryOptions history_options;  // Output directory and concurrency
+    std::size_t io_threads = 0;  // Runtime pool size, 0 for the default
+    std::vector<int> io_cpus;  // Cores for the runtime pool
+    std::string options_currency;  // Value this currency's option chain instead of starting the menu
+    int feed_shards = 1;  // Feed connections for --options (FeedConfig::shards)
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "--capture") {
+            capture_path = argv[i + 1];
+        } else if (flag == "--log") {
+            AsyncLogger::instance().set_file(argv[i + 1]);
+        } else if (flag == "--replay") {
+            replay_path = argv[i + 1];
+        } else if (flag == "--speed") {
+            replay_speed = std::stod(argv[i + 1]);
+        } else if (flag == "--batch") {
+            batch_path = argv[i + 1];
+        } else if (flag == "--rate") {
+            matching.refill_per_second = std::stod(argv[i + 1]) * matching.cost;
+            non_matching.refill_per_second = std::stod(argv[i + 1]) * non_matching.cost;
+        } else if (flag == "--burst") {
+            matching.max_credits = std::stod(argv[i + 1]) * matching.cost;
+            non_matching.max_credits = std::stod(argv[i + 1]) * non_matching.cost;
+        } else if (flag == "--strategy") {
+            strategy_instrument = argv[i + 1];
+        } else if (flag == "--shm") {
+            shared_memory_name = argv[i + 1];
+        } else if (flag == "--attach") {
+            attach_name = argv[i + 1];
+        } else if (flag == "--history") {
+            history_instruments = argv[i + 1];
+        } else if (flag == "--from" || flag == "--to") {
+            try {
+                (flag == "--from" ? history_template.start_ms : history_template.end_ms) = parse_time_ms(argv[i + 1]);
+            } catch (const std::exception&) {
+                std::cerr << "Bad " << flag << " value " << argv[i + 1] << "\n";
+                return 1;
+            }
+        } else if (flag == "--candles") {
+            history_template.kind = HistoryKind::Candles;
+            history_template.resolution = argv[i + 1];
+        } else if (flag == "--dir") {
+            history_options.directory = argv[i + 1];
+        } else if (flag == "--connections") {
+            history_options.connections = std::stoul(argv[i + 1]);
+        } else if (flag == "--options") {
+            options_currency = argv[i + 1];
+        } else if (flag == "--shards") {
+            feed_shards = std::stoi(argv[i + 1]);
+        } else if (flag == "--io-threads") {
+            io_threads = std::stoul(argv[i + 1]);
+        } else if (flag == "--io-cpus") {
+            std::stringstream cpu_list(argv[i + 1]);
+            for (std::string cpu; std::getline(cpu_list, cpu, ',');) {
+                io_cpus.push_back(std::stoi(cpu));
+            }
+        } else if (flag == "--risk") {
+            try {
+                RiskEngine::instance().load_limits(argv[i + 1]);
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        } else {
+            std::cerr << "Unknown option " << flag << "\n";
+            return 1;
+        }
+    }
+
+    Runtime::instance().configure(io_threads, io_cpus);
+
+    if (!replay_path.empty()) {  // Offline: no credentials or connection needed
+        try {
+            Rtm_Server feed;
+            if (!shared_memory_name.empty()) {
+                feed.enable_shared_memory(shared_memory_name);
+            }
+            feed.replay(replay_path, replay_speed);
+        } catch (const std::exception& e) {
+            std::cerr << "Replay failed: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!attach_name.empty()) {  // Another process owns the connection; follow its shared-memory feed
+        try {
+            SharedFeedReader reader(attach_name);
+            MarketEvent event;
+            std::uint64_t reported_lost = 0;
+            while (reader.publisher_alive()) {
+                if (!reader.next(event)) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    continue;
+                }
+                AsyncLogger::instance().log(event);
+                if (reader.lost() != reported_lost) {
+                    std::cerr << "Fell behind the publisher: " << reader.lost() - reported_lost << " events lost\n";
+                    reported_lost = reader.lost();
+                }
+            }
+            AsyncLogger::instance().flush();
+        } catch (const std::exception& e) {
+            std::cerr << "Attach failed: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!history_instruments.empty()) {  // Public market data only: no credentials needed
+        try {
+            std::vector<HistoryJob> jobs;
+            std::istringstream list(history_instruments);
+            std::string instrument;
+            while (std::getline(list, instrument, ',')) {
+                if (!instrument.empty()) {
+                    jobs.push_back(history_template);
+                    jobs.back().instrument = instrument;
+                }
+            }
+            RateLimiter limiter(matching, non_matching);
+            HistoryDownloader downloader("test.deribit.com", "443", limiter, history_options);
+            HistoryReport report = downloader.run(jobs);
+            downloader.print_report(report, std::cout);
+            return report.failed_jobs == 0 ? 0 : 2;
+        } catch (const std::exception& e) {
+            std::cerr << "History download failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (!options_currency.empty()) {  // Public market data only: no credentials needed
+        try {
+            OptionChainConfig chain_config;
+            chain_config.currency = options_currency;
+            chain_config.index_name.clear();
+            for (char c : options_currency) {
+                chain_config.index_name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            chain_config.index_name += "_usd";
+            OptionChain chain(chain_config);
+            {
+                DeribitClient client("test.deribit.com", "443", "", "");
+                client.connect();
+                json::value response = client.async_request(json::value{
+                    {"jsonrpc", "2.0"},
+                    {"method", "public/get_instruments"},
+                    {"params", { {"currency", options_currency}, {"kind", "option"}, {"expired", false} }}
+                }).get();
+                const auto* result = response.as_object().if_contains("result");
+                if (!result) {
+                    throw std::runtime_error("public/get_instruments failed: " + json::serialize(response));
+                }
+                InstrumentRegistry::instance().apply_instruments(*result, true);
+                chain.add_options(*result);
+            }
+            std::cerr << "Valuing " << chain.size() << " " << options_currency << " options\n";
+
+            FeedConfig feed_config = chain.feed_config();
+            feed_config.shards = feed_shards;
+            Rtm_Server feed;
+            feed.set_feed_config(feed_config);
+            feed.set_conflation("ticker.", ConflationPolicy::LatestOnly);  // Only the newest quote of each option matters
+            if (!capture_path.empty()) {
+                feed.enable_capture(capture_path);
+            }
+            if (!shared_memory_name.empty()) {
+                feed.enable_shared_memory(shared_memory_name);
+            }
+            feed.set_strategy(&chain);
+            feed.run();
+            chain.print(std::cout);
+        } catch (const std::exception& e) {
+            std::cerr << "Option chain failed: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
 
-int main() {
     const char* client_id = std::getenv("DERIBIT_CLIENT_ID");  // Retrieve client ID from environment variable
     const char* client_secret = std::getenv("DERIBIT_CLIENT_SECRET");  // Retrieve client secret from environment variable
     if (!client_id || !client_secret) {  // Check if environment variables are set
@@ -10,8 +246,88 @@ int main() {
         return 1;
     }
 
+    // TLS sessions outlive the process so a restart resumes instead of doing full handshakes
+    const char* session_file = std::getenv("GOTRADEX_TLS_SESSION_FILE");
+    const char* home = std::getenv("HOME");
+    if (session_file && *session_file) {
+        ConnectionBootstrap::instance().set_session_file(session_file);
+    } else if (!session_file && home) {
+        ConnectionBootstrap::instance().set_session_file(std::string(home) + "/.gotradex_tls_sessions");
+    }
+
+    // Instrument reference data from the last download, so orders are validated from the first one
+    const char* instrument_file = std::getenv("GOTRADEX_INSTRUMENT_FILE");
+    if (instrument_file && *instrument_file) {
+        InstrumentRegistry::instance().set_snapshot_file(instrument_file);
+    } else if (!instrument_file && home) {
+        InstrumentRegistry::instance().set_snapshot_file(std::string(home) + "/.gotradex_instruments.json");
+    }
+
+    const char* latency_dump = std::getenv("GOTRADEX_LATENCY_DUMP");  // Optional file for periodic latency reports
+    if (latency_dump) {
+        LatencyRegistry::instance().start_periodic_dump(latency_dump, std::chrono::seconds(10));
+    }
+
+    if (!batch_path.empty()) {  // Non-interactive order entry
+        try {
+            std::ifstream file;
+            if (batch_path != "-") {
+                file.open(batch_path);
+                if (!file) {
+                    std::cerr << "Cannot open batch file " << batch_path << "\n";
+                    return 1;
+                }
+            }
+            DeribitClient client("test.deribit.com", "443", client_id, client_secret);
+            client.connect();
+            client.authenticate();
+            RateLimiter limiter(matching);
+            OrderBatch batch(client, limiter);
+            BatchReport report = batch.run(batch_path == "-" ? std::cin : file);
+            batch.print_report(report, std::cout);
+            return report.failed == 0 ? 0 : 2;
+        } catch (const std::exception& e) {
+            std::cerr << "Batch failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    if (!strategy_instrument.empty()) {  // Feed-driven trading on the consumer thread
+        try {
+            ImbalanceConfig strategy_config;
+            strategy_config.instrument = strategy_instrument;
+            ImbalanceStrategy strategy(strategy_config);
+            OrderGateway gateway("test.deribit.com", "443", client_id, client_secret);
+            gateway.connect();
+
+            FeedConfig feed_config;
+            feed_config.instruments = {strategy_instrument};
+            feed_config.channel_templates = {"book.{}.100ms"};
+            Rtm_Server feed;
+            feed.set_feed_config(feed_config);
+            if (!capture_path.empty()) {
+                feed.enable_capture(capture_path);
+            }
+            if (!shared_memory_name.empty()) {
+                feed.enable_shared_memory(shared_memory_name);
+            }
+            feed.set_strategy(&strategy, &gateway);
+            feed.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Strategy failed: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
     try {
         TradingSystem system("test.deribit.com", "443", client_id, client_secret);  // Initialize TradingSystem with connection details
+        if (!capture_path.empty()) {
+            system.set_capture_path(capture_path);
+        }
+        if (!shared_memory_name.empty()) {
+            system.set_shared_memory(shared_memory_name);
+        }
         system.main_menu();  // Display main menu for user interaction
     } catch (const std::exception& e) {  // Catch any exceptions and display error
         std::cerr << "Fatal error: " << e.what() << "\n";  // Print exception message